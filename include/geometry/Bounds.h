@@ -0,0 +1,55 @@
+#ifndef BOUNDS_H
+#define BOUNDS_H
+
+#include <glm/glm.hpp>
+
+#include <cfloat>
+#include <cstddef>
+
+#include <geometry/Vertex.h>
+
+// 轴对齐包围盒，默认是空的（min > max），expand 之后才有效
+struct Bounds
+{
+  glm::vec3 min = glm::vec3(FLT_MAX);
+  glm::vec3 max = glm::vec3(-FLT_MAX);
+
+  bool empty() const
+  {
+    return min.x > max.x;
+  }
+
+  void expand(const glm::vec3 &point)
+  {
+    min = glm::min(min, point);
+    max = glm::max(max, point);
+  }
+
+  void expand(const Bounds &other)
+  {
+    if (other.empty())
+      return;
+    min = glm::min(min, other.min);
+    max = glm::max(max, other.max);
+  }
+
+  glm::vec3 center() const
+  {
+    return (min + max) * 0.5f;
+  }
+
+  glm::vec3 extents() const
+  {
+    return (max - min) * 0.5f;
+  }
+
+  static Bounds of(const Vertex *vertices, size_t count)
+  {
+    Bounds bounds;
+    for (size_t i = 0; i < count; i++)
+      bounds.expand(vertices[i].Position);
+    return bounds;
+  }
+};
+
+#endif
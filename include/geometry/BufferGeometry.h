@@ -9,27 +9,21 @@
 #include <vector>
 #include <iostream>
 
+#include <tool/render_state.h>
+#include <geometry/GeometryHandle.h>
+#include <geometry/Tangents.h>
+
 using namespace std;
 
 const float PI = glm::pi<float>();
 
-// mesh.h中也定义此属性
-struct Vertex
-{
-  glm::vec3 Position;  // 顶点位置
-  glm::vec3 Normal;    // 法线
-  glm::vec2 TexCoords; // 纹理坐标
-
-  glm::vec3 Tangent;   // 切线
-  glm::vec3 Bitangent; // 副切线
-};
-
-class BufferGeometry
+// 几何体基类，子类在构造函数中填充 vertices / indices 后调用 setupBuffers() 上传
+// 作为 GPU 资源句柄只能移动，不能按值传递，绘制使用 drawMesh(geometry)
+class BufferGeometry : public GeometryHandle
 {
 public:
   vector<Vertex> vertices;
   vector<unsigned int> indices;
-  unsigned int VAO;
 
   void logParameters()
   {
@@ -43,57 +37,31 @@ public:
     }
   }
 
-  // 计算切线向量并添加到顶点属性中
+  // 计算切线向量并添加到顶点属性中，setupBuffers() 上传前会自动调用
   void computeTangents()
   {
+    generateTangents(vertices, indices);
   }
 
-  void dispose()
+  // 释放 CPU 端的顶点和索引，之后仍可绘制，但不能再修改或重新上传
+  void releaseCpuData()
   {
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
-    glDeleteVertexArrays(1, &VAO);
-    glDeleteBuffers(1, &VBO);
-    glDeleteBuffers(1, &EBO);
+    vector<Vertex>().swap(vertices);
+    vector<unsigned int>().swap(indices);
   }
 
 private:
   glm::mat4 matrix = glm::mat4(1.0f);
 
 protected:
-  unsigned int VBO, EBO;
-
+  // 按 GeometryHandle::defaultLayout 上传
   void setupBuffers()
   {
-    glGenVertexArrays(1, &VAO);
-    glGenBuffers(1, &VBO);
-    glGenBuffers(1, &EBO);
-
-    glBindVertexArray(VAO);
-
-    // vertex attribute
-    glBindBuffer(GL_ARRAY_BUFFER, VBO);
-    glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(Vertex), &vertices[0], GL_DYNAMIC_DRAW);
-
-    // indixes
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned int), &indices[0], GL_STATIC_DRAW);
-
-    // 设置顶点属性指针
-    // Position
-    glEnableVertexAttribArray(0);
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void *)0);
-
-    // Normal
-    glEnableVertexAttribArray(1);
-    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void *)offsetof(Vertex, Normal));
-
-    // TexCoords
-    glEnableVertexAttribArray(2);
-    glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void *)offsetof(Vertex, TexCoords));
+    computeTangents();
+    upload(vertices, indices, defaultLayout);
 
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
-    glBindVertexArray(0);
+    if (!keepCpuData)
+      releaseCpuData();
   }
 };
 #endif
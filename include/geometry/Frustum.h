@@ -0,0 +1,406 @@
+#ifndef FRUSTUM_H
+#define FRUSTUM_H
+
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+#include <geometry/Bounds.h>
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#define FRUSTUM_AVX 1
+#endif
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define FRUSTUM_SSE2 1
+#endif
+
+// 视锥体的六个平面，xyz 为指向内侧的单位法线，点 p 在平面内侧时 dot(xyz, p) + w >= 0
+struct Frustum
+{
+  glm::vec4 planes[6]; // 左、右、下、上、近、远
+  // 距离剔除：包围球离 eye 超过 maxDistance 时不可见，0 表示不限制。只用于包围球的测试
+  glm::vec3 eye = glm::vec3(0.0f);
+  float maxDistance = 0.0f;
+
+  // 从 projection * view（或 projection * view * model，此时在模型空间中测试）提取平面（Gribb / Hartmann）
+  static Frustum fromMatrix(const glm::mat4 &matrix)
+  {
+    glm::vec4 row0(matrix[0][0], matrix[1][0], matrix[2][0], matrix[3][0]);
+    glm::vec4 row1(matrix[0][1], matrix[1][1], matrix[2][1], matrix[3][1]);
+    glm::vec4 row2(matrix[0][2], matrix[1][2], matrix[2][2], matrix[3][2]);
+    glm::vec4 row3(matrix[0][3], matrix[1][3], matrix[2][3], matrix[3][3]);
+    Frustum frustum;
+    frustum.planes[0] = row3 + row0;
+    frustum.planes[1] = row3 - row0;
+    frustum.planes[2] = row3 + row1;
+    frustum.planes[3] = row3 - row1;
+    frustum.planes[4] = row3 + row2;
+    frustum.planes[5] = row3 - row2;
+    for (glm::vec4 &plane : frustum.planes)
+      plane /= glm::length(glm::vec3(plane));
+    return frustum;
+  }
+
+  // 比远平面更近的距离上限，按到相机的距离剔除而不是按平面，转动相机时剔除的范围不变
+  void setDistanceCutoff(const glm::vec3 &position, float distance)
+  {
+    eye = position;
+    maxDistance = distance;
+  }
+
+  bool withinDistance(const glm::vec3 &center, float radius) const
+  {
+    if (maxDistance <= 0.0f)
+      return true;
+    glm::vec3 offset = center - eye;
+    float limit = maxDistance + radius;
+    return (offset.x * offset.x + offset.y * offset.y) + offset.z * offset.z <= limit * limit;
+  }
+
+  bool intersectsSphere(const glm::vec3 &center, float radius) const
+  {
+    for (const glm::vec4 &plane : planes)
+      if (glm::dot(glm::vec3(plane), center) + plane.w < -radius)
+        return false;
+    return withinDistance(center, radius);
+  }
+
+  // 包围盒在某个平面外侧时不可见；与平面相交或在所有平面内侧时可见（保守，角落附近可能误判为可见）
+  bool intersects(const Bounds &bounds) const
+  {
+    if (bounds.empty())
+      return false;
+    glm::vec3 center = bounds.center(), extents = bounds.extents();
+    for (const glm::vec4 &plane : planes)
+    {
+      float radius = glm::dot(glm::abs(glm::vec3(plane)), extents);
+      if (glm::dot(glm::vec3(plane), center) + plane.w < -radius)
+        return false;
+    }
+    return true;
+  }
+};
+
+// 包围盒在 matrix 变换后的轴对齐包围盒（Arvo）
+inline Bounds transformBounds(const Bounds &bounds, const glm::mat4 &matrix)
+{
+  if (bounds.empty())
+    return bounds;
+  glm::vec3 center = glm::vec3(matrix * glm::vec4(bounds.center(), 1.0f));
+  glm::vec3 extents = bounds.extents();
+  glm::vec3 worldExtents = glm::abs(glm::vec3(matrix[0])) * extents.x + glm::abs(glm::vec3(matrix[1])) * extents.y +
+                           glm::abs(glm::vec3(matrix[2])) * extents.z;
+  Bounds result;
+  result.min = center - worldExtents;
+  result.max = center + worldExtents;
+  return result;
+}
+
+// 结构体数组形式的包围球，批量剔除时一次读取 4 / 8 个
+struct SphereSoA
+{
+  std::vector<float> x, y, z, radius;
+
+  size_t size() const
+  {
+    return x.size();
+  }
+
+  void clear()
+  {
+    x.clear();
+    y.clear();
+    z.clear();
+    radius.clear();
+  }
+
+  void reserve(size_t count)
+  {
+    x.reserve(count);
+    y.reserve(count);
+    z.reserve(count);
+    radius.reserve(count);
+  }
+
+  void push(const glm::vec3 &center, float r)
+  {
+    x.push_back(center.x);
+    y.push_back(center.y);
+    z.push_back(center.z);
+    radius.push_back(r);
+  }
+
+  // 模型空间的包围盒经过 matrix 变换后的外接球，半径按最大的轴缩放
+  void push(const Bounds &bounds, const glm::mat4 &matrix)
+  {
+    float scale = std::max(glm::length(glm::vec3(matrix[0])), std::max(glm::length(glm::vec3(matrix[1])), glm::length(glm::vec3(matrix[2]))));
+    push(glm::vec3(matrix * glm::vec4(bounds.center(), 1.0f)), glm::length(bounds.extents()) * scale);
+  }
+};
+
+// 结构体数组形式的轴对齐包围盒（中心和半长）
+struct BoundsSoA
+{
+  std::vector<float> centerX, centerY, centerZ, extentX, extentY, extentZ;
+
+  size_t size() const
+  {
+    return centerX.size();
+  }
+
+  void clear()
+  {
+    for (std::vector<float> *column : {&centerX, &centerY, &centerZ, &extentX, &extentY, &extentZ})
+      column->clear();
+  }
+
+  void push(const Bounds &bounds)
+  {
+    glm::vec3 center = bounds.center(), extents = bounds.extents();
+    centerX.push_back(center.x);
+    centerY.push_back(center.y);
+    centerZ.push_back(center.z);
+    extentX.push_back(extents.x);
+    extentY.push_back(extents.y);
+    extentZ.push_back(extents.z);
+  }
+};
+
+struct CullStats
+{
+  size_t tested = 0;
+  size_t visible = 0; // 提交绘制的数量
+  size_t culled = 0;
+  double ms = 0.0;
+
+  void add(const CullStats &other)
+  {
+    tested += other.tested;
+    visible += other.visible;
+    culled += other.culled;
+    ms += other.ms;
+  }
+};
+
+// 批量视锥剔除，把可见项的下标写入 visible（需要至少 end - begin 的空间），返回可见的数量
+//
+// 编译时打开 AVX（-mavx / -march=native）时一次测试 8 个，x86 上默认用 SSE2 一次 4 个，其他平台逐个测试。
+// mode 可以强制使用较窄的实现，便于比较；三种实现的结果相同
+class FrustumCuller
+{
+public:
+  enum class Mode
+  {
+    Scalar,
+    Sse,
+    Avx,
+    Best,
+  };
+
+  inline static CullStats stats;     // 当前帧，每次 cull 累加；多个线程同时 cull 时 ms 是各线程耗时之和
+  inline static CullStats lastFrame; // 上一帧
+
+  // 每帧开始时调用一次
+  static void beginFrame()
+  {
+    lastFrame = stats;
+    stats = CullStats();
+  }
+
+  static const char *modeName(Mode mode)
+  {
+    switch (resolve(mode))
+    {
+    case Mode::Avx:
+      return "AVX";
+    case Mode::Sse:
+      return "SSE2";
+    default:
+      return "scalar";
+    }
+  }
+
+  static size_t cull(const Frustum &frustum, const SphereSoA &spheres, size_t begin, size_t end, uint32_t *visible, Mode mode = Mode::Best)
+  {
+    auto start = std::chrono::steady_clock::now();
+    size_t count = 0, i = begin;
+    mode = resolve(mode);
+    bool cutoff = frustum.maxDistance > 0.0f;
+#ifdef FRUSTUM_AVX
+    if (mode == Mode::Avx)
+      for (; i + 8 <= end; i += 8)
+      {
+        __m256 cx = _mm256_loadu_ps(&spheres.x[i]), cy = _mm256_loadu_ps(&spheres.y[i]), cz = _mm256_loadu_ps(&spheres.z[i]);
+        __m256 negativeRadius = _mm256_sub_ps(_mm256_setzero_ps(), _mm256_loadu_ps(&spheres.radius[i]));
+        __m256 inside = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+        for (const glm::vec4 &plane : frustum.planes)
+        {
+          __m256 distance = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(cx, _mm256_set1_ps(plane.x)), _mm256_mul_ps(cy, _mm256_set1_ps(plane.y))),
+                                          _mm256_add_ps(_mm256_mul_ps(cz, _mm256_set1_ps(plane.z)), _mm256_set1_ps(plane.w)));
+          inside = _mm256_and_ps(inside, _mm256_cmp_ps(distance, negativeRadius, _CMP_GE_OQ));
+        }
+        if (cutoff)
+        {
+          __m256 dx = _mm256_sub_ps(cx, _mm256_set1_ps(frustum.eye.x)), dy = _mm256_sub_ps(cy, _mm256_set1_ps(frustum.eye.y)),
+                 dz = _mm256_sub_ps(cz, _mm256_set1_ps(frustum.eye.z));
+          __m256 squared = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(dx, dx), _mm256_mul_ps(dy, dy)), _mm256_mul_ps(dz, dz));
+          __m256 limit = _mm256_sub_ps(_mm256_set1_ps(frustum.maxDistance), negativeRadius);
+          inside = _mm256_and_ps(inside, _mm256_cmp_ps(squared, _mm256_mul_ps(limit, limit), _CMP_LE_OQ));
+        }
+        count += writeMask(_mm256_movemask_ps(inside), i, visible + count);
+      }
+#endif
+#ifdef FRUSTUM_SSE2
+    if (mode != Mode::Scalar)
+      for (; i + 4 <= end; i += 4)
+      {
+        __m128 cx = _mm_loadu_ps(&spheres.x[i]), cy = _mm_loadu_ps(&spheres.y[i]), cz = _mm_loadu_ps(&spheres.z[i]);
+        __m128 negativeRadius = _mm_sub_ps(_mm_setzero_ps(), _mm_loadu_ps(&spheres.radius[i]));
+        __m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+        for (const glm::vec4 &plane : frustum.planes)
+        {
+          __m128 distance = _mm_add_ps(_mm_add_ps(_mm_mul_ps(cx, _mm_set1_ps(plane.x)), _mm_mul_ps(cy, _mm_set1_ps(plane.y))),
+                                       _mm_add_ps(_mm_mul_ps(cz, _mm_set1_ps(plane.z)), _mm_set1_ps(plane.w)));
+          inside = _mm_and_ps(inside, _mm_cmpge_ps(distance, negativeRadius));
+        }
+        if (cutoff)
+        {
+          __m128 dx = _mm_sub_ps(cx, _mm_set1_ps(frustum.eye.x)), dy = _mm_sub_ps(cy, _mm_set1_ps(frustum.eye.y)), dz = _mm_sub_ps(cz, _mm_set1_ps(frustum.eye.z));
+          __m128 squared = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)), _mm_mul_ps(dz, dz));
+          __m128 limit = _mm_sub_ps(_mm_set1_ps(frustum.maxDistance), negativeRadius);
+          inside = _mm_and_ps(inside, _mm_cmple_ps(squared, _mm_mul_ps(limit, limit)));
+        }
+        count += writeMask(_mm_movemask_ps(inside), i, visible + count);
+      }
+#endif
+    // 与 SIMD 相同的运算顺序，结果逐个相同
+    for (; i < end; i++)
+    {
+      bool inside = true;
+      for (const glm::vec4 &plane : frustum.planes)
+        inside = inside && (spheres.x[i] * plane.x + spheres.y[i] * plane.y) + (spheres.z[i] * plane.z + plane.w) >= -spheres.radius[i];
+      if (inside && cutoff)
+        inside = frustum.withinDistance(glm::vec3(spheres.x[i], spheres.y[i], spheres.z[i]), spheres.radius[i]);
+      if (inside)
+        visible[count++] = (uint32_t)i;
+    }
+    record(end - begin, count, std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+    return count;
+  }
+
+  static size_t cull(const Frustum &frustum, const BoundsSoA &bounds, size_t begin, size_t end, uint32_t *visible, Mode mode = Mode::Best)
+  {
+    auto start = std::chrono::steady_clock::now();
+    size_t count = 0, i = begin;
+    mode = resolve(mode);
+    glm::vec4 absolute[6];
+    for (int p = 0; p < 6; p++)
+      absolute[p] = glm::abs(frustum.planes[p]);
+#ifdef FRUSTUM_AVX
+    if (mode == Mode::Avx)
+      for (; i + 8 <= end; i += 8)
+      {
+        __m256 cx = _mm256_loadu_ps(&bounds.centerX[i]), cy = _mm256_loadu_ps(&bounds.centerY[i]), cz = _mm256_loadu_ps(&bounds.centerZ[i]);
+        __m256 ex = _mm256_loadu_ps(&bounds.extentX[i]), ey = _mm256_loadu_ps(&bounds.extentY[i]), ez = _mm256_loadu_ps(&bounds.extentZ[i]);
+        __m256 inside = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+        for (int p = 0; p < 6; p++)
+        {
+          const glm::vec4 &plane = frustum.planes[p];
+          __m256 distance = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(cx, _mm256_set1_ps(plane.x)), _mm256_mul_ps(cy, _mm256_set1_ps(plane.y))),
+                                          _mm256_add_ps(_mm256_mul_ps(cz, _mm256_set1_ps(plane.z)), _mm256_set1_ps(plane.w)));
+          __m256 radius = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(ex, _mm256_set1_ps(absolute[p].x)), _mm256_mul_ps(ey, _mm256_set1_ps(absolute[p].y))),
+                                        _mm256_mul_ps(ez, _mm256_set1_ps(absolute[p].z)));
+          inside = _mm256_and_ps(inside, _mm256_cmp_ps(_mm256_add_ps(distance, radius), _mm256_setzero_ps(), _CMP_GE_OQ));
+        }
+        count += writeMask(_mm256_movemask_ps(inside), i, visible + count);
+      }
+#endif
+#ifdef FRUSTUM_SSE2
+    if (mode != Mode::Scalar)
+      for (; i + 4 <= end; i += 4)
+      {
+        __m128 cx = _mm_loadu_ps(&bounds.centerX[i]), cy = _mm_loadu_ps(&bounds.centerY[i]), cz = _mm_loadu_ps(&bounds.centerZ[i]);
+        __m128 ex = _mm_loadu_ps(&bounds.extentX[i]), ey = _mm_loadu_ps(&bounds.extentY[i]), ez = _mm_loadu_ps(&bounds.extentZ[i]);
+        __m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+        for (int p = 0; p < 6; p++)
+        {
+          const glm::vec4 &plane = frustum.planes[p];
+          __m128 distance = _mm_add_ps(_mm_add_ps(_mm_mul_ps(cx, _mm_set1_ps(plane.x)), _mm_mul_ps(cy, _mm_set1_ps(plane.y))),
+                                       _mm_add_ps(_mm_mul_ps(cz, _mm_set1_ps(plane.z)), _mm_set1_ps(plane.w)));
+          __m128 radius = _mm_add_ps(_mm_add_ps(_mm_mul_ps(ex, _mm_set1_ps(absolute[p].x)), _mm_mul_ps(ey, _mm_set1_ps(absolute[p].y))),
+                                     _mm_mul_ps(ez, _mm_set1_ps(absolute[p].z)));
+          inside = _mm_and_ps(inside, _mm_cmpge_ps(_mm_add_ps(distance, radius), _mm_setzero_ps()));
+        }
+        count += writeMask(_mm_movemask_ps(inside), i, visible + count);
+      }
+#endif
+    for (; i < end; i++)
+    {
+      bool inside = true;
+      for (int p = 0; p < 6; p++)
+      {
+        const glm::vec4 &plane = frustum.planes[p];
+        float distance = (bounds.centerX[i] * plane.x + bounds.centerY[i] * plane.y) + (bounds.centerZ[i] * plane.z + plane.w);
+        float radius = (bounds.extentX[i] * absolute[p].x + bounds.extentY[i] * absolute[p].y) + bounds.extentZ[i] * absolute[p].z;
+        inside = inside && distance + radius >= 0.0f;
+      }
+      if (inside)
+        visible[count++] = (uint32_t)i;
+    }
+    record(end - begin, count, std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+    return count;
+  }
+
+  // 逐个测试的调用方（例如 Model::Draw）自己计入统计
+  static void record(size_t tested, size_t visible, double ms)
+  {
+    static std::mutex lock;
+    std::lock_guard<std::mutex> guard(lock);
+    CullStats frame;
+    frame.tested = tested;
+    frame.visible = visible;
+    frame.culled = tested - visible;
+    frame.ms = ms;
+    stats.add(frame);
+  }
+
+private:
+  static Mode resolve(Mode mode)
+  {
+#ifndef FRUSTUM_AVX
+    if (mode == Mode::Avx || mode == Mode::Best)
+      mode = Mode::Sse;
+#else
+    if (mode == Mode::Best)
+      mode = Mode::Avx;
+#endif
+#ifndef FRUSTUM_SSE2
+    mode = Mode::Scalar;
+#endif
+    return mode;
+  }
+
+  // 按位写出 mask 中可见项的下标
+  static size_t writeMask(int mask, size_t base, uint32_t *out)
+  {
+    size_t count = 0;
+    while (mask != 0)
+    {
+      int bit = 0;
+      while (((mask >> bit) & 1) == 0)
+        bit++;
+      out[count++] = (uint32_t)(base + bit);
+      mask &= mask - 1;
+    }
+    return count;
+  }
+};
+
+#endif
@@ -0,0 +1,200 @@
+#ifndef GEOMETRY_HANDLE_H
+#define GEOMETRY_HANDLE_H
+
+#include <glad/glad.h>
+
+#include <utility>
+#include <vector>
+
+#include <tool/render_state.h>
+#include <tool/upload_scheduler.h>
+#include <geometry/Bounds.h>
+#include <geometry/Vertex.h>
+#include <geometry/VertexLayout.h>
+
+// 一份已上传到 GPU 的几何体：持有 VAO/VBO/EBO 以及绘制所需的索引数量和类型
+//
+// 只能移动不能复制，析构时自动释放 GL 对象，移动后原对象不再持有任何资源。
+// 绘制只依赖 indexCount / indexType，所以上传之后可以释放 CPU 端的顶点/索引数组
+//
+// 析构时需要 GL 上下文仍然存在，生命周期覆盖到 glfwTerminate() 之后的对象请提前调用 dispose()
+class GeometryHandle
+{
+public:
+  unsigned int VAO = 0;
+  GLsizei indexCount = 0;
+  GLenum indexType = GL_UNSIGNED_INT;
+
+  // 上传到 GPU 的字节数
+  size_t vertexBytes = 0;
+  size_t indexBytes = 0;
+
+  // 模型空间的包围盒，上传时计算
+  Bounds bounds;
+
+  // 为 false 时，BufferGeometry / Mesh 上传完成后立即释放 CPU 端的 vertices 和 indices
+  inline static bool keepCpuData = true;
+
+  // 之后创建的 BufferGeometry / Mesh 使用的顶点布局，例如 VertexLayout::compact()
+  inline static VertexLayout defaultLayout = VertexLayout::standard();
+
+  GeometryHandle() = default;
+
+  GeometryHandle(const GeometryHandle &) = delete;
+  GeometryHandle &operator=(const GeometryHandle &) = delete;
+
+  GeometryHandle(GeometryHandle &&other) noexcept
+  {
+    take(other);
+  }
+
+  GeometryHandle &operator=(GeometryHandle &&other) noexcept
+  {
+    if (this != &other)
+    {
+      dispose();
+      take(other);
+    }
+    return *this;
+  }
+
+  ~GeometryHandle()
+  {
+    dispose();
+  }
+
+  bool valid() const
+  {
+    return VAO != 0;
+  }
+
+  // 可以重复调用，只有第一次真正删除
+  void dispose()
+  {
+    if (VAO != 0)
+    {
+      RenderState::forgetVertexArray(VAO);
+      glDeleteVertexArrays(1, &VAO);
+    }
+    if (VBO != 0)
+    {
+      UploadScheduler::cancelBuffer(VBO);
+      glDeleteBuffers(1, &VBO);
+    }
+    if (EBO != 0)
+    {
+      UploadScheduler::cancelBuffer(EBO);
+      glDeleteBuffers(1, &EBO);
+    }
+    VAO = VBO = EBO = 0;
+    indexCount = 0;
+    vertexBytes = indexBytes = 0;
+    bounds = Bounds();
+  }
+
+  // GL 4.4 起使用不可变存储（glBufferStorage），否则退回 glBufferData(GL_STATIC_DRAW)
+  static bool immutableStorage()
+  {
+    return GLAD_GL_VERSION_4_4 != 0;
+  }
+
+protected:
+  unsigned int VBO = 0, EBO = 0;
+
+  // 按布局打包并上传，重新上传前先释放旧的对象
+  void upload(const std::vector<Vertex> &vertices, const std::vector<unsigned int> &indices, const VertexLayout &requested)
+  {
+    upload(vertices.data(), vertices.size(), indices.data(), indices.size(), requested);
+  }
+
+  // 数据可以来自任意内存（例如映射的 MeshCache 文件），已知包围盒时传入以省去一次遍历
+  void upload(const Vertex *vertices, size_t numVertices, const unsigned int *indices, size_t numIndices, const VertexLayout &requested, const Bounds *knownBounds = nullptr)
+  {
+    dispose();
+    if (numVertices == 0 || numIndices == 0)
+      return;
+
+    bounds = knownBounds ? *knownBounds : Bounds::of(vertices, numVertices);
+    VertexLayout layout = requested.resolve(vertices, numVertices);
+    glGenVertexArrays(1, &VAO);
+    glGenBuffers(1, &VBO);
+    glGenBuffers(1, &EBO);
+
+    RenderState::bindVertexArray(VAO);
+
+    // 标准布局与 Vertex 的内存布局相同，直接上传
+    glBindBuffer(GL_ARRAY_BUFFER, VBO);
+    vertexBytes = numVertices * layout.stride();
+    if (layout.stride() == sizeof(Vertex))
+      bufferData(GL_ARRAY_BUFFER, VBO, VAO, vertexBytes, vertices);
+    else
+      bufferData(GL_ARRAY_BUFFER, VBO, VAO, vertexBytes, layout.pack(vertices, numVertices).data());
+
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+    indexCount = (GLsizei)numIndices;
+    if (layout.useIndex16(numVertices))
+    {
+      std::vector<unsigned short> shortIndices(indices, indices + numIndices);
+      indexType = GL_UNSIGNED_SHORT;
+      indexBytes = shortIndices.size() * sizeof(unsigned short);
+      bufferData(GL_ELEMENT_ARRAY_BUFFER, EBO, VAO, indexBytes, shortIndices.data());
+    }
+    else
+    {
+      indexType = GL_UNSIGNED_INT;
+      indexBytes = numIndices * sizeof(unsigned int);
+      bufferData(GL_ELEMENT_ARRAY_BUFFER, EBO, VAO, indexBytes, indices);
+    }
+
+    layout.apply();
+
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    RenderState::bindVertexArray(0);
+  }
+
+private:
+  void take(GeometryHandle &other)
+  {
+    VAO = std::exchange(other.VAO, 0);
+    VBO = std::exchange(other.VBO, 0);
+    EBO = std::exchange(other.EBO, 0);
+    indexCount = std::exchange(other.indexCount, 0);
+    indexType = other.indexType;
+    vertexBytes = std::exchange(other.vertexBytes, 0);
+    indexBytes = std::exchange(other.indexBytes, 0);
+    bounds = std::exchange(other.bounds, Bounds());
+  }
+
+  // UploadScheduler::enabled 时只分配存储，数据在之后的帧里复制进来，复制完成前 drawMesh 跳过这个 VAO
+  static void bufferData(GLenum target, unsigned int buffer, unsigned int gate, size_t size, const void *data)
+  {
+    bool deferred = UploadScheduler::enabled;
+    const void *initial = deferred ? nullptr : data;
+    if (immutableStorage())
+      glBufferStorage(target, size, initial, 0);
+    else
+      glBufferData(target, size, initial, GL_STATIC_DRAW);
+    if (deferred)
+      UploadScheduler::buffer(buffer, 0, data, size, gate);
+  }
+};
+
+// 所有示例共用的绘制函数
+// ------------------------------------------------------------------------
+inline void drawMesh(const GeometryHandle &geometry, GLenum mode = GL_TRIANGLES)
+{
+  if (!UploadScheduler::ready(geometry.VAO))
+    return;
+  RenderState::bindVertexArray(geometry.VAO);
+  glDrawElements(mode, geometry.indexCount, geometry.indexType, 0);
+}
+
+inline void drawMeshInstanced(const GeometryHandle &geometry, GLsizei instanceCount, GLenum mode = GL_TRIANGLES)
+{
+  if (!UploadScheduler::ready(geometry.VAO))
+    return;
+  RenderState::bindVertexArray(geometry.VAO);
+  glDrawElementsInstanced(mode, geometry.indexCount, geometry.indexType, 0, instanceCount);
+}
+
+#endif
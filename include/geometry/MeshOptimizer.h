@@ -0,0 +1,418 @@
+#ifndef MESH_OPTIMIZER_H
+#define MESH_OPTIMIZER_H
+
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <geometry/Vertex.h>
+
+// 顶点缓存统计（FIFO 缓存模拟），保存原始计数，多个网格的统计可以直接相加
+// ACMR：每个三角形平均变换的顶点数，0.5 ~ 3，越小越好
+// ATVR：变换次数 / 顶点数，最好为 1
+struct VertexCacheStats
+{
+  size_t misses = 0;
+  size_t triangles = 0;
+  size_t vertices = 0;
+
+  float acmr() const
+  {
+    return triangles > 0 ? (float)misses / triangles : 0.0f;
+  }
+
+  float atvr() const
+  {
+    return vertices > 0 ? (float)misses / vertices : 0.0f;
+  }
+
+  void add(const VertexCacheStats &other)
+  {
+    misses += other.misses;
+    triangles += other.triangles;
+    vertices += other.vertices;
+  }
+};
+
+struct MeshOptimizeStats
+{
+  VertexCacheStats before;
+  VertexCacheStats after;
+
+  void add(const MeshOptimizeStats &other)
+  {
+    before.add(other.before);
+    after.add(other.after);
+  }
+
+  void print(const std::string &name) const
+  {
+    std::cout << "MESH_OPTIMIZER " << name << ": " << after.triangles << " triangles, vertices " << before.vertices << " -> " << after.vertices
+              << ", ACMR " << before.acmr() << " -> " << after.acmr() << ", ATVR " << before.atvr() << " -> " << after.atvr() << std::endl;
+  }
+};
+
+// 网格优化，在上传前对三角形列表依次执行：
+// 1. weld：合并所有属性逐字节相同的顶点（OBJ 导入后每个角都是独立的顶点）
+// 2. tipsify：重排三角形以提高顶点后变换缓存命中率（Sander et al. 2007）
+// 3. optimizeOverdraw：把 tipsify 的结果切成簇，按朝外程度排序，先画外侧减少过度绘制
+// 4. optimizeVertexFetch：按首次使用的顺序重排顶点，提高顶点读取的内存局部性
+//
+// 第 3 步只在簇内 ACMR 不超过 overdrawThreshold 倍时切分，缓存命中率基本不受影响
+class MeshOptimizer
+{
+public:
+  inline static bool enabled = true;
+  inline static unsigned int cacheSize = 16;
+  inline static float overdrawThreshold = 1.05f;
+
+  static MeshOptimizeStats optimize(std::vector<Vertex> &vertices, std::vector<unsigned int> &indices)
+  {
+    MeshOptimizeStats stats;
+    stats.before = analyzeVertexCache(indices, vertices.size());
+
+    weld(vertices, indices);
+    std::vector<unsigned int> clusters;
+    indices = tipsify(indices, vertices.size(), cacheSize, &clusters);
+    optimizeOverdraw(indices, vertices, clusters, overdrawThreshold);
+    optimizeVertexFetch(vertices, indices);
+
+    stats.after = analyzeVertexCache(indices, vertices.size());
+    return stats;
+  }
+
+  // 模拟 FIFO 缓存
+  // ------------------------------------------------------------------------
+  static VertexCacheStats analyzeVertexCache(const std::vector<unsigned int> &indices, size_t vertexCount, unsigned int size = 0)
+  {
+    VertexCacheStats stats;
+    stats.triangles = indices.size() / 3;
+    stats.vertices = vertexCount;
+    if (indices.empty() || vertexCount == 0)
+      return stats;
+    size = size != 0 ? size : cacheSize;
+
+    // 顶点进入缓存的时间戳，当前时间减去时间戳不超过缓存大小即命中
+    std::vector<unsigned int> timestamp(vertexCount, 0);
+    unsigned int time = size + 1;
+    for (unsigned int index : indices)
+    {
+      if (time - timestamp[index] > size)
+      {
+        timestamp[index] = time++;
+        stats.misses++;
+      }
+    }
+    return stats;
+  }
+
+  // 合并相同的顶点，返回合并后的顶点数
+  // ------------------------------------------------------------------------
+  static size_t weld(std::vector<Vertex> &vertices, std::vector<unsigned int> &indices)
+  {
+    struct VertexHash
+    {
+      const std::vector<Vertex> *vertices;
+      size_t operator()(unsigned int index) const
+      {
+        // FNV-1a
+        const unsigned char *bytes = reinterpret_cast<const unsigned char *>(&(*vertices)[index]);
+        size_t hash = 14695981039346656037ULL;
+        for (size_t i = 0; i < sizeof(Vertex); i++)
+        {
+          hash ^= bytes[i];
+          hash *= 1099511628211ULL;
+        }
+        return hash;
+      }
+    };
+    struct VertexEqual
+    {
+      const std::vector<Vertex> *vertices;
+      bool operator()(unsigned int a, unsigned int b) const
+      {
+        return std::memcmp(&(*vertices)[a], &(*vertices)[b], sizeof(Vertex)) == 0;
+      }
+    };
+
+    std::unordered_map<unsigned int, unsigned int, VertexHash, VertexEqual> unique(vertices.size(), VertexHash{&vertices}, VertexEqual{&vertices});
+    std::vector<unsigned int> remap(vertices.size());
+    std::vector<Vertex> welded;
+    welded.reserve(vertices.size());
+    for (unsigned int i = 0; i < vertices.size(); i++)
+    {
+      auto result = unique.emplace(i, (unsigned int)welded.size());
+      if (result.second)
+        welded.push_back(vertices[i]);
+      remap[i] = result.first->second;
+    }
+    for (unsigned int &index : indices)
+      index = remap[index];
+    vertices.swap(welded);
+    return vertices.size();
+  }
+
+  // Tipsify：从一个顶点出发输出它所有未输出的三角形（扇形），然后在这些三角形的顶点中
+  // 选择仍在缓存中、剩余三角形又不会把它挤出缓存的顶点继续；没有时回退到最近输出的顶点（dead-end 栈），
+  // 再没有就按顶点顺序找下一个。每次回退都是一个天然的簇边界，记录在 clusters 中（三角形序号）
+  // ------------------------------------------------------------------------
+  static std::vector<unsigned int> tipsify(const std::vector<unsigned int> &indices, size_t vertexCount, unsigned int size, std::vector<unsigned int> *clusters = nullptr)
+  {
+    size_t triangleCount = indices.size() / 3;
+    std::vector<unsigned int> result;
+    result.reserve(triangleCount * 3);
+    if (clusters)
+      clusters->clear();
+    if (triangleCount == 0)
+      return result;
+
+    // 顶点 -> 三角形 邻接表
+    std::vector<unsigned int> liveCount(vertexCount, 0);
+    for (size_t i = 0; i < triangleCount * 3; i++)
+      liveCount[indices[i]]++;
+    std::vector<unsigned int> adjacencyStart(vertexCount + 1, 0);
+    for (size_t v = 0; v < vertexCount; v++)
+      adjacencyStart[v + 1] = adjacencyStart[v] + liveCount[v];
+    std::vector<unsigned int> adjacency(triangleCount * 3);
+    std::vector<unsigned int> fill(adjacencyStart.begin(), adjacencyStart.end() - 1);
+    for (size_t i = 0; i < triangleCount * 3; i++)
+      adjacency[fill[indices[i]]++] = (unsigned int)(i / 3);
+
+    std::vector<unsigned int> timestamp(vertexCount, 0);
+    std::vector<bool> emitted(triangleCount, false);
+    std::vector<unsigned int> deadEnd;
+    std::vector<unsigned int> candidates;
+    unsigned int time = size + 1;
+    size_t cursor = 0;
+    int fanning = 0;
+    bool newCluster = true;
+
+    while (fanning >= 0)
+    {
+      candidates.clear();
+      for (unsigned int a = adjacencyStart[fanning]; a < adjacencyStart[fanning + 1]; a++)
+      {
+        unsigned int triangle = adjacency[a];
+        if (emitted[triangle])
+          continue;
+        if (newCluster && clusters)
+          clusters->push_back((unsigned int)(result.size() / 3));
+        newCluster = false;
+        for (int corner = 0; corner < 3; corner++)
+        {
+          unsigned int v = indices[triangle * 3 + corner];
+          result.push_back(v);
+          deadEnd.push_back(v);
+          candidates.push_back(v);
+          liveCount[v]--;
+          if (time - timestamp[v] > size)
+            timestamp[v] = time++;
+        }
+        emitted[triangle] = true;
+      }
+
+      // 选择下一个扇形中心
+      int next = -1;
+      int bestPriority = -1;
+      for (unsigned int v : candidates)
+      {
+        if (liveCount[v] == 0)
+          continue;
+        int priority = 0;
+        if (time - timestamp[v] + 2 * liveCount[v] <= size)
+          priority = time - timestamp[v];
+        if (priority > bestPriority)
+        {
+          bestPriority = priority;
+          next = v;
+        }
+      }
+      if (next == -1)
+      {
+        next = skipDeadEnd(liveCount, deadEnd, cursor);
+        newCluster = true;
+      }
+      fanning = next;
+    }
+    return result;
+  }
+
+  // 把 tipsify 的簇继续切分，然后按簇朝外的程度从大到小排序
+  // ------------------------------------------------------------------------
+  static void optimizeOverdraw(std::vector<unsigned int> &indices, const std::vector<Vertex> &vertices, const std::vector<unsigned int> &hardClusters, float threshold)
+  {
+    size_t triangleCount = indices.size() / 3;
+    if (triangleCount == 0 || hardClusters.empty())
+      return;
+
+    std::vector<unsigned int> clusters = softClusters(indices, vertices.size(), hardClusters, threshold);
+    if (clusters.size() <= 1)
+      return;
+
+    // 整个网格按面积加权的中心
+    glm::vec3 meshCenter(0.0f);
+    float meshArea = 0.0f;
+    for (size_t t = 0; t < triangleCount; t++)
+    {
+      glm::vec3 center, normal;
+      float area = triangleGeometry(indices, vertices, t, center, normal);
+      meshCenter += center * area;
+      meshArea += area;
+    }
+    if (meshArea > 0.0f)
+      meshCenter /= meshArea;
+
+    struct Cluster
+    {
+      unsigned int begin, end;
+      float sortKey;
+    };
+    std::vector<Cluster> sorted;
+    sorted.reserve(clusters.size());
+    for (size_t c = 0; c < clusters.size(); c++)
+    {
+      unsigned int begin = clusters[c];
+      unsigned int end = c + 1 < clusters.size() ? clusters[c + 1] : (unsigned int)triangleCount;
+      glm::vec3 center(0.0f), normal(0.0f);
+      float area = 0.0f;
+      for (unsigned int t = begin; t < end; t++)
+      {
+        glm::vec3 triangleCenter, triangleNormal;
+        float triangleArea = triangleGeometry(indices, vertices, t, triangleCenter, triangleNormal);
+        center += triangleCenter * triangleArea;
+        normal += triangleNormal * triangleArea;
+        area += triangleArea;
+      }
+      if (area > 0.0f)
+        center /= area;
+      float length = glm::length(normal);
+      if (length > 0.0f)
+        normal /= length;
+      sorted.push_back({begin, end, glm::dot(center - meshCenter, normal)});
+    }
+    std::stable_sort(sorted.begin(), sorted.end(), [](const Cluster &a, const Cluster &b)
+                     { return a.sortKey > b.sortKey; });
+
+    std::vector<unsigned int> result;
+    result.reserve(indices.size());
+    for (const Cluster &cluster : sorted)
+      result.insert(result.end(), indices.begin() + cluster.begin * 3, indices.begin() + cluster.end * 3);
+    indices.swap(result);
+  }
+
+  // 按首次使用的顺序重排顶点，删除没有被引用的顶点
+  // ------------------------------------------------------------------------
+  static void optimizeVertexFetch(std::vector<Vertex> &vertices, std::vector<unsigned int> &indices)
+  {
+    const unsigned int UNUSED = 0xffffffffu;
+    std::vector<unsigned int> remap(vertices.size(), UNUSED);
+    std::vector<Vertex> reordered;
+    reordered.reserve(vertices.size());
+    for (unsigned int &index : indices)
+    {
+      if (remap[index] == UNUSED)
+      {
+        remap[index] = (unsigned int)reordered.size();
+        reordered.push_back(vertices[index]);
+      }
+      index = remap[index];
+    }
+    vertices.swap(reordered);
+  }
+
+private:
+  static int skipDeadEnd(const std::vector<unsigned int> &liveCount, std::vector<unsigned int> &deadEnd, size_t &cursor)
+  {
+    while (!deadEnd.empty())
+    {
+      unsigned int v = deadEnd.back();
+      deadEnd.pop_back();
+      if (liveCount[v] > 0)
+        return v;
+    }
+    while (cursor < liveCount.size())
+    {
+      if (liveCount[cursor] > 0)
+        return (int)cursor;
+      cursor++;
+    }
+    return -1;
+  }
+
+  // 在每个硬边界簇内模拟缓存，局部 ACMR 已经不超过整簇 ACMR * threshold 时切开
+  static std::vector<unsigned int> softClusters(const std::vector<unsigned int> &indices, size_t vertexCount, const std::vector<unsigned int> &hardClusters, float threshold)
+  {
+    size_t triangleCount = indices.size() / 3;
+    std::vector<unsigned int> timestamp(vertexCount, 0);
+    unsigned int time = cacheSize + 1;
+    std::vector<unsigned int> result;
+
+    auto missesOf = [&](size_t triangle)
+    {
+      unsigned int misses = 0;
+      for (int corner = 0; corner < 3; corner++)
+      {
+        unsigned int v = indices[triangle * 3 + corner];
+        if (time - timestamp[v] > cacheSize)
+        {
+          timestamp[v] = time++;
+          misses++;
+        }
+      }
+      return misses;
+    };
+    auto flushCache = [&]()
+    {
+      time += cacheSize + 1;
+    };
+
+    for (size_t c = 0; c < hardClusters.size(); c++)
+    {
+      size_t begin = hardClusters[c];
+      size_t end = c + 1 < hardClusters.size() ? hardClusters[c + 1] : triangleCount;
+
+      // 整簇的 ACMR
+      flushCache();
+      unsigned int clusterMisses = 0;
+      for (size_t t = begin; t < end; t++)
+        clusterMisses += missesOf(t);
+      float limit = (float)clusterMisses / (end - begin) * threshold;
+
+      flushCache();
+      result.push_back((unsigned int)begin);
+      size_t start = begin;
+      unsigned int misses = 0;
+      for (size_t t = begin; t < end; t++)
+      {
+        misses += missesOf(t);
+        if (t + 1 < end && misses <= limit * (t + 1 - start))
+        {
+          result.push_back((unsigned int)(t + 1));
+          start = t + 1;
+          misses = 0;
+          flushCache();
+        }
+      }
+    }
+    return result;
+  }
+
+  static float triangleGeometry(const std::vector<unsigned int> &indices, const std::vector<Vertex> &vertices, size_t triangle, glm::vec3 &center, glm::vec3 &normal)
+  {
+    const glm::vec3 &p0 = vertices[indices[triangle * 3]].Position;
+    const glm::vec3 &p1 = vertices[indices[triangle * 3 + 1]].Position;
+    const glm::vec3 &p2 = vertices[indices[triangle * 3 + 2]].Position;
+    center = (p0 + p1 + p2) / 3.0f;
+    glm::vec3 cross = glm::cross(p1 - p0, p2 - p0);
+    float length = glm::length(cross);
+    normal = length > 0.0f ? cross / length : glm::vec3(0.0f);
+    return length * 0.5f;
+  }
+};
+
+#endif
@@ -0,0 +1,133 @@
+#ifndef TANGENTS_H
+#define TANGENTS_H
+
+#include <glm/glm.hpp>
+
+#include <vector>
+
+#include <tool/parallel.h>
+
+// 零向量原样返回
+inline glm::vec3 safeNormalize(const glm::vec3 &v)
+{
+  float length = glm::length(v);
+  return length > 0.0f ? v / length : glm::vec3(0.0f);
+}
+
+// 切线空间生成，顺序与 MikkTSpace 一致：
+// 1. 每个三角形由 UV 的偏导求出切线 / 副切线方向（按 UV 面积的符号翻转，不受三角形大小影响）
+// 2. 每个角把方向投影到该顶点法线的切平面上并归一化，按该角的内角加权
+// 3. 每个顶点累加所有角的结果，再做 Gram-Schmidt 正交化，副切线取 cross(N, T) 乘以手性符号
+//
+// 对 vector<Vertex> 模板化，BufferGeometry 和 Mesh 的 Vertex 都可以使用。
+// 第 1、2 步按三角形并行，第 3 步按顶点并行，每个顶点按三角形顺序累加，结果与线程数无关
+template <typename VertexType>
+void generateTangents(std::vector<VertexType> &vertices, const std::vector<unsigned int> &indices)
+{
+  const size_t triangleCount = indices.size() / 3;
+  const size_t vertexCount = vertices.size();
+  if (triangleCount == 0 || vertexCount == 0)
+    return;
+
+  struct Corner
+  {
+    glm::vec3 tangent;
+    glm::vec3 bitangent;
+  };
+  std::vector<Corner> corners(triangleCount * 3);
+
+  // 每个三角形三个角，互不重叠，可以直接并行写
+  Parallel::forRange(triangleCount, 4096, [&](size_t begin, size_t end)
+                     {
+    for (size_t triangle = begin; triangle < end; triangle++)
+    {
+      const unsigned int *index = &indices[triangle * 3];
+      const VertexType &v0 = vertices[index[0]];
+      const VertexType &v1 = vertices[index[1]];
+      const VertexType &v2 = vertices[index[2]];
+
+      glm::vec3 edge1 = v1.Position - v0.Position;
+      glm::vec3 edge2 = v2.Position - v0.Position;
+      glm::vec2 deltaUV1 = v1.TexCoords - v0.TexCoords;
+      glm::vec2 deltaUV2 = v2.TexCoords - v0.TexCoords;
+
+      // 只取行列式的符号，方向在投影后再归一化
+      float area = deltaUV1.x * deltaUV2.y - deltaUV2.x * deltaUV1.y;
+      float sign = area < 0.0f ? -1.0f : 1.0f;
+      bool degenerate = area == 0.0f;
+      glm::vec3 faceTangent = sign * (edge1 * deltaUV2.y - edge2 * deltaUV1.y);
+      glm::vec3 faceBitangent = sign * (edge2 * deltaUV1.x - edge1 * deltaUV2.x);
+
+      // 三个内角，边只归一化一次
+      glm::vec3 side0 = safeNormalize(v1.Position - v0.Position);
+      glm::vec3 side1 = safeNormalize(v2.Position - v1.Position);
+      glm::vec3 side2 = safeNormalize(v0.Position - v2.Position);
+      const float angles[3] = {
+          glm::acos(glm::clamp(-glm::dot(side0, side2), -1.0f, 1.0f)),
+          glm::acos(glm::clamp(-glm::dot(side1, side0), -1.0f, 1.0f)),
+          glm::acos(glm::clamp(-glm::dot(side2, side1), -1.0f, 1.0f))};
+
+      for (int corner = 0; corner < 3; corner++)
+      {
+        Corner &result = corners[triangle * 3 + corner];
+        result.tangent = glm::vec3(0.0f);
+        result.bitangent = glm::vec3(0.0f);
+        if (degenerate)
+          continue;
+
+        const glm::vec3 &normal = vertices[index[corner]].Normal;
+        glm::vec3 tangent = faceTangent - normal * glm::dot(normal, faceTangent);
+        glm::vec3 bitangent = faceBitangent - normal * glm::dot(normal, faceBitangent);
+        float angle = angles[corner];
+
+        float tangentLength = glm::length(tangent);
+        float bitangentLength = glm::length(bitangent);
+        if (tangentLength > 0.0f)
+          result.tangent = tangent * (angle / tangentLength);
+        if (bitangentLength > 0.0f)
+          result.bitangent = bitangent * (angle / bitangentLength);
+      }
+    } });
+
+  // 顶点 -> 角 的邻接表（按三角形顺序），计数排序，单线程即可
+  std::vector<unsigned int> cornerStart(vertexCount + 1, 0);
+  for (unsigned int index : indices)
+    cornerStart[index + 1]++;
+  for (size_t i = 0; i < vertexCount; i++)
+    cornerStart[i + 1] += cornerStart[i];
+  std::vector<unsigned int> vertexCorners(triangleCount * 3);
+  std::vector<unsigned int> fill(cornerStart.begin(), cornerStart.end() - 1);
+  for (size_t corner = 0; corner < triangleCount * 3; corner++)
+    vertexCorners[fill[indices[corner]]++] = (unsigned int)corner;
+
+  Parallel::forRange(vertexCount, 8192, [&](size_t begin, size_t end)
+                     {
+    for (size_t i = begin; i < end; i++)
+    {
+      glm::vec3 tangent(0.0f), bitangent(0.0f);
+      for (unsigned int c = cornerStart[i]; c < cornerStart[i + 1]; c++)
+      {
+        tangent += corners[vertexCorners[c]].tangent;
+        bitangent += corners[vertexCorners[c]].bitangent;
+      }
+
+      VertexType &vertex = vertices[i];
+      glm::vec3 normal = vertex.Normal;
+      tangent -= normal * glm::dot(normal, tangent);
+      float length = glm::length(tangent);
+      if (length > 1e-8f)
+        tangent /= length;
+      else
+      {
+        // 没有有效的 UV（例如球的极点），任取一个与法线垂直的方向
+        glm::vec3 axis = glm::abs(normal.x) < 0.9f ? glm::vec3(1.0f, 0.0f, 0.0f) : glm::vec3(0.0f, 1.0f, 0.0f);
+        tangent = glm::normalize(glm::cross(axis, normal));
+      }
+      float handedness = glm::dot(glm::cross(normal, tangent), bitangent) < 0.0f ? -1.0f : 1.0f;
+
+      vertex.Tangent = tangent;
+      vertex.Bitangent = glm::cross(normal, tangent) * handedness;
+    } });
+}
+
+#endif
@@ -0,0 +1,19 @@
+#ifndef VERTEX_H
+#define VERTEX_H
+
+#include <glm/glm.hpp>
+
+// CPU 端的顶点，BufferGeometry 和 Mesh 共用
+// 上传到 GPU 时按 VertexLayout 打包，不一定是这 56 字节的全精度格式
+// 所有成员都有初始值，焊接顶点时按字节比较不会读到未初始化的内存
+struct Vertex
+{
+  glm::vec3 Position = glm::vec3(0.0f);  // 顶点位置
+  glm::vec3 Normal = glm::vec3(0.0f);    // 法线
+  glm::vec2 TexCoords = glm::vec2(0.0f); // 纹理坐标
+
+  glm::vec3 Tangent = glm::vec3(0.0f);   // 切线
+  glm::vec3 Bitangent = glm::vec3(0.0f); // 副切线
+};
+
+#endif
@@ -0,0 +1,219 @@
+#ifndef VERTEX_LAYOUT_H
+#define VERTEX_LAYOUT_H
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <glm/gtc/packing.hpp>
+
+#include <cstring>
+#include <vector>
+
+#include <geometry/Vertex.h>
+
+// 顶点属性的存储格式
+enum class PositionFormat
+{
+  Float3, // 12 字节
+  Half4   // 8 字节，w 固定为 1，远离原点的大网格会有 1/2048 量级的相对误差
+};
+
+enum class DirectionFormat
+{
+  Float3,          // 12 字节
+  Snorm10_10_10_2, // 4 字节，GL_INT_2_10_10_10_REV
+  None             // 不上传
+};
+
+enum class TexCoordFormat
+{
+  Float2, // 8 字节
+  Half2,  // 4 字节
+  Unorm16 // 4 字节，只能表示 [0, 1]，超出范围时自动退回 Half2
+};
+
+// 顶点布局：每个属性的格式以及索引位宽
+// 着色器端不需要改动，归一化的整数和半精度属性读出来仍然是 vec3 / vec2
+//
+// 属性位置与之前保持一致：0 Position, 1 Normal, 2 TexCoords, 3 Tangent, 4 Bitangent
+class VertexLayout
+{
+public:
+  PositionFormat position = PositionFormat::Float3;
+  DirectionFormat normal = DirectionFormat::Float3;
+  TexCoordFormat texCoords = TexCoordFormat::Float2;
+  DirectionFormat tangent = DirectionFormat::Float3; // 切线和副切线使用同一种格式
+  bool index16 = false;                              // 顶点数不超过 65536 时使用 16 位索引
+
+  // 与原来的 Vertex 结构体逐字节相同，56 字节
+  static VertexLayout standard()
+  {
+    return VertexLayout();
+  }
+
+  // 24 字节：半精度位置、10_10_10_2 法线/切线/副切线、unorm16 纹理坐标、16 位索引
+  static VertexLayout compact()
+  {
+    VertexLayout layout;
+    layout.position = PositionFormat::Half4;
+    layout.normal = DirectionFormat::Snorm10_10_10_2;
+    layout.texCoords = TexCoordFormat::Unorm16;
+    layout.tangent = DirectionFormat::Snorm10_10_10_2;
+    layout.index16 = true;
+    return layout;
+  }
+
+  // Unorm16 需要所有纹理坐标都在 [0, 1] 内，否则换成 Half2
+  VertexLayout resolve(const Vertex *vertices, size_t count) const
+  {
+    VertexLayout resolved = *this;
+    if (texCoords != TexCoordFormat::Unorm16)
+      return resolved;
+    for (size_t i = 0; i < count; i++)
+    {
+      const Vertex &vertex = vertices[i];
+      if (vertex.TexCoords.x < 0.0f || vertex.TexCoords.x > 1.0f || vertex.TexCoords.y < 0.0f || vertex.TexCoords.y > 1.0f)
+      {
+        resolved.texCoords = TexCoordFormat::Half2;
+        break;
+      }
+    }
+    return resolved;
+  }
+
+  VertexLayout resolve(const std::vector<Vertex> &vertices) const
+  {
+    return resolve(vertices.data(), vertices.size());
+  }
+
+  bool useIndex16(size_t vertexCount) const
+  {
+    return index16 && vertexCount <= 65536;
+  }
+
+  unsigned int stride() const
+  {
+    return positionSize() + directionSize(normal) + texCoordsSize() + directionSize(tangent) * 2;
+  }
+
+  // 按布局把顶点打包成一块连续内存
+  std::vector<unsigned char> pack(const Vertex *vertices, size_t count) const
+  {
+    unsigned int vertexStride = stride();
+    std::vector<unsigned char> data(count * vertexStride);
+    unsigned char *out = data.data();
+    for (size_t i = 0; i < count; i++)
+    {
+      const Vertex &vertex = vertices[i];
+      unsigned char *cursor = out;
+      if (position == PositionFormat::Float3)
+        cursor = write(cursor, vertex.Position);
+      else
+        cursor = write(cursor, glm::packHalf4x16(glm::vec4(vertex.Position, 1.0f)));
+
+      cursor = writeDirection(cursor, normal, vertex.Normal);
+
+      if (texCoords == TexCoordFormat::Float2)
+        cursor = write(cursor, vertex.TexCoords);
+      else if (texCoords == TexCoordFormat::Half2)
+        cursor = write(cursor, glm::packHalf2x16(vertex.TexCoords));
+      else
+        cursor = write(cursor, glm::packUnorm2x16(vertex.TexCoords));
+
+      cursor = writeDirection(cursor, tangent, vertex.Tangent);
+      writeDirection(cursor, tangent, vertex.Bitangent);
+      out += vertexStride;
+    }
+    return data;
+  }
+
+  std::vector<unsigned char> pack(const std::vector<Vertex> &vertices) const
+  {
+    return pack(vertices.data(), vertices.size());
+  }
+
+  // 为当前绑定的 VAO / GL_ARRAY_BUFFER 设置属性指针
+  void apply() const
+  {
+    GLsizei vertexStride = stride();
+    size_t offset = 0;
+
+    if (position == PositionFormat::Float3)
+      attribute(0, 3, GL_FLOAT, GL_FALSE, vertexStride, offset);
+    else
+      attribute(0, 4, GL_HALF_FLOAT, GL_FALSE, vertexStride, offset);
+    offset += positionSize();
+
+    directionAttribute(1, normal, vertexStride, offset);
+    offset += directionSize(normal);
+
+    if (texCoords == TexCoordFormat::Float2)
+      attribute(2, 2, GL_FLOAT, GL_FALSE, vertexStride, offset);
+    else if (texCoords == TexCoordFormat::Half2)
+      attribute(2, 2, GL_HALF_FLOAT, GL_FALSE, vertexStride, offset);
+    else
+      attribute(2, 2, GL_UNSIGNED_SHORT, GL_TRUE, vertexStride, offset);
+    offset += texCoordsSize();
+
+    directionAttribute(3, tangent, vertexStride, offset);
+    offset += directionSize(tangent);
+    directionAttribute(4, tangent, vertexStride, offset);
+  }
+
+private:
+  unsigned int positionSize() const
+  {
+    return position == PositionFormat::Float3 ? 12 : 8;
+  }
+
+  unsigned int texCoordsSize() const
+  {
+    return texCoords == TexCoordFormat::Float2 ? 8 : 4;
+  }
+
+  static unsigned int directionSize(DirectionFormat format)
+  {
+    switch (format)
+    {
+    case DirectionFormat::Float3:
+      return 12;
+    case DirectionFormat::Snorm10_10_10_2:
+      return 4;
+    default:
+      return 0;
+    }
+  }
+
+  template <typename T>
+  static unsigned char *write(unsigned char *cursor, const T &value)
+  {
+    std::memcpy(cursor, &value, sizeof(T));
+    return cursor + sizeof(T);
+  }
+
+  static unsigned char *writeDirection(unsigned char *cursor, DirectionFormat format, const glm::vec3 &direction)
+  {
+    if (format == DirectionFormat::Float3)
+      return write(cursor, direction);
+    if (format == DirectionFormat::Snorm10_10_10_2)
+      return write(cursor, glm::packSnorm3x10_1x2(glm::vec4(direction, 0.0f)));
+    return cursor;
+  }
+
+  static void attribute(GLuint location, GLint size, GLenum type, GLboolean normalized, GLsizei stride, size_t offset)
+  {
+    glEnableVertexAttribArray(location);
+    glVertexAttribPointer(location, size, type, normalized, stride, (void *)offset);
+  }
+
+  static void directionAttribute(GLuint location, DirectionFormat format, GLsizei stride, size_t offset)
+  {
+    if (format == DirectionFormat::Float3)
+      attribute(location, 3, GL_FLOAT, GL_FALSE, stride, offset);
+    else if (format == DirectionFormat::Snorm10_10_10_2)
+      attribute(location, 4, GL_INT_2_10_10_10_REV, GL_TRUE, stride, offset);
+    else
+      glDisableVertexAttribArray(location);
+  }
+};
+
+#endif
@@ -0,0 +1,430 @@
+#ifndef BLOCK_COMPRESS_H
+#define BLOCK_COMPRESS_H
+
+#include <glad/glad.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include <tool/parallel.h>
+
+// glad 只生成了核心函数，S3TC 的格式来自 EXT_texture_compression_s3tc / EXT_texture_sRGB
+#ifndef GL_COMPRESSED_RGB_S3TC_DXT1_EXT
+#define GL_COMPRESSED_RGB_S3TC_DXT1_EXT 0x83F0
+#endif
+#ifndef GL_COMPRESSED_RGBA_S3TC_DXT5_EXT
+#define GL_COMPRESSED_RGBA_S3TC_DXT5_EXT 0x83F3
+#endif
+#ifndef GL_COMPRESSED_SRGB_S3TC_DXT1_EXT
+#define GL_COMPRESSED_SRGB_S3TC_DXT1_EXT 0x8C4C
+#endif
+#ifndef GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT
+#define GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT 0x8C4F
+#endif
+
+enum class BlockFormat
+{
+  BC1, // RGB，4 bpp，不透明的颜色贴图
+  BC3, // RGBA，8 bpp，BC1 的颜色 + BC4 的透明度
+  BC4, // 单通道，4 bpp，高度图、AO、粗糙度
+  BC5, // 双通道，8 bpp，法线贴图的 xy，z 在着色器中重建
+  BC7, // RGBA，8 bpp，只用模式 6，质量比 BC1/BC3 高
+};
+
+// CPU 上的 BCn 块压缩，供离线的贴图烘焙工具使用（src/tools/texture_cooker）
+//
+// 每 4x4 个像素压缩为 8 或 16 字节。端点沿主成分方向取包围范围再向内收缩 1/16，
+// 每个像素选误差最小的调色板下标；不做端点迭代优化，质量接近 GPU 驱动的实时压缩
+// 输入统一为 RGBA8，按块行分给多个线程
+class BlockCompress
+{
+public:
+  static size_t blockBytes(BlockFormat format)
+  {
+    return format == BlockFormat::BC1 || format == BlockFormat::BC4 ? 8 : 16;
+  }
+
+  static size_t compressedSize(BlockFormat format, int width, int height)
+  {
+    return (size_t)((width + 3) / 4) * ((height + 3) / 4) * blockBytes(format);
+  }
+
+  static GLenum internalFormat(BlockFormat format, bool srgb = false)
+  {
+    switch (format)
+    {
+    case BlockFormat::BC1:
+      return srgb ? GL_COMPRESSED_SRGB_S3TC_DXT1_EXT : GL_COMPRESSED_RGB_S3TC_DXT1_EXT;
+    case BlockFormat::BC3:
+      return srgb ? GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT : GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+    case BlockFormat::BC4:
+      return GL_COMPRESSED_RED_RGTC1;
+    case BlockFormat::BC5:
+      return GL_COMPRESSED_RG_RGTC2;
+    default:
+      return srgb ? GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM : GL_COMPRESSED_RGBA_BPTC_UNORM;
+    }
+  }
+
+  static GLenum baseFormat(BlockFormat format)
+  {
+    switch (format)
+    {
+    case BlockFormat::BC1:
+      return GL_RGB;
+    case BlockFormat::BC4:
+      return GL_RED;
+    case BlockFormat::BC5:
+      return GL_RG;
+    default:
+      return GL_RGBA;
+    }
+  }
+
+  // 由 KTX 中记录的线性格式反查，不是块压缩格式时返回 false
+  static bool fromInternalFormat(GLenum internal, BlockFormat &format)
+  {
+    const BlockFormat all[5] = {BlockFormat::BC1, BlockFormat::BC3, BlockFormat::BC4, BlockFormat::BC5, BlockFormat::BC7};
+    for (BlockFormat candidate : all)
+      if (internalFormat(candidate) == internal)
+      {
+        format = candidate;
+        return true;
+      }
+    return false;
+  }
+
+  static const char *name(BlockFormat format)
+  {
+    const char *names[5] = {"BC1", "BC3", "BC4", "BC5", "BC7"};
+    return names[(int)format];
+  }
+
+  // rgba 为 width * height * 4 字节，不足 4 的边缘块重复最后一行/列
+  static std::vector<unsigned char> compress(BlockFormat format, const unsigned char *rgba, int width, int height)
+  {
+    int blocksX = (width + 3) / 4;
+    int blocksY = (height + 3) / 4;
+    size_t bytes = blockBytes(format);
+    std::vector<unsigned char> result((size_t)blocksX * blocksY * bytes);
+
+    Parallel::forRange(blocksY, 8, [&](size_t begin, size_t end)
+                       {
+                         unsigned char block[64];
+                         for (size_t by = begin; by < end; by++)
+                           for (int bx = 0; bx < blocksX; bx++)
+                           {
+                             for (int y = 0; y < 4; y++)
+                               for (int x = 0; x < 4; x++)
+                               {
+                                 int sx = std::min(bx * 4 + x, width - 1);
+                                 int sy = std::min((int)by * 4 + y, height - 1);
+                                 memcpy(block + (y * 4 + x) * 4, rgba + ((size_t)sy * width + sx) * 4, 4);
+                               }
+                             encodeBlock(format, block, result.data() + (by * blocksX + bx) * bytes);
+                           } });
+    return result;
+  }
+
+  static void encodeBlock(BlockFormat format, const unsigned char block[64], unsigned char *out)
+  {
+    unsigned char channel[16];
+    switch (format)
+    {
+    case BlockFormat::BC1:
+      encodeColor(block, out);
+      break;
+    case BlockFormat::BC3:
+      extract(block, 3, channel);
+      encodeAlpha(channel, out);
+      encodeColor(block, out + 8);
+      break;
+    case BlockFormat::BC4:
+      extract(block, 0, channel);
+      encodeAlpha(channel, out);
+      break;
+    case BlockFormat::BC5:
+      extract(block, 0, channel);
+      encodeAlpha(channel, out);
+      extract(block, 1, channel);
+      encodeAlpha(channel, out + 8);
+      break;
+    case BlockFormat::BC7:
+      encodeMode6(block, out);
+      break;
+    }
+  }
+
+private:
+  static void extract(const unsigned char block[64], int component, unsigned char channel[16])
+  {
+    for (int i = 0; i < 16; i++)
+      channel[i] = block[i * 4 + component];
+  }
+
+  // 前 dims 个通道的均值和主方向（幂迭代）
+  static void principalAxis(const unsigned char block[64], int dims, float mean[4], float axis[4])
+  {
+    for (int c = 0; c < 4; c++)
+    {
+      mean[c] = 0.0f;
+      for (int i = 0; i < 16; i++)
+        mean[c] += block[i * 4 + c];
+      mean[c] /= 16.0f;
+    }
+    float covariance[4][4] = {};
+    for (int i = 0; i < 16; i++)
+      for (int a = 0; a < dims; a++)
+        for (int b = 0; b < dims; b++)
+          covariance[a][b] += (block[i * 4 + a] - mean[a]) * (block[i * 4 + b] - mean[b]);
+
+    for (int c = 0; c < 4; c++)
+      axis[c] = c < dims ? 1.0f : 0.0f;
+    for (int iteration = 0; iteration < 8; iteration++)
+    {
+      float next[4] = {};
+      float length = 0.0f;
+      for (int a = 0; a < dims; a++)
+      {
+        for (int b = 0; b < dims; b++)
+          next[a] += covariance[a][b] * axis[b];
+        length = std::max(length, std::fabs(next[a]));
+      }
+      if (length < 1e-6f)
+        break; // 所有像素相同
+      for (int a = 0; a < dims; a++)
+        axis[a] = next[a] / length;
+    }
+    float length = 0.0f;
+    for (int a = 0; a < dims; a++)
+      length += axis[a] * axis[a];
+    length = std::sqrt(length);
+    for (int a = 0; a < dims; a++)
+      axis[a] /= length;
+  }
+
+  // 沿主方向的两个端点，向内收缩 1/16 以减小量化误差
+  static void endpoints(const unsigned char block[64], int dims, float low[4], float high[4])
+  {
+    float mean[4], axis[4];
+    principalAxis(block, dims, mean, axis);
+    float minT = 1e30f, maxT = -1e30f;
+    for (int i = 0; i < 16; i++)
+    {
+      float t = 0.0f;
+      for (int c = 0; c < dims; c++)
+        t += (block[i * 4 + c] - mean[c]) * axis[c];
+      minT = std::min(minT, t);
+      maxT = std::max(maxT, t);
+    }
+    float inset = (maxT - minT) / 16.0f;
+    minT += inset;
+    maxT -= inset;
+    for (int c = 0; c < 4; c++)
+    {
+      low[c] = std::min(std::max(mean[c] + axis[c] * minT, 0.0f), 255.0f);
+      high[c] = std::min(std::max(mean[c] + axis[c] * maxT, 0.0f), 255.0f);
+    }
+  }
+
+  static unsigned int to565(const float color[4])
+  {
+    unsigned int r = (unsigned int)(color[0] * 31.0f / 255.0f + 0.5f);
+    unsigned int g = (unsigned int)(color[1] * 63.0f / 255.0f + 0.5f);
+    unsigned int b = (unsigned int)(color[2] * 31.0f / 255.0f + 0.5f);
+    return (r << 11) | (g << 5) | b;
+  }
+
+  static void from565(unsigned int packed, int color[3])
+  {
+    int r = (packed >> 11) & 31, g = (packed >> 5) & 63, b = packed & 31;
+    color[0] = (r << 3) | (r >> 2);
+    color[1] = (g << 2) | (g >> 4);
+    color[2] = (b << 3) | (b >> 2);
+  }
+
+  // BC1 的颜色块，总是使用 4 色模式（c0 > c1），BC3 也共用
+  static void encodeColor(const unsigned char block[64], unsigned char *out)
+  {
+    float low[4], high[4];
+    endpoints(block, 3, low, high);
+    unsigned int c0 = to565(high), c1 = to565(low);
+    if (c0 < c1)
+      std::swap(c0, c1);
+
+    int palette[4][3];
+    from565(c0, palette[0]);
+    from565(c1, palette[1]);
+    for (int c = 0; c < 3; c++)
+    {
+      palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+      palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+    }
+
+    uint32_t indices = 0;
+    if (c0 != c1)
+      for (int i = 0; i < 16; i++)
+        indices |= (uint32_t)nearest(block + i * 4, palette, 4, 3) << (2 * i);
+
+    out[0] = c0 & 0xff;
+    out[1] = c0 >> 8;
+    out[2] = c1 & 0xff;
+    out[3] = c1 >> 8;
+    for (int i = 0; i < 4; i++)
+      out[4 + i] = (indices >> (8 * i)) & 0xff;
+  }
+
+  template <int N>
+  static int nearest(const unsigned char *pixel, const int (&palette)[N][3], int count, int dims)
+  {
+    int best = 0, bestError = 1 << 30;
+    for (int p = 0; p < count; p++)
+    {
+      int error = 0;
+      for (int c = 0; c < dims; c++)
+      {
+        int d = pixel[c] - palette[p][c];
+        error += d * d;
+      }
+      if (error < bestError)
+      {
+        bestError = error;
+        best = p;
+      }
+    }
+    return best;
+  }
+
+  // BC4 的单通道块（也是 BC3 的透明度块和 BC5 的每个通道），使用 8 值模式（a0 > a1）
+  static void encodeAlpha(const unsigned char values[16], unsigned char *out)
+  {
+    int low = 255, high = 0;
+    for (int i = 0; i < 16; i++)
+    {
+      low = std::min(low, (int)values[i]);
+      high = std::max(high, (int)values[i]);
+    }
+    out[0] = (unsigned char)high;
+    out[1] = (unsigned char)low;
+
+    uint64_t indices = 0;
+    if (high != low)
+    {
+      int palette[8];
+      palette[0] = high;
+      palette[1] = low;
+      for (int p = 2; p < 8; p++)
+        palette[p] = ((8 - p) * high + (p - 1) * low + 3) / 7;
+      for (int i = 0; i < 16; i++)
+      {
+        int best = 0, bestError = 1 << 30;
+        for (int p = 0; p < 8; p++)
+        {
+          int error = std::abs(values[i] - palette[p]);
+          if (error < bestError)
+          {
+            bestError = error;
+            best = p;
+          }
+        }
+        indices |= (uint64_t)best << (3 * i);
+      }
+    }
+    for (int i = 0; i < 6; i++)
+      out[2 + i] = (indices >> (8 * i)) & 0xff;
+  }
+
+  // BC7 模式 6：单个子集，RGBA 端点各 7 位加 1 个 p 位，4 位下标
+  static void encodeMode6(const unsigned char block[64], unsigned char *out)
+  {
+    static const int weights[16] = {0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64};
+    float low[4], high[4];
+    endpoints(block, 4, low, high);
+
+    int quantized[2][4], pbit[2];
+    const float *ends[2] = {low, high};
+    for (int e = 0; e < 2; e++)
+    {
+      int bestError = 1 << 30;
+      for (int p = 0; p < 2; p++)
+      {
+        int candidate[4], error = 0;
+        for (int c = 0; c < 4; c++)
+        {
+          candidate[c] = std::min(std::max((int)std::lround((ends[e][c] - p) / 2.0f), 0), 127);
+          int d = ((candidate[c] << 1) | p) - (int)std::lround(ends[e][c]);
+          error += d * d;
+        }
+        if (error < bestError)
+        {
+          bestError = error;
+          pbit[e] = p;
+          memcpy(quantized[e], candidate, sizeof(candidate));
+        }
+      }
+    }
+
+    int palette[16][4];
+    for (int w = 0; w < 16; w++)
+      for (int c = 0; c < 4; c++)
+      {
+        int e0 = (quantized[0][c] << 1) | pbit[0];
+        int e1 = (quantized[1][c] << 1) | pbit[1];
+        palette[w][c] = ((64 - weights[w]) * e0 + weights[w] * e1 + 32) >> 6;
+      }
+    int indices[16];
+    for (int i = 0; i < 16; i++)
+    {
+      int best = 0, bestError = 1 << 30;
+      for (int w = 0; w < 16; w++)
+      {
+        int error = 0;
+        for (int c = 0; c < 4; c++)
+        {
+          int d = block[i * 4 + c] - palette[w][c];
+          error += d * d;
+        }
+        if (error < bestError)
+        {
+          bestError = error;
+          best = w;
+        }
+      }
+      indices[i] = best;
+    }
+    // 第一个像素的下标最高位隐含为 0，否则交换端点；权重关于中点对称，下标取反即可
+    if (indices[0] >= 8)
+    {
+      for (int c = 0; c < 4; c++)
+        std::swap(quantized[0][c], quantized[1][c]);
+      std::swap(pbit[0], pbit[1]);
+      for (int i = 0; i < 16; i++)
+        indices[i] = 15 - indices[i];
+    }
+
+    memset(out, 0, 16);
+    int position = 0;
+    auto put = [&](unsigned int value, int bits)
+    {
+      for (int b = 0; b < bits; b++, position++)
+        if (value & (1u << b))
+          out[position >> 3] |= (unsigned char)(1u << (position & 7));
+    };
+    put(1u << 6, 7);
+    for (int c = 0; c < 4; c++)
+    {
+      put(quantized[0][c], 7);
+      put(quantized[1][c], 7);
+    }
+    put(pbit[0], 1);
+    put(pbit[1], 1);
+    put(indices[0], 3);
+    for (int i = 1; i < 16; i++)
+      put(indices[i], 4);
+  }
+};
+
+#endif
@@ -0,0 +1,90 @@
+#ifndef FRAME_CONSTANTS_H
+#define FRAME_CONSTANTS_H
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include <tool/shader.h>
+
+// 与着色器中 FrameConstants 块一一对应（std140，所有成员按 16 字节对齐）
+// layout(std140) uniform FrameConstants {
+//   mat4 view;
+//   mat4 projection;
+//   mat4 viewProj;
+//   vec4 cameraPosition; // xyz: 相机位置
+//   vec4 frameTime;      // x: 时间, y: 帧间隔
+//   vec4 lightDirection; // 平行光
+//   vec4 lightAmbient;
+//   vec4 lightDiffuse;
+//   vec4 lightSpecular;
+// };
+struct FrameConstantsData
+{
+  glm::mat4 view = glm::mat4(1.0f);
+  glm::mat4 projection = glm::mat4(1.0f);
+  glm::mat4 viewProj = glm::mat4(1.0f);
+  glm::vec4 cameraPosition = glm::vec4(0.0f);
+  glm::vec4 frameTime = glm::vec4(0.0f);
+  glm::vec4 lightDirection = glm::vec4(0.0f, -1.0f, 0.0f, 0.0f);
+  glm::vec4 lightAmbient = glm::vec4(0.0f);
+  glm::vec4 lightDiffuse = glm::vec4(0.0f);
+  glm::vec4 lightSpecular = glm::vec4(0.0f);
+};
+
+static_assert(sizeof(FrameConstantsData) == 288, "FrameConstantsData must match the std140 layout");
+
+// 每帧共享的常量缓冲，每帧上传一次，所有声明了 FrameConstants 块的 Shader 自动绑定
+class FrameConstants
+{
+public:
+  FrameConstantsData data;
+  unsigned int UBO;
+
+  // 需要在 OpenGL 上下文创建之后构造
+  FrameConstants()
+  {
+    glGenBuffers(1, &UBO);
+    glBindBuffer(GL_UNIFORM_BUFFER, UBO);
+    glBufferData(GL_UNIFORM_BUFFER, sizeof(FrameConstantsData), NULL, GL_DYNAMIC_DRAW);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+    glBindBufferBase(GL_UNIFORM_BUFFER, Shader::uniformBlockBindings["FrameConstants"], UBO);
+  }
+
+  // 相机与时间
+  void setCamera(const glm::mat4 &view, const glm::mat4 &projection, const glm::vec3 &position)
+  {
+    data.view = view;
+    data.projection = projection;
+    data.viewProj = projection * view;
+    data.cameraPosition = glm::vec4(position, 1.0f);
+  }
+
+  void setTime(float time, float deltaTime)
+  {
+    data.frameTime = glm::vec4(time, deltaTime, 0.0f, 0.0f);
+  }
+
+  // 全局平行光
+  void setDirectionLight(const glm::vec3 &direction, const glm::vec3 &ambient, const glm::vec3 &diffuse, const glm::vec3 &specular)
+  {
+    data.lightDirection = glm::vec4(direction, 0.0f);
+    data.lightAmbient = glm::vec4(ambient, 0.0f);
+    data.lightDiffuse = glm::vec4(diffuse, 0.0f);
+    data.lightSpecular = glm::vec4(specular, 0.0f);
+  }
+
+  // 每帧调用一次，整块上传
+  void upload()
+  {
+    glBindBuffer(GL_UNIFORM_BUFFER, UBO);
+    glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(FrameConstantsData), &data);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+  }
+
+  void dispose()
+  {
+    glDeleteBuffers(1, &UBO);
+  }
+};
+
+#endif
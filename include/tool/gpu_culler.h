@@ -0,0 +1,341 @@
+#ifndef GPU_CULLER_H
+#define GPU_CULLER_H
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+#include <geometry/Frustum.h>
+#include <geometry/GeometryHandle.h>
+#include <tool/render_state.h>
+#include <tool/shader.h>
+
+// glDrawElementsIndirect 读取的命令，布局由 GL 规定
+struct DrawElementsIndirectCommand
+{
+  GLuint count;
+  GLuint instanceCount;
+  GLuint firstIndex;
+  GLint baseVertex;
+  GLuint baseInstance;
+};
+
+struct GpuCullStats
+{
+  unsigned int instances = 0;
+  unsigned int visible = 0; // 几帧之前的结果，回读不等待 GPU
+  double cullMs = 0.0;      // GPU 计时，同样晚几帧
+  double hiZMs = 0.0;
+};
+
+// GPU 上的实例剔除（GL 4.3 计算着色器 + 间接绘制）
+//
+// 实例的包围球在构造时上传一次，之后 CPU 不再读写逐实例的数据：
+// 1. cull() 把间接绘制命令的 instanceCount 清零，计算着色器按视锥、距离和上一帧的深度金字塔测试每个包围球，
+//    可见的下标追加到 visibleBuffer，同时累加命令的 instanceCount
+// 2. draw() 绑定 visibleBuffer（binding 1）并调用 glDrawElementsIndirect，
+//    顶点着色器 #include "gpu_instances.glsl"，用 visibleInstance() 取自己的逐实例数据
+// 3. captureDepth() 在场景画完之后把默认帧缓冲的深度复制出来，生成最大深度的 mip 链（Hi-Z），供下一帧的 cull() 使用
+//
+// 遮挡测试用的是上一帧的深度和矩阵，被遮挡的物体重新露出时晚一帧出现。
+// 构造前先检查 supported()，GL 3.3 上使用 InstanceCuller
+class GpuCuller
+{
+public:
+  unsigned int spheresBuffer = 0;  // binding 0
+  unsigned int visibleBuffer = 0;  // binding 1
+  unsigned int commandBuffer = 0;  // binding 2，也是 GL_DRAW_INDIRECT_BUFFER
+  bool occlusion = true;
+
+  GpuCullStats stats;
+
+  static bool supported()
+  {
+    return GLAD_GL_VERSION_4_3 != 0;
+  }
+
+  // spheres: xyz 为世界空间的中心，w 为半径
+  explicit GpuCuller(const std::vector<glm::vec4> &spheres) : instanceCount((GLsizei)spheres.size())
+  {
+    cullProgram.reset(new Shader(Shader::compute("static/shader/gpu_cull_comp.glsl")));
+    downsampleProgram.reset(new Shader(Shader::compute("static/shader/hiz_downsample_comp.glsl")));
+    resolveUniforms();
+
+    glGenBuffers(1, &spheresBuffer);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, spheresBuffer);
+    glBufferData(GL_SHADER_STORAGE_BUFFER, std::max<size_t>(spheres.size(), 1) * sizeof(glm::vec4), spheres.data(), GL_STATIC_DRAW);
+    glGenBuffers(1, &visibleBuffer);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, visibleBuffer);
+    glBufferData(GL_SHADER_STORAGE_BUFFER, std::max<size_t>(spheres.size(), 1) * sizeof(GLuint), nullptr, GL_DYNAMIC_COPY);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+    glGenBuffers(1, &commandBuffer);
+    glGenBuffers(1, &commandTemplate);
+    glGenBuffers(1, &readbackBuffer);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, readbackBuffer);
+    glBufferData(GL_COPY_WRITE_BUFFER, FRAMES * sizeof(GLuint), nullptr, GL_STREAM_READ);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+    glGenQueries(FRAMES * 2, &queries[0][0]);
+    stats.instances = (unsigned int)instanceCount;
+  }
+
+  ~GpuCuller()
+  {
+    for (GLsync fence : fences)
+      if (fence != 0)
+        glDeleteSync(fence);
+    glDeleteQueries(FRAMES * 2, &queries[0][0]);
+    unsigned int buffers[] = {spheresBuffer, visibleBuffer, commandBuffer, commandTemplate, readbackBuffer};
+    glDeleteBuffers(5, buffers);
+    deleteHiZ();
+    RenderState::forgetProgram(cullProgram->ID);
+    RenderState::forgetProgram(downsampleProgram->ID);
+    glDeleteProgram(cullProgram->ID);
+    glDeleteProgram(downsampleProgram->ID);
+  }
+  GpuCuller(const GpuCuller &) = delete;
+  GpuCuller &operator=(const GpuCuller &) = delete;
+
+  // 每个网格一个间接绘制命令，只在网格数量或索引数变化时重新上传
+  void setMeshes(const std::vector<const GeometryHandle *> &meshes)
+  {
+    std::vector<DrawElementsIndirectCommand> commands(meshes.size());
+    for (size_t i = 0; i < meshes.size(); i++)
+      commands[i] = {(GLuint)meshes[i]->indexCount, 0, 0, 0, 0};
+    if (commands.size() == commandCounts.size() &&
+        std::equal(commands.begin(), commands.end(), commandCounts.begin(), [](const DrawElementsIndirectCommand &a, GLuint count)
+                   { return a.count == count; }))
+      return;
+    commandCounts.clear();
+    for (const DrawElementsIndirectCommand &command : commands)
+      commandCounts.push_back(command.count);
+    size_t bytes = std::max<size_t>(commands.size(), 1) * sizeof(DrawElementsIndirectCommand);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, commandTemplate);
+    glBufferData(GL_COPY_WRITE_BUFFER, bytes, commands.data(), GL_STATIC_DRAW);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, commandBuffer);
+    glBufferData(GL_COPY_WRITE_BUFFER, bytes, nullptr, GL_DYNAMIC_COPY);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+  }
+
+  // maxDistance 为 0 时只按视锥剔除
+  void cull(const glm::mat4 &viewProj, const glm::vec3 &eye, float maxDistance = 0.0f)
+  {
+    if (commandCounts.empty())
+      return;
+    collectStats();
+    frame = (frame + 1) % FRAMES;
+    currentViewProj = viewProj;
+
+    // 从模板复制命令，instanceCount 归零
+    glBindBuffer(GL_COPY_READ_BUFFER, commandTemplate);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, commandBuffer);
+    glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, commandCounts.size() * sizeof(DrawElementsIndirectCommand));
+
+    Frustum frustum = Frustum::fromMatrix(viewProj);
+    bool testOcclusion = occlusion && hiZValid;
+    glBeginQuery(GL_TIME_ELAPSED, queries[frame][0]);
+    cullProgram->use();
+    cullProgram->set(instanceCountUniform, (int)instanceCount);
+    cullProgram->set(commandCountUniform, (int)commandCounts.size());
+    cullProgram->setArray(planesUniform, frustum.planes, 6);
+    cullProgram->set(eyeCutoffUniform, glm::vec4(eye, maxDistance));
+    cullProgram->set(occlusionUniform, testOcclusion);
+    if (testOcclusion)
+    {
+      cullProgram->set(previousViewProjUniform, hiZViewProj);
+      cullProgram->set(hiZLevelsUniform, hiZLevelCount);
+      cullProgram->set(hiZUniform, 0);
+      RenderState::bindTexture(0, GL_TEXTURE_2D, hiZPyramid);
+    }
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, spheresBuffer);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, visibleBuffer);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, commandBuffer);
+    glDispatchCompute((GLuint)(instanceCount + 63) / 64, 1, 1);
+    glEndQuery(GL_TIME_ELAPSED);
+    // 间接命令和顶点着色器读取 visibleBuffer 之前等待计算着色器写完
+    glMemoryBarrier(GL_COMMAND_BARRIER_BIT | GL_SHADER_STORAGE_BARRIER_BIT | GL_BUFFER_UPDATE_BARRIER_BIT);
+
+    // 可见数量复制到回读缓冲，几帧之后 fence 通过再读取
+    glBindBuffer(GL_COPY_READ_BUFFER, commandBuffer);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, readbackBuffer);
+    glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, offsetof(DrawElementsIndirectCommand, instanceCount), frame * sizeof(GLuint),
+                        sizeof(GLuint));
+    glBindBuffer(GL_COPY_READ_BUFFER, 0);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+    if (fences[frame] != 0)
+      glDeleteSync(fences[frame]);
+    fences[frame] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    culled[frame] = true;
+  }
+
+  // 绘制第 mesh 个网格的可见实例，VAO 和着色器由调用方设置
+  void draw(const GeometryHandle &geometry, size_t mesh, GLenum mode = GL_TRIANGLES)
+  {
+    if (mesh >= commandCounts.size() || !UploadScheduler::ready(geometry.VAO))
+      return;
+    RenderState::bindVertexArray(geometry.VAO);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, visibleBuffer);
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, commandBuffer);
+    glDrawElementsIndirect(mode, geometry.indexType, (const void *)(mesh * sizeof(DrawElementsIndirectCommand)));
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+  }
+
+  // 场景画完之后调用：复制当前读帧缓冲（默认帧缓冲）的深度，生成下一帧遮挡测试用的深度金字塔
+  void captureDepth(int width, int height)
+  {
+    if (width <= 0 || height <= 0)
+      return;
+    if (width != hiZWidth || height != hiZHeight)
+      createHiZ(width, height);
+
+    glBeginQuery(GL_TIME_ELAPSED, queries[frame][1]);
+    RenderState::bindTexture(0, GL_TEXTURE_2D, hiZDepth);
+    glCopyTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, 0, 0, width, height);
+
+    downsampleProgram->use();
+    downsampleProgram->set(sourceUniform, 0);
+    int levelWidth = width, levelHeight = height;
+    for (int level = 0; level < hiZLevelCount; level++)
+    {
+      // 第 0 级从深度纹理复制，之后每级读取金字塔的上一级
+      RenderState::bindTexture(0, GL_TEXTURE_2D, level == 0 ? hiZDepth : hiZPyramid);
+      downsampleProgram->set(sourceLevelUniform, level == 0 ? 0 : level - 1);
+      downsampleProgram->set(scaleUniform, level == 0 ? 1 : 2);
+      glBindImageTexture(0, hiZPyramid, level, GL_FALSE, 0, GL_WRITE_ONLY, GL_R32F);
+      glDispatchCompute((GLuint)(levelWidth + 7) / 8, (GLuint)(levelHeight + 7) / 8, 1);
+      glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT | GL_SHADER_IMAGE_ACCESS_BARRIER_BIT);
+      levelWidth = std::max(1, levelWidth / 2);
+      levelHeight = std::max(1, levelHeight / 2);
+    }
+    glEndQuery(GL_TIME_ELAPSED);
+    captured[frame] = true;
+    hiZViewProj = currentViewProj;
+    hiZValid = true;
+  }
+
+  // 例如窗口大小变化、相机跳转之后，下一帧不做遮挡测试
+  void invalidateDepth()
+  {
+    hiZValid = false;
+  }
+
+  unsigned int hiZTexture() const
+  {
+    return hiZPyramid;
+  }
+
+private:
+  static const int FRAMES = 3;
+
+  GLsizei instanceCount;
+  std::vector<GLuint> commandCounts;
+  unsigned int commandTemplate = 0;
+  unsigned int readbackBuffer = 0;
+  GLsync fences[FRAMES] = {0, 0, 0};
+  GLuint queries[FRAMES][2]; // 每帧的剔除和深度金字塔
+  bool culled[FRAMES] = {false, false, false};
+  bool captured[FRAMES] = {false, false, false};
+  int frame = 0;
+
+  std::unique_ptr<Shader> cullProgram, downsampleProgram;
+  Uniform<int> instanceCountUniform, commandCountUniform, hiZLevelsUniform, hiZUniform;
+  Uniform<glm::vec4> planesUniform, eyeCutoffUniform;
+  Uniform<bool> occlusionUniform;
+  Uniform<glm::mat4> previousViewProjUniform;
+  Uniform<int> sourceUniform, sourceLevelUniform, scaleUniform;
+
+  unsigned int hiZDepth = 0, hiZPyramid = 0;
+  int hiZWidth = 0, hiZHeight = 0, hiZLevelCount = 0;
+  glm::mat4 currentViewProj = glm::mat4(1.0f), hiZViewProj = glm::mat4(1.0f);
+  bool hiZValid = false;
+
+  void resolveUniforms()
+  {
+    instanceCountUniform = cullProgram->uniform<int>("instanceCount");
+    commandCountUniform = cullProgram->uniform<int>("commandCount");
+    planesUniform = cullProgram->uniform<glm::vec4>("planes");
+    eyeCutoffUniform = cullProgram->uniform<glm::vec4>("eyeCutoff");
+    occlusionUniform = cullProgram->uniform<bool>("occlusion");
+    previousViewProjUniform = cullProgram->uniform<glm::mat4>("previousViewProj");
+    hiZUniform = cullProgram->uniform<int>("hiZ");
+    hiZLevelsUniform = cullProgram->uniform<int>("hiZLevels");
+    sourceUniform = downsampleProgram->uniform<int>("source");
+    sourceLevelUniform = downsampleProgram->uniform<int>("sourceLevel");
+    scaleUniform = downsampleProgram->uniform<int>("scale");
+  }
+
+  void createHiZ(int width, int height)
+  {
+    deleteHiZ();
+    hiZWidth = width;
+    hiZHeight = height;
+    hiZLevelCount = 1 + (int)std::floor(std::log2((float)std::max(width, height)));
+
+    glGenTextures(1, &hiZDepth);
+    RenderState::bindTexture(0, GL_TEXTURE_2D, hiZDepth);
+    glTexStorage2D(GL_TEXTURE_2D, 1, GL_DEPTH_COMPONENT32F, width, height);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_COMPARE_MODE, GL_NONE);
+
+    // 金字塔不补成 2 的幂，奇数尺寸的最后一个纹素覆盖上一级的 3 个纹素，occluded() 按第 0 层的像素右移定位纹素
+    glGenTextures(1, &hiZPyramid);
+    RenderState::bindTexture(0, GL_TEXTURE_2D, hiZPyramid);
+    glTexStorage2D(GL_TEXTURE_2D, hiZLevelCount, GL_R32F, width, height);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST_MIPMAP_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    hiZValid = false;
+  }
+
+  void deleteHiZ()
+  {
+    for (unsigned int *texture : {&hiZDepth, &hiZPyramid})
+      if (*texture != 0)
+      {
+        RenderState::forgetTexture(*texture);
+        glDeleteTextures(1, texture);
+        *texture = 0;
+      }
+  }
+
+  // 读取已经完成的帧的可见数量和 GPU 耗时，未完成的跳过，不等待
+  void collectStats()
+  {
+    for (int i = 1; i <= FRAMES; i++)
+    {
+      int slot = (frame + i) % FRAMES; // 从最早的一帧开始
+      if (culled[slot] && fences[slot] != 0 && glClientWaitSync(fences[slot], 0, 0) != GL_TIMEOUT_EXPIRED)
+      {
+        GLuint visible = 0;
+        glBindBuffer(GL_COPY_READ_BUFFER, readbackBuffer);
+        glGetBufferSubData(GL_COPY_READ_BUFFER, slot * sizeof(GLuint), sizeof(GLuint), &visible);
+        glBindBuffer(GL_COPY_READ_BUFFER, 0);
+        stats.visible = visible;
+        stats.cullMs = queryMs(queries[slot][0]);
+        culled[slot] = false;
+        // 深度金字塔在 fence 之后提交，结果可能还没有
+        GLuint available = 0;
+        if (captured[slot])
+          glGetQueryObjectuiv(queries[slot][1], GL_QUERY_RESULT_AVAILABLE, &available);
+        if (available)
+          stats.hiZMs = queryMs(queries[slot][1]);
+        captured[slot] = false;
+      }
+    }
+  }
+
+  static double queryMs(GLuint query)
+  {
+    GLuint64 nanoseconds = 0;
+    glGetQueryObjectui64v(query, GL_QUERY_RESULT, &nanoseconds);
+    return nanoseconds / 1e6;
+  }
+};
+
+#endif
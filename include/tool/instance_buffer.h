@@ -0,0 +1,119 @@
+#ifndef INSTANCE_BUFFER_H
+#define INSTANCE_BUFFER_H
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include <cstddef>
+
+// 每帧重写的实例数据，三块区域轮流使用
+//
+// 每帧 map() 取下一块区域的写指针（等待这块区域上一次的绘制完成），写入后 unmap()，绘制之后 fence()。
+// GL 4.4 起整个缓冲用 glBufferStorage 持久映射，写指针一直有效；否则每帧用
+// glMapBufferRange(UNSYNCHRONIZED | INVALIDATE_RANGE) 映射这一块区域，同步同样由 fence 保证。
+// 写指针可以交给工作线程填写，map() / unmap() / fence() 在 GL 线程上调用
+//
+// 实例属性的指针要加上 offset()，例如每帧对 VAO 重新调用 glVertexAttribPointer
+class InstanceBuffer
+{
+public:
+  static const unsigned int REGIONS = 3;
+
+  unsigned int buffer = 0;
+  unsigned int stalls = 0; // map() 时区域还在被 GPU 读取的次数
+
+  InstanceBuffer(size_t capacity, size_t elementSize = sizeof(glm::mat4)) : capacity(capacity), elementSize(elementSize)
+  {
+    regionBytes = capacity * elementSize;
+    glGenBuffers(1, &buffer);
+    glBindBuffer(GL_ARRAY_BUFFER, buffer);
+    if (persistentMapping())
+    {
+      GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+      glBufferStorage(GL_ARRAY_BUFFER, regionBytes * REGIONS, nullptr, flags);
+      persistent = (unsigned char *)glMapBufferRange(GL_ARRAY_BUFFER, 0, regionBytes * REGIONS, flags);
+    }
+    else
+      glBufferData(GL_ARRAY_BUFFER, regionBytes * REGIONS, nullptr, GL_STREAM_DRAW);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+  }
+
+  ~InstanceBuffer()
+  {
+    for (GLsync &fence : fences)
+      if (fence != 0)
+        glDeleteSync(fence);
+    if (persistent != nullptr)
+    {
+      glBindBuffer(GL_ARRAY_BUFFER, buffer);
+      glUnmapBuffer(GL_ARRAY_BUFFER);
+      glBindBuffer(GL_ARRAY_BUFFER, 0);
+    }
+    glDeleteBuffers(1, &buffer);
+  }
+  InstanceBuffer(const InstanceBuffer &) = delete;
+  InstanceBuffer &operator=(const InstanceBuffer &) = delete;
+
+  // GL 4.4 起持久映射
+  static bool persistentMapping()
+  {
+    return GLAD_GL_VERSION_4_4 != 0;
+  }
+
+  size_t size() const
+  {
+    return capacity;
+  }
+
+  // 切换到下一块区域并返回它的写指针，可以写 size() 个元素
+  void *map()
+  {
+    region = (region + 1) % REGIONS;
+    GLsync &pending = fences[region];
+    if (pending != 0)
+    {
+      if (glClientWaitSync(pending, 0, 0) == GL_TIMEOUT_EXPIRED)
+      {
+        stalls++;
+        glClientWaitSync(pending, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000000ull);
+      }
+      glDeleteSync(pending);
+      pending = 0;
+    }
+    if (persistent != nullptr)
+      return persistent + offset();
+    glBindBuffer(GL_ARRAY_BUFFER, buffer);
+    return glMapBufferRange(GL_ARRAY_BUFFER, offset(), regionBytes, GL_MAP_WRITE_BIT | GL_MAP_UNSYNCHRONIZED_BIT | GL_MAP_INVALIDATE_RANGE_BIT);
+  }
+
+  void unmap()
+  {
+    if (persistent != nullptr)
+      return;
+    glBindBuffer(GL_ARRAY_BUFFER, buffer);
+    glUnmapBuffer(GL_ARRAY_BUFFER);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+  }
+
+  // 读取当前区域的绘制都提交之后调用
+  void fence()
+  {
+    fences[region] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+  }
+
+  // 当前区域在缓冲中的字节偏移
+  size_t offset() const
+  {
+    return region * regionBytes;
+  }
+
+private:
+  size_t capacity;
+  size_t elementSize;
+  size_t regionBytes = 0;
+  unsigned int region = REGIONS - 1; // 第一次 map() 之后是 0
+  unsigned char *persistent = nullptr;
+  GLsync fences[REGIONS] = {0, 0, 0};
+};
+
+#endif
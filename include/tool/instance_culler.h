@@ -0,0 +1,110 @@
+#ifndef INSTANCE_CULLER_H
+#define INSTANCE_CULLER_H
+
+#include <glm/glm.hpp>
+
+#include <chrono>
+#include <cstring>
+#include <vector>
+
+#include <geometry/Frustum.h>
+#include <tool/occlusion_culler.h>
+#include <tool/parallel.h>
+
+struct InstanceCullStats
+{
+  size_t instances = 0;
+  size_t visible = 0;
+  size_t occluded = 0; // 在视锥内但被遮挡
+  unsigned int threads = 0;
+  double cullMs = 0.0;    // 剔除阶段的墙上时间
+  double compactMs = 0.0; // 把可见矩阵写到输出的墙上时间
+};
+
+// 多线程的实例剔除和紧凑
+//
+// 实例按 chunkSize 分块，第一遍各线程领取块，用 FrustumCuller 测试包围球，可见下标写在块自己的区间里；
+// 前缀和得到每块在输出中的起点后，第二遍各线程把自己块的矩阵拷贝过去。输出按实例下标排序，与线程数无关。
+// 传入 occlusion 时，第一遍在视锥内的实例还要用包围球的外接盒做遮挡测试（遮挡体已经光栅化）。
+// 输出可以直接是映射的实例缓冲（见 InstanceBuffer），拷贝在工作线程上完成，渲染线程只等待
+class InstanceCuller
+{
+public:
+  inline static size_t chunkSize = 16 * 1024;
+
+  InstanceCullStats stats; // 上一次 cull
+
+  // 返回可见数量，out 至少有 spheres.size() 个矩阵的空间
+  size_t cull(const Frustum &frustum, const SphereSoA &spheres, const glm::mat4 *matrices, glm::mat4 *out, OcclusionCuller *occlusion = nullptr)
+  {
+    size_t count = spheres.size();
+    size_t chunks = (count + chunkSize - 1) / chunkSize;
+    indices.resize(count);
+    offsets.assign(chunks + 1, 0);
+    occludedCounts.assign(chunks, 0);
+    occlusionMs.assign(chunks, 0.0);
+
+    auto start = std::chrono::steady_clock::now();
+    Parallel::forEach(chunks, [&](size_t chunk)
+                      {
+                        size_t begin = chunk * chunkSize;
+                        size_t end = std::min(count, begin + chunkSize);
+                        size_t visibleCount = FrustumCuller::cull(frustum, spheres, begin, end, &indices[begin]);
+                        if (occlusion != nullptr)
+                        {
+                          auto tested = std::chrono::steady_clock::now();
+                          uint32_t *visible = &indices[begin];
+                          size_t kept = 0;
+                          for (size_t i = 0; i < visibleCount; i++)
+                          {
+                            uint32_t index = visible[i];
+                            glm::vec3 center(spheres.x[index], spheres.y[index], spheres.z[index]);
+                            Bounds bounds;
+                            bounds.min = center - glm::vec3(spheres.radius[index]);
+                            bounds.max = center + glm::vec3(spheres.radius[index]);
+                            if (!occlusion->occluded(bounds))
+                              visible[kept++] = index;
+                          }
+                          occludedCounts[chunk] = visibleCount - kept;
+                          occlusionMs[chunk] = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - tested).count();
+                          visibleCount = kept;
+                        }
+                        offsets[chunk + 1] = visibleCount; });
+    auto culled = std::chrono::steady_clock::now();
+
+    for (size_t chunk = 0; chunk < chunks; chunk++)
+      offsets[chunk + 1] += offsets[chunk];
+    Parallel::forEach(chunks, [&](size_t chunk)
+                      {
+                        const uint32_t *visible = &indices[chunk * chunkSize];
+                        glm::mat4 *target = out + offsets[chunk];
+                        size_t visibleCount = offsets[chunk + 1] - offsets[chunk];
+                        for (size_t i = 0; i < visibleCount; i++)
+                          memcpy(&target[i], &matrices[visible[i]], sizeof(glm::mat4)); });
+    auto compacted = std::chrono::steady_clock::now();
+
+    stats.instances = count;
+    stats.visible = offsets[chunks];
+    stats.occluded = 0;
+    double testMs = 0.0;
+    for (size_t chunk = 0; chunk < chunks; chunk++)
+    {
+      stats.occluded += occludedCounts[chunk];
+      testMs += occlusionMs[chunk];
+    }
+    if (occlusion != nullptr)
+      occlusion->record(stats.visible + stats.occluded, stats.occluded, testMs);
+    stats.threads = (unsigned int)std::min<size_t>(Parallel::workerCount(), std::max<size_t>(chunks, 1));
+    stats.cullMs = std::chrono::duration<double, std::milli>(culled - start).count();
+    stats.compactMs = std::chrono::duration<double, std::milli>(compacted - culled).count();
+    return stats.visible;
+  }
+
+private:
+  std::vector<uint32_t> indices; // 每块的可见下标从块的起点开始存放
+  std::vector<size_t> offsets;   // offsets[chunk + 1] 先是块的可见数量，前缀和之后是块在输出中的终点
+  std::vector<size_t> occludedCounts; // 每块被遮挡的数量和遮挡测试的耗时
+  std::vector<double> occlusionMs;
+};
+
+#endif
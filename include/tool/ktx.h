@@ -0,0 +1,218 @@
+#ifndef KTX_H
+#define KTX_H
+
+#include <glad/glad.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <string>
+#include <vector>
+
+#include <tool/block_compress.h>
+#include <tool/mapped_file.h>
+
+// KTX 1.1 容器（https://registry.khronos.org/KTX/specs/1.0/ktxspec.v1.html）
+//
+// 只支持本仓库用到的部分：小端、二维、非数组，1 或 6 个面，每级 mipmap 预先计算好。
+// 格式限于 BlockCompress 的块压缩格式和 8 位 / 半精度 / 浮点的 R、RG、RGB、RGBA，
+// 每级的 imageSize 必须与宽高和格式算出的大小一致，截断或损坏的文件在 open() 时就被拒绝。
+// 读取时映射整个文件，各级数据直接指向映射的内存，KtxFile 析构前不能释放
+// ------------------------------------------------------------------------
+struct KtxLevel
+{
+  const unsigned char *data = nullptr;
+  size_t size = 0; // 一个面的字节数
+  int width = 0;
+  int height = 0;
+};
+
+class KtxFile
+{
+public:
+  GLenum internalFormat = 0;
+  GLenum baseInternalFormat = 0;
+  GLenum format = 0; // 非压缩格式的 glFormat / glType，压缩格式为 0
+  GLenum type = 0;
+  int width = 0;
+  int height = 0;
+  int faces = 0;
+  int levels = 0;
+  std::map<std::string, std::string> keyValues;
+
+  KtxFile() = default;
+  explicit KtxFile(const std::string &path)
+  {
+    open(path);
+  }
+
+  KtxFile(const KtxFile &) = delete;
+  KtxFile &operator=(const KtxFile &) = delete;
+
+  bool open(const std::string &path)
+  {
+    images.clear();
+    keyValues.clear();
+    if (!file.open(path) || !parse())
+    {
+      file.close();
+      images.clear();
+      return false;
+    }
+    return true;
+  }
+
+  bool valid() const
+  {
+    return file.valid();
+  }
+
+  bool compressed() const
+  {
+    return type == 0;
+  }
+
+  const KtxLevel &level(int level, int face = 0) const
+  {
+    return images[(size_t)level * faces + face];
+  }
+
+  std::string value(const std::string &key) const
+  {
+    auto found = keyValues.find(key);
+    return found == keyValues.end() ? std::string() : found->second;
+  }
+
+  // images 按 level 优先、面在内的顺序排列，每级的大小由调用方保证一致
+  static bool write(const std::string &path, GLenum internalFormat, GLenum baseInternalFormat, int width, int height, int faces,
+                    const std::vector<std::vector<unsigned char>> &images, const std::map<std::string, std::string> &keyValues)
+  {
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out)
+      return false;
+    std::string keyValueData;
+    for (const auto &pair : keyValues)
+    {
+      uint32_t size = (uint32_t)(pair.first.size() + 1 + pair.second.size() + 1);
+      keyValueData.append((const char *)&size, 4);
+      keyValueData.append(pair.first.c_str(), pair.first.size() + 1);
+      keyValueData.append(pair.second.c_str(), pair.second.size() + 1);
+      keyValueData.append(padding(size), '\0');
+    }
+
+    uint32_t header[13] = {ENDIANNESS, 0, 1, 0, internalFormat, baseInternalFormat, (uint32_t)width, (uint32_t)height, 0, 0,
+                           (uint32_t)faces, (uint32_t)(images.size() / faces), (uint32_t)keyValueData.size()};
+    out.write((const char *)IDENTIFIER, sizeof(IDENTIFIER));
+    out.write((const char *)header, sizeof(header));
+    out.write(keyValueData.data(), keyValueData.size());
+    for (size_t i = 0; i < images.size(); i += faces)
+    {
+      uint32_t imageSize = (uint32_t)images[i].size();
+      out.write((const char *)&imageSize, 4);
+      for (int face = 0; face < faces; face++)
+      {
+        out.write((const char *)images[i + face].data(), images[i + face].size());
+        out.write("\0\0\0", padding(images[i + face].size()));
+      }
+    }
+    return (bool)out;
+  }
+
+private:
+  inline static const unsigned char IDENTIFIER[12] = {0xAB, 'K', 'T', 'X', ' ', '1', '1', 0xBB, '\r', '\n', 0x1A, '\n'};
+  static const uint32_t ENDIANNESS = 0x04030201;
+
+  MappedFile file;
+  std::vector<KtxLevel> images;
+
+  static size_t padding(size_t size)
+  {
+    return (4 - size % 4) % 4;
+  }
+
+  // 一个面在这一级的字节数，非压缩格式每行按 4 字节对齐；不支持的格式返回 0
+  size_t expectedSize(int levelWidth, int levelHeight) const
+  {
+    if (compressed())
+    {
+      BlockFormat block;
+      if (!BlockCompress::fromInternalFormat(internalFormat, block))
+        return 0;
+      return BlockCompress::compressedSize(block, levelWidth, levelHeight);
+    }
+    size_t channels = format == GL_RED ? 1 : format == GL_RG ? 2 : format == GL_RGB ? 3 : format == GL_RGBA ? 4 : 0;
+    size_t typeBytes = type == GL_UNSIGNED_BYTE ? 1 : type == GL_HALF_FLOAT ? 2 : type == GL_FLOAT ? 4 : 0;
+    size_t rowBytes = (size_t)levelWidth * channels * typeBytes;
+    return ((rowBytes + 3) & ~(size_t)3) * levelHeight;
+  }
+
+  bool parse()
+  {
+    const unsigned char *bytes = file.data();
+    size_t size = file.size();
+    uint32_t header[13];
+    if (size < sizeof(IDENTIFIER) + sizeof(header) || memcmp(bytes, IDENTIFIER, sizeof(IDENTIFIER)) != 0)
+      return false;
+    memcpy(header, bytes + sizeof(IDENTIFIER), sizeof(header));
+    if (header[0] != ENDIANNESS || header[8] > 1 || header[9] != 0 || (header[10] != 1 && header[10] != 6))
+      return false;
+    type = header[1];
+    format = header[3];
+    internalFormat = header[4];
+    baseInternalFormat = header[5];
+    width = (int)header[6];
+    height = (int)header[7];
+    faces = (int)header[10];
+    levels = std::max(1, (int)header[11]);
+    if (header[6] == 0 || header[7] == 0 || header[6] > 65536 || header[7] > 65536 || header[11] > 17 ||
+        (1 << (levels - 1)) > std::max(width, height) || expectedSize(width, height) == 0)
+      return false;
+
+    size_t offset = sizeof(IDENTIFIER) + sizeof(header);
+    size_t keyValueEnd = offset + header[12];
+    if (keyValueEnd > size)
+      return false;
+    while (offset + 4 <= keyValueEnd)
+    {
+      uint32_t pairSize;
+      memcpy(&pairSize, bytes + offset, 4);
+      offset += 4;
+      if (offset + pairSize > keyValueEnd)
+        return false;
+      const char *pair = (const char *)bytes + offset;
+      size_t keyLength = strnlen(pair, pairSize);
+      if (keyLength < pairSize)
+        keyValues[std::string(pair, keyLength)] = std::string(pair + keyLength + 1, strnlen(pair + keyLength + 1, pairSize - keyLength - 1));
+      offset += pairSize + padding(pairSize);
+    }
+    offset = keyValueEnd;
+
+    for (int level = 0; level < levels; level++)
+    {
+      if (offset + 4 > size)
+        return false;
+      uint32_t imageSize;
+      memcpy(&imageSize, bytes + offset, 4);
+      offset += 4;
+      if (imageSize != expectedSize(std::max(1, width >> level), std::max(1, height >> level)))
+        return false;
+      for (int face = 0; face < faces; face++)
+      {
+        if (offset + imageSize > size)
+          return false;
+        KtxLevel image;
+        image.data = bytes + offset;
+        image.size = imageSize;
+        image.width = std::max(1, width >> level);
+        image.height = std::max(1, height >> level);
+        images.push_back(image);
+        offset += imageSize + padding(imageSize);
+      }
+    }
+    return true;
+  }
+};
+
+#endif
@@ -0,0 +1,120 @@
+#ifndef LIGHT_BUFFER_H
+#define LIGHT_BUFFER_H
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include <tool/shader.h>
+#include <tool/render_state.h>
+
+#include <vector>
+
+using namespace std;
+
+// 一个点光源占 4 个 RGBA32F 纹素（64 字节）
+// texel 0: position.xyz, constant
+// texel 1: diffuse.rgb,  linear
+// texel 2: specular.rgb, quadratic
+// texel 3: ambient.rgb,  未使用
+struct PointLightData
+{
+  glm::vec4 positionConstant;
+  glm::vec4 diffuseLinear;
+  glm::vec4 specularQuadratic;
+  glm::vec4 ambient;
+};
+
+// 点光源数组存放在纹理缓冲（TBO）中，GL 3.3 即可使用，容量不受 uniform 数量限制，
+// 每帧一次 glBufferSubData 上传，着色器中按 pointLightCount 循环
+//
+// 着色器端：
+// uniform samplerBuffer pointLightBuffer;
+// uniform int pointLightCount;
+class LightBuffer
+{
+public:
+  vector<PointLightData> lights;
+  unsigned int TBO, texture;
+  unsigned int textureUnit;
+
+  LightBuffer(unsigned int textureUnit = 8, unsigned int initialCapacity = 64) : textureUnit(textureUnit), capacity(0)
+  {
+    glGenBuffers(1, &TBO);
+    glGenTextures(1, &texture);
+    reserve(initialCapacity);
+
+    // 纹理引用的是缓冲对象本身，之后扩容重新分配存储也不需要再次关联
+    glBindTexture(GL_TEXTURE_BUFFER, texture);
+    glTexBuffer(GL_TEXTURE_BUFFER, GL_RGBA32F, TBO);
+    glBindTexture(GL_TEXTURE_BUFFER, 0);
+  }
+
+  unsigned int add(const glm::vec3 &position, const glm::vec3 &diffuse, const glm::vec3 &specular, const glm::vec3 &ambient,
+                   float constant = 1.0f, float linear = 0.09f, float quadratic = 0.032f)
+  {
+    PointLightData light;
+    light.positionConstant = glm::vec4(position, constant);
+    light.diffuseLinear = glm::vec4(diffuse, linear);
+    light.specularQuadratic = glm::vec4(specular, quadratic);
+    light.ambient = glm::vec4(ambient, 0.0f);
+    lights.push_back(light);
+    return lights.size() - 1;
+  }
+
+  void setPosition(unsigned int index, const glm::vec3 &position)
+  {
+    lights[index].positionConstant = glm::vec4(position, lights[index].positionConstant.w);
+  }
+
+  void clear()
+  {
+    lights.clear();
+  }
+
+  int count() const
+  {
+    return (int)lights.size();
+  }
+
+  // 整个数组一次上传，容量不足时按两倍扩容
+  void upload()
+  {
+    if (lights.size() > capacity)
+      reserve(glm::max((unsigned int)lights.size(), capacity * 2));
+    if (lights.empty())
+      return;
+    glBindBuffer(GL_TEXTURE_BUFFER, TBO);
+    glBufferSubData(GL_TEXTURE_BUFFER, 0, lights.size() * sizeof(PointLightData), &lights[0]);
+    glBindBuffer(GL_TEXTURE_BUFFER, 0);
+  }
+
+  // 绑定到纹理单元并设置着色器中的数量
+  void bind(Shader &shader)
+  {
+    RenderState::bindTexture(textureUnit, GL_TEXTURE_BUFFER, texture);
+    shader.setInt("pointLightBuffer", textureUnit);
+    shader.setInt("pointLightCount", count());
+  }
+
+  void dispose()
+  {
+    RenderState::forgetTexture(texture);
+    glDeleteTextures(1, &texture);
+    glDeleteBuffers(1, &TBO);
+  }
+
+private:
+  unsigned int capacity;
+
+  void reserve(unsigned int newCapacity)
+  {
+    if (newCapacity <= capacity)
+      return;
+    capacity = newCapacity;
+    glBindBuffer(GL_TEXTURE_BUFFER, TBO);
+    glBufferData(GL_TEXTURE_BUFFER, capacity * sizeof(PointLightData), NULL, GL_DYNAMIC_DRAW);
+    glBindBuffer(GL_TEXTURE_BUFFER, 0);
+  }
+};
+
+#endif
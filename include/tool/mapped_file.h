@@ -0,0 +1,155 @@
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#ifdef _WIN32
+// glad 定义的 APIENTRY 与 windows.h 中的相同（__stdcall），先取消定义避免重复定义的警告
+#undef APIENTRY
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include <cstddef>
+#include <cstring>
+#include <string>
+
+// 只读映射整个文件，析构时解除映射
+// ------------------------------------------------------------------------
+class MappedFile
+{
+public:
+  MappedFile() = default;
+  explicit MappedFile(const std::string &path)
+  {
+    open(path);
+  }
+  ~MappedFile()
+  {
+    close();
+  }
+
+  MappedFile(const MappedFile &) = delete;
+  MappedFile &operator=(const MappedFile &) = delete;
+
+  bool open(const std::string &path)
+  {
+    close();
+#ifdef _WIN32
+    file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+    if (file == INVALID_HANDLE_VALUE)
+      return false;
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0)
+    {
+      close();
+      return false;
+    }
+    mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+    if (mapping == NULL)
+    {
+      close();
+      return false;
+    }
+    bytes = (const unsigned char *)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (bytes == nullptr)
+    {
+      close();
+      return false;
+    }
+    length = (size_t)fileSize.QuadPart;
+#else
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+      return false;
+    struct stat status;
+    if (fstat(fd, &status) != 0 || status.st_size == 0)
+    {
+      ::close(fd);
+      return false;
+    }
+    void *address = mmap(nullptr, (size_t)status.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    // 映射建立后就不再需要文件描述符
+    ::close(fd);
+    if (address == MAP_FAILED)
+      return false;
+    bytes = (const unsigned char *)address;
+    length = (size_t)status.st_size;
+#endif
+    return true;
+  }
+
+  void close()
+  {
+#ifdef _WIN32
+    if (bytes != nullptr)
+      UnmapViewOfFile(bytes);
+    if (mapping != NULL)
+      CloseHandle(mapping);
+    if (file != INVALID_HANDLE_VALUE)
+      CloseHandle(file);
+    mapping = NULL;
+    file = INVALID_HANDLE_VALUE;
+#else
+    if (bytes != nullptr)
+      munmap((void *)bytes, length);
+#endif
+    bytes = nullptr;
+    length = 0;
+  }
+
+  bool valid() const
+  {
+    return bytes != nullptr;
+  }
+
+  const unsigned char *data() const
+  {
+    return bytes;
+  }
+
+  size_t size() const
+  {
+    return length;
+  }
+
+private:
+  const unsigned char *bytes = nullptr;
+  size_t length = 0;
+#ifdef _WIN32
+  HANDLE file = INVALID_HANDLE_VALUE;
+  HANDLE mapping = NULL;
+#endif
+};
+
+// FNV-1a，按 8 字节一组处理，剩余的按字节
+// ------------------------------------------------------------------------
+inline unsigned long long hashBytes(const void *data, size_t size, unsigned long long seed = 14695981039346656037ULL)
+{
+  const unsigned char *bytes = (const unsigned char *)data;
+  unsigned long long result = seed;
+  size_t i = 0;
+  for (; i + 8 <= size; i += 8)
+  {
+    unsigned long long word;
+    std::memcpy(&word, bytes + i, 8);
+    result ^= word;
+    result *= 1099511628211ULL;
+  }
+  for (; i < size; i++)
+  {
+    result ^= bytes[i];
+    result *= 1099511628211ULL;
+  }
+  return result;
+}
+
+#endif
@@ -6,64 +6,102 @@
 #include <glm/gtc/matrix_transform.hpp>
 
 #include <tool/shader.h>
+#include <tool/render_state.h>
+#include <geometry/GeometryHandle.h>
+#include <geometry/Tangents.h>
 
+#include <mutex>
 #include <string>
+#include <unordered_set>
 #include <vector>
 
 using namespace std;
 
-#ifndef BUFFER_GROMETRY
-struct Vertex
+// returns the one shared copy of value: meshes that use the same texture point at the same
+// type and path strings instead of each allocating their own
+inline const string *InternString(const string &value)
 {
-	glm::vec3 Position;	 // 顶点属性
-	glm::vec3 Normal;		 // 法线
-	glm::vec2 TexCoords; // 纹理坐标
-
-	// 切线空间属性
-	glm::vec3 Tangent;
-	glm::vec3 Bitangent;
-};
-#endif
+	static mutex lock;
+	static unordered_set<string> strings; // node based, so the pointers stay valid as it grows
+	lock_guard<mutex> guard(lock);
+	return &*strings.insert(value).first;
+}
 
 struct Texture
 {
-	unsigned int id;
-	string type;
-	string path;
+	unsigned int id = 0;
+	const string *type = nullptr; // interned, see InternString
+	const string *path = nullptr;
 };
 
-class Mesh
+// a mesh owns its GPU buffers (see GeometryHandle): it can be moved, e.g. into
+// Model::meshes, but not copied
+class Mesh : public GeometryHandle
 {
 public:
 	// mesh Data
 	vector<Vertex> vertices;
 	vector<unsigned int> indices;
 	vector<Texture> textures;
-	unsigned int VAO;
+	// sampler uniform of each texture (texture_diffuse1, texture_specular1, ...), interned once instead of built every Draw
+	vector<const string *> samplers;
 
 	Mesh(vector<Vertex> vertices, vector<unsigned int> indices, vector<Texture> textures)
+		: vertices(std::move(vertices)), indices(std::move(indices)), textures(std::move(textures))
 	{
-		this->vertices = vertices;
-		this->indices = indices;
-		this->textures = textures;
+		nameSamplers();
 
 		// now that we have all the required data, set the vertex buffers and its attribute pointers.
 		setupMesh();
 	}
+	// upload straight from memory the mesh does not own (e.g. a mapped MeshCache file);
+	// the CPU copies are only made when GeometryHandle::keepCpuData is set
+	Mesh(const Vertex *vertexData, size_t numVertices, const unsigned int *indexData, size_t numIndices, vector<Texture> textures, const Bounds &knownBounds)
+		: textures(std::move(textures))
+	{
+		nameSamplers();
+		upload(vertexData, numVertices, indexData, numIndices, defaultLayout, &knownBounds);
+		if (keepCpuData)
+		{
+			vertices.assign(vertexData, vertexData + numVertices);
+			indices.assign(indexData, indexData + numIndices);
+		}
+	}
 	// render the mesh
 	void Draw(Shader &shader)
 	{
-		// bind appropriate textures
+		for (unsigned int i = 0; i < textures.size(); i++)
+		{
+			// now set the sampler to the correct texture unit
+			shader.setInt(*samplers[i], i);
+			// and finally bind the texture, skipped if it is already bound to this unit
+			RenderState::bindTexture(i, GL_TEXTURE_2D, textures[i].id);
+		}
+
+		// draw mesh, the VAO stays bound so consecutive draws of the same mesh skip the rebind
+		drawMesh(*this);
+	}
+
+	// free the CPU copies once they are on the GPU, drawing only needs indexCount
+	void releaseCpuData()
+	{
+		vector<Vertex>().swap(vertices);
+		vector<unsigned int>().swap(indices);
+	}
+
+private:
+	void nameSamplers()
+	{
 		unsigned int diffuseNr = 1;
 		unsigned int specularNr = 1;
 		unsigned int normalNr = 1;
 		unsigned int heightNr = 1;
-		for (unsigned int i = 0; i < textures.size(); i++)
+		samplers.reserve(textures.size());
+		for (const Texture &texture : textures)
 		{
-			glActiveTexture(GL_TEXTURE0 + i); // active proper texture unit before binding
-																				// retrieve texture number (the N in diffuse_textureN)
+			// retrieve texture number (the N in diffuse_textureN)
 			string number;
-			string name = textures[i].type;
+			const string &name = *texture.type;
 			if (name == "texture_diffuse")
 				number = std::to_string(diffuseNr++);
 			else if (name == "texture_specular")
@@ -72,62 +110,18 @@ public:
 				number = std::to_string(normalNr++); // transfer unsigned int to stream
 			else if (name == "texture_height")
 				number = std::to_string(heightNr++); // transfer unsigned int to stream
-
-			// now set the sampler to the correct texture unit
-			glUniform1i(glGetUniformLocation(shader.ID, (name + number).c_str()), i);
-			// and finally bind the texture
-			glBindTexture(GL_TEXTURE_2D, textures[i].id);
+			samplers.push_back(InternString(name + number));
 		}
-
-		// draw mesh
-		glBindVertexArray(VAO);
-		glDrawElements(GL_TRIANGLES, indices.size(), GL_UNSIGNED_INT, 0);
-		glBindVertexArray(0);
-
-		// always good practice to set everything back to defaults once configured.
-		glActiveTexture(GL_TEXTURE0);
 	}
 
-private:
-	// render data
-	unsigned int VBO, EBO;
-
 	void setupMesh()
 	{
-		// create buffers/arrays
-		glGenVertexArrays(1, &VAO);
-		glGenBuffers(1, &VBO);
-		glGenBuffers(1, &EBO);
-
-		glBindVertexArray(VAO);
-		// load data into vertex buffers
-		glBindBuffer(GL_ARRAY_BUFFER, VBO);
-		// A great thing about structs is that their memory layout is sequential for all its items.
-		// The effect is that we can simply pass a pointer to the struct and it translates perfectly to a glm::vec3/2 array which
-		// again translates to 3/2 floats which translates to a byte array.
-		glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(Vertex), &vertices[0], GL_STATIC_DRAW);
-
-		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
-		glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned int), &indices[0], GL_STATIC_DRAW);
-
-		// set the vertex attribute pointers
-		// vertex Positions
-		glEnableVertexAttribArray(0);
-		glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void *)0);
-		// vertex normals
-		glEnableVertexAttribArray(1);
-		glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void *)offsetof(Vertex, Normal));
-		// vertex texture coords
-		glEnableVertexAttribArray(2);
-		glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void *)offsetof(Vertex, TexCoords));
-		// vertex tangent
-		glEnableVertexAttribArray(3);
-		glVertexAttribPointer(3, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void *)offsetof(Vertex, Tangent));
-		// vertex bitangent
-		glEnableVertexAttribArray(4);
-		glVertexAttribPointer(4, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void *)offsetof(Vertex, Bitangent));
+		// create buffers/arrays and pack the vertices with the current GeometryHandle::defaultLayout;
+		// the standard layout is byte for byte the Vertex struct, compact layouts quantize the attributes
+		upload(vertices, indices, defaultLayout);
 
-		glBindVertexArray(0);
+		if (!keepCpuData)
+			releaseCpuData();
 	}
 };
 
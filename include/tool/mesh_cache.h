@@ -0,0 +1,380 @@
+#ifndef MESH_CACHE_H
+#define MESH_CACHE_H
+
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <geometry/Bounds.h>
+#include <geometry/MeshOptimizer.h>
+#include <geometry/Vertex.h>
+#include <tool/mapped_file.h>
+#include <tool/mesh.h>
+
+// 缓存文件格式：
+// MeshCacheHeader | MeshCacheRecord[meshCount] | MeshCacheTexture[textureCount] | 字符串 | Vertex[vertexCount] | unsigned int[indexCount]
+// 顶点和索引就是上传用的数据，映射后直接传给 glBufferData / glBufferStorage
+//
+// 结构体按本机布局直接写入，缓存只在生成它的机器上使用（与着色器程序二进制缓存相同）
+// ------------------------------------------------------------------------
+const unsigned int MESH_CACHE_MAGIC = 0x434d474f; // "OGMC"
+const unsigned int MESH_CACHE_VERSION = 1;
+
+struct MeshCacheHeader
+{
+  unsigned int magic;
+  unsigned int version;
+  unsigned int headerSize; // sizeof(MeshCacheHeader)
+  unsigned int vertexSize; // sizeof(Vertex)
+  unsigned long long sourceHash;
+  unsigned long long importHash;
+  unsigned int meshCount;
+  unsigned int textureCount;
+  unsigned long long stringsOffset;
+  unsigned long long stringsSize;
+  unsigned long long verticesOffset;
+  unsigned long long vertexCount;
+  unsigned long long indicesOffset;
+  unsigned long long indexCount;
+  Bounds bounds;
+  MeshOptimizeStats optimizeStats;
+};
+
+// 一个子网格：顶点/索引范围（索引相对于 firstVertex）、材质贴图范围和包围盒
+struct MeshCacheRecord
+{
+  unsigned int firstVertex;
+  unsigned int vertexCount;
+  unsigned int firstIndex;
+  unsigned int indexCount;
+  unsigned int firstTexture;
+  unsigned int textureCount;
+  Bounds bounds;
+};
+
+// 材质贴图引用，偏移相对于字符串区
+struct MeshCacheTexture
+{
+  unsigned int typeOffset;
+  unsigned int typeLength;
+  unsigned int pathOffset;
+  unsigned int pathLength;
+};
+
+// 缓存的有效性：源文件（包括 OBJ 引用的 mtl）内容的哈希和导入参数的哈希
+struct MeshCacheKey
+{
+  unsigned long long sourceHash = 0;
+  unsigned long long importHash = 0;
+};
+
+struct MeshCacheStats
+{
+  unsigned int hits = 0;
+  unsigned int misses = 0;
+  unsigned int rejected = 0; // 缓存文件存在但已失效或损坏
+  double importMs = 0.0;     // 未命中时 assimp 导入 + 处理 + 写缓存的时间
+  double loadMs = 0.0;       // 命中时映射 + 上传的时间
+};
+
+class MeshCache
+{
+public:
+  inline static bool enabled = true;
+  inline static std::string cacheDir = "./output/mesh_cache";
+  inline static MeshCacheStats stats;
+  // ModelHandle 在加载线程上导入，更新 stats 时加锁
+  inline static std::mutex statsLock;
+
+  static void printStats()
+  {
+    std::cout << "MESH_CACHE hits: " << stats.hits << ", misses: " << stats.misses << ", rejected: " << stats.rejected
+              << ", import: " << stats.importMs << " ms, load: " << stats.loadMs << " ms" << std::endl;
+  }
+
+  // 文件名只由源文件路径决定，源文件或导入参数变化后旧文件被拒绝并覆盖
+  static std::string cachePath(const std::string &sourcePath)
+  {
+    std::ostringstream name;
+    name << cacheDir << "/" << std::hex << hashBytes(sourcePath.data(), sourcePath.size()) << ".mesh";
+    return name.str();
+  }
+
+  static MeshCacheKey key(const std::string &sourcePath, unsigned int importFlags)
+  {
+    MeshCacheKey result;
+    result.sourceHash = hashSource(sourcePath);
+
+    unsigned long long importHash = hashBytes(&MESH_CACHE_VERSION, sizeof(MESH_CACHE_VERSION));
+    unsigned int vertexSize = sizeof(Vertex);
+    importHash = hashBytes(&vertexSize, sizeof(vertexSize), importHash);
+    importHash = hashBytes(&importFlags, sizeof(importFlags), importHash);
+    importHash = hashBytes(&MeshOptimizer::enabled, sizeof(MeshOptimizer::enabled), importHash);
+    importHash = hashBytes(&MeshOptimizer::cacheSize, sizeof(MeshOptimizer::cacheSize), importHash);
+    importHash = hashBytes(&MeshOptimizer::overdrawThreshold, sizeof(MeshOptimizer::overdrawThreshold), importHash);
+    result.importHash = importHash;
+    return result;
+  }
+
+  // 源文件的内容，OBJ 还包括 mtllib 引用的材质文件
+  static unsigned long long hashSource(const std::string &path)
+  {
+    MappedFile source(path);
+    if (!source.valid())
+      return 0;
+    unsigned long long result = hashBytes(source.data(), source.size());
+
+    std::string extension = std::filesystem::path(path).extension().string();
+    if (extension != ".obj" && extension != ".OBJ")
+      return result;
+    std::string directory = path.substr(0, path.find_last_of('/') + 1);
+    const char *text = (const char *)source.data();
+    const char *end = text + source.size();
+    for (const char *line = text; line < end;)
+    {
+      const char *lineEnd = (const char *)std::memchr(line, '\n', end - line);
+      if (lineEnd == nullptr)
+        lineEnd = end;
+      if (lineEnd - line > 7 && std::strncmp(line, "mtllib ", 7) == 0)
+      {
+        std::string name(line + 7, lineEnd);
+        while (!name.empty() && (name.back() == '\r' || name.back() == ' '))
+          name.pop_back();
+        MappedFile material(directory + name);
+        if (material.valid())
+          result = hashBytes(material.data(), material.size(), result);
+      }
+      line = lineEnd + 1;
+    }
+    return result;
+  }
+};
+
+// 映射并校验缓存文件，访问函数返回的指针直接指向映射的内存，关闭后失效
+// ------------------------------------------------------------------------
+class MeshCacheReader
+{
+public:
+  bool open(const std::string &path, const MeshCacheKey &key)
+  {
+    if (!file.open(path))
+      return false;
+    if (!validate(key))
+    {
+      file.close();
+      return false;
+    }
+    return true;
+  }
+
+  const MeshCacheHeader &header() const
+  {
+    return *(const MeshCacheHeader *)file.data();
+  }
+
+  const MeshCacheRecord &record(unsigned int index) const
+  {
+    return records()[index];
+  }
+
+  const Vertex *vertices(const MeshCacheRecord &record) const
+  {
+    return (const Vertex *)(file.data() + header().verticesOffset) + record.firstVertex;
+  }
+
+  const unsigned int *indices(const MeshCacheRecord &record) const
+  {
+    return (const unsigned int *)(file.data() + header().indicesOffset) + record.firstIndex;
+  }
+
+  std::string textureType(unsigned int index) const
+  {
+    const MeshCacheTexture &texture = textures()[index];
+    return std::string(strings() + texture.typeOffset, texture.typeLength);
+  }
+
+  std::string texturePath(unsigned int index) const
+  {
+    const MeshCacheTexture &texture = textures()[index];
+    return std::string(strings() + texture.pathOffset, texture.pathLength);
+  }
+
+private:
+  MappedFile file;
+
+  const MeshCacheRecord *records() const
+  {
+    return (const MeshCacheRecord *)(file.data() + sizeof(MeshCacheHeader));
+  }
+
+  const MeshCacheTexture *textures() const
+  {
+    return (const MeshCacheTexture *)(records() + header().meshCount);
+  }
+
+  const char *strings() const
+  {
+    return (const char *)file.data() + header().stringsOffset;
+  }
+
+  // 所有偏移和范围都在文件内才使用，截断或损坏的文件按失效处理
+  bool validate(const MeshCacheKey &key) const
+  {
+    unsigned long long size = file.size();
+    if (size < sizeof(MeshCacheHeader))
+      return false;
+    const MeshCacheHeader &h = header();
+    if (h.magic != MESH_CACHE_MAGIC || h.version != MESH_CACHE_VERSION || h.headerSize != sizeof(MeshCacheHeader) ||
+        h.vertexSize != sizeof(Vertex) || h.sourceHash != key.sourceHash || h.importHash != key.importHash)
+      return false;
+
+    unsigned long long tablesEnd = sizeof(MeshCacheHeader) + (unsigned long long)h.meshCount * sizeof(MeshCacheRecord) +
+                                   (unsigned long long)h.textureCount * sizeof(MeshCacheTexture);
+    if (tablesEnd > size || h.stringsOffset < tablesEnd || h.stringsSize > size - h.stringsOffset)
+      return false;
+    if (h.verticesOffset > size || h.vertexCount > (size - h.verticesOffset) / sizeof(Vertex))
+      return false;
+    if (h.indicesOffset > size || h.indexCount > (size - h.indicesOffset) / sizeof(unsigned int))
+      return false;
+
+    for (unsigned int i = 0; i < h.meshCount; i++)
+    {
+      const MeshCacheRecord &r = record(i);
+      if ((unsigned long long)r.firstVertex + r.vertexCount > h.vertexCount ||
+          (unsigned long long)r.firstIndex + r.indexCount > h.indexCount ||
+          (unsigned long long)r.firstTexture + r.textureCount > h.textureCount)
+        return false;
+    }
+    for (unsigned int i = 0; i < h.textureCount; i++)
+    {
+      const MeshCacheTexture &t = textures()[i];
+      if ((unsigned long long)t.typeOffset + t.typeLength > h.stringsSize ||
+          (unsigned long long)t.pathOffset + t.pathLength > h.stringsSize)
+        return false;
+    }
+    return true;
+  }
+};
+
+// 导入时收集每个子网格的数据，最后一次写出
+// ------------------------------------------------------------------------
+class MeshCacheWriter
+{
+public:
+  // 按导入的总量预先分配，避免逐个网格追加时反复扩容
+  void reserve(size_t meshCount, size_t vertexCount, size_t indexCount)
+  {
+    records.reserve(meshCount);
+    vertices.reserve(vertexCount);
+    indices.reserve(indexCount);
+  }
+
+  void addMesh(const std::vector<Vertex> &meshVertices, const std::vector<unsigned int> &meshIndices, const std::vector<Texture> &meshTextures)
+  {
+    MeshCacheRecord record;
+    record.firstVertex = (unsigned int)vertices.size();
+    record.vertexCount = (unsigned int)meshVertices.size();
+    record.firstIndex = (unsigned int)indices.size();
+    record.indexCount = (unsigned int)meshIndices.size();
+    record.firstTexture = (unsigned int)textures.size();
+    record.textureCount = (unsigned int)meshTextures.size();
+    record.bounds = Bounds::of(meshVertices.data(), meshVertices.size());
+    records.push_back(record);
+    bounds.expand(record.bounds);
+
+    vertices.insert(vertices.end(), meshVertices.begin(), meshVertices.end());
+    indices.insert(indices.end(), meshIndices.begin(), meshIndices.end());
+    for (const Texture &texture : meshTextures)
+    {
+      MeshCacheTexture reference;
+      reference.typeOffset = addString(*texture.type);
+      reference.typeLength = (unsigned int)texture.type->size();
+      reference.pathOffset = addString(*texture.path);
+      reference.pathLength = (unsigned int)texture.path->size();
+      textures.push_back(reference);
+    }
+  }
+
+  // 先写临时文件再改名，中途退出不会留下不完整的缓存
+  bool write(const std::string &path, const MeshCacheKey &key, const MeshOptimizeStats &optimizeStats) const
+  {
+    MeshCacheHeader header = {};
+    header.magic = MESH_CACHE_MAGIC;
+    header.version = MESH_CACHE_VERSION;
+    header.headerSize = sizeof(MeshCacheHeader);
+    header.vertexSize = sizeof(Vertex);
+    header.sourceHash = key.sourceHash;
+    header.importHash = key.importHash;
+    header.meshCount = (unsigned int)records.size();
+    header.textureCount = (unsigned int)textures.size();
+    header.stringsOffset = sizeof(MeshCacheHeader) + records.size() * sizeof(MeshCacheRecord) + textures.size() * sizeof(MeshCacheTexture);
+    header.stringsSize = strings.size();
+    header.verticesOffset = align(header.stringsOffset + header.stringsSize);
+    header.vertexCount = vertices.size();
+    header.indicesOffset = align(header.verticesOffset + vertices.size() * sizeof(Vertex));
+    header.indexCount = indices.size();
+    header.bounds = bounds;
+    header.optimizeStats = optimizeStats;
+
+    std::error_code error;
+    std::filesystem::create_directories(std::filesystem::path(path).parent_path(), error);
+    std::string temporary = path + ".tmp";
+    {
+      std::ofstream file(temporary, std::ios::binary | std::ios::trunc);
+      if (!file)
+        return false;
+      file.write((const char *)&header, sizeof(header));
+      file.write((const char *)records.data(), records.size() * sizeof(MeshCacheRecord));
+      file.write((const char *)textures.data(), textures.size() * sizeof(MeshCacheTexture));
+      file.write(strings.data(), strings.size());
+      pad(file, header.verticesOffset);
+      file.write((const char *)vertices.data(), vertices.size() * sizeof(Vertex));
+      pad(file, header.indicesOffset);
+      file.write((const char *)indices.data(), indices.size() * sizeof(unsigned int));
+      if (!file)
+        return false;
+    }
+    std::filesystem::rename(temporary, path, error);
+    if (error)
+    {
+      std::filesystem::remove(temporary, error);
+      return false;
+    }
+    return true;
+  }
+
+private:
+  std::vector<MeshCacheRecord> records;
+  std::vector<MeshCacheTexture> textures;
+  std::string strings;
+  std::vector<Vertex> vertices;
+  std::vector<unsigned int> indices;
+  Bounds bounds;
+
+  unsigned int addString(const std::string &text)
+  {
+    unsigned int offset = (unsigned int)strings.size();
+    strings += text;
+    return offset;
+  }
+
+  static unsigned long long align(unsigned long long offset)
+  {
+    return (offset + 15) & ~15ULL;
+  }
+
+  static void pad(std::ofstream &file, unsigned long long offset)
+  {
+    static const char zeros[16] = {};
+    unsigned long long position = (unsigned long long)file.tellp();
+    if (offset > position)
+      file.write(zeros, offset - position);
+  }
+};
+
+#endif
@@ -0,0 +1,324 @@
+#ifndef MIP_GENERATOR_H
+#define MIP_GENERATOR_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define MIP_GENERATOR_SSE2 1
+#endif
+
+enum class MipFilter
+{
+  Linear, // 数据贴图（高度、粗糙度、高光强度等），直接平均
+  Srgb,   // 颜色贴图，转换到线性空间平均后再编码回 sRGB，透明度直接平均
+  Normal, // 法线贴图，解码为向量平均后重新归一化
+};
+
+struct MipLevel
+{
+  int width = 0;
+  int height = 0;
+  std::vector<unsigned char> data;
+};
+
+// CPU 上生成 8 位图片的 mipmap 链，代替运行时的 glGenerateMipmap
+//
+// 每级由上一级 2x2 盒式滤波得到（奇数尺寸时丢弃最后一行/列，只有 1 像素宽/高时重复）。
+// 颜色贴图在线性空间中平均，避免 sRGB 数据直接平均导致的变暗；法线贴图平均后重新归一化；
+// alphaCutoff > 0 时按 Castaño 的方法缩放每级的透明度，使透明度大于阈值的比例与第 0 级相同，
+// 透明度测试的草丛和窗户在远处不会变稀
+//
+// x86 上使用 SSE2（x86-64 的基线，不需要额外的编译选项），其他平台和 simd = false 时使用标量实现，两者结果相同
+class MipGenerator
+{
+public:
+  inline static bool simd = true;
+
+  // 由文件名推测滤波方式，TextureCache 和 src/tools/texture_cooker 共用
+  static MipFilter guess(const std::string &path)
+  {
+    std::string name = path.substr(path.find_last_of("/\\") + 1);
+    std::transform(name.begin(), name.end(), name.begin(), [](unsigned char c)
+                   { return (char)std::tolower(c); });
+    auto contains = [&](const char *part)
+    {
+      return name.find(part) != std::string::npos;
+    };
+    if (contains("normal") || contains("_ddn") || contains("_nrm"))
+      return MipFilter::Normal;
+    if (contains("height") || contains("disp") || contains("_ao") || contains("roughness") || contains("metallic") ||
+        contains("spec") || contains("bump") || contains("gloss"))
+      return MipFilter::Linear;
+    return MipFilter::Srgb;
+  }
+
+  // 生成第 1 级到 1x1 的所有级别，不包括第 0 级
+  static std::vector<MipLevel> generate(const unsigned char *pixels, int width, int height, int channels, MipFilter filter, float alphaCutoff = 0.0f)
+  {
+    std::vector<MipLevel> levels;
+    bool hasAlpha = channels == 2 || channels == 4;
+    float targetCoverage = alphaCutoff > 0.0f && hasAlpha ? coverage(pixels, width, height, channels, alphaCutoff, 1.0f) : 0.0f;
+
+    const unsigned char *source = pixels;
+    int w = width, h = height;
+    while (w > 1 || h > 1)
+    {
+      MipLevel level;
+      level.width = std::max(1, w / 2);
+      level.height = std::max(1, h / 2);
+      level.data.resize((size_t)level.width * level.height * channels);
+      downsample(source, w, h, channels, filter, level.data.data());
+      if (alphaCutoff > 0.0f && hasAlpha)
+        scaleAlpha(level, channels, alphaCoverageScale(level, channels, alphaCutoff, targetCoverage));
+      levels.push_back(std::move(level));
+      source = levels.back().data.data();
+      w = levels.back().width;
+      h = levels.back().height;
+    }
+    return levels;
+  }
+
+  // 透明度大于 cutoff 的像素比例，透明度先乘以 scale
+  static float coverage(const unsigned char *pixels, int width, int height, int channels, float cutoff, float scale)
+  {
+    size_t count = (size_t)width * height, covered = 0;
+    float threshold = cutoff * 255.0f;
+    for (size_t i = 0; i < count; i++)
+      if (pixels[i * channels + channels - 1] * scale > threshold)
+        covered++;
+    return count == 0 ? 0.0f : (float)covered / (float)count;
+  }
+
+  // source 为 width x height，dest 为 max(1, width / 2) x max(1, height / 2)
+  static void downsample(const unsigned char *source, int width, int height, int channels, MipFilter filter, unsigned char *dest)
+  {
+    if (filter == MipFilter::Normal && channels < 3)
+      filter = MipFilter::Linear;
+    int destWidth = std::max(1, width / 2), destHeight = std::max(1, height / 2);
+    size_t rowBytes = (size_t)width * channels;
+    for (int y = 0; y < destHeight; y++)
+    {
+      const unsigned char *row0 = source + (size_t)std::min(y * 2, height - 1) * rowBytes;
+      const unsigned char *row1 = source + (size_t)std::min(y * 2 + 1, height - 1) * rowBytes;
+      unsigned char *out = dest + (size_t)y * destWidth * channels;
+      int x = 0;
+      if (width == 1)
+        x = 0; // 只有一列时左右两个样本相同，全部走标量
+      else if (filter == MipFilter::Linear)
+        x = linearRow(row0, row1, destWidth, channels, out);
+      else if (filter == MipFilter::Srgb)
+        x = srgbRow(row0, row1, destWidth, channels, out);
+      else
+        x = normalRow(row0, row1, destWidth, channels, out);
+      for (; x < destWidth; x++)
+        scalarPixel(row0, row1, std::min(x * 2, width - 1), std::min(x * 2 + 1, width - 1), channels, filter, out + x * channels);
+    }
+  }
+
+private:
+  struct Tables
+  {
+    float toLinear[256];
+    unsigned char toSrgb[4097];
+
+    Tables()
+    {
+      for (int i = 0; i < 256; i++)
+      {
+        float c = i / 255.0f;
+        toLinear[i] = c <= 0.04045f ? c / 12.92f : std::pow((c + 0.055f) / 1.055f, 2.4f);
+      }
+      for (int i = 0; i <= 4096; i++)
+      {
+        float l = i / 4096.0f;
+        float c = l <= 0.0031308f ? l * 12.92f : 1.055f * std::pow(l, 1.0f / 2.4f) - 0.055f;
+        toSrgb[i] = (unsigned char)std::lround(std::min(std::max(c, 0.0f), 1.0f) * 255.0f);
+      }
+    }
+  };
+
+  static const Tables &tables()
+  {
+    static const Tables instance;
+    return instance;
+  }
+
+  static unsigned char encodeSrgb(float linear)
+  {
+    int index = (int)(std::min(std::max(linear, 0.0f), 1.0f) * 4096.0f + 0.5f);
+    return tables().toSrgb[index];
+  }
+
+  static bool isAlpha(int channel, int channels)
+  {
+    return (channels == 2 || channels == 4) && channel == channels - 1;
+  }
+
+  // 一个输出像素，x0/x1 是源图中的两列
+  static void scalarPixel(const unsigned char *row0, const unsigned char *row1, int x0, int x1, int channels, MipFilter filter, unsigned char *out)
+  {
+    const unsigned char *p[4] = {row0 + x0 * channels, row0 + x1 * channels, row1 + x0 * channels, row1 + x1 * channels};
+    if (filter == MipFilter::Normal)
+    {
+      // 与 normalRow 相同的运算顺序，两种实现的结果逐字节相同
+      float n[3];
+      for (int c = 0; c < 3; c++)
+        n[c] = (float)(p[0][c] + p[1][c] + p[2][c] + p[3][c]) * (1.0f / 127.5f) - 4.0f;
+      normalize(n, out);
+      for (int c = 3; c < channels; c++)
+        out[c] = (unsigned char)((p[0][c] + p[1][c] + p[2][c] + p[3][c] + 2) >> 2);
+      return;
+    }
+    for (int c = 0; c < channels; c++)
+    {
+      if (filter == MipFilter::Srgb && !isAlpha(c, channels))
+      {
+        const float *toLinear = tables().toLinear;
+        out[c] = encodeSrgb((toLinear[p[0][c]] + toLinear[p[1][c]] + toLinear[p[2][c]] + toLinear[p[3][c]]) * 0.25f);
+      }
+      else
+        out[c] = (unsigned char)((p[0][c] + p[1][c] + p[2][c] + p[3][c] + 2) >> 2);
+    }
+  }
+
+  static void normalize(const float n[3], unsigned char *out)
+  {
+    float lengthSquared = n[0] * n[0] + n[1] * n[1] + n[2] * n[2];
+    float scale = lengthSquared > 1e-12f ? 1.0f / std::sqrt(lengthSquared) : 0.0f;
+    for (int c = 0; c < 3; c++)
+      out[c] = (unsigned char)std::lround(std::min(std::max((n[c] * scale + 1.0f) * 127.5f, 0.0f), 255.0f));
+  }
+
+  // 以下三个函数处理一行中能用 SIMD 的前缀，返回已经完成的输出像素数，剩余的由 scalarPixel 完成
+
+  static int linearRow(const unsigned char *row0, const unsigned char *row1, int destWidth, int channels, unsigned char *out)
+  {
+#ifdef MIP_GENERATOR_SSE2
+    if (!simd || channels != 4)
+      return 0;
+    // 每次 4 个源像素（16 字节）得到 2 个输出像素
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i two = _mm_set1_epi16(2);
+    int x = 0;
+    for (; x + 2 <= destWidth; x += 2)
+    {
+      __m128i a = _mm_loadu_si128((const __m128i *)(row0 + x * 8));
+      __m128i b = _mm_loadu_si128((const __m128i *)(row1 + x * 8));
+      __m128i low = _mm_add_epi16(_mm_unpacklo_epi8(a, zero), _mm_unpacklo_epi8(b, zero));   // 像素 0、1 的纵向和
+      __m128i high = _mm_add_epi16(_mm_unpackhi_epi8(a, zero), _mm_unpackhi_epi8(b, zero)); // 像素 2、3
+      __m128i sum = _mm_add_epi16(_mm_unpacklo_epi64(low, high), _mm_unpackhi_epi64(low, high));
+      sum = _mm_srli_epi16(_mm_add_epi16(sum, two), 2);
+      _mm_storel_epi64((__m128i *)(out + x * 4), _mm_packus_epi16(sum, sum));
+    }
+    return x;
+#else
+    (void)row0, (void)row1, (void)destWidth, (void)channels, (void)out;
+    return 0;
+#endif
+  }
+
+  static int srgbRow(const unsigned char *row0, const unsigned char *row1, int destWidth, int channels, unsigned char *out)
+  {
+#ifdef MIP_GENERATOR_SSE2
+    if (!simd || channels != 4)
+      return 0;
+    // 查表得到线性值后用 SSE 累加，alpha 通道按 1/255 缩放后一起平均
+    const float *toLinear = tables().toLinear;
+    const __m128 quarter = _mm_set1_ps(0.25f);
+    const float alphaScale = 1.0f / 255.0f;
+    for (int x = 0; x < destWidth; x++)
+    {
+      const unsigned char *p[4] = {row0 + x * 8, row0 + x * 8 + 4, row1 + x * 8, row1 + x * 8 + 4};
+      __m128 sum = _mm_setzero_ps();
+      for (int i = 0; i < 4; i++)
+        sum = _mm_add_ps(sum, _mm_setr_ps(toLinear[p[i][0]], toLinear[p[i][1]], toLinear[p[i][2]], p[i][3] * alphaScale));
+      float average[4];
+      _mm_storeu_ps(average, _mm_mul_ps(sum, quarter));
+      unsigned char *pixel = out + x * 4;
+      pixel[0] = encodeSrgb(average[0]);
+      pixel[1] = encodeSrgb(average[1]);
+      pixel[2] = encodeSrgb(average[2]);
+      pixel[3] = (unsigned char)((p[0][3] + p[1][3] + p[2][3] + p[3][3] + 2) >> 2);
+    }
+    return destWidth;
+#else
+    (void)row0, (void)row1, (void)destWidth, (void)channels, (void)out;
+    return 0;
+#endif
+  }
+
+  static int normalRow(const unsigned char *row0, const unsigned char *row1, int destWidth, int channels, unsigned char *out)
+  {
+#ifdef MIP_GENERATOR_SSE2
+    if (!simd || channels != 4)
+      return 0;
+    const __m128i zero = _mm_setzero_si128();
+    const __m128 scale = _mm_set1_ps(1.0f / 127.5f);
+    const __m128 four = _mm_set1_ps(4.0f);
+    const __m128 half = _mm_set1_ps(127.5f);
+    for (int x = 0; x < destWidth; x++)
+    {
+      // 4 个像素的 xyzw 按通道求和，再整体映射到 [-1, 1]：sum / 127.5 - 4
+      __m128i a = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)(row0 + x * 8)), zero);
+      __m128i b = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)(row1 + x * 8)), zero);
+      __m128i rows = _mm_add_epi16(a, b);
+      __m128i pair = _mm_add_epi16(rows, _mm_unpackhi_epi64(rows, rows));
+      __m128 sum = _mm_cvtepi32_ps(_mm_unpacklo_epi16(pair, zero));
+      __m128 n = _mm_sub_ps(_mm_mul_ps(sum, scale), four);
+
+      float v[4];
+      _mm_storeu_ps(v, n);
+      float lengthSquared = v[0] * v[0] + v[1] * v[1] + v[2] * v[2];
+      float inverse = lengthSquared > 1e-12f ? 1.0f / std::sqrt(lengthSquared) : 0.0f;
+      __m128 encoded = _mm_mul_ps(_mm_add_ps(_mm_mul_ps(n, _mm_set1_ps(inverse)), _mm_set1_ps(1.0f)), half);
+      _mm_storeu_ps(v, encoded);
+      unsigned char *pixel = out + x * 4;
+      for (int c = 0; c < 3; c++)
+        pixel[c] = (unsigned char)std::lround(std::min(std::max(v[c], 0.0f), 255.0f));
+      pixel[3] = (unsigned char)((_mm_extract_epi16(pair, 3) + 2) >> 2);
+    }
+    return destWidth;
+#else
+    (void)row0, (void)row1, (void)destWidth, (void)channels, (void)out;
+    return 0;
+#endif
+  }
+
+  // 二分查找透明度的缩放系数，使覆盖率接近第 0 级
+  static float alphaCoverageScale(const MipLevel &level, int channels, float cutoff, float target)
+  {
+    float low = 0.0f, high = 4.0f, best = 1.0f, bestError = 2.0f;
+    for (int i = 0; i < 12; i++)
+    {
+      float scale = (low + high) * 0.5f;
+      float current = coverage(level.data.data(), level.width, level.height, channels, cutoff, scale);
+      if (std::fabs(current - target) < bestError)
+      {
+        bestError = std::fabs(current - target);
+        best = scale;
+      }
+      if (current < target)
+        low = scale;
+      else
+        high = scale;
+    }
+    return best;
+  }
+
+  static void scaleAlpha(MipLevel &level, int channels, float scale)
+  {
+    size_t count = (size_t)level.width * level.height;
+    for (size_t i = 0; i < count; i++)
+    {
+      unsigned char &alpha = level.data[i * channels + channels - 1];
+      alpha = (unsigned char)std::min(255.0f, alpha * scale + 0.5f);
+    }
+  }
+};
+
+#endif
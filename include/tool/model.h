@@ -5,14 +5,32 @@
 #include <assimp/scene.h>
 #include <assimp/postprocess.h>
 
+#include <geometry/Frustum.h>
+#include <geometry/MeshOptimizer.h>
+#include <tool/mesh_cache.h>
+#include <tool/parallel.h>
+#include <tool/texture_cache.h>
+
 #include <string>
 #include <fstream>
 #include <sstream>
 #include <iostream>
 #include <map>
 #include <vector>
+#include <chrono>
+#include <functional>
+#include <mutex>
 using namespace std;
 unsigned int TextureFromFile(const char *path, const string &directory, bool gamma = false);
+
+// the CPU side of one mesh, built by Model::processMesh before it is uploaded
+struct MeshData
+{
+	vector<Vertex> vertices;
+	vector<unsigned int> indices;
+	vector<Texture> textures;
+};
+
 class Model
 {
 public:
@@ -21,34 +39,207 @@ public:
 	string directory;
 	bool gammaCorrection;
 
+	// true: let assimp compute tangents (aiProcess_CalcTangentSpace)
+	// false: skip that step and use generateTangents() after loading
+	inline static bool assimpTangents = true;
+
+	// vertex cache / overdraw / fetch statistics summed over all meshes, see MeshOptimizer::enabled
+	MeshOptimizeStats optimizeStats;
+	// union of the mesh bounds in model space
+	Bounds bounds;
+	// time spent in the constructor, and whether the meshes came from the MeshCache instead of assimp
+	double loadMs = 0.0;
+	bool fromCache = false;
+	// part of loadMs spent decoding (on Parallel::workerCount() threads) and uploading the material textures
+	double textureMs = 0.0;
+
+	// flip applied to material textures, part of the TextureCache key. false matches aiProcess_FlipUVs;
+	// 27_load_model sets it because its textures used to be loaded after stb's global flip was turned on
+	inline static bool flipTextures = false;
+
 	Model(string const &path, bool gamma = false) : gammaCorrection(gamma)
 	{
 		loadModel(path);
 	}
 
+	// the textures are shared through the TextureCache, each model holds one reference per entry of textures_loaded
+	~Model()
+	{
+		dispose();
+	}
+
+	// releases the textures and deletes the meshes; call it before glfwTerminate() when the model outlives the context
+	void dispose()
+	{
+		for (const Texture &texture : textures_loaded)
+			TextureCache::release(texture.id);
+		textures_loaded.clear();
+		meshes.clear();
+	}
+	Model(const Model &) = delete;
+	Model &operator=(const Model &) = delete;
+	// the moved-from model keeps no textures, so only the new one releases them
+	Model(Model &&other) noexcept
+		: textures_loaded(std::move(other.textures_loaded)), meshes(std::move(other.meshes)), directory(std::move(other.directory)),
+		  gammaCorrection(other.gammaCorrection), optimizeStats(other.optimizeStats), bounds(other.bounds),
+		  loadMs(other.loadMs), fromCache(other.fromCache), textureMs(other.textureMs)
+	{
+		other.textures_loaded.clear();
+	}
+
 	void Draw(Shader &shader)
 	{
 		for (unsigned int i = 0; i < meshes.size(); i++)
 			meshes[i].Draw(shader);
 	}
 
+	// skips the meshes whose bounds are outside the frustum; pass Frustum::fromMatrix(projection * view * model)
+	// so the planes are in model space. The counts and time go to FrustumCuller::stats
+	void Draw(Shader &shader, const Frustum &frustum)
+	{
+		auto start = chrono::steady_clock::now();
+		vector<unsigned int> visible;
+		for (unsigned int i = 0; i < meshes.size(); i++)
+			if (frustum.intersects(meshes[i].bounds))
+				visible.push_back(i);
+		FrustumCuller::record(meshes.size(), visible.size(), chrono::duration<double, milli>(chrono::steady_clock::now() - start).count());
+		for (unsigned int i : visible)
+			meshes[i].Draw(shader);
+	}
+
 private:
+	// ModelHandle imports on its own thread into a model that is created empty
+	friend class ModelHandle;
+	struct Deferred
+	{
+	};
+	Model(Deferred, bool gamma) : gammaCorrection(gamma)
+	{
+	}
+
+	// set by ModelHandle: receives each processed mesh on the loading thread instead of uploading it here
+	function<void(MeshData &&)> meshSink;
+
 	void loadModel(string const &path)
 	{
+		auto start = std::chrono::steady_clock::now();
+		if (importMeshes(path))
+			loadPendingTextures();
+		loadMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+	}
+
+	// builds the meshes from the MeshCache or through assimp and registers their textures, which are not loaded yet.
+	// Touches no GL state when meshSink is set
+	bool importMeshes(string const &path)
+	{
+		auto start = std::chrono::steady_clock::now();
+		// retrieve the directory path of the filepath
+		directory = path.substr(0, path.find_last_of('/'));
+		unsigned int flags = aiProcess_Triangulate | aiProcess_GenSmoothNormals | aiProcess_FlipUVs;
+		if (assimpTangents)
+			flags |= aiProcess_CalcTangentSpace;
+
+		// try the cooked binary first: it is invalidated when the source file or the import settings change
+		MeshCacheKey cacheKey;
+		string cachePath;
+		if (MeshCache::enabled)
+		{
+			cacheKey = MeshCache::key(path, flags);
+			cachePath = MeshCache::cachePath(path);
+			if (loadCache(cachePath, cacheKey))
+			{
+				fromCache = true;
+				lock_guard<mutex> guard(MeshCache::statsLock);
+				MeshCache::stats.hits++;
+				MeshCache::stats.loadMs += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+				return true;
+			}
+			if (std::filesystem::exists(cachePath))
+			{
+				lock_guard<mutex> guard(MeshCache::statsLock);
+				MeshCache::stats.rejected++;
+			}
+		}
+
 		// read file via ASSIMP
 		Assimp::Importer importer;
-		const aiScene *scene = importer.ReadFile(path, aiProcess_Triangulate | aiProcess_GenSmoothNormals | aiProcess_FlipUVs | aiProcess_CalcTangentSpace);
+		const aiScene *scene = importer.ReadFile(path, flags);
 		// check for errors
 		if (!scene || scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE || !scene->mRootNode) // if is Not Zero
 		{
 			cout << "ERROR::ASSIMP:: " << importer.GetErrorString() << endl;
-			return;
+			return false;
 		}
-		// retrieve the directory path of the filepath
-		directory = path.substr(0, path.find_last_of('/'));
 
-		// process ASSIMP's root node recursively
+		// process ASSIMP's root node recursively, collecting the processed meshes for the cache
+		MeshCacheWriter writer;
+		cacheWriter = MeshCache::enabled ? &writer : nullptr;
+		reserve(scene);
 		processNode(scene->mRootNode, scene);
+		cacheWriter = nullptr;
+		if (MeshCache::enabled)
+			writer.write(cachePath, cacheKey, optimizeStats);
+
+		lock_guard<mutex> guard(MeshCache::statsLock);
+		MeshCache::stats.misses++;
+		MeshCache::stats.importMs += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+		return true;
+	}
+
+	// upload every mesh straight from the mapped cache file, textures are still decoded from their image files.
+	// A meshSink gets copies instead, the mapping is closed before they are uploaded
+	bool loadCache(const string &cachePath, const MeshCacheKey &key)
+	{
+		MeshCacheReader cache;
+		if (!cache.open(cachePath, key))
+			return false;
+		const MeshCacheHeader &header = cache.header();
+		// with a meshSink the render thread owns meshes and may be iterating them
+		if (!meshSink)
+			meshes.reserve(header.meshCount);
+		for (unsigned int i = 0; i < header.meshCount; i++)
+		{
+			const MeshCacheRecord &record = cache.record(i);
+			vector<Texture> textures;
+			textures.reserve(record.textureCount);
+			for (unsigned int t = record.firstTexture; t < record.firstTexture + record.textureCount; t++)
+				textures.push_back(loadTexture(cache.texturePath(t), cache.textureType(t)));
+			if (meshSink)
+			{
+				MeshData data;
+				data.vertices.assign(cache.vertices(record), cache.vertices(record) + record.vertexCount);
+				data.indices.assign(cache.indices(record), cache.indices(record) + record.indexCount);
+				data.textures = std::move(textures);
+				meshSink(std::move(data));
+			}
+			else
+				meshes.emplace_back(cache.vertices(record), record.vertexCount, cache.indices(record), record.indexCount, std::move(textures), record.bounds);
+		}
+		// with a meshSink the render thread grows bounds as it uploads the meshes; optimizeStats is only read after the loading thread is joined
+		if (!meshSink)
+			bounds = header.bounds;
+		optimizeStats = header.optimizeStats;
+		return true;
+	}
+
+	// size meshes, textures_loaded and the cache writer from the scene totals before processNode fills them
+	void reserve(const aiScene *scene)
+	{
+		size_t vertexCount = 0, indexCount = 0;
+		for (unsigned int i = 0; i < scene->mNumMeshes; i++)
+		{
+			vertexCount += scene->mMeshes[i]->mNumVertices;
+			indexCount += (size_t)scene->mMeshes[i]->mNumFaces * 3; // triangulated
+		}
+		if (!meshSink)
+			meshes.reserve(scene->mNumMeshes);
+		size_t textureCount = 0;
+		for (unsigned int i = 0; i < scene->mNumMaterials; i++)
+			for (aiTextureType type : {aiTextureType_DIFFUSE, aiTextureType_SPECULAR, aiTextureType_HEIGHT, aiTextureType_AMBIENT})
+				textureCount += scene->mMaterials[i]->GetTextureCount(type);
+		textures_loaded.reserve(textureCount);
+		if (cacheWriter)
+			cacheWriter->reserve(scene->mNumMeshes, vertexCount, indexCount);
 	}
 
 	// processes a node in a recursive fashion. Processes each individual mesh located at the node and repeats this process on its children nodes (if any).
@@ -60,7 +251,7 @@ private:
 			// the node object only contains indices to index the actual objects in the scene.
 			// the scene contains all the data, node is just to keep stuff organized (like relations between nodes).
 			aiMesh *mesh = scene->mMeshes[node->mMeshes[i]];
-			meshes.push_back(processMesh(mesh, scene));
+			addMesh(processMesh(mesh, scene));
 		}
 		// after we've processed all of the meshes (if any) we then recursively process each of the children nodes
 		for (unsigned int i = 0; i < node->mNumChildren; i++)
@@ -68,12 +259,27 @@ private:
 			processNode(node->mChildren[i], scene);
 		}
 	}
-	Mesh processMesh(aiMesh *mesh, const aiScene *scene)
+	void addMesh(MeshData &&data)
+	{
+		if (meshSink)
+		{
+			meshSink(std::move(data));
+			return;
+		}
+		meshes.emplace_back(std::move(data.vertices), std::move(data.indices), std::move(data.textures));
+		bounds.expand(meshes.back().bounds);
+	}
+
+	MeshData processMesh(aiMesh *mesh, const aiScene *scene)
 	{
 		// data to fill
-		vector<Vertex> vertices;
-		vector<unsigned int> indices;
-		vector<Texture> textures;
+		MeshData data;
+		vector<Vertex> &vertices = data.vertices;
+		vector<unsigned int> &indices = data.indices;
+		vector<Texture> &textures = data.textures;
+		// sized up front from the assimp counts, the loops below never reallocate
+		vertices.reserve(mesh->mNumVertices);
+		indices.reserve((size_t)mesh->mNumFaces * 3);
 
 		// walk through each of the mesh's vertices
 		for (unsigned int i = 0; i < mesh->mNumVertices; i++)
@@ -102,16 +308,19 @@ private:
 				vec.x = mesh->mTextureCoords[0][i].x;
 				vec.y = mesh->mTextureCoords[0][i].y;
 				vertex.TexCoords = vec;
-				// tangent
-				vector.x = mesh->mTangents[i].x;
-				vector.y = mesh->mTangents[i].y;
-				vector.z = mesh->mTangents[i].z;
-				vertex.Tangent = vector;
-				// bitangent
-				vector.x = mesh->mBitangents[i].x;
-				vector.y = mesh->mBitangents[i].y;
-				vector.z = mesh->mBitangents[i].z;
-				vertex.Bitangent = vector;
+				// tangent, only present when assimp computed them (see assimpTangents)
+				if (mesh->HasTangentsAndBitangents())
+				{
+					vector.x = mesh->mTangents[i].x;
+					vector.y = mesh->mTangents[i].y;
+					vector.z = mesh->mTangents[i].z;
+					vertex.Tangent = vector;
+					// bitangent
+					vector.x = mesh->mBitangents[i].x;
+					vector.y = mesh->mBitangents[i].y;
+					vector.z = mesh->mBitangents[i].z;
+					vertex.Bitangent = vector;
+				}
 			}
 			else
 				vertex.TexCoords = glm::vec2(0.0f, 0.0f);
@@ -121,11 +330,17 @@ private:
 		// now wak through each of the mesh's faces (a face is a mesh its triangle) and retrieve the corresponding vertex indices.
 		for (unsigned int i = 0; i < mesh->mNumFaces; i++)
 		{
-			aiFace face = mesh->mFaces[i];
+			const aiFace &face = mesh->mFaces[i];
 			// retrieve all indices of the face and store them in the indices vector
 			for (unsigned int j = 0; j < face.mNumIndices; j++)
 				indices.push_back(face.mIndices[j]);
 		}
+		// weld duplicated vertices and reorder for the post-transform cache before uploading
+		if (MeshOptimizer::enabled && mesh->mPrimitiveTypes == aiPrimitiveType_TRIANGLE)
+			optimizeStats.add(MeshOptimizer::optimize(vertices, indices));
+		// tangents not computed by assimp: generate them ourselves, in parallel over the triangles
+		if (!mesh->HasTangentsAndBitangents() && mesh->mTextureCoords[0])
+			generateTangents(vertices, indices);
 		// process materials
 		aiMaterial *material = scene->mMaterials[mesh->mMaterialIndex];
 		// we assume a convention for sampler names in the shaders. Each diffuse texture should be named
@@ -136,92 +351,120 @@ private:
 		// normal: texture_normalN
 
 		// 1. diffuse maps
-		vector<Texture> diffuseMaps = loadMaterialTextures(material, aiTextureType_DIFFUSE, "texture_diffuse");
-		textures.insert(textures.end(), diffuseMaps.begin(), diffuseMaps.end());
+		loadMaterialTextures(textures, material, aiTextureType_DIFFUSE, "texture_diffuse");
 		// 2. specular maps
-		vector<Texture> specularMaps = loadMaterialTextures(material, aiTextureType_SPECULAR, "texture_specular");
-		textures.insert(textures.end(), specularMaps.begin(), specularMaps.end());
+		loadMaterialTextures(textures, material, aiTextureType_SPECULAR, "texture_specular");
 		// 3. normal maps
-		std::vector<Texture> normalMaps = loadMaterialTextures(material, aiTextureType_HEIGHT, "texture_normal");
-		textures.insert(textures.end(), normalMaps.begin(), normalMaps.end());
+		loadMaterialTextures(textures, material, aiTextureType_HEIGHT, "texture_normal");
 		// 4. height maps
-		std::vector<Texture> heightMaps = loadMaterialTextures(material, aiTextureType_AMBIENT, "texture_height");
-		textures.insert(textures.end(), heightMaps.begin(), heightMaps.end());
+		loadMaterialTextures(textures, material, aiTextureType_AMBIENT, "texture_height");
 
-		// return a mesh object created from the extracted mesh data
-		return Mesh(vertices, indices, textures);
+		// the cache stores exactly what is uploaded
+		if (cacheWriter)
+			cacheWriter->addMesh(vertices, indices, textures);
+
+		// return the extracted mesh data, addMesh creates the mesh object
+		return data;
 	}
 
-	vector<Texture> loadMaterialTextures(aiMaterial *mat, aiTextureType type, string typeName)
+	// appends the material's textures of the given type to textures
+	void loadMaterialTextures(vector<Texture> &textures, aiMaterial *mat, aiTextureType type, const char *typeName)
 	{
-		vector<Texture> textures;
 		for (unsigned int i = 0; i < mat->GetTextureCount(type); i++)
 		{
 			aiString str;
 			mat->GetTexture(type, i, &str);
-			// check if texture was loaded before and if so, continue to next iteration: skip loading a new texture
-			bool skip = false;
-			for (unsigned int j = 0; j < textures_loaded.size(); j++)
-			{
-				if (std::strcmp(textures_loaded[j].path.data(), str.C_Str()) == 0)
-				{
-					textures.push_back(textures_loaded[j]);
-					skip = true; // a texture with the same filepath has already been loaded, continue to next one. (optimization)
-					break;
-				}
-			}
-			if (!skip)
-			{ // if texture hasn't been loaded already, load it
-				Texture texture;
-				texture.id = TextureFromFile(str.C_Str(), this->directory);
-				texture.type = typeName;
-				texture.path = str.C_Str();
-				textures.push_back(texture);
-				textures_loaded.push_back(texture); // store it as texture loaded for entire model, to ensure we won't unnecesery load duplicate textures.
-			}
+			textures.push_back(loadTexture(str.C_Str(), typeName));
 		}
-		return textures;
 	}
-};
 
-unsigned int TextureFromFile(const char *path, const string &directory, bool gamma)
-{
-	string filename = string(path);
-	filename = directory + '/' + filename;
+	// registers the texture; the image is decoded later by loadPendingTextures, until then its id is 0
+	Texture loadTexture(const string &path, const string &typeName)
+	{
+		// interned: equal paths are the same pointer
+		const string *internedPath = InternString(path);
+		// check if texture was registered before and if so, reuse it: skip loading a new texture
+		for (unsigned int j = 0; j < textures_loaded.size(); j++)
+		{
+			if (textures_loaded[j].path == internedPath)
+				return textures_loaded[j]; // a texture with the same filepath has already been loaded (optimization)
+		}
+		Texture texture;
+		texture.id = 0;
+		texture.type = InternString(typeName);
+		texture.path = internedPath;
+		textures_loaded.push_back(texture); // store it as texture loaded for entire model, to ensure we won't unnecesery load duplicate textures.
+		return texture;
+	}
 
-	unsigned int textureID;
-	glGenTextures(1, &textureID);
+	// gamma only applies to colour textures, normal, specular and height maps stay linear
+	TextureParams textureParams(const string &type) const
+	{
+		TextureParams params;
+		params.flip = flipTextures;
+		params.srgb = gammaCorrection && type == "texture_diffuse";
+		return params;
+	}
 
-	int width, height, nrComponents;
-	unsigned char *data = stbi_load(filename.c_str(), &width, &height, &nrComponents, 0);
-	if (data)
+	// decode the registered textures missing from the TextureCache on worker threads, then upload them here on the context thread
+	void loadPendingTextures()
 	{
-		GLenum format;
-		if (nrComponents == 1)
-			format = GL_RED;
-		else if (nrComponents == 3)
-			format = GL_RGB;
-		else if (nrComponents == 4)
-			format = GL_RGBA;
+		auto start = std::chrono::steady_clock::now();
+		vector<size_t> pending;
+		for (size_t i = 0; i < textures_loaded.size(); i++)
+			if (textures_loaded[i].id == 0)
+				pending.push_back(i);
+		if (pending.empty())
+			return;
 
-		glBindTexture(GL_TEXTURE_2D, textureID);
-		glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, data);
-		glGenerateMipmap(GL_TEXTURE_2D);
+		// textures already used by another model (or sample) are only referenced again
+		vector<TextureParams> params(pending.size());
+		vector<string> keys(pending.size());
+		vector<size_t> misses;
+		for (size_t i = 0; i < pending.size(); i++)
+		{
+			Texture &texture = textures_loaded[pending[i]];
+			params[i] = textureParams(*texture.type);
+			keys[i] = TextureCache::key(directory + '/' + *texture.path, params[i]);
+			texture.id = TextureCache::acquire(keys[i]);
+			if (texture.id == 0)
+				misses.push_back(i);
+		}
 
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+		vector<TextureImage> images(misses.size());
+		auto decode = [&](size_t i)
+		{
+			images[i] = TextureCache::decode(directory + '/' + *textures_loaded[pending[misses[i]]].path, params[misses[i]]);
+		};
+		Parallel::forEach(misses.size(), decode);
+		for (size_t i = 0; i < misses.size(); i++)
+			textures_loaded[pending[misses[i]]].id = TextureCache::insert(keys[misses[i]], params[misses[i]], images[i]);
 
-		stbi_image_free(data);
-	}
-	else
-	{
-		std::cout << "Texture failed to load at path: " << path << std::endl;
-		stbi_image_free(data);
+		map<const string *, unsigned int> ids;
+		for (size_t i = 0; i < pending.size(); i++)
+		{
+			const Texture &texture = textures_loaded[pending[i]];
+			ids[texture.path] = texture.id;
+		}
+		// the meshes copied their textures before the ids were known
+		for (Mesh &mesh : meshes)
+			for (Texture &texture : mesh.textures)
+				if (texture.id == 0)
+					texture.id = ids[texture.path];
+		textureMs += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
 	}
 
-	return textureID;
+	// set while loadModel imports through assimp with the MeshCache enabled
+	MeshCacheWriter *cacheWriter = nullptr;
+};
+
+// loads through the TextureCache; the caller owns one reference, see TextureCache::release
+unsigned int TextureFromFile(const char *path, const string &directory, bool gamma)
+{
+	TextureParams params;
+	params.flip = Model::flipTextures;
+	params.srgb = gamma;
+	return TextureCache::load(directory + '/' + string(path), params);
 }
 
 #endif
\ No newline at end of file
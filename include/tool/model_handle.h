@@ -0,0 +1,282 @@
+#ifndef MODEL_HANDLE_H
+#define MODEL_HANDLE_H
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+
+#include <tool/model.h>
+#include <tool/texture_cache.h>
+
+// 在后台线程上加载的模型
+//
+// 加载线程依次完成 MeshCache / assimp 导入、网格优化、切线生成和贴图解码，
+// 每个网格处理完就放进队列；渲染线程每帧调用 update()，在时间预算内把已经就绪的网格和贴图上传，
+// 所以加载期间渲染循环和 ImGui 不会停顿。Draw() 只画已经上传的网格，贴图上传之前绑定的是 0
+//
+// 构造时记录 GeometryHandle::defaultLayout 和 keepCpuData，之后上传的网格都使用这两个设置
+// 加载线程持有 this，不能复制也不能移动
+class ModelHandle
+{
+public:
+  explicit ModelHandle(const std::string &path, bool gamma = false)
+      : loaded(Model::Deferred(), gamma), layout(GeometryHandle::defaultLayout), keepCpuData(GeometryHandle::keepCpuData),
+        start(std::chrono::steady_clock::now())
+  {
+    loaded.meshSink = [this](MeshData &&data)
+    {
+      Bounds meshBounds = Bounds::of(data.vertices.data(), data.vertices.size());
+      std::lock_guard<std::mutex> guard(lock);
+      if (cancelled)
+        return;
+      parsedBounds.expand(meshBounds);
+      meshQueue.push_back(std::move(data));
+      meshesParsed++;
+    };
+    worker = std::thread([this, path]()
+                         { load(path); });
+  }
+
+  ~ModelHandle()
+  {
+    dispose();
+  }
+
+  // 等待加载线程结束（assimp 的导入无法中途取消），释放还没上传的图片以及已经上传的网格和贴图。
+  // 可以重复调用，生命周期覆盖到 glfwTerminate() 之后时需要在它之前调用
+  void dispose()
+  {
+    cancelled = true;
+    if (worker.joinable())
+      worker.join();
+    for (DecodedTexture &texture : textureQueue)
+      stbi_image_free(texture.image.data);
+    textureQueue.clear();
+    meshQueue.clear();
+    loaded.dispose();
+    finished = true;
+  }
+
+  ModelHandle(const ModelHandle &) = delete;
+  ModelHandle &operator=(const ModelHandle &) = delete;
+
+  // 每帧在持有 GL 上下文的线程上调用。至少上传一项，超出 budgetMs 后留到下一帧
+  void update(double budgetMs = 2.0)
+  {
+    if (finished)
+      return;
+    auto frameStart = std::chrono::steady_clock::now();
+    auto overBudget = [&]()
+    {
+      return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - frameStart).count() > budgetMs;
+    };
+
+    VertexLayout previousLayout = GeometryHandle::defaultLayout;
+    bool previousKeepCpuData = GeometryHandle::keepCpuData;
+    GeometryHandle::defaultLayout = layout;
+    GeometryHandle::keepCpuData = keepCpuData;
+    MeshData data;
+    while (popMesh(data))
+    {
+      loaded.meshes.emplace_back(std::move(data.vertices), std::move(data.indices), std::move(data.textures));
+      Mesh &mesh = loaded.meshes.back();
+      loaded.bounds.expand(mesh.bounds);
+      // 贴图可能先于网格上传
+      for (Texture &texture : mesh.textures)
+        if (texture.id == 0 && textureIds.count(texture.path))
+          texture.id = textureIds[texture.path];
+      meshesUploaded++;
+      if (overBudget())
+        break;
+    }
+    GeometryHandle::defaultLayout = previousLayout;
+    GeometryHandle::keepCpuData = previousKeepCpuData;
+
+    DecodedTexture decoded;
+    while (!overBudget() && popTexture(decoded))
+    {
+      // 解码期间其他模型或示例可能已经加载了同一张贴图
+      unsigned int id = TextureCache::acquire(decoded.key);
+      if (id != 0)
+        stbi_image_free(decoded.image.data);
+      else
+        id = TextureCache::insert(decoded.key, decoded.params, decoded.image);
+      Texture &registered = loaded.textures_loaded[decoded.index];
+      registered.id = id;
+      textureIds[registered.path] = id;
+      for (Mesh &mesh : loaded.meshes)
+        for (Texture &texture : mesh.textures)
+          if (texture.path == registered.path)
+            texture.id = id;
+      texturesUploaded++;
+    }
+
+    std::lock_guard<std::mutex> guard(lock);
+    if (workerDone && meshQueue.empty() && textureQueue.empty())
+    {
+      worker.join();
+      finished = true;
+      loaded.loadMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+  }
+
+  // 全部网格和贴图都已上传（导入失败时也为 true，见 failed()）
+  bool ready() const
+  {
+    return finished;
+  }
+
+  bool failed() const
+  {
+    return finished && importFailed;
+  }
+
+  // 0 ~ 1，导入完成之前不知道总量，返回 0
+  float progress() const
+  {
+    if (finished)
+      return 1.0f;
+    std::lock_guard<std::mutex> guard(lock);
+    if (!imported || meshesParsed + texturesTotal == 0)
+      return 0.0f;
+    return (float)(meshesUploaded + texturesUploaded) / (float)(meshesParsed + texturesTotal);
+  }
+
+  const char *status() const
+  {
+    if (finished)
+      return importFailed ? "failed" : "ready";
+    std::lock_guard<std::mutex> guard(lock);
+    return imported ? "uploading" : "importing";
+  }
+
+  // 已经导入的网格的包围盒，网格上传之前就可以用来画占位
+  Bounds bounds() const
+  {
+    std::lock_guard<std::mutex> guard(lock);
+    return parsedBounds;
+  }
+
+  // 把 1x1x1 的盒子变换到包围盒上的矩阵，还没有包围盒或已经加载完成时返回 false
+  bool placeholder(const glm::mat4 &modelMatrix, glm::mat4 &boxMatrix) const
+  {
+    Bounds box = bounds();
+    if (finished || box.empty())
+      return false;
+    boxMatrix = glm::translate(modelMatrix, box.center());
+    boxMatrix = glm::scale(boxMatrix, glm::max(box.extents() * 2.0f, glm::vec3(1e-4f)));
+    return true;
+  }
+
+  void Draw(Shader &shader)
+  {
+    loaded.Draw(shader);
+  }
+
+  void Draw(Shader &shader, const Frustum &frustum)
+  {
+    loaded.Draw(shader, frustum);
+  }
+
+  // 加载完成之前只包含已经上传的网格，textures_loaded 中的贴图 id 可能还是 0
+  Model &model()
+  {
+    return loaded;
+  }
+
+private:
+  struct DecodedTexture
+  {
+    size_t index = 0; // textures_loaded 中的下标
+    std::string key;  // TextureCache 的键
+    TextureParams params;
+    TextureImage image;
+  };
+
+  Model loaded;
+  VertexLayout layout;
+  bool keepCpuData;
+  std::chrono::steady_clock::time_point start;
+  std::thread worker;
+
+  // 以下成员由 lock 保护
+  mutable std::mutex lock;
+  std::deque<MeshData> meshQueue;
+  std::deque<DecodedTexture> textureQueue;
+  Bounds parsedBounds;
+  size_t meshesParsed = 0;
+  size_t texturesTotal = 0;
+  bool imported = false;
+  bool importFailed = false;
+  bool workerDone = false;
+
+  // 只在渲染线程上访问
+  size_t meshesUploaded = 0;
+  size_t texturesUploaded = 0;
+  std::unordered_map<const std::string *, unsigned int> textureIds;
+  bool finished = false;
+
+  std::atomic<bool> cancelled{false};
+
+  // 加载线程
+  void load(const std::string &path)
+  {
+    bool ok = loaded.importMeshes(path);
+    size_t textureCount = ok ? loaded.textures_loaded.size() : 0;
+    {
+      std::lock_guard<std::mutex> guard(lock);
+      imported = true;
+      importFailed = !ok;
+      texturesTotal = textureCount;
+    }
+
+    // 导入结束后 textures_loaded 不再增长，渲染线程只修改其中的 id
+    auto decode = [&](size_t i)
+    {
+      if (cancelled)
+        return;
+      DecodedTexture decoded;
+      decoded.index = i;
+      const Texture &texture = loaded.textures_loaded[i];
+      string path = loaded.directory + '/' + *texture.path;
+      decoded.params = loaded.textureParams(*texture.type);
+      decoded.key = TextureCache::key(path, decoded.params);
+      decoded.image = TextureCache::decode(path, decoded.params);
+      std::lock_guard<std::mutex> guard(lock);
+      textureQueue.push_back(std::move(decoded));
+    };
+    Parallel::forEach(textureCount, decode);
+
+    std::lock_guard<std::mutex> guard(lock);
+    workerDone = true;
+  }
+
+  bool popMesh(MeshData &data)
+  {
+    std::lock_guard<std::mutex> guard(lock);
+    if (meshQueue.empty())
+      return false;
+    data = std::move(meshQueue.front());
+    meshQueue.pop_front();
+    return true;
+  }
+
+  bool popTexture(DecodedTexture &decoded)
+  {
+    std::lock_guard<std::mutex> guard(lock);
+    if (textureQueue.empty())
+      return false;
+    decoded = std::move(textureQueue.front());
+    textureQueue.pop_front();
+    return true;
+  }
+};
+
+#endif
@@ -0,0 +1,420 @@
+#ifndef OCCLUSION_CULLER_H
+#define OCCLUSION_CULLER_H
+
+#include <glm/glm.hpp>
+#include <glm/gtc/constants.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+#include <geometry/Bounds.h>
+#include <geometry/Frustum.h>
+
+struct OcclusionStats
+{
+  size_t occluders = 0;
+  size_t triangles = 0; // 光栅化的三角形，近平面裁剪之后计
+  size_t tested = 0;
+  size_t occluded = 0;
+  double rasterizeMs = 0.0;
+  double testMs = 0.0; // 多个线程同时测试时是各线程耗时之和
+};
+
+// CPU 上的软件遮挡剔除
+//
+// 每帧 beginFrame() 之后把选定的遮挡体（路沿的盒子、行星的代理球）以低分辨率光栅化成只有深度的缓冲，
+// 提交绘制之前用 visible() 测试被遮挡物的包围盒：包围盒最近的深度比覆盖到的每个像素的遮挡深度都远，就不用画。
+//
+// 深度缓冲按 8x8 像素分块存放，每块还记录块内最远的深度（一级层次）。
+// 光栅化一次处理一行 8 个像素，用三条边函数的符号得到覆盖掩码；三角形最近的深度不比块的最远深度近时整块跳过。
+// 覆盖是保守的：只写入整个像素都在三角形内的像素，写入的深度是像素内最远的。代价是网格内部的每条边两侧
+// 都会留下不写入的像素，遮挡体越细碎、缓冲越小，剔除掉的越少，但不会剔除掉能看到一部分的物体。
+// 测试先比较块的最远深度，整块被遮挡就不再逐像素比较。
+// 编译时打开 AVX 一次处理 8 个像素，x86 上默认 SSE2 一次 4 个，与 FrustumCuller 使用同样的 Mode，三种实现的结果相同。
+//
+// 遮挡体必须在真实物体的内部（例如球用内接的多面体），否则会把露出来的物体剔掉。
+// 深度是 NDC 深度映射到 [0, 1]，越小越近
+class OcclusionCuller
+{
+public:
+  static const int TILE = 8;
+
+  FrustumCuller::Mode mode = FrustumCuller::Mode::Best;
+  OcclusionStats stats;     // 当前帧
+  OcclusionStats lastFrame; // 上一帧
+
+  // 分辨率向上取整到 8 的倍数；宽高比不必与窗口相同，光栅化和测试使用同一个映射
+  OcclusionCuller(int width = 256, int height = 128)
+  {
+    resize(width, height);
+  }
+
+  void resize(int width, int height)
+  {
+    tilesX = std::max(1, (width + TILE - 1) / TILE);
+    tilesY = std::max(1, (height + TILE - 1) / TILE);
+    this->width = tilesX * TILE;
+    this->height = tilesY * TILE;
+    depth.assign((size_t)this->width * this->height, 1.0f);
+    tileMax.assign((size_t)tilesX * tilesY, 1.0f);
+  }
+
+  int bufferWidth() const
+  {
+    return width;
+  }
+
+  int bufferHeight() const
+  {
+    return height;
+  }
+
+  // 每帧开始时调用：清空深度，设置这一帧的观察投影矩阵
+  void beginFrame(const glm::mat4 &viewProj)
+  {
+    lastFrame = stats;
+    stats = OcclusionStats();
+    this->viewProj = viewProj;
+    for (int i = 0; i < 12; i++)
+      absColumns[i] = std::fabs((&viewProj[0][0])[i]);
+    std::fill(depth.begin(), depth.end(), 1.0f);
+    std::fill(tileMax.begin(), tileMax.end(), 1.0f);
+  }
+
+  // 光栅化一个三角形网格遮挡体，positions 为模型空间的坐标
+  void addOccluder(const glm::vec3 *positions, size_t vertexCount, const uint32_t *indices, size_t indexCount, const glm::mat4 &model)
+  {
+    auto start = std::chrono::steady_clock::now();
+    glm::mat4 matrix = viewProj * model;
+    clip.resize(vertexCount);
+    for (size_t i = 0; i < vertexCount; i++)
+      clip[i] = matrix * glm::vec4(positions[i], 1.0f);
+    for (size_t i = 0; i + 2 < indexCount; i += 3)
+      rasterizeClipped(clip[indices[i]], clip[indices[i + 1]], clip[indices[i + 2]]);
+    stats.occluders++;
+    stats.rasterizeMs += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+  }
+
+  // 模型空间的盒子，例如 BoxGeometry 的 [-0.5, 0.5]^3
+  void addBox(const glm::mat4 &model, const Bounds &box)
+  {
+    glm::vec3 corners[8];
+    for (int i = 0; i < 8; i++)
+      corners[i] = glm::vec3(i & 1 ? box.max.x : box.min.x, i & 2 ? box.max.y : box.min.y, i & 4 ? box.max.z : box.min.z);
+    static const uint32_t faces[36] = {0, 2, 1, 1, 2, 3, 4, 5, 6, 5, 7, 6, 0, 1, 4, 1, 5, 4,
+                                       2, 6, 3, 3, 6, 7, 0, 4, 2, 2, 4, 6, 1, 3, 5, 3, 7, 5};
+    addOccluder(corners, 8, faces, 36, model);
+  }
+
+  // 球的内接多面体，顶点都在球面上，整个多面体在球内
+  void addSphere(const glm::mat4 &model, const glm::vec3 &center, float radius)
+  {
+    static std::vector<glm::vec3> positions;
+    static std::vector<uint32_t> indices;
+    if (positions.empty())
+      buildSphere(positions, indices);
+    glm::mat4 placed = glm::scale(glm::translate(model, center), glm::vec3(radius));
+    addOccluder(positions.data(), positions.size(), indices.data(), indices.size(), placed);
+  }
+
+  // 世界空间的包围盒是否可能可见，计入统计。只能在一个线程上调用
+  bool visible(const Bounds &bounds)
+  {
+    auto start = std::chrono::steady_clock::now();
+    bool result = !occluded(bounds);
+    record(1, result ? 0 : 1, std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+    return result;
+  }
+
+  // 不计入统计，可以在多个线程上同时调用（光栅化完成之后）。
+  // 跨过近平面或者完全在屏幕外时返回 false，视锥剔除由调用方负责
+  bool occluded(const Bounds &bounds) const
+  {
+    if (bounds.empty())
+      return false;
+    // 区间运算：裁剪空间的中心加减范围包含了八个角，再除以 w 的上下限得到保守的屏幕矩形和最近的深度，
+    // 比逐个投影八个角少很多运算。逐个分量展开、不构造 glm 临时对象，示例按 -g 不优化编译时也足够快
+    const float *m = &viewProj[0][0], *a = absColumns;
+    float cx = (bounds.min.x + bounds.max.x) * 0.5f, cy = (bounds.min.y + bounds.max.y) * 0.5f, cz = (bounds.min.z + bounds.max.z) * 0.5f;
+    float ex = (bounds.max.x - bounds.min.x) * 0.5f, ey = (bounds.max.y - bounds.min.y) * 0.5f, ez = (bounds.max.z - bounds.min.z) * 0.5f;
+    float clip[4], range[4];
+    for (int i = 0; i < 4; i++)
+    {
+      clip[i] = m[i] * cx + m[4 + i] * cy + m[8 + i] * cz + m[12 + i];
+      range[i] = a[i] * ex + a[4 + i] * ey + a[8 + i] * ez;
+    }
+    // 任何一个角在近平面前面（z < -w）时不测试
+    if (clip[2] + clip[3] - range[2] - range[3] < 0.0f)
+      return false;
+    float nearW = clip[3] - range[3], farW = clip[3] + range[3];
+    if (nearW <= 0.0f)
+      return false;
+    float lowX = clip[0] - range[0], highX = clip[0] + range[0];
+    float lowY = clip[1] - range[1], highY = clip[1] + range[1];
+    float left = (std::min(lowX / nearW, lowX / farW) * 0.5f + 0.5f) * width;
+    float right = (std::max(highX / nearW, highX / farW) * 0.5f + 0.5f) * width;
+    float bottom = (std::min(lowY / nearW, lowY / farW) * 0.5f + 0.5f) * height;
+    float top = (std::max(highY / nearW, highY / farW) * 0.5f + 0.5f) * height;
+    // 透视和正交投影的裁剪 z 是 w 的线性函数（z = a * w + b，a > 0），w 最小的角 z 也最小，
+    // 最近的深度正好是 (z - range) / nearW，不需要与 farW 组合
+    float nearest = (clip[2] - range[2]) / nearW * 0.5f + 0.5f;
+    // 包围盒覆盖的像素（保守地包含边缘上的像素）
+    // （先在浮点上截到缓冲范围，w 接近 0 时坐标可能超出 int）
+    int x0 = (int)std::max(0.0f, std::floor(left)), x1 = (int)std::min((float)(width - 1), std::floor(right));
+    int y0 = (int)std::max(0.0f, std::floor(bottom)), y1 = (int)std::min((float)(height - 1), std::floor(top));
+    if (x0 > x1 || y0 > y1)
+      return false;
+
+    FrustumCuller::Mode resolved = resolve(mode);
+    const float *farthest = tileMax.data();
+    for (int ty = y0 / TILE; ty <= y1 / TILE; ty++)
+      for (int tx = x0 / TILE; tx <= x1 / TILE; tx++)
+      {
+        int tile = ty * tilesX + tx;
+        if (nearest > farthest[tile])
+          continue;
+        // 块内与包围盒重叠的列和行
+        int columnBegin = std::max(x0 - tx * TILE, 0), columnEnd = std::min(x1 - tx * TILE, TILE - 1);
+        int rowBegin = std::max(y0 - ty * TILE, 0), rowEnd = std::min(y1 - ty * TILE, TILE - 1);
+        const float *block = depth.data() + (size_t)tile * TILE * TILE;
+        for (int row = rowBegin; row <= rowEnd; row++)
+          if (rowVisible(block + row * TILE, columnBegin, columnEnd, nearest, resolved))
+            return false;
+      }
+    return true;
+  }
+
+  // 多线程测试的调用方（例如 InstanceCuller）在测试结束后计入统计
+  void record(size_t tested, size_t occluded, double ms)
+  {
+    stats.tested += tested;
+    stats.occluded += occluded;
+    stats.testMs += ms;
+  }
+
+  // 深度缓冲的一个像素，调试用
+  float depthAt(int x, int y) const
+  {
+    int tile = (y / TILE) * tilesX + x / TILE;
+    return depth[(size_t)tile * TILE * TILE + (y % TILE) * TILE + x % TILE];
+  }
+
+private:
+  int width = 0, height = 0, tilesX = 0, tilesY = 0;
+  std::vector<float> depth;   // 按块存放，块内按行，每行 8 个像素
+  std::vector<float> tileMax; // 每块的最远深度
+  glm::mat4 viewProj = glm::mat4(1.0f);
+  float absColumns[12]; // viewProj 前三列的绝对值，把包围盒的半边长变换到裁剪空间
+  std::vector<glm::vec4> clip;
+
+  static FrustumCuller::Mode resolve(FrustumCuller::Mode mode)
+  {
+#ifndef FRUSTUM_AVX
+    if (mode == FrustumCuller::Mode::Avx || mode == FrustumCuller::Mode::Best)
+      mode = FrustumCuller::Mode::Sse;
+#else
+    if (mode == FrustumCuller::Mode::Best)
+      mode = FrustumCuller::Mode::Avx;
+#endif
+#ifndef FRUSTUM_SSE2
+    mode = FrustumCuller::Mode::Scalar;
+#endif
+    return mode;
+  }
+
+  // 裁剪空间到缓冲的像素坐标，z 为 [0, 1] 的深度
+  glm::vec3 toScreen(const glm::vec4 &position) const
+  {
+    glm::vec3 ndc = glm::vec3(position) / position.w;
+    return glm::vec3((ndc.x * 0.5f + 0.5f) * width, (ndc.y * 0.5f + 0.5f) * height, ndc.z * 0.5f + 0.5f);
+  }
+
+  // 只裁剪近平面（z >= -w），其余方向由包围矩形限制在缓冲内
+  void rasterizeClipped(const glm::vec4 &a, const glm::vec4 &b, const glm::vec4 &c)
+  {
+    const glm::vec4 *input[3] = {&a, &b, &c};
+    glm::vec4 polygon[4];
+    int count = 0;
+    for (int i = 0; i < 3; i++)
+    {
+      const glm::vec4 &current = *input[i], &next = *input[(i + 1) % 3];
+      float currentDistance = current.z + current.w, nextDistance = next.z + next.w;
+      if (currentDistance >= 0.0f)
+        polygon[count++] = current;
+      if ((currentDistance >= 0.0f) != (nextDistance >= 0.0f))
+        polygon[count++] = current + (next - current) * (currentDistance / (currentDistance - nextDistance));
+    }
+    for (int i = 1; i + 1 < count; i++)
+      rasterize(toScreen(polygon[0]), toScreen(polygon[i]), toScreen(polygon[i + 1]));
+  }
+
+  void rasterize(glm::vec3 v0, glm::vec3 v1, glm::vec3 v2)
+  {
+    float area = (v1.x - v0.x) * (v2.y - v0.y) - (v1.y - v0.y) * (v2.x - v0.x);
+    if (std::fabs(area) < 1e-8f)
+      return;
+    // 两面都光栅化，统一成逆时针
+    if (area < 0.0f)
+    {
+      std::swap(v1, v2);
+      area = -area;
+    }
+    int x0 = (int)std::max(0.0f, std::floor(std::min({v0.x, v1.x, v2.x})));
+    int x1 = (int)std::min((float)(width - 1), std::floor(std::max({v0.x, v1.x, v2.x})));
+    int y0 = (int)std::max(0.0f, std::floor(std::min({v0.y, v1.y, v2.y})));
+    int y1 = (int)std::min((float)(height - 1), std::floor(std::max({v0.y, v1.y, v2.y})));
+    if (x0 > x1 || y0 > y1)
+      return;
+    stats.triangles++;
+
+    // 边函数 e = A * x + B * y + C，在像素中心求值。每条边向内收缩半个像素（C 减去 (|A| + |B|) / 2），
+    // 三条边都 >= 0 时整个像素都在三角形内；只覆盖了一部分的像素不写入，否则会挡住从没覆盖的部分露出来的物体
+    const glm::vec3 *vertices[3] = {&v0, &v1, &v2};
+    float edgeA[3], edgeB[3], edgeC[3];
+    for (int i = 0; i < 3; i++)
+    {
+      const glm::vec3 &from = *vertices[i], &to = *vertices[(i + 1) % 3];
+      edgeA[i] = from.y - to.y;
+      edgeB[i] = to.x - from.x;
+      edgeC[i] = -(edgeA[i] * from.x + edgeB[i] * from.y) - 0.5f * (std::fabs(edgeA[i]) + std::fabs(edgeB[i]));
+    }
+    // 深度平面 z = zA * x + zB * y + zC。写入像素内最远的深度，不超过三角形最远的顶点，遮挡深度不会比真实的近
+    float zA = ((v1.z - v0.z) * (v2.y - v0.y) - (v2.z - v0.z) * (v1.y - v0.y)) / area;
+    float zB = ((v2.z - v0.z) * (v1.x - v0.x) - (v1.z - v0.z) * (v2.x - v0.x)) / area;
+    float zC = v0.z - zA * v0.x - zB * v0.y + 0.5f * (std::fabs(zA) + std::fabs(zB));
+    float nearest = std::min({v0.z, v1.z, v2.z}), farthest = std::max({v0.z, v1.z, v2.z});
+
+    FrustumCuller::Mode resolved = resolve(mode);
+    for (int ty = y0 / TILE; ty <= y1 / TILE; ty++)
+      for (int tx = x0 / TILE; tx <= x1 / TILE; tx++)
+      {
+        int tile = ty * tilesX + tx;
+        // 块里每个像素都不比三角形远，写入不会改变任何值
+        if (nearest >= tileMax[tile])
+          continue;
+        float *block = &depth[(size_t)tile * TILE * TILE];
+        float blockMax = 0.0f;
+        for (int row = 0; row < TILE; row++)
+        {
+          float y = (float)(ty * TILE + row) + 0.5f;
+          float rowMax = rasterizeRow(block + row * TILE, (float)(tx * TILE) + 0.5f, y, edgeA, edgeB, edgeC, zA, zB, zC, farthest, resolved);
+          blockMax = std::max(blockMax, rowMax);
+        }
+        tileMax[tile] = blockMax;
+      }
+  }
+
+  // 一行 8 个像素：覆盖的像素取 min(旧深度, 三角形深度)，返回这一行写入之后的最远深度
+  static float rasterizeRow(float *row, float x, float y, const float *edgeA, const float *edgeB, const float *edgeC, float zA, float zB, float zC,
+                            float farthest, FrustumCuller::Mode mode)
+  {
+#ifdef FRUSTUM_AVX
+    if (mode == FrustumCuller::Mode::Avx)
+    {
+      __m256 px = _mm256_add_ps(_mm256_set1_ps(x), _mm256_setr_ps(0.0f, 1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f, 7.0f));
+      __m256 inside = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+      for (int i = 0; i < 3; i++)
+      {
+        __m256 edge = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(px, _mm256_set1_ps(edgeA[i])), _mm256_set1_ps(edgeB[i] * y)), _mm256_set1_ps(edgeC[i]));
+        inside = _mm256_and_ps(inside, _mm256_cmp_ps(edge, _mm256_setzero_ps(), _CMP_GE_OQ));
+      }
+      __m256 z = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(px, _mm256_set1_ps(zA)), _mm256_set1_ps(zB * y)), _mm256_set1_ps(zC));
+      z = _mm256_min_ps(z, _mm256_set1_ps(farthest));
+      __m256 old = _mm256_loadu_ps(row);
+      __m256 result = _mm256_blendv_ps(old, _mm256_min_ps(old, z), inside);
+      _mm256_storeu_ps(row, result);
+      __m128 half = _mm_max_ps(_mm256_castps256_ps128(result), _mm256_extractf128_ps(result, 1));
+      half = _mm_max_ps(half, _mm_movehl_ps(half, half));
+      return _mm_cvtss_f32(_mm_max_ss(half, _mm_shuffle_ps(half, half, 1)));
+    }
+#endif
+#ifdef FRUSTUM_SSE2
+    if (mode != FrustumCuller::Mode::Scalar)
+    {
+      __m128 rowMax = _mm_setzero_ps();
+      for (int half = 0; half < TILE; half += 4)
+      {
+        __m128 px = _mm_add_ps(_mm_set1_ps(x + (float)half), _mm_setr_ps(0.0f, 1.0f, 2.0f, 3.0f));
+        __m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+        for (int i = 0; i < 3; i++)
+        {
+          __m128 edge = _mm_add_ps(_mm_add_ps(_mm_mul_ps(px, _mm_set1_ps(edgeA[i])), _mm_set1_ps(edgeB[i] * y)), _mm_set1_ps(edgeC[i]));
+          inside = _mm_and_ps(inside, _mm_cmpge_ps(edge, _mm_setzero_ps()));
+        }
+        __m128 z = _mm_add_ps(_mm_add_ps(_mm_mul_ps(px, _mm_set1_ps(zA)), _mm_set1_ps(zB * y)), _mm_set1_ps(zC));
+        z = _mm_min_ps(z, _mm_set1_ps(farthest));
+        __m128 old = _mm_loadu_ps(row + half);
+        // SSE2 没有 blendv，用与 / 与非 / 或选择
+        __m128 result = _mm_or_ps(_mm_and_ps(inside, _mm_min_ps(old, z)), _mm_andnot_ps(inside, old));
+        _mm_storeu_ps(row + half, result);
+        rowMax = _mm_max_ps(rowMax, result);
+      }
+      rowMax = _mm_max_ps(rowMax, _mm_movehl_ps(rowMax, rowMax));
+      return _mm_cvtss_f32(_mm_max_ss(rowMax, _mm_shuffle_ps(rowMax, rowMax, 1)));
+    }
+#endif
+    // 与 SIMD 相同的运算顺序，结果逐个相同
+    float rowMax = 0.0f;
+    for (int lane = 0; lane < TILE; lane++)
+    {
+      float px = x + (float)lane;
+      bool inside = true;
+      for (int i = 0; i < 3; i++)
+        inside = inside && (px * edgeA[i] + edgeB[i] * y) + edgeC[i] >= 0.0f;
+      if (inside)
+        row[lane] = std::min(row[lane], std::min((px * zA + zB * y) + zC, farthest));
+      rowMax = std::max(rowMax, row[lane]);
+    }
+    return rowMax;
+  }
+
+  // 一行中 [columnBegin, columnEnd] 的像素是否有遮挡深度不比 nearest 近的
+  static bool rowVisible(const float *row, int columnBegin, int columnEnd, float nearest, FrustumCuller::Mode mode)
+  {
+    int columns = ((1 << (columnEnd + 1)) - 1) & ~((1 << columnBegin) - 1);
+#ifdef FRUSTUM_AVX
+    if (mode == FrustumCuller::Mode::Avx)
+      return (_mm256_movemask_ps(_mm256_cmp_ps(_mm256_loadu_ps(row), _mm256_set1_ps(nearest), _CMP_GE_OQ)) & columns) != 0;
+#endif
+#ifdef FRUSTUM_SSE2
+    if (mode != FrustumCuller::Mode::Scalar)
+    {
+      __m128 value = _mm_set1_ps(nearest);
+      int mask = _mm_movemask_ps(_mm_cmpge_ps(_mm_loadu_ps(row), value)) | (_mm_movemask_ps(_mm_cmpge_ps(_mm_loadu_ps(row + 4), value)) << 4);
+      return (mask & columns) != 0;
+    }
+#endif
+    for (int column = columnBegin; column <= columnEnd; column++)
+      if (row[column] >= nearest)
+        return true;
+    return false;
+  }
+
+  // 8 圈 12 段的经纬球，单位半径
+  static void buildSphere(std::vector<glm::vec3> &positions, std::vector<uint32_t> &indices)
+  {
+    const int RINGS = 8, SEGMENTS = 12;
+    for (int ring = 0; ring <= RINGS; ring++)
+    {
+      float phi = glm::pi<float>() * ring / RINGS;
+      for (int segment = 0; segment < SEGMENTS; segment++)
+      {
+        float theta = glm::two_pi<float>() * segment / SEGMENTS;
+        positions.push_back(glm::vec3(std::sin(phi) * std::cos(theta), std::cos(phi), std::sin(phi) * std::sin(theta)));
+      }
+    }
+    for (int ring = 0; ring < RINGS; ring++)
+      for (int segment = 0; segment < SEGMENTS; segment++)
+      {
+        uint32_t a = ring * SEGMENTS + segment, b = ring * SEGMENTS + (segment + 1) % SEGMENTS;
+        uint32_t c = a + SEGMENTS, d = b + SEGMENTS;
+        indices.insert(indices.end(), {a, c, b, b, c, d});
+      }
+  }
+};
+
+#endif
@@ -0,0 +1,193 @@
+#ifndef PARALLEL_H
+#define PARALLEL_H
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// 把 [0, count) 切成若干连续区间，在多个线程上执行 fn(begin, end)，全部完成后返回
+//
+// 数量少于 minChunk 时直接在调用线程上执行。工作线程常驻，第一次用到时创建，
+// 平时阻塞在条件变量上，每帧调用（例如实例剔除）不再反复创建和 join 线程。
+// fn 的不同区间之间不能写同一块内存
+class Parallel
+{
+public:
+  // 0 表示使用 std::thread::hardware_concurrency()
+  inline static unsigned int threadCount = 0;
+
+  static unsigned int workerCount()
+  {
+    unsigned int count = threadCount != 0 ? threadCount : std::thread::hardware_concurrency();
+    return std::max(1u, count);
+  }
+
+  template <typename Fn>
+  static void forRange(size_t count, size_t minChunk, Fn fn)
+  {
+    size_t chunks = std::min<size_t>(workerCount(), minChunk == 0 ? count : count / minChunk);
+    if (chunks <= 1)
+    {
+      if (count > 0)
+        fn((size_t)0, count);
+      return;
+    }
+
+    size_t chunkSize = (count + chunks - 1) / chunks;
+    forEach(chunks, [&](size_t chunk)
+            {
+              size_t begin = chunk * chunkSize;
+              size_t end = std::min(count, begin + chunkSize);
+              if (begin < end)
+                fn(begin, end);
+            });
+  }
+
+  // 对 [0, count) 的每一项执行 fn(index)，各线程从共享计数器领取下一项
+  // 适合数量少、耗时差别大的任务（例如解码大小不一的图片）
+  template <typename Fn>
+  static void forEach(size_t count, Fn fn)
+  {
+    if (count == 0)
+      return;
+    size_t threads = std::min<size_t>(workerCount(), count);
+    if (threads <= 1)
+    {
+      for (size_t i = 0; i < count; i++)
+        fn(i);
+      return;
+    }
+
+    std::atomic<size_t> next(0);
+    Job job;
+    job.work = [&]()
+    {
+      for (size_t i = next++; i < count; i = next++)
+        fn(i);
+    };
+    job.helpers = threads - 1;
+    pool().run(job, true);
+  }
+
+  // 在某个工作线程上执行 fn，调用线程等待它完成；已经在工作线程上时直接执行
+  // 用于会修改线程局部状态的任务（例如 stbi_set_flip_vertically_on_load_thread），这些状态不会留在调用线程上
+  template <typename Fn>
+  static void runOnWorker(Fn fn)
+  {
+    if (onWorker)
+    {
+      fn();
+      return;
+    }
+    Job job;
+    job.work = [&]()
+    { fn(); };
+    job.helpers = 1;
+    pool().run(job, false);
+  }
+
+private:
+  inline static thread_local bool onWorker = false;
+
+  struct Job
+  {
+    std::function<void()> work;
+    size_t helpers = 0; // 最多几个工作线程参与
+    size_t joined = 0;
+    size_t running = 0;
+  };
+
+  // 常驻的工作线程。调用线程把任务放进队列，自己也从同一个计数器领取，
+  // 所以工作线程都在忙别的任务（另一个线程的 forEach，或者 fn 里嵌套的调用）时也不会卡住
+  class Pool
+  {
+  public:
+    ~Pool()
+    {
+      {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+      }
+      wake.notify_all();
+      for (std::thread &worker : workers)
+        worker.join();
+    }
+
+    void run(Job &job, bool callerDrains)
+    {
+      {
+        std::lock_guard<std::mutex> lock(mutex);
+        while (workers.size() < job.helpers)
+          workers.emplace_back([this]()
+                               { loop(); });
+        queue.push_back(&job);
+      }
+      if (job.helpers == 1)
+        wake.notify_one();
+      else
+        wake.notify_all();
+
+      if (callerDrains)
+        job.work();
+
+      // 计数器已经领完，还没有被领走的名额不再需要；调用线程不参与时等待名额全部领走。之后等已经加入的工作线程做完
+      std::unique_lock<std::mutex> lock(mutex);
+      if (callerDrains)
+        removeFromQueue(&job);
+      done.wait(lock, [&]()
+                { return job.running == 0 && (job.joined == job.helpers || callerDrains); });
+      removeFromQueue(&job);
+    }
+
+  private:
+    std::mutex mutex;
+    std::condition_variable wake, done;
+    std::deque<Job *> queue;
+    std::vector<std::thread> workers;
+    bool stopping = false;
+
+    void removeFromQueue(Job *job)
+    {
+      auto it = std::find(queue.begin(), queue.end(), job);
+      if (it != queue.end())
+        queue.erase(it);
+    }
+
+    void loop()
+    {
+      onWorker = true;
+      std::unique_lock<std::mutex> lock(mutex);
+      while (true)
+      {
+        wake.wait(lock, [&]()
+                  { return stopping || !queue.empty(); });
+        if (stopping)
+          return;
+        Job *job = queue.front();
+        job->joined++;
+        job->running++;
+        if (job->joined == job->helpers)
+          queue.pop_front();
+        lock.unlock();
+        job->work();
+        lock.lock();
+        job->running--;
+        if (job->running == 0)
+          done.notify_all();
+      }
+    }
+  };
+
+  static Pool &pool()
+  {
+    static Pool instance;
+    return instance;
+  }
+};
+
+#endif
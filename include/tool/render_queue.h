@@ -0,0 +1,357 @@
+#ifndef RENDER_QUEUE_H
+#define RENDER_QUEUE_H
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <utility>
+#include <vector>
+
+#include <geometry/GeometryHandle.h>
+#include <tool/render_state.h>
+#include <tool/shader.h>
+
+struct RenderQueueStats
+{
+  size_t items = 0;
+  size_t transparent = 0;
+  // 排序之后执行时的状态切换
+  unsigned int programChanges = 0;
+  unsigned int textureChanges = 0; // 纹理组合的切换，不是 glBindTexture 的次数
+  unsigned int vertexArrayChanges = 0;
+  // 按提交顺序执行时会有的状态切换，用于对比
+  unsigned int submittedProgramChanges = 0;
+  unsigned int submittedTextureChanges = 0;
+  unsigned int submittedVertexArrayChanges = 0;
+  unsigned int constants = 0; // 上传的逐绘制 uniform
+  double sortMs = 0.0;
+  double executeMs = 0.0; // 发出 GL 调用的 CPU 时间
+};
+
+// 按排序键提交的绘制队列
+//
+// 渲染循环里不再直接绑定程序、纹理和 VAO，而是把每次绘制作为一项加入队列：
+// 程序、最多 4 个纹理单元上的纹理、几何体（VAO 和索引范围）、逐绘制的 uniform 常量，以及用来排序的世界空间位置。
+// flush() 给每项生成 64 位排序键，排序之后一次执行，相邻的项共享的状态只设置一次：
+//
+//   不透明  [63] 0 | [62..53] 程序 | [52..37] 纹理组合 | [36..13] 深度（由近到远）| [12..0] VAO
+//   透明    [63] 1 | [62..39] 深度（由远到近）| [38..29] 程序 | [28..13] 纹理组合 | [12..0] VAO
+//
+// 不透明的项先画，按程序、纹理、深度排序；透明的项开启混合，严格由远到近。
+// 程序、纹理组合和 VAO 按这一帧第一次出现的顺序编号，深度是到相机的视空间距离除以 farDistance 后量化到 24 位。
+// 每帧的 uniform（例如 textureMap、factor）和共享的资源（FrameConstants、LightBuffer）仍然在 flush() 之前设置
+//
+// RenderQueue queue;
+// queue.beginFrame(view, 100.0f);
+// queue.add(sceneShader, containerGeometry, position).texture(0, GL_TEXTURE_2D, woodMap).set(sceneModel, model);
+// queue.add(sceneShader, grassGeometry, position, RenderQueue::Transparent).texture(0, GL_TEXTURE_2D, grassMap).set(sceneModel, model);
+// queue.flush();
+class RenderQueue
+{
+public:
+  static const unsigned int MAX_TEXTURES = 4;
+
+  enum Layer
+  {
+    Opaque,
+    Transparent,
+  };
+
+  RenderQueueStats stats; // 上一次 flush
+
+  // add() 返回，继续设置这一项的纹理和逐绘制常量
+  class Draw
+  {
+  public:
+    Draw(RenderQueue &queue, size_t item) : queue(queue), item(item) {}
+
+    Draw &texture(unsigned int unit, GLenum target, unsigned int id)
+    {
+      if (unit < MAX_TEXTURES)
+        queue.items[item].textures[unit] = {target, id};
+      return *this;
+    }
+
+    template <typename T>
+    Draw &set(Uniform<T> handle, const T &value)
+    {
+      if (!handle.valid())
+        return *this;
+      Constant constant;
+      constant.location = handle.location;
+      store(constant, value);
+      queue.constants.push_back(constant);
+      queue.items[item].constantCount++;
+      return *this;
+    }
+
+  private:
+    RenderQueue &queue;
+    size_t item;
+  };
+
+  // 每帧开始时调用：清空队列，设置计算深度用的观察矩阵和远处的距离
+  void beginFrame(const glm::mat4 &view, float farDistance)
+  {
+    this->view = view;
+    this->farDistance = farDistance;
+    items.clear();
+    constants.clear();
+  }
+
+  // 绘制几何体的全部索引
+  Draw add(const Shader &shader, const GeometryHandle &geometry, const glm::vec3 &position, Layer layer = Opaque, GLenum mode = GL_TRIANGLES)
+  {
+    return add(shader, geometry, 0, geometry.indexCount, position, layer, mode);
+  }
+
+  // 绘制 [firstIndex, firstIndex + indexCount) 的索引
+  Draw add(const Shader &shader, const GeometryHandle &geometry, GLsizei firstIndex, GLsizei indexCount, const glm::vec3 &position,
+           Layer layer = Opaque, GLenum mode = GL_TRIANGLES)
+  {
+    Item item;
+    item.program = shader.ID;
+    item.vertexArray = geometry.VAO;
+    item.indexType = geometry.indexType;
+    item.mode = mode;
+    item.firstIndex = firstIndex;
+    item.indexCount = indexCount;
+    item.layer = layer;
+    item.depth = -(view * glm::vec4(position, 1.0f)).z;
+    item.constantBegin = constants.size();
+    items.push_back(item);
+    return Draw(*this, items.size() - 1);
+  }
+
+  size_t size() const
+  {
+    return items.size();
+  }
+
+  // 排序并执行队列中的所有项，之后队列为空
+  void flush()
+  {
+    auto start = std::chrono::steady_clock::now();
+    stats = RenderQueueStats();
+    stats.items = items.size();
+    buildKeys();
+    order.resize(items.size());
+    for (size_t i = 0; i < items.size(); i++)
+      order[i] = {items[i].key, (uint32_t)i};
+    std::sort(order.begin(), order.end());
+    auto sorted = std::chrono::steady_clock::now();
+
+    const Item *previous = nullptr;
+    for (const std::pair<uint64_t, uint32_t> &entry : order)
+    {
+      const Item &item = items[entry.second];
+      if (previous == nullptr || previous->layer != item.layer)
+        setLayerState(item.layer);
+      if (previous == nullptr || previous->program != item.program)
+      {
+        RenderState::useProgram(item.program);
+        stats.programChanges++;
+      }
+      if (previous == nullptr || previous->textureSet != item.textureSet)
+      {
+        for (unsigned int unit = 0; unit < MAX_TEXTURES; unit++)
+          if (item.textures[unit].id != 0)
+            RenderState::bindTexture(unit, item.textures[unit].target, item.textures[unit].id);
+        stats.textureChanges++;
+      }
+      if (previous == nullptr || previous->vertexArray != item.vertexArray)
+        stats.vertexArrayChanges++;
+      for (size_t i = 0; i < item.constantCount; i++)
+        upload(constants[item.constantBegin + i]);
+      stats.constants += (unsigned int)item.constantCount;
+      if (item.layer == Transparent)
+        stats.transparent++;
+      draw(item);
+      previous = &item;
+    }
+
+    // 按提交顺序会有的切换
+    for (size_t i = 0; i < items.size(); i++)
+    {
+      stats.submittedProgramChanges += i == 0 || items[i].program != items[i - 1].program;
+      stats.submittedTextureChanges += i == 0 || items[i].textureSet != items[i - 1].textureSet;
+      stats.submittedVertexArrayChanges += i == 0 || items[i].vertexArray != items[i - 1].vertexArray;
+    }
+    auto executed = std::chrono::steady_clock::now();
+    stats.sortMs = std::chrono::duration<double, std::milli>(sorted - start).count();
+    stats.executeMs = std::chrono::duration<double, std::milli>(executed - sorted).count();
+    items.clear();
+    constants.clear();
+  }
+
+private:
+  struct TextureBinding
+  {
+    GLenum target = GL_TEXTURE_2D;
+    unsigned int id = 0;
+  };
+
+  // 一个逐绘制的 uniform，按类型存放最多 16 个分量
+  struct Constant
+  {
+    enum Type
+    {
+      Int,
+      Float,
+      Vec2,
+      Vec3,
+      Vec4,
+      Mat3,
+      Mat4,
+    };
+    GLint location = -1;
+    Type type = Int;
+    union
+    {
+      int integer;
+      float values[16];
+    };
+  };
+
+  struct Item
+  {
+    unsigned int program = 0;
+    unsigned int vertexArray = 0;
+    GLenum indexType = GL_UNSIGNED_INT;
+    GLenum mode = GL_TRIANGLES;
+    GLsizei firstIndex = 0;
+    GLsizei indexCount = 0;
+    Layer layer = Opaque;
+    float depth = 0.0f;
+    TextureBinding textures[MAX_TEXTURES];
+    size_t constantBegin = 0;
+    size_t constantCount = 0;
+    uint32_t textureSet = 0; // flush() 时编号
+    uint64_t key = 0;
+  };
+
+  std::vector<Item> items;
+  std::vector<Constant> constants;
+  std::vector<std::pair<uint64_t, uint32_t>> order;
+  glm::mat4 view = glm::mat4(1.0f);
+  float farDistance = 100.0f;
+
+  static void store(Constant &constant, bool value)
+  {
+    constant.type = Constant::Int;
+    constant.integer = value ? 1 : 0;
+  }
+  static void store(Constant &constant, int value)
+  {
+    constant.type = Constant::Int;
+    constant.integer = value;
+  }
+  static void store(Constant &constant, float value)
+  {
+    constant.type = Constant::Float;
+    constant.values[0] = value;
+  }
+  static void store(Constant &constant, const glm::vec2 &value)
+  {
+    constant.type = Constant::Vec2;
+    std::copy(&value[0], &value[0] + 2, constant.values);
+  }
+  static void store(Constant &constant, const glm::vec3 &value)
+  {
+    constant.type = Constant::Vec3;
+    std::copy(&value[0], &value[0] + 3, constant.values);
+  }
+  static void store(Constant &constant, const glm::vec4 &value)
+  {
+    constant.type = Constant::Vec4;
+    std::copy(&value[0], &value[0] + 4, constant.values);
+  }
+  static void store(Constant &constant, const glm::mat3 &value)
+  {
+    constant.type = Constant::Mat3;
+    std::copy(&value[0][0], &value[0][0] + 9, constant.values);
+  }
+  static void store(Constant &constant, const glm::mat4 &value)
+  {
+    constant.type = Constant::Mat4;
+    std::copy(&value[0][0], &value[0][0] + 16, constant.values);
+  }
+
+  static void upload(const Constant &constant)
+  {
+    switch (constant.type)
+    {
+    case Constant::Int:
+      glUniform1i(constant.location, constant.integer);
+      break;
+    case Constant::Float:
+      glUniform1f(constant.location, constant.values[0]);
+      break;
+    case Constant::Vec2:
+      glUniform2fv(constant.location, 1, constant.values);
+      break;
+    case Constant::Vec3:
+      glUniform3fv(constant.location, 1, constant.values);
+      break;
+    case Constant::Vec4:
+      glUniform4fv(constant.location, 1, constant.values);
+      break;
+    case Constant::Mat3:
+      glUniformMatrix3fv(constant.location, 1, GL_FALSE, constant.values);
+      break;
+    case Constant::Mat4:
+      glUniformMatrix4fv(constant.location, 1, GL_FALSE, constant.values);
+      break;
+    }
+  }
+
+  static void setLayerState(Layer layer)
+  {
+    RenderState::setBlend(layer == Transparent);
+    if (layer == Transparent)
+      RenderState::setBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+  }
+
+  static void draw(const Item &item)
+  {
+    if (!UploadScheduler::ready(item.vertexArray))
+      return;
+    RenderState::bindVertexArray(item.vertexArray);
+    size_t indexSize = item.indexType == GL_UNSIGNED_SHORT ? sizeof(GLushort) : sizeof(GLuint);
+    glDrawElements(item.mode, item.indexCount, item.indexType, (const void *)(item.firstIndex * indexSize));
+  }
+
+  // 程序、纹理组合和 VAO 按第一次出现的顺序编号，编号超出位宽时截断（只影响排序的紧凑程度，不影响正确性）
+  void buildKeys()
+  {
+    std::map<unsigned int, uint64_t> programs, vertexArrays;
+    std::map<std::array<unsigned int, MAX_TEXTURES * 2>, uint32_t> textureSets;
+    for (Item &item : items)
+    {
+      uint64_t program = programs.emplace(item.program, programs.size()).first->second & 0x3ff;
+      uint64_t vertexArray = vertexArrays.emplace(item.vertexArray, vertexArrays.size()).first->second & 0x1fff;
+      std::array<unsigned int, MAX_TEXTURES * 2> textures;
+      for (unsigned int unit = 0; unit < MAX_TEXTURES; unit++)
+      {
+        textures[unit * 2] = item.textures[unit].target;
+        textures[unit * 2 + 1] = item.textures[unit].id;
+      }
+      item.textureSet = textureSets.emplace(textures, (uint32_t)textureSets.size()).first->second;
+      uint64_t textureSet = item.textureSet & 0xffff;
+
+      float normalized = std::min(std::max(item.depth / farDistance, 0.0f), 1.0f);
+      uint64_t depth = (uint64_t)(normalized * 0xffffff);
+      if (item.layer == Opaque)
+        item.key = (program << 53) | (textureSet << 37) | (depth << 13) | vertexArray;
+      else
+        item.key = (1ull << 63) | ((0xffffff - depth) << 39) | (program << 29) | (textureSet << 13) | vertexArray;
+    }
+  }
+};
+
+#endif
@@ -0,0 +1,258 @@
+#ifndef RENDER_STATE_H
+#define RENDER_STATE_H
+
+#include <glad/glad.h>
+
+#include <iostream>
+#include <unordered_set>
+
+// 每帧 GL 调用统计
+struct RenderStateStats
+{
+  unsigned int issued = 0;  // 实际发出的 GL 调用
+  unsigned int skipped = 0; // 与当前状态相同而省掉的调用
+};
+
+// GL 状态缓存：记录当前绑定的程序、VAO、各纹理单元上的纹理以及混合/深度/剔除状态，
+// 与记录相同的调用直接跳过。GL 4.5 下纹理使用 DSA（glBindTextureUnit）绑定，不再切换活动纹理单元
+//
+// 所有成员都是静态的，整个进程共享一个 GL 上下文。直接调用 gl 函数修改了这些状态之后
+// （例如初始化阶段加载纹理、创建帧缓冲），需要调用 RenderState::invalidate()
+class RenderState
+{
+public:
+  static const unsigned int MAX_TEXTURE_UNITS = 32;
+
+  inline static RenderStateStats stats;     // 当前帧
+  inline static RenderStateStats lastFrame; // 上一帧
+
+  // 每帧开始时调用，保存上一帧的统计并清零
+  static void beginFrame()
+  {
+    lastFrame = stats;
+    stats = RenderStateStats();
+  }
+
+  // 忘记所有记录的状态，之后的每个调用都会真正发出一次
+  static void invalidate()
+  {
+    program = UNKNOWN;
+    vertexArray = UNKNOWN;
+    for (unsigned int unit = 0; unit < MAX_TEXTURE_UNITS; unit++)
+      for (unsigned int slot = 0; slot < TARGET_SLOTS; slot++)
+        textures[unit][slot] = UNKNOWN;
+    for (unsigned int i = 0; i < CAPABILITY_COUNT; i++)
+      capabilities[i] = -1;
+    depthFunc = UNKNOWN;
+    cullFace = UNKNOWN;
+    blendSrc = UNKNOWN;
+    blendDst = UNKNOWN;
+  }
+
+  static bool directStateAccess()
+  {
+    return GLAD_GL_VERSION_4_5 != 0;
+  }
+
+  // ------------------------------------------------------------------------
+  static void useProgram(unsigned int id)
+  {
+    if (program == id)
+    {
+      stats.skipped++;
+      return;
+    }
+    glUseProgram(id);
+    program = id;
+    stats.issued++;
+  }
+
+  // 删除程序之后调用，避免之后新建的同名程序被误认为已经在使用
+  static void forgetProgram(unsigned int id)
+  {
+    if (program == id)
+      program = UNKNOWN;
+  }
+
+  static void bindVertexArray(unsigned int id)
+  {
+    if (vertexArray == id)
+    {
+      stats.skipped++;
+      return;
+    }
+    glBindVertexArray(id);
+    vertexArray = id;
+    stats.issued++;
+  }
+
+  // 删除 VAO 之后调用，原因同 forgetProgram
+  static void forgetVertexArray(unsigned int id)
+  {
+    if (vertexArray == id)
+      vertexArray = UNKNOWN;
+  }
+
+  // 删除纹理之后调用，原因同 forgetProgram；同名的新纹理第一次绑定时重新按目标绑定
+  static void forgetTexture(unsigned int id)
+  {
+    for (unsigned int unit = 0; unit < MAX_TEXTURE_UNITS; unit++)
+      for (unsigned int slot = 0; slot < TARGET_SLOTS; slot++)
+        if (textures[unit][slot] == id)
+          textures[unit][slot] = UNKNOWN;
+    boundTextures.erase(id);
+  }
+
+  // 非 DSA 路径绑定后把活动纹理单元恢复为 0，和直接调用 glBindTexture 的代码混用也不会绑错单元
+  static void bindTexture(unsigned int unit, GLenum target, unsigned int texture)
+  {
+    int slot = targetSlot(target);
+    if (unit < MAX_TEXTURE_UNITS && slot >= 0 && textures[unit][slot] == texture)
+    {
+      stats.skipped++;
+      return;
+    }
+    // glBindTextureUnit(unit, 0) 会解绑该单元上所有目标，纹理 0 仍按目标解绑；
+    // glGenTextures 刚生成、还没有绑定过的名字没有目标，glBindTextureUnit 会报 GL_INVALID_OPERATION，
+    // 所以每个名字第一次经过这里时按目标绑定并记下来，之后才用 DSA（不向驱动查询 glIsTexture）
+    if (directStateAccess() && texture != 0 && !boundTextures.insert(texture).second)
+    {
+      glBindTextureUnit(unit, texture);
+      stats.issued++;
+    }
+    else
+    {
+      glActiveTexture(GL_TEXTURE0 + unit);
+      glBindTexture(target, texture);
+      stats.issued += 2;
+      if (unit != 0)
+      {
+        glActiveTexture(GL_TEXTURE0);
+        stats.issued++;
+      }
+    }
+    if (unit < MAX_TEXTURE_UNITS && slot >= 0)
+      textures[unit][slot] = texture;
+  }
+
+  // 混合 / 深度测试 / 面剔除开关
+  // ------------------------------------------------------------------------
+  static void setBlend(bool enabled)
+  {
+    setCapability(BLEND, GL_BLEND, enabled);
+  }
+  static void setDepthTest(bool enabled)
+  {
+    setCapability(DEPTH_TEST, GL_DEPTH_TEST, enabled);
+  }
+  static void setCullFace(bool enabled)
+  {
+    setCapability(CULL_FACE, GL_CULL_FACE, enabled);
+  }
+
+  static void setBlendFunc(GLenum src, GLenum dst)
+  {
+    if (blendSrc == src && blendDst == dst)
+    {
+      stats.skipped++;
+      return;
+    }
+    glBlendFunc(src, dst);
+    blendSrc = src;
+    blendDst = dst;
+    stats.issued++;
+  }
+
+  static void setDepthFunc(GLenum func)
+  {
+    if (depthFunc == func)
+    {
+      stats.skipped++;
+      return;
+    }
+    glDepthFunc(func);
+    depthFunc = func;
+    stats.issued++;
+  }
+
+  // GL_FRONT / GL_BACK
+  static void setCullMode(GLenum face)
+  {
+    if (cullFace == face)
+    {
+      stats.skipped++;
+      return;
+    }
+    glCullFace(face);
+    cullFace = face;
+    stats.issued++;
+  }
+
+  static void printStats()
+  {
+    std::cout << "RENDER_STATE issued: " << lastFrame.issued << ", skipped: " << lastFrame.skipped
+              << (directStateAccess() ? " (DSA)" : "") << std::endl;
+  }
+
+private:
+  static const unsigned int UNKNOWN = 0xffffffffu;
+  static const unsigned int TARGET_SLOTS = 5;
+
+  enum Capability
+  {
+    BLEND,
+    DEPTH_TEST,
+    CULL_FACE,
+    CAPABILITY_COUNT
+  };
+
+  // 初始状态未知，第一次调用一定会发出
+  inline static unsigned int program = UNKNOWN;
+  inline static unsigned int vertexArray = UNKNOWN;
+  inline static unsigned int textures[MAX_TEXTURE_UNITS][TARGET_SLOTS] = {};
+  inline static int capabilities[CAPABILITY_COUNT] = {-1, -1, -1};
+  inline static GLenum depthFunc = UNKNOWN;
+  inline static GLenum cullFace = UNKNOWN;
+  inline static GLenum blendSrc = UNKNOWN;
+  inline static GLenum blendDst = UNKNOWN;
+  // 经过 bindTexture 按目标绑定过的纹理名，已经有目标，可以用 glBindTextureUnit
+  inline static std::unordered_set<unsigned int> boundTextures;
+  inline static bool initialized = (invalidate(), true);
+
+  // 每个纹理单元上不同目标的绑定互不影响，分别记录
+  static int targetSlot(GLenum target)
+  {
+    switch (target)
+    {
+    case GL_TEXTURE_2D:
+      return 0;
+    case GL_TEXTURE_CUBE_MAP:
+      return 1;
+    case GL_TEXTURE_BUFFER:
+      return 2;
+    case GL_TEXTURE_2D_MULTISAMPLE:
+      return 3;
+    case GL_TEXTURE_3D:
+      return 4;
+    default:
+      return -1; // 不记录，每次都发出
+    }
+  }
+
+  static void setCapability(Capability capability, GLenum cap, bool enabled)
+  {
+    if (capabilities[capability] == (int)enabled)
+    {
+      stats.skipped++;
+      return;
+    }
+    if (enabled)
+      glEnable(cap);
+    else
+      glDisable(cap);
+    capabilities[capability] = enabled;
+    stats.issued++;
+  }
+};
+
+#endif
@@ -9,6 +9,33 @@
 #include <fstream>
 #include <sstream>
 #include <iostream>
+#include <chrono>
+#include <filesystem>
+#include <unordered_map>
+
+#include <tool/shader_preprocessor.h>
+#include <tool/render_state.h>
+
+// typed handle to a uniform location, resolved once and reused every frame
+// ------------------------------------------------------------------------
+template <typename T>
+struct Uniform
+{
+    GLint location = -1;
+
+    bool valid() const { return location != -1; }
+};
+
+// program binary cache counters
+// ------------------------------------------------------------------------
+struct ProgramCacheStats
+{
+    unsigned int hits = 0;
+    unsigned int misses = 0;
+    unsigned int rejected = 0;
+    double compileMs = 0.0; // time spent compiling + linking on misses
+    double loadMs = 0.0;    // time spent in glProgramBinary on hits
+};
 
 class Shader
 {
@@ -19,169 +46,428 @@ public:
     // constructor generates the shader on the fly
     // ------------------------------------------------------------------------
     Shader(const char *vertexPath, const char *fragmentPath, const char *geometryPath = nullptr)
+        : Shader(vertexPath, fragmentPath, ShaderDefines(), geometryPath)
     {
-
-        std::string vert_string = vertexPath;
-        std::string frag_string = fragmentPath;
-        std::string gemo_string = "";
-
-        const char *vert_char = vert_string.insert(2, dirName).c_str();
-        const char *frag_char = frag_string.insert(2, dirName).c_str();
-        const char *gemo_char;
-
+    }
+    // same as above, with defines injected after #version of every stage
+    // ------------------------------------------------------------------------
+    Shader(const char *vertexPath, const char *fragmentPath, const ShaderDefines &defines, const char *geometryPath = nullptr)
+    {
+        // 1. retrieve the vertex/fragment source code from filePath, expanding #include
+        ShaderSource vertex = ShaderPreprocessor::load(resolvePath(vertexPath), defines);
+        ShaderSource fragment = ShaderPreprocessor::load(resolvePath(fragmentPath), defines);
+        ShaderSource geometry;
         if (geometryPath != nullptr)
-        {
-            gemo_string = geometryPath;
-            gemo_char = gemo_string.insert(2, dirName).c_str();
-        }
+            geometry = ShaderPreprocessor::load(resolvePath(geometryPath), defines);
+        buildProgram(vertex, fragment, geometry);
+    }
+    // already expanded sources, see ShaderVariants
+    // ------------------------------------------------------------------------
+    Shader(const ShaderSource &vertex, const ShaderSource &fragment, const ShaderSource &geometry = ShaderSource())
+    {
+        buildProgram(vertex, fragment, geometry);
+    }
+    // compute shader program (GL 4.3), loaded and expanded like the other stages
+    // ------------------------------------------------------------------------
+    static Shader compute(const char *computePath, const ShaderDefines &defines = ShaderDefines())
+    {
+        return Shader(ShaderPreprocessor::load(resolvePath(computePath), defines), ComputeStage());
+    }
+    // "./shader/x.glsl" -> "./" + dirName + "shader/x.glsl"
+    // ------------------------------------------------------------------------
+    static std::string resolvePath(const std::string &path)
+    {
+        if (path.compare(0, 2, "./") != 0)
+            return path;
+        return "./" + dirName + path.substr(2);
+    }
+    // program binary cache, shared by every Shader in the process
+    // ------------------------------------------------------------------------
+    // uniform blocks bound automatically after linking, block name -> binding point
+    inline static std::unordered_map<std::string, GLuint> uniformBlockBindings = {{"FrameConstants", 0}};
+    inline static std::string cacheDir = "./output/shader_cache";
+    inline static bool useProgramCache = true;
+    inline static ProgramCacheStats cacheStats;
 
-        // 1. retrieve the vertex/fragment source code from filePath
-        std::string vertexCode;
-        std::string fragmentCode;
-        std::string geometryCode;
-        std::ifstream vShaderFile;
-        std::ifstream fShaderFile;
-        std::ifstream gShaderFile;
-        // ensure ifstream objects can throw exceptions:
-        vShaderFile.exceptions(std::ifstream::failbit | std::ifstream::badbit);
-        fShaderFile.exceptions(std::ifstream::failbit | std::ifstream::badbit);
-        gShaderFile.exceptions(std::ifstream::failbit | std::ifstream::badbit);
-        try
-        {
-            // open files
-            vShaderFile.open(vert_char);
-            fShaderFile.open(frag_char);
-            std::stringstream vShaderStream, fShaderStream;
-            // read file's buffer contents into streams
-            vShaderStream << vShaderFile.rdbuf();
-            fShaderStream << fShaderFile.rdbuf();
-            // close file handlers
-            vShaderFile.close();
-            fShaderFile.close();
-            // convert stream into string
-            vertexCode = vShaderStream.str();
-            fragmentCode = fShaderStream.str();
-            // if geometry shader path is present, also load a geometry shader
-            if (geometryPath != nullptr)
-            {
-                gShaderFile.open(gemo_char);
-                std::stringstream gShaderStream;
-                gShaderStream << gShaderFile.rdbuf();
-                gShaderFile.close();
-                geometryCode = gShaderStream.str();
-            }
-        }
-        catch (std::ifstream::failure &e)
-        {
-            std::cout << "ERROR::SHADER::FILE_NOT_SUCCESFULLY_READ" << std::endl;
-        }
-        const char *vShaderCode = vertexCode.c_str();
-        const char *fShaderCode = fragmentCode.c_str();
-        // 2. compile shaders
-        unsigned int vertex, fragment;
-        // vertex shader
-        vertex = glCreateShader(GL_VERTEX_SHADER);
-        glShaderSource(vertex, 1, &vShaderCode, NULL);
-        glCompileShader(vertex);
-        checkCompileErrors(vertex, "VERTEX");
-        // fragment Shader
-        fragment = glCreateShader(GL_FRAGMENT_SHADER);
-        glShaderSource(fragment, 1, &fShaderCode, NULL);
-        glCompileShader(fragment);
-        checkCompileErrors(fragment, "FRAGMENT");
-        // if geometry shader is given, compile geometry shader
-        unsigned int geometry;
-        if (geometryPath != nullptr)
-        {
-            const char *gShaderCode = geometryCode.c_str();
-            geometry = glCreateShader(GL_GEOMETRY_SHADER);
-            glShaderSource(geometry, 1, &gShaderCode, NULL);
-            glCompileShader(geometry);
-            checkCompileErrors(geometry, "GEOMETRY");
-        }
-        // shader Program
-        ID = glCreateProgram();
-        glAttachShader(ID, vertex);
-        glAttachShader(ID, fragment);
-        if (geometryPath != nullptr)
-            glAttachShader(ID, geometry);
-        glLinkProgram(ID);
-        checkCompileErrors(ID, "PROGRAM");
-        // delete the shaders as they're linked into our program now and no longer necessery
-        glDeleteShader(vertex);
-        glDeleteShader(fragment);
-        if (geometryPath != nullptr)
-            glDeleteShader(geometry);
+    static void printCacheStats()
+    {
+        double avgCompileMs = cacheStats.misses > 0 ? cacheStats.compileMs / cacheStats.misses : 0.0;
+        std::cout << "SHADER::PROGRAM_CACHE hits: " << cacheStats.hits
+                  << ", misses: " << cacheStats.misses
+                  << ", rejected: " << cacheStats.rejected
+                  << ", compile: " << cacheStats.compileMs << " ms"
+                  << ", load: " << cacheStats.loadMs << " ms";
+        if (cacheStats.misses > 0 && cacheStats.hits > 0)
+            std::cout << ", saved ~" << avgCompileMs * cacheStats.hits - cacheStats.loadMs << " ms";
+        std::cout << std::endl;
     }
-    // activate the shader
+    // activate the shader, skipped when it is already the current program
     // ------------------------------------------------------------------------
     void use()
     {
-        glUseProgram(ID);
+        RenderState::useProgram(ID);
+    }
+    // uniform location lookup, served from the table built at link time
+    // ------------------------------------------------------------------------
+    GLint getUniformLocation(const std::string &name) const
+    {
+        auto it = uniformLocations.find(name);
+        if (it != uniformLocations.end())
+            return it->second;
+        // not reported by glGetActiveUniform (e.g. "light" for a struct), ask the driver once and remember the answer
+        GLint location = glGetUniformLocation(ID, name.c_str());
+        uniformLocations.emplace(name, location);
+        return location;
+    }
+    // resolve a typed handle once, outside of the render loop
+    // ------------------------------------------------------------------------
+    template <typename T>
+    Uniform<T> uniform(const std::string &name) const
+    {
+        return Uniform<T>{getUniformLocation(name)};
+    }
+    // handle based setters, no string building and no driver lookup
+    // ------------------------------------------------------------------------
+    template <typename T>
+    void set(Uniform<T> handle, const T &value) const
+    {
+        upload(handle.location, value);
+    }
+    template <typename T>
+    void setArray(Uniform<T> handle, const T *values, GLsizei count) const
+    {
+        uploadArray(handle.location, values, count);
     }
     // utility uniform functions
     // ------------------------------------------------------------------------
     void setBool(const std::string &name, bool value) const
     {
-        glUniform1i(glGetUniformLocation(ID, name.c_str()), (int)value);
+        glUniform1i(getUniformLocation(name), (int)value);
     }
     // ------------------------------------------------------------------------
     void setInt(const std::string &name, int value) const
     {
-        glUniform1i(glGetUniformLocation(ID, name.c_str()), value);
+        glUniform1i(getUniformLocation(name), value);
     }
     // ------------------------------------------------------------------------
     void setFloat(const std::string &name, float value) const
     {
-        glUniform1f(glGetUniformLocation(ID, name.c_str()), value);
+        glUniform1f(getUniformLocation(name), value);
     }
     // ------------------------------------------------------------------------
     void setVec2(const std::string &name, const glm::vec2 &value) const
     {
-        glUniform2fv(glGetUniformLocation(ID, name.c_str()), 1, &value[0]);
+        glUniform2fv(getUniformLocation(name), 1, &value[0]);
     }
     void setVec2(const std::string &name, float x, float y) const
     {
-        glUniform2f(glGetUniformLocation(ID, name.c_str()), x, y);
+        glUniform2f(getUniformLocation(name), x, y);
     }
     // ------------------------------------------------------------------------
     void setVec3(const std::string &name, const glm::vec3 &value) const
     {
-        glUniform3fv(glGetUniformLocation(ID, name.c_str()), 1, &value[0]);
+        glUniform3fv(getUniformLocation(name), 1, &value[0]);
     }
     void setVec3(const std::string &name, float x, float y, float z) const
     {
-        glUniform3f(glGetUniformLocation(ID, name.c_str()), x, y, z);
+        glUniform3f(getUniformLocation(name), x, y, z);
     }
     // ------------------------------------------------------------------------
     void setVec4(const std::string &name, const glm::vec4 &value) const
     {
-        glUniform4fv(glGetUniformLocation(ID, name.c_str()), 1, &value[0]);
+        glUniform4fv(getUniformLocation(name), 1, &value[0]);
     }
     void setVec4(const std::string &name, float x, float y, float z, float w)
     {
-        glUniform4f(glGetUniformLocation(ID, name.c_str()), x, y, z, w);
+        glUniform4f(getUniformLocation(name), x, y, z, w);
     }
     // ------------------------------------------------------------------------
     void setMat2(const std::string &name, const glm::mat2 &mat) const
     {
-        glUniformMatrix2fv(glGetUniformLocation(ID, name.c_str()), 1, GL_FALSE, &mat[0][0]);
+        glUniformMatrix2fv(getUniformLocation(name), 1, GL_FALSE, &mat[0][0]);
     }
     // ------------------------------------------------------------------------
     void setMat3(const std::string &name, const glm::mat3 &mat) const
     {
-        glUniformMatrix3fv(glGetUniformLocation(ID, name.c_str()), 1, GL_FALSE, &mat[0][0]);
+        glUniformMatrix3fv(getUniformLocation(name), 1, GL_FALSE, &mat[0][0]);
     }
     // ------------------------------------------------------------------------
     void setMat4(const std::string &name, const glm::mat4 &mat) const
     {
-        glUniformMatrix4fv(glGetUniformLocation(ID, name.c_str()), 1, GL_FALSE, &mat[0][0]);
+        glUniformMatrix4fv(getUniformLocation(name), 1, GL_FALSE, &mat[0][0]);
     }
 
 private:
+    struct ComputeStage
+    {
+    };
+    Shader(const ShaderSource &compute, ComputeStage)
+    {
+        buildComputeProgram(compute);
+    }
+
+    static constexpr unsigned int PROGRAM_BINARY_MAGIC = 0x4250474f; // "OGPB"
+
+    mutable std::unordered_map<std::string, GLint> uniformLocations;
+
+    // key = all stage sources + the driver that produced the binary
+    // ------------------------------------------------------------------------
+    static std::string programCacheKey(const std::string &vertexCode, const std::string &fragmentCode, const std::string &geometryCode)
+    {
+        unsigned long long hash = ShaderPreprocessor::hash(vertexCode);
+        hash = ShaderPreprocessor::hash("\x01" + fragmentCode, hash);
+        hash = ShaderPreprocessor::hash("\x02" + geometryCode, hash);
+        const GLubyte *strings[3] = {glGetString(GL_VENDOR), glGetString(GL_RENDERER), glGetString(GL_VERSION)};
+        for (const GLubyte *str : strings)
+            hash = ShaderPreprocessor::hash(str ? (const char *)str : "", hash);
+        std::ostringstream key;
+        key << std::hex << hash;
+        return key.str();
+    }
+    static bool programBinarySupported()
+    {
+        if (!useProgramCache || !GLAD_GL_VERSION_4_1)
+            return false;
+        GLint formats = 0;
+        glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+        return formats > 0;
+    }
+    // cached binaries are stored as: magic, binary format, binary length, data
+    // ------------------------------------------------------------------------
+    bool loadProgramBinary(const std::string &path)
+    {
+        std::ifstream file(path, std::ios::binary);
+        if (!file)
+            return false;
+        unsigned int header[3] = {0, 0, 0};
+        file.read((char *)header, sizeof(header));
+        if (!file || header[0] != PROGRAM_BINARY_MAGIC || header[2] == 0)
+            return false;
+        std::string binary(header[2], '\0');
+        file.read(&binary[0], header[2]);
+        if (!file)
+            return false;
+
+        ID = glCreateProgram();
+        glProgramBinary(ID, (GLenum)header[1], binary.data(), (GLsizei)binary.size());
+        GLint success = 0;
+        glGetProgramiv(ID, GL_LINK_STATUS, &success);
+        if (!success)
+        {
+            // driver update or a different GPU, fall back to compiling from source
+            glDeleteProgram(ID);
+            ID = 0;
+            return false;
+        }
+        return true;
+    }
+    void storeProgramBinary(const std::string &path)
+    {
+        GLint length = 0;
+        glGetProgramiv(ID, GL_PROGRAM_BINARY_LENGTH, &length);
+        if (length <= 0)
+            return;
+        std::string binary(length, '\0');
+        GLenum format = 0;
+        glGetProgramBinary(ID, length, NULL, &format, &binary[0]);
+
+        std::error_code error;
+        std::filesystem::create_directories(cacheDir, error);
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        if (!file)
+            return;
+        unsigned int header[3] = {PROGRAM_BINARY_MAGIC, (unsigned int)format, (unsigned int)length};
+        file.write((const char *)header, sizeof(header));
+        file.write(binary.data(), binary.size());
+    }
+    // load the program from the binary cache, or compile and link it from source
+    // ------------------------------------------------------------------------
+    void buildProgram(const ShaderSource &vertexSource, const ShaderSource &fragmentSource, const ShaderSource &geometrySource)
+    {
+        const std::string &vertexCode = vertexSource.code;
+        const std::string &fragmentCode = fragmentSource.code;
+        const std::string &geometryCode = geometrySource.code;
+        bool cacheable = programBinarySupported();
+        std::string cachePath;
+        if (cacheable)
+        {
+            cachePath = cacheDir + "/" + programCacheKey(vertexCode, fragmentCode, geometryCode) + ".bin";
+            if (loadCachedProgram(cachePath))
+                return;
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        const char *vShaderCode = vertexCode.c_str();
+        const char *fShaderCode = fragmentCode.c_str();
+        // 2. compile shaders
+        unsigned int vertex, fragment;
+        // vertex shader
+        vertex = glCreateShader(GL_VERTEX_SHADER);
+        glShaderSource(vertex, 1, &vShaderCode, NULL);
+        glCompileShader(vertex);
+        if (!checkCompileErrors(vertex, "VERTEX"))
+            ShaderPreprocessor::printSourceFiles(vertexSource);
+        // fragment Shader
+        fragment = glCreateShader(GL_FRAGMENT_SHADER);
+        glShaderSource(fragment, 1, &fShaderCode, NULL);
+        glCompileShader(fragment);
+        if (!checkCompileErrors(fragment, "FRAGMENT"))
+            ShaderPreprocessor::printSourceFiles(fragmentSource);
+        // if geometry shader is given, compile geometry shader
+        unsigned int geometry = 0;
+        if (!geometryCode.empty())
+        {
+            const char *gShaderCode = geometryCode.c_str();
+            geometry = glCreateShader(GL_GEOMETRY_SHADER);
+            glShaderSource(geometry, 1, &gShaderCode, NULL);
+            glCompileShader(geometry);
+            if (!checkCompileErrors(geometry, "GEOMETRY"))
+                ShaderPreprocessor::printSourceFiles(geometrySource);
+        }
+        // shader Program
+        ID = glCreateProgram();
+        glAttachShader(ID, vertex);
+        glAttachShader(ID, fragment);
+        if (geometry != 0)
+            glAttachShader(ID, geometry);
+        if (cacheable)
+            glProgramParameteri(ID, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+        glLinkProgram(ID);
+        bool linked = checkCompileErrors(ID, "PROGRAM");
+        // delete the shaders as they're linked into our program now and no longer necessery
+        glDeleteShader(vertex);
+        glDeleteShader(fragment);
+        if (geometry != 0)
+            glDeleteShader(geometry);
+
+        cacheStats.misses++;
+        cacheStats.compileMs += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        if (cacheable && linked)
+            storeProgramBinary(cachePath);
+        reflectUniforms();
+        bindUniformBlocks();
+    }
+
+    // compute program, cached the same way under its own key
+    // ------------------------------------------------------------------------
+    void buildComputeProgram(const ShaderSource &computeSource)
+    {
+        const std::string &computeCode = computeSource.code;
+        bool cacheable = programBinarySupported();
+        std::string cachePath;
+        if (cacheable)
+        {
+            cachePath = cacheDir + "/" + programCacheKey("\x03" + computeCode, "", "") + ".bin";
+            if (loadCachedProgram(cachePath))
+                return;
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        const char *cShaderCode = computeCode.c_str();
+        unsigned int compute = glCreateShader(GL_COMPUTE_SHADER);
+        glShaderSource(compute, 1, &cShaderCode, NULL);
+        glCompileShader(compute);
+        if (!checkCompileErrors(compute, "COMPUTE"))
+            ShaderPreprocessor::printSourceFiles(computeSource);
+        ID = glCreateProgram();
+        glAttachShader(ID, compute);
+        if (cacheable)
+            glProgramParameteri(ID, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+        glLinkProgram(ID);
+        bool linked = checkCompileErrors(ID, "PROGRAM");
+        glDeleteShader(compute);
+
+        cacheStats.misses++;
+        cacheStats.compileMs += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        if (cacheable && linked)
+            storeProgramBinary(cachePath);
+        reflectUniforms();
+        bindUniformBlocks();
+    }
+    bool loadCachedProgram(const std::string &cachePath)
+    {
+        auto start = std::chrono::steady_clock::now();
+        if (loadProgramBinary(cachePath))
+        {
+            cacheStats.hits++;
+            cacheStats.loadMs += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+            reflectUniforms();
+            bindUniformBlocks();
+            return true;
+        }
+        if (std::filesystem::exists(cachePath))
+            cacheStats.rejected++;
+        return false;
+    }
+
+    // query every active uniform once after linking. arrays of basic types are
+    // reported as "name[0]" with a size, so expand them to "name" and "name[i]"
+    // ------------------------------------------------------------------------
+    void reflectUniforms()
+    {
+        uniformLocations.clear();
+        GLint count = 0, maxLength = 0;
+        glGetProgramiv(ID, GL_ACTIVE_UNIFORMS, &count);
+        glGetProgramiv(ID, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxLength);
+        if (count <= 0)
+            return;
+        std::string buffer(maxLength > 0 ? maxLength : 1, '\0');
+        for (GLint i = 0; i < count; i++)
+        {
+            GLsizei length = 0;
+            GLint size = 0;
+            GLenum type = 0;
+            glGetActiveUniform(ID, (GLuint)i, maxLength, &length, &size, &type, &buffer[0]);
+            std::string name(buffer.data(), length);
+            GLint location = glGetUniformLocation(ID, name.c_str());
+            if (location == -1)
+                continue; // uniform block member, set through its buffer
+            uniformLocations[name] = location;
+
+            if (name.size() < 3 || name.compare(name.size() - 3, 3, "[0]") != 0)
+                continue;
+            std::string base = name.substr(0, name.size() - 3);
+            uniformLocations[base] = location;
+            for (GLint element = 1; element < size; element++)
+            {
+                std::string elementName = base + "[" + std::to_string(element) + "]";
+                uniformLocations[elementName] = glGetUniformLocation(ID, elementName.c_str());
+            }
+        }
+    }
+
+    // attach every known uniform block this program declares to its shared binding point
+    // ------------------------------------------------------------------------
+    void bindUniformBlocks()
+    {
+        for (const auto &binding : uniformBlockBindings)
+        {
+            GLuint blockIndex = glGetUniformBlockIndex(ID, binding.first.c_str());
+            if (blockIndex != GL_INVALID_INDEX)
+                glUniformBlockBinding(ID, blockIndex, binding.second);
+        }
+    }
+
+    static void upload(GLint location, bool value) { glUniform1i(location, (int)value); }
+    static void upload(GLint location, int value) { glUniform1i(location, value); }
+    static void upload(GLint location, float value) { glUniform1f(location, value); }
+    static void upload(GLint location, const glm::vec2 &value) { glUniform2fv(location, 1, &value[0]); }
+    static void upload(GLint location, const glm::vec3 &value) { glUniform3fv(location, 1, &value[0]); }
+    static void upload(GLint location, const glm::vec4 &value) { glUniform4fv(location, 1, &value[0]); }
+    static void upload(GLint location, const glm::mat2 &mat) { glUniformMatrix2fv(location, 1, GL_FALSE, &mat[0][0]); }
+    static void upload(GLint location, const glm::mat3 &mat) { glUniformMatrix3fv(location, 1, GL_FALSE, &mat[0][0]); }
+    static void upload(GLint location, const glm::mat4 &mat) { glUniformMatrix4fv(location, 1, GL_FALSE, &mat[0][0]); }
+
+    static void uploadArray(GLint location, const int *values, GLsizei count) { glUniform1iv(location, count, values); }
+    static void uploadArray(GLint location, const float *values, GLsizei count) { glUniform1fv(location, count, values); }
+    static void uploadArray(GLint location, const glm::vec2 *values, GLsizei count) { glUniform2fv(location, count, &values[0][0]); }
+    static void uploadArray(GLint location, const glm::vec3 *values, GLsizei count) { glUniform3fv(location, count, &values[0][0]); }
+    static void uploadArray(GLint location, const glm::vec4 *values, GLsizei count) { glUniform4fv(location, count, &values[0][0]); }
+    static void uploadArray(GLint location, const glm::mat4 *values, GLsizei count) { glUniformMatrix4fv(location, count, GL_FALSE, &values[0][0][0]); }
+
     // utility function for checking shader compilation/linking errors.
     // ------------------------------------------------------------------------
-    void checkCompileErrors(GLuint shader, std::string type)
+    bool checkCompileErrors(GLuint shader, std::string type)
     {
         GLint success;
         GLchar infoLog[1024];
@@ -205,6 +491,7 @@ private:
                           << infoLog << "\n -- --------------------------------------------------- -- " << std::endl;
             }
         }
+        return success;
     }
 };
 
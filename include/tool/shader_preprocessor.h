@@ -0,0 +1,186 @@
+#ifndef SHADER_PREPROCESSOR_H
+#define SHADER_PREPROCESSOR_H
+
+#include <string>
+#include <vector>
+#include <map>
+#include <set>
+#include <fstream>
+#include <sstream>
+#include <iostream>
+#include <filesystem>
+
+// caller supplied defines, injected right after #version. std::map keeps them
+// sorted so the same set always produces the same source and the same key
+// ------------------------------------------------------------------------
+typedef std::map<std::string, std::string> ShaderDefines;
+
+// a fully expanded stage, ready for glShaderSource
+// ------------------------------------------------------------------------
+struct ShaderSource
+{
+    std::string code;
+    std::vector<std::string> files; // index = source string number used in #line
+    bool loaded = false;
+};
+
+// minimal GLSL preprocessor: resolves #include "file" (relative to the including
+// file first, then every directory in includeDirs), includes each file only once
+// and keeps #line directives so compile errors point at the right file
+// ------------------------------------------------------------------------
+class ShaderPreprocessor
+{
+public:
+    inline static std::vector<std::string> includeDirs = {"./static/shader"};
+
+    static ShaderSource load(const std::string &path, const ShaderDefines &defines = ShaderDefines())
+    {
+        ShaderSource source;
+        std::set<std::string> included;
+        source.loaded = expand(path, source, included, 0);
+        if (!source.loaded)
+            return source;
+        injectDefines(source.code, defines);
+        return source;
+    }
+
+    // "A=1;B;C=2" style key, stable for a given set of defines
+    // ------------------------------------------------------------------------
+    static std::string definesKey(const ShaderDefines &defines)
+    {
+        std::string key;
+        for (const auto &define : defines)
+        {
+            key += define.first;
+            if (!define.second.empty())
+                key += "=" + define.second;
+            key += ";";
+        }
+        return key;
+    }
+
+    // FNV-1a over the expanded sources, used to key programs by their content
+    // ------------------------------------------------------------------------
+    static unsigned long long hash(const std::string &text, unsigned long long hash = 14695981039346656037ULL)
+    {
+        for (unsigned char c : text)
+        {
+            hash ^= c;
+            hash *= 1099511628211ULL;
+        }
+        return hash;
+    }
+
+    static void printSourceFiles(const ShaderSource &source)
+    {
+        for (size_t i = 0; i < source.files.size(); i++)
+            std::cout << "  source " << i << ": " << source.files[i] << std::endl;
+    }
+
+private:
+    static bool expand(const std::string &path, ShaderSource &source, std::set<std::string> &included, int depth)
+    {
+        if (depth > 32)
+        {
+            std::cout << "ERROR::SHADER::INCLUDE_TOO_DEEP: " << path << std::endl;
+            return false;
+        }
+        std::ifstream file(path);
+        if (!file)
+        {
+            std::cout << "ERROR::SHADER::FILE_NOT_SUCCESFULLY_READ: " << path << std::endl;
+            return false;
+        }
+
+        int sourceIndex = (int)source.files.size();
+        source.files.push_back(path);
+        if (depth > 0)
+            source.code += "#line 1 " + std::to_string(sourceIndex) + "\n";
+
+        std::string line;
+        int lineNumber = 0;
+        while (std::getline(file, line))
+        {
+            lineNumber++;
+            std::string includePath;
+            if (!parseInclude(line, includePath))
+            {
+                source.code += line;
+                source.code += "\n";
+                continue;
+            }
+
+            std::string resolved = resolveInclude(path, includePath);
+            if (resolved.empty())
+            {
+                std::cout << "ERROR::SHADER::INCLUDE_NOT_FOUND: " << includePath << " (" << path << ":" << lineNumber << ")" << std::endl;
+                return false;
+            }
+            // every include behaves as if it had #pragma once
+            if (included.insert(resolved).second && !expand(resolved, source, included, depth + 1))
+                return false;
+            source.code += "#line " + std::to_string(lineNumber + 1) + " " + std::to_string(sourceIndex) + "\n";
+        }
+        return true;
+    }
+
+    static bool parseInclude(const std::string &line, std::string &includePath)
+    {
+        size_t start = line.find_first_not_of(" \t");
+        if (start == std::string::npos || line.compare(start, 8, "#include") != 0)
+            return false;
+        size_t open = line.find('"', start + 8);
+        size_t close = open == std::string::npos ? open : line.find('"', open + 1);
+        if (close == std::string::npos)
+            return false;
+        includePath = line.substr(open + 1, close - open - 1);
+        return true;
+    }
+
+    static std::string resolveInclude(const std::string &includer, const std::string &includePath)
+    {
+        namespace fs = std::filesystem;
+        std::vector<fs::path> candidates;
+        candidates.push_back(fs::path(includer).parent_path() / includePath);
+        for (const std::string &dir : includeDirs)
+            candidates.push_back(fs::path(dir) / includePath);
+
+        std::error_code error;
+        for (const fs::path &candidate : candidates)
+        {
+            if (fs::is_regular_file(candidate, error))
+                return candidate.lexically_normal().generic_string();
+        }
+        return "";
+    }
+
+    // defines must come after #version, which has to stay the first statement
+    // ------------------------------------------------------------------------
+    static void injectDefines(std::string &code, const ShaderDefines &defines)
+    {
+        if (defines.empty())
+            return;
+        std::string block;
+        for (const auto &define : defines)
+            block += "#define " + define.first + (define.second.empty() ? "" : " " + define.second) + "\n";
+
+        size_t version = code.find("#version");
+        if (version == std::string::npos)
+        {
+            code = block + "#line 1 0\n" + code;
+            return;
+        }
+        size_t lineEnd = code.find('\n', version);
+        if (lineEnd == std::string::npos)
+        {
+            code += "\n";
+            lineEnd = code.size() - 1;
+        }
+        int versionLine = 1;
+        for (size_t i = 0; i < version; i++)
+            versionLine += code[i] == '\n';
+        code.insert(lineEnd + 1, block + "#line " + std::to_string(versionLine + 1) + " 0\n");
+    }
+};
+
+#endif
@@ -0,0 +1,95 @@
+#ifndef SHADER_VARIANTS_H
+#define SHADER_VARIANTS_H
+
+#include <glad/glad.h>
+
+#include <string>
+#include <sstream>
+#include <unordered_map>
+
+#include <tool/shader.h>
+#include <tool/shader_preprocessor.h>
+#include <tool/render_state.h>
+
+// all permutations of one set of shader files. a permutation is compiled the
+// first time it is requested and kept for the lifetime of the object, so
+// switching features at runtime costs a hash lookup instead of a recompile
+//
+// ShaderVariants sceneShaders("./shader/scene_vert.glsl", "./shader/scene_frag.glsl");
+// Shader &shader = sceneShaders.get({{"PARALLAX", ""}});
+// ------------------------------------------------------------------------
+class ShaderVariants
+{
+public:
+    ShaderVariants(const char *vertexPath, const char *fragmentPath, const ShaderDefines &baseDefines = ShaderDefines(), const char *geometryPath = nullptr)
+        : vertexPath(Shader::resolvePath(vertexPath)), fragmentPath(Shader::resolvePath(fragmentPath)),
+          geometryPath(geometryPath != nullptr ? Shader::resolvePath(geometryPath) : ""), baseDefines(baseDefines)
+    {
+    }
+
+    // defines given here override the base defines with the same name
+    // ------------------------------------------------------------------------
+    Shader &get(const ShaderDefines &defines = ShaderDefines())
+    {
+        ShaderDefines merged = baseDefines;
+        for (const auto &define : defines)
+            merged[define.first] = define.second;
+
+        std::string definesKey = ShaderPreprocessor::definesKey(merged);
+        auto variant = variantKeys.find(definesKey);
+        if (variant != variantKeys.end())
+            return programs.at(variant->second);
+
+        // permutation key is the hash of the expanded sources, so define sets
+        // that expand to the same code share one program
+        ShaderSource vertex = ShaderPreprocessor::load(vertexPath, merged);
+        ShaderSource fragment = ShaderPreprocessor::load(fragmentPath, merged);
+        ShaderSource geometry;
+        if (!geometryPath.empty())
+            geometry = ShaderPreprocessor::load(geometryPath, merged);
+        std::string contentKey = permutationKey(vertex, fragment, geometry);
+        variantKeys[definesKey] = contentKey;
+
+        auto program = programs.find(contentKey);
+        if (program == programs.end())
+            program = programs.emplace(contentKey, Shader(vertex, fragment, geometry)).first;
+        return program->second;
+    }
+
+    unsigned int compiledCount() const
+    {
+        return programs.size();
+    }
+
+    void dispose()
+    {
+        for (auto &program : programs)
+        {
+            RenderState::forgetProgram(program.second.ID);
+            glDeleteProgram(program.second.ID);
+        }
+        programs.clear();
+        variantKeys.clear();
+    }
+
+private:
+    std::string vertexPath;
+    std::string fragmentPath;
+    std::string geometryPath;
+    ShaderDefines baseDefines;
+
+    std::unordered_map<std::string, std::string> variantKeys; // defines key -> permutation key
+    std::unordered_map<std::string, Shader> programs;         // permutation key -> program
+
+    static std::string permutationKey(const ShaderSource &vertex, const ShaderSource &fragment, const ShaderSource &geometry)
+    {
+        unsigned long long hash = ShaderPreprocessor::hash(vertex.code);
+        hash = ShaderPreprocessor::hash("\x01" + fragment.code, hash);
+        hash = ShaderPreprocessor::hash("\x02" + geometry.code, hash);
+        std::ostringstream key;
+        key << std::hex << hash;
+        return key.str();
+    }
+};
+
+#endif
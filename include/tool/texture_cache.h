@@ -0,0 +1,907 @@
+#ifndef TEXTURE_CACHE_H
+#define TEXTURE_CACHE_H
+
+#include <glad/glad.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include <tool/block_compress.h>
+#include <tool/ktx.h>
+#include <tool/mapped_file.h>
+#include <tool/mip_generator.h>
+#include <tool/parallel.h>
+#include <tool/render_state.h>
+#include <tool/texture_streamer.h>
+// 示例在 #define STB_IMAGE_IMPLEMENTATION 之后包含 stb_image.h，再次包含会重复生成实现
+#ifndef STBI_INCLUDE_STB_IMAGE_H
+#include <tool/stb_image.h>
+#endif
+#include <tool/upload_scheduler.h>
+
+// 采样和颜色空间参数，与路径一起组成缓存的键
+struct TextureParams
+{
+  GLint wrap = GL_REPEAT;
+  GLint minFilter = GL_LINEAR_MIPMAP_LINEAR; // 带 MIPMAP 的过滤方式才分配并生成 mipmap
+  GLint magFilter = GL_LINEAR;
+  bool flip = true;  // 加载时 y 轴翻转
+  bool srgb = false; // 颜色贴图使用 GL_SRGB8 / GL_SRGB8_ALPHA8，采样时转换到线性空间
+  float alphaCutoff = 0.0f; // 透明度测试的阈值，大于 0 时生成 mipmap 保持透明度覆盖率（草丛、窗户）
+  bool stream = false;      // 带 mipmap 的 2D 纹理交给 TextureStreamer 按需调入各级
+
+  // HDR 环境贴图：边缘截断，不生成 mipmap
+  static TextureParams hdr()
+  {
+    TextureParams params;
+    params.wrap = GL_CLAMP_TO_EDGE;
+    params.minFilter = GL_LINEAR;
+    return params;
+  }
+
+  // 立方体贴图：边缘截断，不翻转；mipmaps 时生成完整的 mipmap 链（例如用作反射的环境贴图）
+  static TextureParams cubemap(bool mipmaps = false)
+  {
+    TextureParams params = hdr();
+    params.flip = false;
+    if (mipmaps)
+      params.minFilter = GL_LINEAR_MIPMAP_LINEAR;
+    return params;
+  }
+
+  bool mipmaps() const
+  {
+    return minFilter != GL_LINEAR && minFilter != GL_NEAREST;
+  }
+
+  unsigned long long hash(unsigned long long seed) const
+  {
+    GLint fields[6] = {wrap, minFilter, magFilter, flip, srgb, stream};
+    return hashBytes(&alphaCutoff, sizeof(alphaCutoff), hashBytes(fields, sizeof(fields), seed));
+  }
+};
+
+// 解码后等待上传的图片，HDR 时 data 实际指向 float
+struct TextureImage
+{
+  std::string path;
+  unsigned char *data = nullptr;
+  int width = 0;
+  int height = 0;
+  int nrComponents = 0;
+  bool hdr = false;
+  unsigned long long contentHash = 0; // 文件内容的哈希
+  std::shared_ptr<KtxFile> cooked;    // 烘焙好的块压缩贴图，此时 data 为空
+  int face = 0;                       // 立方体贴图 KTX 中的面
+  std::shared_ptr<std::vector<MipLevel>> mips; // CPU 生成的第 1 级及以后的 mipmap，为空时上传后调用 glGenerateMipmap
+};
+
+struct TextureCacheStats
+{
+  unsigned int hits = 0;        // 路径和参数相同，直接复用
+  unsigned int contentHits = 0; // 路径不同但文件内容相同，复用并记住新路径
+  unsigned int misses = 0;      // 新上传的纹理
+  unsigned int failed = 0;      // 文件不存在或无法解码
+  unsigned int cooked = 0;      // 使用烘焙好的块压缩贴图上传
+};
+
+// 进程内共享的纹理缓存，所有示例和 Model 都从这里加载纹理
+//
+// 先按（类型、规范化路径、参数）查找；未命中时读取文件，再按（文件内容、参数）查找，
+// 不同路径指向相同内容的文件也只上传一次。每次加载持有一个引用，release() 减到 0 时删除纹理。
+// GL 4.2 起使用不可变存储（glTexStorage2D），否则逐级 glTexImage2D 并限制 GL_TEXTURE_MAX_LEVEL
+// UploadScheduler::enabled 时存储立即分配，像素数据交给 UploadScheduler 在之后的帧里上传
+//
+// src/tools/texture_cooker 把图片烘焙成带完整 mipmap 的 BCn 压缩 KTX（见 cookedPath()）。
+// 解码时如果存在与源文件内容哈希、翻转方向都一致的 KTX，直接映射它，跳过解码和 mipmap 生成；
+// 驱动不支持该压缩格式（例如没有 S3TC）时在上传前改为解码源文件
+//
+// TextureParams::stream 的 2D 纹理只上传低精度的几级，其余级别由 TextureStreamer 按绘制时的请求和显存预算调入、移出
+//
+// cpuMipmaps 时 mipmap 在解码线程上由 MipGenerator 生成（颜色贴图在线性空间平均、法线重新归一化、
+// alphaCutoff 保持覆盖率），上传时逐级 glTexSubImage2D；HDR 仍然使用 glGenerateMipmap
+//
+// 立方体贴图的六个面在多个线程上并行解码，大小必须相同，与 2D 纹理一样一次分配全部存储。
+// 也可以从一张十字形展开图或六个面的 KTX 加载（loadCubemap(path)）；texture_cooker 把六个面烘焙成一个 KTX
+// （cookedCubemapPath()），源文件内容一致时 loadCubemap(faces) 直接使用它
+class TextureCache
+{
+public:
+  inline static TextureCacheStats stats;
+  inline static bool useCooked = true;
+  inline static std::string cookedDir = "./output/cooked";
+  inline static bool cpuMipmaps = true;
+
+  static unsigned int load(const std::string &path, const TextureParams &params = TextureParams())
+  {
+    std::string cacheKey = key(path, params);
+    unsigned int id = acquire(cacheKey);
+    if (id != 0)
+      return id;
+    TextureImage image = decode(path, params);
+    return insert(cacheKey, params, image);
+  }
+
+  // stbi_loadf 解码为浮点，上传为 GL_RGB16F 等半精度格式
+  static unsigned int loadHdr(const std::string &path, const TextureParams &params = TextureParams::hdr())
+  {
+    std::string cacheKey = makeKey('H', {path}, params);
+    unsigned int id = acquire(cacheKey);
+    if (id != 0)
+      return id;
+    std::vector<TextureImage> images;
+    images.push_back(decode(path, params, true));
+    return insertImages(cacheKey, GL_TEXTURE_2D, params, images);
+  }
+
+  // faces 依次为 +X, -X, +Y, -Y, +Z, -Z
+  static unsigned int loadCubemap(const std::vector<std::string> &faces, const TextureParams &params = TextureParams::cubemap())
+  {
+    std::string cacheKey = makeKey('C', faces, params);
+    unsigned int id = acquire(cacheKey);
+    if (id != 0)
+      return id;
+    std::vector<TextureImage> images;
+    if (!useCooked || !openCookedCubemap(faces, params, images))
+    {
+      images.assign(faces.size(), TextureImage());
+      Parallel::forEach(faces.size(), [&](size_t i)
+                        { images[i] = decodeFile(faces[i], params, false, false); });
+    }
+    return insertImages(cacheKey, GL_TEXTURE_CUBE_MAP, params, images);
+  }
+
+  // 单个文件中的立方体贴图：
+  //   .ktx             六个面的 KTX，块压缩格式或 8 位的 GL_RED/RG/RGB/RGBA
+  //   宽高比 4:3       横向十字，中间一行依次为 -X, +Z, +X, -Z，+Y 在 +Z 上方，-Y 在 +Z 下方
+  //   宽高比 3:4       纵向十字，与横向十字相同，-Z 在 -Y 下方并旋转 180 度
+  //   宽高比 6:1 / 1:6 按 +X, -X, +Y, -Y, +Z, -Z 排列的长条
+  static unsigned int loadCubemap(const std::string &path, const TextureParams &params = TextureParams::cubemap())
+  {
+    std::string cacheKey = makeKey('C', {path}, params);
+    unsigned int id = acquire(cacheKey);
+    if (id != 0)
+      return id;
+    std::string extension = std::filesystem::path(path).extension().string();
+    std::transform(extension.begin(), extension.end(), extension.begin(), [](unsigned char c)
+                   { return (char)std::tolower(c); });
+    std::vector<TextureImage> images = extension == ".ktx" ? decodeKtxCubemap(path, params) : decodeCross(path, params);
+    return insertImages(cacheKey, GL_TEXTURE_CUBE_MAP, params, images);
+  }
+
+  // 以下四个函数把 load() 拆开，供需要在其他线程上解码的调用方使用（见 Model::loadPendingTextures）
+  // ------------------------------------------------------------------------
+  static std::string key(const std::string &path, const TextureParams &params)
+  {
+    return makeKey('T', {path}, params);
+  }
+
+  // 已缓存时增加引用并返回纹理，否则返回 0
+  static unsigned int acquire(const std::string &cacheKey)
+  {
+    auto found = byKey.find(cacheKey);
+    if (found == byKey.end())
+      return 0;
+    entries[found->second].refCount++;
+    stats.hits++;
+    return found->second;
+  }
+
+  // 不调用 gl 函数，可以在任意线程上执行
+  static TextureImage decode(const std::string &path, const TextureParams &params, bool hdr = false)
+  {
+    return decodeFile(path, params, hdr, useCooked && !hdr);
+  }
+
+  // 源文件烘焙后的位置：当前目录下的文件保持相对路径（static/texture/wood.png -> <cookedDir>/static/texture/wood.png.ktx），
+  // 其他位置的文件用规范化路径的哈希命名。不翻转的版本另存为 .noflip.ktx，两种方向可以同时存在
+  static std::string cookedPath(const std::string &path, bool flip = true)
+  {
+    const char *extension = flip ? ".ktx" : ".noflip.ktx";
+    std::error_code error;
+    std::filesystem::path canonical = std::filesystem::weakly_canonical(path, error);
+    if (error)
+      canonical = path;
+    std::filesystem::path relative = canonical.lexically_relative(std::filesystem::current_path(error));
+    if (error || relative.empty() || *relative.begin() == "..")
+      return cookedDir + "/" + std::to_string(hashBytes(canonical.generic_string().data(), canonical.generic_string().size())) + extension;
+    return cookedDir + "/" + relative.generic_string() + extension;
+  }
+
+  // 烘焙时记录的透明度阈值，没有阈值时为空字符串（不写入）
+  static std::string alphaCutoffValue(float alphaCutoff)
+  {
+    return alphaCutoff > 0.0f ? std::to_string(alphaCutoff) : std::string();
+  }
+
+  // 六个面烘焙成的立方体贴图 KTX，放在第一个面所在目录对应的位置（static/texture/skybox -> <cookedDir>/static/texture/skybox/cubemap.ktx）
+  static std::string cookedCubemapPath(const std::vector<std::string> &faces)
+  {
+    std::string directory = std::filesystem::path(faces.empty() ? std::string() : faces[0]).parent_path().generic_string();
+    return cookedPath((directory.empty() ? std::string(".") : directory) + "/cubemap");
+  }
+
+  // 立方体贴图 KTX 中记录的源文件哈希，由六个面各自的内容哈希按顺序组合
+  static unsigned long long cubemapSourceHash(const std::vector<unsigned long long> &faceHashes)
+  {
+    return hashBytes(faceHashes.data(), faceHashes.size() * sizeof(unsigned long long));
+  }
+
+  // 写入 KTX 的方向标记，与 TextureParams::flip 对应（KTX 规范中的 KTXorientation）
+  static const char *orientation(bool flip)
+  {
+    return flip ? "S=r,T=u" : "S=r,T=d";
+  }
+
+  // 当前上下文能否直接使用这种块压缩格式，需要在持有 GL 上下文的线程上调用
+  static bool compressedSupported(BlockFormat format, bool srgb)
+  {
+    switch (format)
+    {
+    case BlockFormat::BC1:
+    case BlockFormat::BC3:
+      return hasExtension("GL_EXT_texture_compression_s3tc") && (!srgb || hasExtension("GL_EXT_texture_sRGB"));
+    case BlockFormat::BC7:
+      return GLAD_GL_VERSION_4_2 || hasExtension("GL_ARB_texture_compression_bptc");
+    default:
+      return true; // RGTC 是 GL 3.0 的核心功能
+    }
+  }
+
+  // 需要 GL 上下文，image 的像素在返回前释放
+  static unsigned int insert(const std::string &cacheKey, const TextureParams &params, TextureImage &image)
+  {
+    std::vector<TextureImage> images;
+    images.push_back(image);
+    image.data = nullptr;
+    image.mips.reset();
+    return insertImages(cacheKey, GL_TEXTURE_2D, params, images);
+  }
+
+  // ------------------------------------------------------------------------
+  static void release(unsigned int id)
+  {
+    auto found = entries.find(id);
+    if (found == entries.end())
+      return;
+    if (--found->second.refCount > 0)
+      return;
+    for (const std::string &cacheKey : found->second.keys)
+      byKey.erase(cacheKey);
+    byContent.erase(found->second.contentKey);
+    entries.erase(found);
+    UploadScheduler::cancelTexture(id);
+    TextureStreamer::remove(id);
+    RenderState::forgetTexture(id);
+    glDeleteTextures(1, &id);
+  }
+
+  static size_t textureCount()
+  {
+    return entries.size();
+  }
+
+  // 估算的显存占用，包括 mipmap；流式纹理只计算常驻的级别
+  static size_t byteCount()
+  {
+    size_t bytes = 0;
+    for (const auto &entry : entries)
+      bytes += TextureStreamer::contains(entry.first) ? TextureStreamer::residentBytes(entry.first) : entry.second.bytes;
+    return bytes;
+  }
+
+  static void printStats()
+  {
+    std::cout << "TEXTURE_CACHE textures: " << textureCount() << ", " << byteCount() / (1024.0 * 1024.0) << " MB"
+              << ", hits: " << stats.hits << ", content hits: " << stats.contentHits
+              << ", misses: " << stats.misses << ", failed: " << stats.failed << ", cooked: " << stats.cooked << std::endl;
+  }
+
+  // GL 4.2 起使用 glTexStorage2D
+  static bool immutableStorage()
+  {
+    return GLAD_GL_VERSION_4_2 != 0;
+  }
+
+private:
+  struct Entry
+  {
+    unsigned int refCount = 0;
+    std::vector<std::string> keys; // 指向这个纹理的所有路径键
+    unsigned long long contentKey = 0;
+    size_t bytes = 0;
+  };
+
+  inline static std::unordered_map<std::string, unsigned int> byKey;
+  inline static std::unordered_map<unsigned long long, unsigned int> byContent;
+  inline static std::unordered_map<unsigned int, Entry> entries;
+
+  // 键的第一个字符区分类型：T 普通纹理，H HDR，C 立方体贴图
+  static std::string makeKey(char kind, const std::vector<std::string> &paths, const TextureParams &params)
+  {
+    std::string cacheKey(1, kind);
+    cacheKey += std::to_string(params.hash(14695981039346656037ULL));
+    for (const std::string &path : paths)
+    {
+      std::error_code error;
+      std::filesystem::path canonical = std::filesystem::weakly_canonical(path, error);
+      cacheKey += '|';
+      cacheKey += error ? path : canonical.generic_string();
+    }
+    return cacheKey;
+  }
+
+  static TextureImage decodeFile(const std::string &path, const TextureParams &params, bool hdr, bool allowCooked)
+  {
+    TextureImage image;
+    image.path = path;
+    image.hdr = hdr;
+    MappedFile file(path);
+    if (!file.valid())
+      return image;
+    image.contentHash = hashBytes(file.data(), file.size());
+    if (allowCooked && openCooked(image, params))
+      return image;
+    // stb 的线程翻转标志设置后不能撤销，之后这个线程不再使用全局的 stbi_set_flip_vertically_on_load。
+    // 解码放到 Parallel 的工作线程上，调用线程（通常是 GL 线程）上示例自己的全局设置照常生效
+    Parallel::runOnWorker([&]()
+                          {
+                            stbi_set_flip_vertically_on_load_thread(params.flip);
+                            if (hdr)
+                              image.data = (unsigned char *)stbi_loadf_from_memory(file.data(), (int)file.size(), &image.width, &image.height, &image.nrComponents, 0);
+                            else
+                              image.data = stbi_load_from_memory(file.data(), (int)file.size(), &image.width, &image.height, &image.nrComponents, 0); });
+    generateMips(image, params, MipGenerator::guess(path));
+    return image;
+  }
+
+  // 烘焙结果的源文件哈希、方向和透明度阈值都与这次加载一致时使用它
+  static bool openCooked(TextureImage &image, const TextureParams &params)
+  {
+    std::string cooked = cookedPath(image.path, params.flip);
+    std::error_code error;
+    if (!std::filesystem::exists(cooked, error))
+      return false;
+    std::shared_ptr<KtxFile> ktx = std::make_shared<KtxFile>(cooked);
+    BlockFormat block;
+    if (!ktx->valid() || ktx->faces != 1 || !BlockCompress::fromInternalFormat(ktx->internalFormat, block) ||
+        ktx->value("sourceHash") != std::to_string(image.contentHash) || ktx->value("KTXorientation") != orientation(params.flip) ||
+        ktx->value("alphaCutoff") != alphaCutoffValue(params.alphaCutoff))
+      return false;
+    GLenum base = BlockCompress::baseFormat(block);
+    image.nrComponents = base == GL_RED ? 1 : base == GL_RG ? 2 : base == GL_RGB ? 3 : 4;
+    image.width = ktx->width;
+    image.height = ktx->height;
+    image.cooked = ktx;
+    return true;
+  }
+
+  // 所有面都烘焙过、格式相同且驱动支持时才使用烘焙结果，否则全部改为解码源文件
+  static void resolveCooked(std::vector<TextureImage> &images, const TextureParams &params)
+  {
+    bool anyCooked = false, usable = true;
+    for (const TextureImage &image : images)
+    {
+      anyCooked = anyCooked || image.cooked;
+      BlockFormat block;
+      usable = usable && image.cooked && image.cooked->internalFormat == images[0].cooked->internalFormat &&
+               image.cooked->levels == images[0].cooked->levels && BlockCompress::fromInternalFormat(image.cooked->internalFormat, block) &&
+               compressedSupported(block, params.srgb);
+    }
+    if (!anyCooked || usable)
+      return;
+    Parallel::forEach(images.size(), [&](size_t i)
+                      {
+                        if (images[i].cooked)
+                          images[i] = decodeFile(images[i].path, params, images[i].hdr, false); });
+  }
+
+  // 六个面的内容哈希与烘焙结果一致时使用它，不解码任何一个面
+  static bool openCookedCubemap(const std::vector<std::string> &faces, const TextureParams &params, std::vector<TextureImage> &images)
+  {
+    std::string cooked = cookedCubemapPath(faces);
+    std::error_code error;
+    if (faces.size() != 6 || !std::filesystem::exists(cooked, error))
+      return false;
+    std::vector<unsigned long long> hashes;
+    for (const std::string &face : faces)
+    {
+      MappedFile file(face);
+      if (!file.valid())
+        return false;
+      hashes.push_back(hashBytes(file.data(), file.size()));
+    }
+    std::shared_ptr<KtxFile> ktx = std::make_shared<KtxFile>(cooked);
+    if (!ktx->valid() || ktx->faces != 6 || ktx->value("sourceHash") != std::to_string(cubemapSourceHash(hashes)) ||
+        ktx->value("KTXorientation") != orientation(params.flip))
+      return false;
+    images = cubemapImages(cooked, ktx);
+    if (images.empty())
+      return false;
+    for (size_t i = 0; i < images.size(); i++)
+    {
+      images[i].path = faces[i];
+      images[i].contentHash = hashes[i];
+    }
+    return true;
+  }
+
+  // 块压缩的 KTX 直接引用映射的数据，8 位未压缩的复制每个面的第 0 级，再按 params 生成 mipmap
+  static std::vector<TextureImage> cubemapImages(const std::string &path, const std::shared_ptr<KtxFile> &ktx)
+  {
+    std::vector<TextureImage> images(6);
+    BlockFormat block;
+    bool compressed = ktx->compressed() && BlockCompress::fromInternalFormat(ktx->internalFormat, block);
+    int channels = ktx->format == GL_RED ? 1 : ktx->format == GL_RG ? 2 : ktx->format == GL_RGB ? 3 : ktx->format == GL_RGBA ? 4 : 0;
+    if (!compressed && (ktx->compressed() || ktx->type != GL_UNSIGNED_BYTE || channels == 0))
+    {
+      std::cout << "Unsupported cubemap KTX format: " << path << std::endl;
+      return {};
+    }
+    if (compressed)
+    {
+      GLenum base = BlockCompress::baseFormat(block);
+      channels = base == GL_RED ? 1 : base == GL_RG ? 2 : base == GL_RGB ? 3 : 4;
+    }
+    for (int face = 0; face < 6; face++)
+    {
+      TextureImage &image = images[face];
+      image.path = path;
+      image.width = ktx->width;
+      image.height = ktx->height;
+      image.nrComponents = channels;
+      image.contentHash = hashBytes(&face, sizeof(face), hashBytes(path.data(), path.size()));
+      image.face = face;
+      if (compressed)
+      {
+        image.cooked = ktx;
+        continue;
+      }
+      // KTX 的每行按 4 字节对齐（KtxFile 打开时已检查每级的大小），复制时去掉填充
+      const KtxLevel &level = ktx->level(0, face);
+      size_t rowBytes = (size_t)image.width * channels, stride = (rowBytes + 3) & ~(size_t)3;
+      image.data = (unsigned char *)malloc(rowBytes * image.height); // stbi_image_free 默认就是 free
+      for (int y = 0; y < image.height; y++)
+        memcpy(image.data + y * rowBytes, level.data + y * stride, rowBytes);
+    }
+    return images;
+  }
+
+  static std::vector<TextureImage> decodeKtxCubemap(const std::string &path, const TextureParams &params)
+  {
+    std::shared_ptr<KtxFile> ktx = std::make_shared<KtxFile>(path);
+    if (!ktx->valid() || ktx->faces != 6)
+    {
+      std::cout << "Cubemap KTX needs 6 faces: " << path << std::endl;
+      return {};
+    }
+    std::vector<TextureImage> images = cubemapImages(path, ktx);
+    Parallel::forEach(images.size(), [&](size_t i)
+                      { generateMips(images[i], params, MipFilter::Srgb); });
+    return images;
+  }
+
+  // 十字形或长条形的展开图，解码后切出六个面，每个面单独生成 mipmap
+  static std::vector<TextureImage> decodeCross(const std::string &path, const TextureParams &params)
+  {
+    TextureParams whole = params;
+    whole.flip = false; // 按展开图原本的方向切分，翻转在切出的面上做
+    whole.minFilter = GL_LINEAR;
+    TextureImage source = decodeFile(path, whole, false, false);
+    if (source.data == nullptr)
+    {
+      std::cout << "Texture failed to load at path: " << path << std::endl;
+      return {};
+    }
+
+    // 每个面在展开图中的（列，行），顺序为 +X, -X, +Y, -Y, +Z, -Z
+    static const int horizontalCross[6][2] = {{2, 1}, {0, 1}, {1, 0}, {1, 2}, {1, 1}, {3, 1}};
+    static const int verticalCross[6][2] = {{2, 1}, {0, 1}, {1, 0}, {1, 2}, {1, 1}, {1, 3}};
+    static const int horizontalStrip[6][2] = {{0, 0}, {1, 0}, {2, 0}, {3, 0}, {4, 0}, {5, 0}};
+    static const int verticalStrip[6][2] = {{0, 0}, {0, 1}, {0, 2}, {0, 3}, {0, 4}, {0, 5}};
+    const int(*layout)[2] = nullptr;
+    int size = 0;
+    bool vertical = false;
+    if (source.width * 3 == source.height * 4)
+    {
+      layout = horizontalCross;
+      size = source.width / 4;
+    }
+    else if (source.width * 4 == source.height * 3)
+    {
+      layout = verticalCross;
+      size = source.width / 3;
+      vertical = true;
+    }
+    else if (source.width == source.height * 6)
+    {
+      layout = horizontalStrip;
+      size = source.height;
+    }
+    else if (source.width * 6 == source.height)
+    {
+      layout = verticalStrip;
+      size = source.width;
+    }
+    if (layout == nullptr || size == 0)
+    {
+      std::cout << "Cubemap image is not a 4:3 / 3:4 cross or a 6:1 / 1:6 strip: " << path << std::endl;
+      stbi_image_free(source.data);
+      return {};
+    }
+
+    std::vector<TextureImage> images(6);
+    int channels = source.nrComponents;
+    size_t rowBytes = (size_t)size * channels;
+    Parallel::forEach(images.size(), [&](size_t face)
+                      {
+                        TextureImage &image = images[face];
+                        image.path = path;
+                        image.width = size;
+                        image.height = size;
+                        image.nrComponents = channels;
+                        image.contentHash = hashBytes(&face, sizeof(face), source.contentHash);
+                        image.data = (unsigned char *)malloc(rowBytes * size); // stbi_image_free 默认就是 free
+                        // 纵向十字的 -Z 上下左右都是反的
+                        bool rotate = vertical && face == 5;
+                        for (int y = 0; y < size; y++)
+                        {
+                          int sourceY = layout[face][1] * size + (rotate ? size - 1 - y : y);
+                          const unsigned char *row = source.data + ((size_t)sourceY * source.width + (size_t)layout[face][0] * size) * channels;
+                          unsigned char *out = image.data + (size_t)(params.flip ? size - 1 - y : y) * rowBytes;
+                          if (!rotate)
+                            memcpy(out, row, rowBytes);
+                          else
+                            for (int x = 0; x < size; x++)
+                              memcpy(out + (size_t)x * channels, row + (size_t)(size - 1 - x) * channels, channels);
+                        }
+                        generateMips(image, params, MipGenerator::guess(path));
+                      });
+    stbi_image_free(source.data);
+    return images;
+  }
+
+  static void generateMips(TextureImage &image, const TextureParams &params, MipFilter filter)
+  {
+    if (image.data != nullptr && !image.hdr && cpuMipmaps && params.mipmaps())
+      image.mips = std::make_shared<std::vector<MipLevel>>(
+          MipGenerator::generate(image.data, image.width, image.height, image.nrComponents, filter, params.alphaCutoff));
+  }
+
+  static bool hasExtension(const char *name)
+  {
+    static std::unordered_set<std::string> extensions;
+    static bool queried = false;
+    if (!queried)
+    {
+      GLint count = 0;
+      glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+      for (GLint i = 0; i < count; i++)
+        extensions.insert((const char *)glGetStringi(GL_EXTENSIONS, i));
+      queried = true;
+    }
+    return extensions.count(name) != 0;
+  }
+
+  static unsigned int insertImages(const std::string &cacheKey, GLenum target, const TextureParams &params, std::vector<TextureImage> &images)
+  {
+    unsigned int id = 0;
+    resolveCooked(images, params);
+    if (validate(images, target))
+    {
+      unsigned long long contentKey = params.hash(hashBytes(cacheKey.data(), 1));
+      for (const TextureImage &image : images)
+        contentKey = hashBytes(&image.contentHash, sizeof(image.contentHash), contentKey);
+
+      auto found = byContent.find(contentKey);
+      if (found != byContent.end())
+      {
+        id = found->second;
+        Entry &entry = entries[id];
+        entry.refCount++;
+        entry.keys.push_back(cacheKey);
+        byKey[cacheKey] = id;
+        stats.contentHits++;
+      }
+      else
+      {
+        Entry entry;
+        id = upload(target, params, images, entry.bytes);
+        entry.refCount = 1;
+        entry.keys.push_back(cacheKey);
+        entry.contentKey = contentKey;
+        entries[id] = entry;
+        byKey[cacheKey] = id;
+        byContent[contentKey] = id;
+        stats.misses++;
+      }
+    }
+    else
+      stats.failed++;
+
+    for (TextureImage &image : images)
+    {
+      stbi_image_free(image.data);
+      image.data = nullptr;
+      image.mips.reset();
+    }
+    return id;
+  }
+
+  // 所有图片都解码成功，立方体贴图的六个面大小和通道数相同
+  static bool validate(const std::vector<TextureImage> &images, GLenum target)
+  {
+    if (images.empty() || (target == GL_TEXTURE_CUBE_MAP && images.size() != 6))
+    {
+      std::cout << "Cubemap texture needs 6 faces, got " << images.size() << std::endl;
+      return false;
+    }
+    for (const TextureImage &image : images)
+    {
+      if (image.data == nullptr && !image.cooked)
+      {
+        std::cout << "Texture failed to load at path: " << image.path << std::endl;
+        return false;
+      }
+      if (image.width != images[0].width || image.height != images[0].height || image.nrComponents != images[0].nrComponents)
+      {
+        std::cout << "Cubemap face does not match the first face: " << image.path << std::endl;
+        return false;
+      }
+    }
+    return true;
+  }
+
+  static unsigned int upload(GLenum target, const TextureParams &params, std::vector<TextureImage> &images, size_t &bytes)
+  {
+    unsigned int id;
+    glGenTextures(1, &id);
+    // 活动纹理单元可能被直接调用 gl 的代码改过，先切回 0；
+    // 新纹理可能复用了绕过 RenderState 删除的纹理名，先清掉旧记录，保证这次绑定一定发出
+    glActiveTexture(GL_TEXTURE0);
+    RenderState::forgetTexture(id);
+    RenderState::bindTexture(0, target, id);
+    bytes = images[0].cooked ? uploadCooked(id, target, params, images) : uploadPixels(id, target, params, images);
+    // 带 mipmap 的立方体贴图在面的接缝处跨面过滤，否则低级别上能看到明显的边
+    if (target == GL_TEXTURE_CUBE_MAP && params.mipmaps())
+      glEnable(GL_TEXTURE_CUBE_MAP_SEAMLESS);
+
+    glTexParameteri(target, GL_TEXTURE_WRAP_S, params.wrap);
+    glTexParameteri(target, GL_TEXTURE_WRAP_T, params.wrap);
+    if (target == GL_TEXTURE_CUBE_MAP)
+      glTexParameteri(target, GL_TEXTURE_WRAP_R, params.wrap);
+    glTexParameteri(target, GL_TEXTURE_MIN_FILTER, params.minFilter);
+    glTexParameteri(target, GL_TEXTURE_MAG_FILTER, params.magFilter);
+    return id;
+  }
+
+  // 解码后的像素，返回估算的显存占用
+  static size_t uploadPixels(unsigned int id, GLenum target, const TextureParams &params, std::vector<TextureImage> &images)
+  {
+    const TextureImage &first = images[0];
+    GLenum format, internalFormat, type;
+    unsigned int texelBytes;
+    formats(first, params.srgb, format, internalFormat, type, texelBytes);
+    if (streamed(target, params) && first.mips && !first.hdr)
+      return streamPixels(id, images[0], format, internalFormat, type, texelBytes);
+    GLsizei levels = 1;
+    if (params.mipmaps())
+      while ((std::max(first.width, first.height) >> levels) > 0)
+        levels++;
+    allocate(target, levels, internalFormat, first.width, first.height, format, type, images.size());
+    // 所有面都有 CPU 生成的完整 mipmap 时直接上传，否则由驱动生成
+    bool cpuMips = levels > 1;
+    for (const TextureImage &image : images)
+      cpuMips = cpuMips && image.mips && (GLsizei)image.mips->size() + 1 == levels;
+    bool generate = levels > 1 && !cpuMips;
+
+    if (UploadScheduler::enabled)
+    {
+      // 交给 UploadScheduler 分帧上传，图片由它释放，需要时在最后一个面上传后再生成 mipmap
+      size_t sourceBytes = (size_t)first.nrComponents * (first.hdr ? sizeof(float) : 1);
+      for (size_t i = 0; i < images.size(); i++)
+      {
+        if (cpuMips)
+          for (size_t level = 0; level < images[i].mips->size(); level++)
+          {
+            std::shared_ptr<std::vector<MipLevel>> mips = images[i].mips;
+            const MipLevel &mip = (*mips)[level];
+            UploadScheduler::texture(id, target, faceTarget(target, i), (GLint)level + 1, mip.width, mip.height, format, type, sourceBytes,
+                                     mip.data.data(), [mips]() mutable
+                                     { mips.reset(); });
+          }
+        std::function<void()> complete;
+        if (generate && i + 1 == images.size())
+          complete = [id, target]()
+          {
+            glActiveTexture(GL_TEXTURE0);
+            RenderState::forgetTexture(id);
+            RenderState::bindTexture(0, target, id);
+            glGenerateMipmap(target);
+          };
+        void *data = images[i].data;
+        UploadScheduler::texture(id, target, faceTarget(target, i), 0, first.width, first.height, format, type, sourceBytes, data,
+                                 [data]()
+                                 { stbi_image_free(data); },
+                                 complete);
+        images[i].data = nullptr;
+      }
+    }
+    else
+    {
+      // 1、3 通道的行不一定是 4 字节对齐
+      glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+      for (size_t i = 0; i < images.size(); i++)
+      {
+        GLenum face = faceTarget(target, i);
+        glTexSubImage2D(face, 0, 0, 0, first.width, first.height, format, type, images[i].data);
+        if (cpuMips)
+          for (size_t level = 0; level < images[i].mips->size(); level++)
+          {
+            const MipLevel &mip = (*images[i].mips)[level];
+            glTexSubImage2D(face, (GLint)level + 1, 0, 0, mip.width, mip.height, format, type, mip.data.data());
+          }
+      }
+      glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+      if (generate)
+        glGenerateMipmap(target);
+    }
+
+    size_t bytes = (size_t)first.width * first.height * texelBytes * images.size();
+    if (levels > 1)
+      bytes = bytes * 4 / 3;
+    return bytes;
+  }
+
+  // 烘焙好的块压缩贴图，各级 mipmap 直接从映射的 KTX 上传，返回显存占用
+  static size_t uploadCooked(unsigned int id, GLenum target, const TextureParams &params, std::vector<TextureImage> &images)
+  {
+    const KtxFile &first = *images[0].cooked;
+    BlockFormat block = BlockFormat::BC1;
+    BlockCompress::fromInternalFormat(first.internalFormat, block);
+    GLenum internalFormat = BlockCompress::internalFormat(block, params.srgb);
+    GLsizei levels = params.mipmaps() ? first.levels : 1;
+    size_t bytes = 0;
+
+    if (streamed(target, params) && levels > 1)
+    {
+      StreamSource source;
+      source.name = images[0].path;
+      source.internalFormat = internalFormat;
+      source.compressed = true;
+      for (GLsizei level = 0; level < levels; level++)
+      {
+        const KtxLevel &image = first.level(level);
+        source.levels.push_back({image.width, image.height, image.size, image.data});
+      }
+      std::shared_ptr<KtxFile> cooked = images[0].cooked;
+      source.release = [cooked]() mutable
+      { cooked.reset(); };
+      bytes = TextureStreamer::add(id, std::move(source));
+      levels = 0;
+    }
+    else if (immutableStorage())
+      glTexStorage2D(target, levels, internalFormat, first.width, first.height);
+    else
+    {
+      glTexParameteri(target, GL_TEXTURE_BASE_LEVEL, 0);
+      glTexParameteri(target, GL_TEXTURE_MAX_LEVEL, levels - 1);
+      for (GLsizei level = 0; level < levels; level++)
+        for (size_t i = 0; i < images.size(); i++)
+        {
+          const KtxLevel &image = first.level(level);
+          glCompressedTexImage2D(faceTarget(target, i), level, internalFormat, image.width, image.height, 0, (GLsizei)image.size, nullptr);
+        }
+    }
+
+    for (GLsizei level = 0; level < levels; level++)
+      for (size_t i = 0; i < images.size(); i++)
+      {
+        const KtxLevel &image = images[i].cooked->level(level, images[i].face);
+        bytes += image.size;
+        if (UploadScheduler::enabled)
+        {
+          // 映射在上传完成前必须保留，由任务持有一份引用
+          std::shared_ptr<KtxFile> cooked = images[i].cooked;
+          UploadScheduler::compressedTexture(id, target, faceTarget(target, i), level, image.width, image.height, internalFormat,
+                                             BlockCompress::blockBytes(block), image.data, [cooked]() mutable
+                                             { cooked.reset(); });
+        }
+        else
+          glCompressedTexSubImage2D(faceTarget(target, i), level, 0, 0, image.width, image.height, internalFormat, (GLsizei)image.size, image.data);
+      }
+
+    // BC4 只有红色通道，和灰度图一样让 rgb 都读到同一个值
+    if (block == BlockFormat::BC4)
+    {
+      GLint swizzle[4] = {GL_RED, GL_RED, GL_RED, GL_ONE};
+      glTexParameteriv(target, GL_TEXTURE_SWIZZLE_RGBA, swizzle);
+    }
+    stats.cooked++;
+    return bytes;
+  }
+
+  static bool streamed(GLenum target, const TextureParams &params)
+  {
+    return params.stream && params.mipmaps() && target == GL_TEXTURE_2D;
+  }
+
+  // 解码结果和 CPU 生成的 mipmap 交给 TextureStreamer 保管，返回常驻的字节数
+  static size_t streamPixels(unsigned int id, TextureImage &image, GLenum format, GLenum internalFormat, GLenum type, unsigned int texelBytes)
+  {
+    StreamSource source;
+    source.name = image.path;
+    source.internalFormat = internalFormat;
+    source.format = format;
+    source.type = type;
+    source.levels.push_back({image.width, image.height, (size_t)image.width * image.height * texelBytes, image.data});
+    for (const MipLevel &mip : *image.mips)
+      source.levels.push_back({mip.width, mip.height, (size_t)mip.width * mip.height * texelBytes, mip.data.data()});
+    unsigned char *data = image.data;
+    std::shared_ptr<std::vector<MipLevel>> mips = image.mips;
+    source.release = [data, mips]() mutable
+    {
+      stbi_image_free(data);
+      mips.reset();
+    };
+    image.data = nullptr;
+    return TextureStreamer::add(id, std::move(source));
+  }
+
+  static void allocate(GLenum target, GLsizei levels, GLenum internalFormat, GLsizei width, GLsizei height, GLenum format, GLenum type, size_t faces)
+  {
+    if (immutableStorage())
+    {
+      glTexStorage2D(target, levels, internalFormat, width, height);
+      return;
+    }
+    // 可变存储：逐级分配，并把最大级别限制在已分配的范围内，纹理才是完整的
+    glTexParameteri(target, GL_TEXTURE_BASE_LEVEL, 0);
+    glTexParameteri(target, GL_TEXTURE_MAX_LEVEL, levels - 1);
+    for (GLsizei level = 0; level < levels; level++)
+      for (size_t i = 0; i < faces; i++)
+      {
+        GLenum face = faceTarget(target, i);
+        glTexImage2D(face, level, internalFormat, std::max(1, width >> level), std::max(1, height >> level), 0, format, type, nullptr);
+      }
+  }
+
+  static GLenum faceTarget(GLenum target, size_t face)
+  {
+    return target == GL_TEXTURE_CUBE_MAP ? GL_TEXTURE_CUBE_MAP_POSITIVE_X + (GLenum)face : target;
+  }
+
+  static void formats(const TextureImage &image, bool srgb, GLenum &format, GLenum &internalFormat, GLenum &type, unsigned int &texelBytes)
+  {
+    static const GLenum baseFormats[4] = {GL_RED, GL_RG, GL_RGB, GL_RGBA};
+    static const GLenum unormFormats[4] = {GL_R8, GL_RG8, GL_RGB8, GL_RGBA8};
+    static const GLenum halfFormats[4] = {GL_R16F, GL_RG16F, GL_RGB16F, GL_RGBA16F};
+    int channels = std::min(std::max(image.nrComponents, 1), 4);
+    format = baseFormats[channels - 1];
+    if (image.hdr)
+    {
+      internalFormat = halfFormats[channels - 1];
+      type = GL_FLOAT;
+      texelBytes = channels * 2;
+      return;
+    }
+    internalFormat = unormFormats[channels - 1];
+    if (srgb && channels == 3)
+      internalFormat = GL_SRGB8;
+    else if (srgb && channels == 4)
+      internalFormat = GL_SRGB8_ALPHA8;
+    type = GL_UNSIGNED_BYTE;
+    texelBytes = channels;
+  }
+};
+
+#endif
@@ -0,0 +1,315 @@
+#ifndef TEXTURE_STREAMER_H
+#define TEXTURE_STREAMER_H
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <tool/render_state.h>
+
+// 流式纹理的一级 mipmap，data 在 TextureStreamer::remove() 之前一直有效
+struct StreamLevel
+{
+  int width = 0;
+  int height = 0;
+  size_t bytes = 0;
+  const void *data = nullptr;
+};
+
+// 注册流式纹理时提供的全部 mipmap 数据和格式，compressed 时 format / type 不使用
+struct StreamSource
+{
+  std::string name;
+  GLenum internalFormat = 0;
+  GLenum format = 0;
+  GLenum type = 0;
+  bool compressed = false;
+  std::vector<StreamLevel> levels;
+  std::function<void()> release; // 纹理移除时释放 levels 指向的数据
+};
+
+struct StreamedTexture
+{
+  unsigned int id = 0;
+  StreamSource source;
+  int residentLevel = 0; // 当前最精细的常驻级别，即 GL_TEXTURE_BASE_LEVEL
+  int minimumLevel = 0;  // 始终常驻的级别，比它更粗的级别不会被移出
+  int wantedLevel = 0;   // 上一帧请求的级别
+  int requestedLevel = INT_MAX;
+  unsigned long long lastUsed = 0; // 最后一次被请求的帧
+  size_t residentBytes = 0;
+};
+
+struct TextureStreamerStats
+{
+  size_t residentBytes = 0;
+  size_t uploadedBytes = 0; // 本帧调入的字节数
+  unsigned int levelsIn = 0;
+  unsigned int levelsOut = 0;
+  unsigned int deferred = 0; // 预算不足、本帧没有调入的纹理数
+};
+
+// 按 mipmap 级别流式加载纹理，显存占用不超过 budgetBytes
+//
+// 注册时只上传尺寸不超过 residentSize 的低精度级别，纹理立即可以采样。绘制时调用 request() /
+// requestScreenSize() 按屏幕上的纹素密度请求需要的级别，update() 每帧把缺少的级别由粗到细逐级调入
+// （每帧不超过 bytesPerFrame），超出预算时按最近最少使用（LRU）的顺序移出最精细的级别。
+//
+// 纹理使用可变存储，每级单独 glTexImage2D / glCompressedTexImage2D，常驻范围由 GL_TEXTURE_BASE_LEVEL 限制；
+// 移出的级别重新指定为 0x0，驱动释放它的显存。源数据在 CPU 一侧保留：烘焙的 KTX 只是映射，未烘焙的贴图保留解码结果
+//
+// 由 TextureCache 在 TextureParams::stream 时注册，release() 时移除
+class TextureStreamer
+{
+public:
+  inline static size_t budgetBytes = 128 * 1024 * 1024;
+  inline static size_t bytesPerFrame = 4 * 1024 * 1024;
+  inline static int residentSize = 128; // 始终常驻的最大尺寸
+  inline static TextureStreamerStats stats;     // 当前帧
+  inline static TextureStreamerStats lastFrame; // 上一帧
+
+  // 需要纹理已经绑定在当前活动单元上，返回常驻的字节数
+  static size_t add(unsigned int id, StreamSource source)
+  {
+    StreamedTexture texture;
+    texture.id = id;
+    texture.source = std::move(source);
+    int last = (int)texture.source.levels.size() - 1;
+    texture.minimumLevel = 0;
+    while (texture.minimumLevel < last && std::max(texture.source.levels[texture.minimumLevel].width,
+                                                   texture.source.levels[texture.minimumLevel].height) > residentSize)
+      texture.minimumLevel++;
+    texture.residentLevel = texture.minimumLevel;
+    texture.wantedLevel = texture.minimumLevel;
+    texture.lastUsed = frame;
+
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, texture.minimumLevel);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, last);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    for (int level = last; level >= texture.minimumLevel; level--)
+      texture.residentBytes += specify(texture.source, level, true);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+
+    size_t bytes = texture.residentBytes;
+    stats.residentBytes += bytes;
+    textures[id] = std::move(texture);
+    return bytes;
+  }
+
+  static void remove(unsigned int id)
+  {
+    auto found = textures.find(id);
+    if (found == textures.end())
+      return;
+    stats.residentBytes -= found->second.residentBytes;
+    if (found->second.source.release)
+      found->second.source.release();
+    textures.erase(found);
+  }
+
+  static bool contains(unsigned int id)
+  {
+    return textures.count(id) != 0;
+  }
+
+  static size_t residentBytes(unsigned int id)
+  {
+    auto found = textures.find(id);
+    return found == textures.end() ? 0 : found->second.residentBytes;
+  }
+
+  // 这一帧至少需要第 level 级，不是流式纹理时忽略
+  static void request(unsigned int id, int level)
+  {
+    auto found = textures.find(id);
+    if (found == textures.end())
+      return;
+    found->second.requestedLevel = std::min(found->second.requestedLevel, std::max(level, 0));
+    found->second.lastUsed = frame;
+  }
+
+  // 物体在屏幕上约 screenPixels 像素宽，纹理在它上面重复 uvRepeat 次：每个像素对应一个纹素的级别
+  static void requestScreenSize(unsigned int id, float screenPixels, float uvRepeat = 1.0f)
+  {
+    auto found = textures.find(id);
+    if (found == textures.end())
+      return;
+    const StreamLevel &top = found->second.source.levels[0];
+    float texels = (float)std::max(top.width, top.height) * uvRepeat;
+    int level = screenPixels <= 0.0f ? INT_MAX : (int)std::floor(std::log2(std::max(texels / screenPixels, 1.0f)));
+    request(id, level);
+  }
+
+  // 包围球投影到屏幕上的直径（像素），球心在相机后面或包含相机时按整个视口高度计算
+  static float screenSize(const glm::vec3 &center, float radius, const glm::mat4 &view, const glm::mat4 &projection, float viewportHeight)
+  {
+    float depth = -(view * glm::vec4(center, 1.0f)).z;
+    if (depth <= radius)
+      return viewportHeight;
+    return std::min(radius * projection[1][1] / depth * viewportHeight, viewportHeight);
+  }
+
+  // 每帧调用一次：处理本帧的请求，调入缺少的级别，超出预算时移出最近最少使用的级别
+  static void update()
+  {
+    lastFrame = stats;
+    stats.uploadedBytes = 0;
+    stats.levelsIn = 0;
+    stats.levelsOut = 0;
+    stats.deferred = 0;
+
+    std::vector<StreamedTexture *> missing;
+    for (auto &pair : textures)
+    {
+      StreamedTexture &texture = pair.second;
+      // 本帧没有绘制的纹理保留上一次的请求，但不再调入
+      if (texture.lastUsed != frame)
+        continue;
+      texture.wantedLevel = std::min(texture.requestedLevel, texture.minimumLevel);
+      texture.requestedLevel = INT_MAX;
+      if (texture.wantedLevel < texture.residentLevel)
+        missing.push_back(&texture);
+    }
+
+    // 差得越多越优先，相同时先处理较小的纹理
+    std::sort(missing.begin(), missing.end(), [](const StreamedTexture *a, const StreamedTexture *b)
+              {
+                int gapA = a->residentLevel - a->wantedLevel, gapB = b->residentLevel - b->wantedLevel;
+                if (gapA != gapB)
+                  return gapA > gapB;
+                return a->residentBytes < b->residentBytes; });
+
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    // 每个纹理每帧最多调入一级，由粗到细逐渐清晰
+    for (StreamedTexture *texture : missing)
+    {
+      int level = texture->residentLevel - 1;
+      size_t bytes = texture->source.levels[level].bytes;
+      if (stats.uploadedBytes > 0 && stats.uploadedBytes + bytes > bytesPerFrame)
+      {
+        stats.deferred++;
+        continue;
+      }
+      if (!makeRoom(bytes, texture))
+      {
+        stats.deferred++;
+        continue;
+      }
+      bind(texture->id);
+      specify(texture->source, level, true);
+      glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, level);
+      texture->residentLevel = level;
+      texture->residentBytes += bytes;
+      stats.residentBytes += bytes;
+      stats.uploadedBytes += bytes;
+      stats.levelsIn++;
+    }
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+
+    // 预算调小后立即生效
+    makeRoom(0, nullptr);
+    frame++;
+  }
+
+  static const std::unordered_map<unsigned int, StreamedTexture> &all()
+  {
+    return textures;
+  }
+
+  static void printStats()
+  {
+    std::cout << "TEXTURE_STREAMER textures: " << textures.size() << ", resident: " << stats.residentBytes / (1024.0 * 1024.0)
+              << " MB / " << budgetBytes / (1024.0 * 1024.0) << " MB, last frame in: " << lastFrame.levelsIn << " levels ("
+              << lastFrame.uploadedBytes / 1024 << " KB), out: " << lastFrame.levelsOut << ", deferred: " << lastFrame.deferred << std::endl;
+  }
+
+private:
+  inline static std::unordered_map<unsigned int, StreamedTexture> textures;
+  inline static unsigned long long frame = 1;
+
+  static void bind(unsigned int id)
+  {
+    glActiveTexture(GL_TEXTURE0);
+    RenderState::forgetTexture(id);
+    RenderState::bindTexture(0, GL_TEXTURE_2D, id);
+  }
+
+  // resident 为 false 时把这一级重新指定为 0x0，释放显存。返回这一级的字节数
+  static size_t specify(const StreamSource &source, int level, bool resident)
+  {
+    const StreamLevel &image = source.levels[level];
+    int width = resident ? image.width : 0, height = resident ? image.height : 0;
+    const void *data = resident ? image.data : nullptr;
+    if (source.compressed)
+      glCompressedTexImage2D(GL_TEXTURE_2D, level, source.internalFormat, width, height, 0, resident ? (GLsizei)image.bytes : 0, data);
+    else
+      glTexImage2D(GL_TEXTURE_2D, level, source.internalFormat, width, height, 0, source.format, source.type, data);
+    return image.bytes;
+  }
+
+  // 超出预算时移出最精细的级别，直到再放得下 bytes。
+  // 先移出比上一帧请求更精细的级别，再按最近最少使用的顺序；本帧用到的级别不会为了调入其他纹理而移出
+  static bool makeRoom(size_t bytes, const StreamedTexture *incoming)
+  {
+    if (stats.residentBytes + bytes <= budgetBytes)
+      return true;
+    // 先确认移出所有可移出的级别后放得下，否则一个都不移出
+    size_t evictable = 0;
+    for (auto &pair : textures)
+      if (evictableLevel(pair.second, incoming))
+        for (int level = pair.second.residentLevel; level < pair.second.minimumLevel; level++)
+          evictable += pair.second.source.levels[level].bytes;
+    if (incoming != nullptr && stats.residentBytes - evictable + bytes > budgetBytes)
+      return false;
+
+    while (stats.residentBytes + bytes > budgetBytes)
+    {
+      StreamedTexture *victim = nullptr;
+      for (auto &pair : textures)
+      {
+        StreamedTexture &texture = pair.second;
+        if (!evictableLevel(texture, incoming))
+          continue;
+        bool excess = texture.residentLevel < texture.wantedLevel;
+        bool victimExcess = victim != nullptr && victim->residentLevel < victim->wantedLevel;
+        if (victim == nullptr || excess > victimExcess || (excess == victimExcess && texture.lastUsed < victim->lastUsed))
+          victim = &texture;
+      }
+      if (victim == nullptr)
+        return false;
+      evict(*victim);
+    }
+    return true;
+  }
+
+  // 纹理有比常驻下限更精细的级别，并且可以为 incoming 让出空间
+  static bool evictableLevel(const StreamedTexture &texture, const StreamedTexture *incoming)
+  {
+    if (&texture == incoming || texture.residentLevel >= texture.minimumLevel)
+      return false;
+    bool excess = texture.residentLevel < texture.wantedLevel;
+    return excess || incoming == nullptr || texture.lastUsed != frame;
+  }
+
+  static void evict(StreamedTexture &texture)
+  {
+    int level = texture.residentLevel;
+    bind(texture.id);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, level + 1);
+    size_t bytes = specify(texture.source, level, false);
+    texture.residentLevel = level + 1;
+    texture.residentBytes -= bytes;
+    stats.residentBytes -= bytes;
+    stats.levelsOut++;
+  }
+};
+
+#endif
@@ -0,0 +1,64 @@
+#ifndef TEXTURE_STREAMER_GUI_H
+#define TEXTURE_STREAMER_GUI_H
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include <tool/gui.h>
+#include <tool/texture_streamer.h>
+
+// TextureStreamer 的调试窗口：总占用和预算、上一帧的调入/移出，以及每个纹理的常驻级别和显存占用
+// 需要在 ImGui::NewFrame() 和 ImGui::Render() 之间调用
+class TextureStreamerOverlay
+{
+public:
+  static void draw()
+  {
+    const double MB = 1024.0 * 1024.0;
+    ImGui::Begin("texture streaming");
+    ImGui::Text("resident %.1f MB / budget %.1f MB", TextureStreamer::stats.residentBytes / MB, TextureStreamer::budgetBytes / MB);
+    ImGui::ProgressBar(std::min(1.0f, (float)((double)TextureStreamer::stats.residentBytes / TextureStreamer::budgetBytes)));
+    int budget = (int)(TextureStreamer::budgetBytes / (1024 * 1024));
+    if (ImGui::SliderInt("budget (MB)", &budget, 8, 1024))
+      TextureStreamer::budgetBytes = (size_t)budget * 1024 * 1024;
+    const TextureStreamerStats &last = TextureStreamer::lastFrame;
+    ImGui::Text("last frame: in %u levels (%zu KB), out %u, deferred %u", last.levelsIn, last.uploadedBytes / 1024, last.levelsOut, last.deferred);
+
+    // 按常驻字节数从大到小
+    std::vector<const StreamedTexture *> textures;
+    for (const auto &pair : TextureStreamer::all())
+      textures.push_back(&pair.second);
+    std::sort(textures.begin(), textures.end(), [](const StreamedTexture *a, const StreamedTexture *b)
+              { return a->residentBytes > b->residentBytes; });
+
+    ImGui::Separator();
+    ImGui::Columns(4, "textures");
+    ImGui::Text("texture");
+    ImGui::NextColumn();
+    ImGui::Text("resident");
+    ImGui::NextColumn();
+    ImGui::Text("level (wanted)");
+    ImGui::NextColumn();
+    ImGui::Text("KB");
+    ImGui::NextColumn();
+    ImGui::Separator();
+    for (const StreamedTexture *texture : textures)
+    {
+      const StreamLevel &resident = texture->source.levels[texture->residentLevel];
+      std::string name = texture->source.name.substr(texture->source.name.find_last_of("/\\") + 1);
+      ImGui::Text("%s", name.c_str());
+      ImGui::NextColumn();
+      ImGui::Text("%dx%d", resident.width, resident.height);
+      ImGui::NextColumn();
+      ImGui::Text("%d (%d)", texture->residentLevel, texture->wantedLevel);
+      ImGui::NextColumn();
+      ImGui::Text("%zu", texture->residentBytes / 1024);
+      ImGui::NextColumn();
+    }
+    ImGui::Columns(1);
+    ImGui::End();
+  }
+};
+
+#endif
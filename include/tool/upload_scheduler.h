@@ -0,0 +1,426 @@
+#ifndef UPLOAD_SCHEDULER_H
+#define UPLOAD_SCHEDULER_H
+
+#include <glad/glad.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <deque>
+#include <functional>
+#include <iostream>
+#include <unordered_map>
+#include <vector>
+
+#include <tool/render_state.h>
+
+struct UploadStats
+{
+  size_t bytes = 0;      // 本帧写入暂存环的字节数
+  unsigned int jobs = 0; // 本帧完成的上传
+  unsigned int stalls = 0; // 暂存环没有空间而提前结束的次数
+  double ms = 0.0;       // flush() 的 CPU 耗时
+};
+
+// 每帧限量的 GPU 上传调度
+//
+// 纹理和缓冲的数据先排队，flush() 每帧调用一次，把队首的数据按行（纹理，压缩纹理按块行）或按字节（缓冲）切块，
+// 复制到一个环形的暂存缓冲中，再用 GL_PIXEL_UNPACK_BUFFER + glTexSubImage2D 或 glCopyBufferSubData
+// 交给 GPU。每帧写入的字节数和耗时不超过 bytesPerFrame / msPerFrame，运行中加载资源时帧时间保持平稳。
+//
+// 每次 flush() 结束插入一个 fence，fence 通过之后这一帧用过的暂存空间才会被复用。
+// GL 4.4 起暂存环用 glBufferStorage 持久映射，否则每块用 glMapBufferRange(UNSYNCHRONIZED) 映射
+//
+// enabled 为 false 时 TextureCache 和 GeometryHandle 照常同步上传。
+// 数据上传完成之前纹理的内容未定义，网格不会被 drawMesh 绘制
+class UploadScheduler
+{
+public:
+  inline static bool enabled = false;
+  inline static size_t bytesPerFrame = 8 * 1024 * 1024;
+  inline static double msPerFrame = 2.0;
+  inline static size_t ringBytes = 32 * 1024 * 1024; // 第一次 flush() 时分配，之后修改无效
+
+  inline static UploadStats stats;     // 当前帧
+  inline static UploadStats lastFrame; // 上一帧
+
+  // 排队上传纹理的一个面（或 2D 纹理）的第 level 级。
+  // data 在上传完成或取消后交给 release 释放，complete 在最后一块提交后调用（例如生成 mipmap）
+  static void texture(unsigned int texture, GLenum target, GLenum face, GLint level, int width, int height, GLenum format, GLenum type,
+                      size_t texelBytes, const void *data, std::function<void()> release, std::function<void()> complete = nullptr)
+  {
+    Job job;
+    job.object = texture;
+    job.target = target;
+    job.face = face;
+    job.level = level;
+    job.width = width;
+    job.height = height;
+    job.format = format;
+    job.type = type;
+    job.rowBytes = (size_t)width * texelBytes;
+    job.bytes = job.rowBytes * height;
+    job.data = (const unsigned char *)data;
+    job.release = std::move(release);
+    job.complete = std::move(complete);
+    queue.push_back(std::move(job));
+  }
+
+  // 块压缩纹理的一级，按 4 像素高的块行切分
+  static void compressedTexture(unsigned int texture, GLenum target, GLenum face, GLint level, int width, int height, GLenum internalFormat,
+                                size_t blockBytes, const void *data, std::function<void()> release)
+  {
+    Job job;
+    job.object = texture;
+    job.target = target;
+    job.face = face;
+    job.level = level;
+    job.width = width;
+    job.height = height;
+    job.compressedFormat = internalFormat;
+    job.rowBytes = (size_t)((width + 3) / 4) * blockBytes;
+    job.bytes = job.rowBytes * ((height + 3) / 4);
+    job.data = (const unsigned char *)data;
+    job.release = std::move(release);
+    queue.push_back(std::move(job));
+  }
+
+  // 排队上传缓冲的 [offset, offset + size)，数据立即复制一份，调用方可以马上释放。
+  // gate 非 0 时，这个值（通常是 VAO）在所有带同一 gate 的上传完成前 ready(gate) 返回 false
+  static void buffer(unsigned int buffer, size_t offset, const void *data, size_t size, unsigned int gate = 0)
+  {
+    Job job;
+    job.object = buffer;
+    job.offset = offset;
+    job.bytes = size;
+    std::vector<unsigned char> *copy = new std::vector<unsigned char>((const unsigned char *)data, (const unsigned char *)data + size);
+    job.data = copy->data();
+    job.release = [copy]()
+    { delete copy; };
+    job.gate = gate;
+    if (gate != 0)
+      gates[gate]++;
+    queue.push_back(std::move(job));
+  }
+
+  static bool ready(unsigned int gate)
+  {
+    return gates.empty() || gates.find(gate) == gates.end();
+  }
+
+  static bool idle()
+  {
+    return queue.empty();
+  }
+
+  static size_t pendingBytes()
+  {
+    size_t bytes = 0;
+    for (const Job &job : queue)
+      bytes += job.bytes - job.done;
+    return bytes;
+  }
+
+  // 删除纹理之前调用，丢弃还没提交的数据
+  static void cancelTexture(unsigned int texture)
+  {
+    cancel(texture, true);
+  }
+
+  // 删除缓冲之前调用
+  static void cancelBuffer(unsigned int buffer)
+  {
+    cancel(buffer, false);
+  }
+
+  // 每帧调用一次，在预算内提交排队的数据
+  static void flush()
+  {
+    lastFrame = stats;
+    stats = UploadStats();
+    if (queue.empty() && batches.empty())
+      return;
+    auto start = std::chrono::steady_clock::now();
+    createRing();
+    retire(false);
+    submit(bytesPerFrame, msPerFrame, start);
+    stats.ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+  }
+
+  // 不限预算地提交全部数据，暂存环满时等待 GPU
+  static void finish()
+  {
+    auto start = std::chrono::steady_clock::now();
+    createRing();
+    bool stalled = false;
+    while (!queue.empty())
+    {
+      retire(stalled);
+      unsigned int stalls = stats.stalls;
+      submit(SIZE_MAX, 1e30, start);
+      stalled = stats.stalls != stalls;
+    }
+    retire(true);
+  }
+
+  // 需要 GL 上下文，释放暂存环和所有排队的数据
+  static void dispose()
+  {
+    for (Job &job : queue)
+      if (job.release)
+        job.release();
+    queue.clear();
+    gates.clear();
+    for (Batch &batch : batches)
+      glDeleteSync(batch.fence);
+    batches.clear();
+    if (ring != 0)
+    {
+      if (mapped != nullptr)
+      {
+        glBindBuffer(GL_COPY_READ_BUFFER, ring);
+        glUnmapBuffer(GL_COPY_READ_BUFFER);
+      }
+      glDeleteBuffers(1, &ring);
+    }
+    ring = 0;
+    mapped = nullptr;
+    head = 0;
+  }
+
+  static void printStats()
+  {
+    std::cout << "UPLOAD " << lastFrame.bytes / 1024 << " KB, jobs: " << lastFrame.jobs << ", stalls: " << lastFrame.stalls
+              << ", " << lastFrame.ms << " ms, pending: " << pendingBytes() / 1024 << " KB" << std::endl;
+  }
+
+  // GL 4.4 起持久映射暂存环
+  static bool persistentMapping()
+  {
+    return GLAD_GL_VERSION_4_4 != 0;
+  }
+
+private:
+  struct Job
+  {
+    unsigned int object = 0; // 纹理或缓冲
+    GLenum target = 0;       // 纹理的目标，缓冲为 0
+    GLenum face = 0;
+    GLint level = 0;
+    int width = 0;
+    int height = 0;
+    GLenum format = 0;
+    GLenum type = 0;
+    GLenum compressedFormat = 0; // 非 0 时 rowBytes 是一行块的字节数
+    size_t rowBytes = 0;
+    size_t offset = 0; // 缓冲中的目标偏移
+    size_t bytes = 0;
+    size_t done = 0; // 已经提交的字节数，纹理总是整行
+    const unsigned char *data = nullptr;
+    unsigned int gate = 0;
+    std::function<void()> release;
+    std::function<void()> complete;
+  };
+
+  // 一次 flush() 用过的暂存空间，fence 通过后整体回收
+  struct Batch
+  {
+    size_t begin = 0;
+    size_t end = 0; // 不回绕，回绕时拆成两个 Batch
+    GLsync fence = 0;
+  };
+
+  static const size_t ALIGNMENT = 256;
+
+  inline static std::deque<Job> queue;
+  inline static std::deque<Batch> batches;
+  inline static std::unordered_map<unsigned int, unsigned int> gates;
+  inline static unsigned int ring = 0;
+  inline static unsigned char *mapped = nullptr; // 持久映射的地址
+  inline static size_t ringSize = 0;
+  inline static size_t head = 0; // 下一次分配的起点
+
+  static void createRing()
+  {
+    if (ring != 0)
+      return;
+    ringSize = ringBytes;
+    glGenBuffers(1, &ring);
+    glBindBuffer(GL_COPY_READ_BUFFER, ring);
+    if (persistentMapping())
+    {
+      GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+      glBufferStorage(GL_COPY_READ_BUFFER, ringSize, nullptr, flags);
+      mapped = (unsigned char *)glMapBufferRange(GL_COPY_READ_BUFFER, 0, ringSize, flags);
+    }
+    else
+      glBufferData(GL_COPY_READ_BUFFER, ringSize, nullptr, GL_STREAM_DRAW);
+    glBindBuffer(GL_COPY_READ_BUFFER, 0);
+  }
+
+  // 从最早的一批开始回收已经通过的 fence，wait 为 true 时至少等到一批通过
+  static void retire(bool wait)
+  {
+    while (!batches.empty())
+    {
+      Batch &batch = batches.front();
+      GLenum result = glClientWaitSync(batch.fence, wait ? GL_SYNC_FLUSH_COMMANDS_BIT : 0, wait ? 1000000000ull : 0);
+      if (result != GL_ALREADY_SIGNALED && result != GL_CONDITION_SATISFIED)
+        return;
+      glDeleteSync(batch.fence);
+      batches.pop_front();
+      wait = false;
+    }
+  }
+
+  // 在 head 处分配 size 字节，与未回收的批次或本次 flush() 已经使用的 [openBegin, openEnd) 重叠时失败
+  static bool allocate(size_t size, size_t openBegin, size_t openEnd, size_t &offset)
+  {
+    if (size > ringSize)
+      return false;
+    size_t begin = (head + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;
+    if (begin + size > ringSize)
+      begin = 0;
+    for (const Batch &batch : batches)
+      if (begin < batch.end && batch.begin < begin + size)
+        return false;
+    if (openBegin < openEnd && begin < openEnd && openBegin < begin + size)
+      return false;
+    offset = begin;
+    head = begin + size;
+    return true;
+  }
+
+  // 复制到暂存环 [offset, offset + size)
+  static void stage(size_t offset, const unsigned char *data, size_t size)
+  {
+    if (mapped != nullptr)
+    {
+      memcpy(mapped + offset, data, size);
+      return;
+    }
+    glBindBuffer(GL_COPY_READ_BUFFER, ring);
+    void *target = glMapBufferRange(GL_COPY_READ_BUFFER, offset, size, GL_MAP_WRITE_BIT | GL_MAP_UNSYNCHRONIZED_BIT | GL_MAP_INVALIDATE_RANGE_BIT);
+    memcpy(target, data, size);
+    glUnmapBuffer(GL_COPY_READ_BUFFER);
+    glBindBuffer(GL_COPY_READ_BUFFER, 0);
+  }
+
+  static void submit(size_t byteBudget, double msBudget, std::chrono::steady_clock::time_point start)
+  {
+    size_t firstOffset = SIZE_MAX, lastEnd = 0;
+    auto closeBatch = [&]()
+    {
+      if (firstOffset == SIZE_MAX)
+        return;
+      Batch batch;
+      batch.begin = firstOffset;
+      batch.end = lastEnd;
+      batch.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+      batches.push_back(batch);
+      firstOffset = SIZE_MAX;
+    };
+
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    size_t submitted = 0;
+    while (!queue.empty())
+    {
+      double elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+      if (submitted > 0 && (submitted >= byteBudget || elapsed >= msBudget))
+        break;
+
+      Job &job = queue.front();
+      size_t remaining = job.bytes - job.done;
+      size_t size = std::min(remaining, std::max<size_t>(byteBudget - std::min(byteBudget, submitted), 1));
+      size = std::min(size, ringSize / 4); // 留出空间给仍在使用中的批次
+      if (job.target != 0)
+        size = std::max<size_t>(size / job.rowBytes, 1) * job.rowBytes; // 纹理整行提交
+      size = std::min(size, remaining);
+
+      size_t offset;
+      if (!allocate(size, firstOffset, lastEnd, offset))
+      {
+        stats.stalls++;
+        break;
+      }
+      // 回绕后的空间与之前的不连续，先结束前一批
+      if (firstOffset != SIZE_MAX && offset != lastEnd && offset < firstOffset)
+        closeBatch();
+      if (firstOffset == SIZE_MAX)
+        firstOffset = offset;
+      lastEnd = offset + size;
+
+      stage(offset, job.data + job.done, size);
+      if (job.target != 0)
+        copyToTexture(job, offset, size);
+      else
+        copyToBuffer(job, offset, size);
+      job.done += size;
+      submitted += size;
+      stats.bytes += size;
+
+      if (job.done == job.bytes)
+      {
+        Job finished = std::move(job);
+        queue.pop_front();
+        if (finished.release)
+          finished.release();
+        if (finished.complete)
+          finished.complete();
+        if (finished.gate != 0 && --gates[finished.gate] == 0)
+          gates.erase(finished.gate);
+        stats.jobs++;
+      }
+    }
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    closeBatch();
+  }
+
+  static void copyToTexture(const Job &job, size_t offset, size_t size)
+  {
+    GLint firstRow = (GLint)(job.done / job.rowBytes);
+    GLsizei rows = (GLsizei)(size / job.rowBytes);
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, ring);
+    // 活动纹理单元可能被示例改过，先切回 0
+    glActiveTexture(GL_TEXTURE0);
+    RenderState::forgetTexture(job.object);
+    RenderState::bindTexture(0, job.target, job.object);
+    if (job.compressedFormat != 0)
+    {
+      GLint y = firstRow * 4;
+      glCompressedTexSubImage2D(job.face, job.level, 0, y, job.width, std::min(rows * 4, job.height - y), job.compressedFormat, (GLsizei)size, (const void *)offset);
+    }
+    else
+      glTexSubImage2D(job.face, job.level, 0, firstRow, job.width, rows, job.format, job.type, (const void *)offset);
+    // 之后以客户端指针调用 glTexImage2D 的代码不能受影响
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+  }
+
+  static void copyToBuffer(const Job &job, size_t offset, size_t size)
+  {
+    glBindBuffer(GL_COPY_READ_BUFFER, ring);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, job.object);
+    glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, offset, job.offset + job.done, size);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+    glBindBuffer(GL_COPY_READ_BUFFER, 0);
+  }
+
+  static void cancel(unsigned int object, bool isTexture)
+  {
+    for (auto it = queue.begin(); it != queue.end();)
+    {
+      if (it->object == object && (it->target != 0) == isTexture)
+      {
+        if (it->release)
+          it->release();
+        if (it->gate != 0 && --gates[it->gate] == 0)
+          gates.erase(it->gate);
+        it = queue.erase(it);
+      }
+      else
+        ++it;
+    }
+  }
+};
+
+#endif
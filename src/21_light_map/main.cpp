@@ -11,13 +11,13 @@
 
 #define STB_IMAGE_IMPLEMENTATION
 #include <tool/stb_image.h>
+#include <tool/texture_cache.h>
 
 #include <tool/gui.h>
 
 void framebuffer_size_callback(GLFWwindow *window, int width, int height);
 void mouse_callback(GLFWwindow *window, double xpos, double ypos);
 void processInput(GLFWwindow *window);
-unsigned int loadTexture(char const *path);
 
 std::string Shader::dirName;
 
@@ -106,8 +106,11 @@ int main(int argc, char *argv[])
   BoxGeometry boxGeometry(1.0, 1.0, 1.0);
   SphereGeometry sphereGeometry(0.1, 10.0, 10.0);
 
-  unsigned int diffuseMap = loadTexture("./static/texture/container2.png");
-  unsigned int specularMap = loadTexture("./static/texture/container2_specular.png");
+  // 这几节的贴图不做 y 轴翻转
+  TextureParams unflipped;
+  unflipped.flip = false;
+  unsigned int diffuseMap = TextureCache::load("./static/texture/container2.png", unflipped);
+  unsigned int specularMap = TextureCache::load("./static/texture/container2_specular.png", unflipped);
   ourShader.use();
   ourShader.setInt("material.diffuse", 0);
   ourShader.setInt("material.specular", 1);
@@ -213,8 +216,7 @@ int main(int argc, char *argv[])
 
     ourShader.setVec3("lightPos", lightPos);
     ourShader.setVec3("viewPos", camera.Position);
-    glBindVertexArray(boxGeometry.VAO);
-    glDrawElements(GL_TRIANGLES, boxGeometry.indices.size(), GL_UNSIGNED_INT, 0);
+    drawMesh(boxGeometry);
 
     // 绘制灯光物体
     lightObjectShader.use();
@@ -225,8 +227,7 @@ int main(int argc, char *argv[])
     lightObjectShader.setMat4("model", model);
     lightObjectShader.setMat4("view", view);
     lightObjectShader.setMat4("projection", projection);
-    glBindVertexArray(sphereGeometry.VAO);
-    glDrawElements(GL_TRIANGLES, sphereGeometry.indices.size(), GL_UNSIGNED_INT, 0);
+    drawMesh(sphereGeometry);
 
     // 渲染 gui
     ImGui::Render();
@@ -290,41 +291,3 @@ void mouse_callback(GLFWwindow *window, double xpos, double ypos)
 
   // camera.ProcessMouseMovement(xoffset, yoffset);
 }
-
-// 加载纹理贴图
-unsigned int loadTexture(char const *path)
-{
-  unsigned int textureID;
-  glGenTextures(1, &textureID);
-
-  int width, height, nrComponents;
-  unsigned char *data = stbi_load(path, &width, &height, &nrComponents, 0);
-  if (data)
-  {
-    GLenum format;
-    if (nrComponents == 1)
-      format = GL_RED;
-    else if (nrComponents == 3)
-      format = GL_RGB;
-    else if (nrComponents == 4)
-      format = GL_RGBA;
-
-    glBindTexture(GL_TEXTURE_2D, textureID);
-    glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, data);
-    glGenerateMipmap(GL_TEXTURE_2D);
-
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-
-    stbi_image_free(data);
-  }
-  else
-  {
-    std::cout << "Texture failed to load at path: " << path << std::endl;
-    stbi_image_free(data);
-  }
-
-  return textureID;
-}
\ No newline at end of file
@@ -8,20 +8,22 @@
 #include <geometry/SphereGeometry.h>
 
 #include <tool/shader.h>
+#include <tool/render_state.h>
 #include <tool/camera.h>
 
 #define STB_IMAGE_IMPLEMENTATION
 #include <tool/stb_image.h>
+#include <tool/texture_cache.h>
 
 #include <tool/gui.h>
 
 #include <tool/mesh.h>
 #include <tool/model.h>
+#include <tool/model_handle.h>
 
 void framebuffer_size_callback(GLFWwindow *window, int width, int height);
 void mouse_callback(GLFWwindow *window, double xpos, double ypos);
 void processInput(GLFWwindow *window);
-unsigned int loadTexture(char const *path);
 
 std::string Shader::dirName;
 
@@ -110,9 +112,9 @@ int main(int argc, char *argv[])
   BoxGeometry boxGeometry(1.0, 1.0, 1.0);
   SphereGeometry sphereGeometry(0.1, 10.0, 10.0);
 
-  unsigned int diffuseMap = loadTexture("./static/texture/container2.png");
-  unsigned int specularMap = loadTexture("./static/texture/container2_specular.png");
-  unsigned int awesomeMap = loadTexture("./static/texture/awesomeface.png");
+  unsigned int diffuseMap = TextureCache::load("./static/texture/container2.png");
+  unsigned int specularMap = TextureCache::load("./static/texture/container2_specular.png");
+  unsigned int awesomeMap = TextureCache::load("./static/texture/awesomeface.png");
   ourShader.use();
   ourShader.setInt("material.diffuse", 0);
   ourShader.setInt("material.specular", 1);
@@ -187,7 +189,14 @@ int main(int argc, char *argv[])
       glm::vec3(0.0f, 1.0f, 0.0f)};
 
   // Model ourModel("./static/model/nanosuit/nanosuit.obj");
-  Model ourModel("./static/model/cerberus/Cerberus.obj");
+  // 在后台线程上加载，加载完成之前窗口照常刷新并显示进度，GPU 上传由 UploadScheduler 分摊到多帧
+  UploadScheduler::enabled = true;
+  // 原来的 loadTexture 全局开启了 stb 的垂直翻转，Cerberus 的贴图一直是翻转后加载的
+  Model::flipTextures = true;
+  ModelHandle ourModel("./static/model/cerberus/Cerberus.obj");
+
+  // 初始化阶段直接调用了 gl 函数，进入渲染循环前清空状态缓存
+  RenderState::invalidate();
 
   while (!glfwWindowShouldClose(window))
   {
@@ -216,6 +225,25 @@ int main(int argc, char *argv[])
     //ImGui::End();
     // *************************************************************************
 
+    // 上传已经就绪的网格和贴图，完成时打印一次统计
+    if (!ourModel.ready())
+    {
+      ourModel.update();
+      ImGui::SetNextWindowSize(ImVec2(300, 80));                                         // 设置窗口大小
+      ImGui::SetNextWindowPos(ImVec2(SCREEN_WIDTH / 2 - 150, SCREEN_HEIGHT / 2 - 40)); // 居中
+      ImGui::Begin("Loading Cerberus", NULL, ImGuiWindowFlags_NoResize | ImGuiWindowFlags_NoCollapse | ImGuiWindowFlags_NoMove);
+      ImGui::Text("%s", ourModel.status());
+      ImGui::ProgressBar(ourModel.progress());
+      ImGui::End();
+      if (ourModel.ready())
+      {
+        Model &loaded = ourModel.model();
+        loaded.optimizeStats.print("Cerberus"); // 顶点焊接和缓存优化前后的 ACMR / ATVR
+        cout << "Cerberus: " << loaded.loadMs << " ms" << (loaded.fromCache ? " (mesh cache)" : " (assimp)") << endl;
+      }
+    }
+    UploadScheduler::flush();
+
     // 渲染指令
     // ...
     glClearColor(clear_color.x, clear_color.y, clear_color.z, clear_color.w);
@@ -232,14 +260,11 @@ int main(int argc, char *argv[])
     lightColor.y = sin(glfwGetTime() * 0.7f);
     lightColor.z = sin(glfwGetTime() * 1.3f);
 
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, diffuseMap);
+    RenderState::bindTexture(0, GL_TEXTURE_2D, diffuseMap);
 
-    glActiveTexture(GL_TEXTURE1);
-    glBindTexture(GL_TEXTURE_2D, specularMap);
+    RenderState::bindTexture(1, GL_TEXTURE_2D, specularMap);
 
-    glActiveTexture(GL_TEXTURE2);
-    glBindTexture(GL_TEXTURE_2D, awesomeMap);
+    RenderState::bindTexture(2, GL_TEXTURE_2D, awesomeMap);
 
     float radius = 10.0f;
     float camX = sin(glfwGetTime()) * radius;
@@ -305,8 +330,7 @@ int main(int argc, char *argv[])
     lightObjectShader.setMat4("model", model);
     lightObjectShader.setVec3("lightColor", glm::vec3(1.0f, 1.0f, 1.0f));
 
-    glBindVertexArray(sphereGeometry.VAO);
-    glDrawElements(GL_TRIANGLES, sphereGeometry.indices.size(), GL_UNSIGNED_INT, 0);
+    drawMesh(sphereGeometry);
 
     for (unsigned int i = 0; i < 4; i++)
     {
@@ -316,8 +340,7 @@ int main(int argc, char *argv[])
       lightObjectShader.setMat4("model", model);
       lightObjectShader.setVec3("lightColor", pointLightColors[i]);
 
-      glBindVertexArray(sphereGeometry.VAO);
-      glDrawElements(GL_TRIANGLES, sphereGeometry.indices.size(), GL_UNSIGNED_INT, 0);
+      drawMesh(sphereGeometry);
     }
 
     // 渲染 gui
@@ -331,6 +354,8 @@ int main(int argc, char *argv[])
   boxGeometry.dispose();
   planeGeometry.dispose();
   sphereGeometry.dispose();
+  ourModel.dispose();
+  UploadScheduler::dispose();
   glfwTerminate();
 
   return 0;
@@ -382,43 +407,3 @@ void mouse_callback(GLFWwindow *window, double xpos, double ypos)
 
   camera.ProcessMouseMovement(xoffset, yoffset);
 }
-
-// 加载纹理贴图
-unsigned int loadTexture(char const *path)
-{
-  unsigned int textureID;
-  glGenTextures(1, &textureID);
-
-  // 图像y轴翻转
-  stbi_set_flip_vertically_on_load(true);
-  int width, height, nrComponents;
-  unsigned char *data = stbi_load(path, &width, &height, &nrComponents, 0);
-  if (data)
-  {
-    GLenum format;
-    if (nrComponents == 1)
-      format = GL_RED;
-    else if (nrComponents == 3)
-      format = GL_RGB;
-    else if (nrComponents == 4)
-      format = GL_RGBA;
-
-    glBindTexture(GL_TEXTURE_2D, textureID);
-    glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, data);
-    glGenerateMipmap(GL_TEXTURE_2D);
-
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-
-    stbi_image_free(data);
-  }
-  else
-  {
-    std::cout << "Texture failed to load at path: " << path << std::endl;
-    stbi_image_free(data);
-  }
-
-  return textureID;
-}
\ No newline at end of file
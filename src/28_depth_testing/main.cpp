@@ -11,13 +11,13 @@
 
 #define STB_IMAGE_IMPLEMENTATION
 #include <tool/stb_image.h>
+#include <tool/texture_cache.h>
 
 #include <tool/gui.h>
 
 void framebuffer_size_callback(GLFWwindow *window, int width, int height);
 void mouse_callback(GLFWwindow *window, double xpos, double ypos);
 void processInput(GLFWwindow *window);
-unsigned int loadTexture(char const *path);
 
 std::string Shader::dirName;
 
@@ -107,8 +107,8 @@ int main(int argc, char *argv[])
   SphereGeometry sphereGeometry(0.04, 10.0, 10.0);
   SphereGeometry sphereGeometry2(0.5, 50.0, 50.0);
 
-  unsigned int woodMap = loadTexture("./static/texture/wood.png");           // 地面
-  unsigned int brickMap = loadTexture("./static/texture/brick_diffuse.jpg"); // 砖块
+  unsigned int woodMap = TextureCache::load("./static/texture/wood.png");           // 地面
+  unsigned int brickMap = TextureCache::load("./static/texture/brick_diffuse.jpg"); // 砖块
 
   sceneShader.use();
   sceneShader.setInt("brickMap", 0);
@@ -241,8 +241,7 @@ int main(int argc, char *argv[])
     sceneShader.setFloat("uvScale", 4.0f);
     sceneShader.setMat4("model", model);
 
-    glBindVertexArray(planeGeometry.VAO);
-    glDrawElements(GL_TRIANGLES, planeGeometry.indices.size(), GL_UNSIGNED_INT, 0);
+    drawMesh(planeGeometry);
 
     // 绘制砖块
     glBindTexture(GL_TEXTURE_2D, brickMap);
@@ -253,15 +252,13 @@ int main(int argc, char *argv[])
     sceneShader.setFloat("uvScale", 1.0f);
     sceneShader.setMat4("model", model);
 
-    glBindVertexArray(boxGeometry.VAO);
-    glDrawElements(GL_TRIANGLES, boxGeometry.indices.size(), GL_UNSIGNED_INT, 0);
+    drawMesh(boxGeometry);
 
     model = glm::mat4(1.0f);
     model = glm::translate(model, glm::vec3(-1.0, 0.5, 2.0));
     sceneShader.setMat4("model", model);
 
-    glBindVertexArray(boxGeometry.VAO);
-    glDrawElements(GL_TRIANGLES, boxGeometry.indices.size(), GL_UNSIGNED_INT, 0);
+    drawMesh(boxGeometry);
 
     // 绘制灯光物体
     // ************************************************************
@@ -275,8 +272,7 @@ int main(int argc, char *argv[])
     lightObjectShader.setMat4("model", model);
     lightObjectShader.setVec3("lightColor", glm::vec3(1.0f, 1.0f, 1.0f));
 
-    glBindVertexArray(sphereGeometry.VAO);
-    glDrawElements(GL_TRIANGLES, sphereGeometry.indices.size(), GL_UNSIGNED_INT, 0);
+    drawMesh(sphereGeometry);
 
     for (unsigned int i = 0; i < 4; i++)
     {
@@ -286,8 +282,7 @@ int main(int argc, char *argv[])
       lightObjectShader.setMat4("model", model);
       lightObjectShader.setVec3("lightColor", pointLightColors[i]);
 
-      glBindVertexArray(sphereGeometry.VAO);
-      glDrawElements(GL_TRIANGLES, sphereGeometry.indices.size(), GL_UNSIGNED_INT, 0);
+      drawMesh(sphereGeometry);
     }
     // ************************************************************
 
@@ -302,6 +297,7 @@ int main(int argc, char *argv[])
   boxGeometry.dispose();
   planeGeometry.dispose();
   sphereGeometry.dispose();
+  sphereGeometry2.dispose();
   glfwTerminate();
 
   return 0;
@@ -353,43 +349,3 @@ void mouse_callback(GLFWwindow *window, double xpos, double ypos)
 
   camera.ProcessMouseMovement(xoffset, yoffset);
 }
-
-// 加载纹理贴图
-unsigned int loadTexture(char const *path)
-{
-  unsigned int textureID;
-  glGenTextures(1, &textureID);
-
-  // 图像y轴翻转
-  stbi_set_flip_vertically_on_load(true);
-  int width, height, nrComponents;
-  unsigned char *data = stbi_load(path, &width, &height, &nrComponents, 0);
-  if (data)
-  {
-    GLenum format;
-    if (nrComponents == 1)
-      format = GL_RED;
-    else if (nrComponents == 3)
-      format = GL_RGB;
-    else if (nrComponents == 4)
-      format = GL_RGBA;
-
-    glBindTexture(GL_TEXTURE_2D, textureID);
-    glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, data);
-    glGenerateMipmap(GL_TEXTURE_2D);
-
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-
-    stbi_image_free(data);
-  }
-  else
-  {
-    std::cout << "Texture failed to load at path: " << path << std::endl;
-    stbi_image_free(data);
-  }
-
-  return textureID;
-}
\ No newline at end of file
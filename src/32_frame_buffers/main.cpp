@@ -12,13 +12,13 @@
 
 #define STB_IMAGE_IMPLEMENTATION
 #include <tool/stb_image.h>
+#include <tool/texture_cache.h>
 
 #include <tool/gui.h>
 
 void framebuffer_size_callback(GLFWwindow *window, int width, int height);
 void mouse_callback(GLFWwindow *window, double xpos, double ypos);
 void processInput(GLFWwindow *window);
-unsigned int loadTexture(char const *path);
 
 std::string Shader::dirName;
 
@@ -115,9 +115,9 @@ int main(int argc, char *argv[])
   BoxGeometry boxGeometry(1.0, 1.0, 1.0);              // 盒子
   SphereGeometry pointLightGeometry(0.04, 10.0, 10.0); // 点光源位置显示
 
-  unsigned int woodMap = loadTexture("./static/texture/wood.png");                         // 地面
-  unsigned int brickMap = loadTexture("./static/texture/brick_diffuse.jpg");               // 砖块
-  unsigned int grassMap = loadTexture("./static/texture/blending_transparent_window.png"); // 草丛
+  unsigned int woodMap = TextureCache::load("./static/texture/wood.png");                         // 地面
+  unsigned int brickMap = TextureCache::load("./static/texture/brick_diffuse.jpg");               // 砖块
+  unsigned int grassMap = TextureCache::load("./static/texture/blending_transparent_window.png"); // 草丛
 
   float factor = 0.0;
 
@@ -287,9 +287,7 @@ int main(int argc, char *argv[])
     sceneShader.setFloat("uvScale", 4.0f);
     sceneShader.setMat4("model", model);
 
-    glBindVertexArray(groundGeometry.VAO);
-    glDrawElements(GL_TRIANGLES, groundGeometry.indices.size(), GL_UNSIGNED_INT, 0);
-    glBindVertexArray(0);
+    drawMesh(groundGeometry);
     // ********************************************************
 
     // 绘制砖块
@@ -302,20 +300,17 @@ int main(int argc, char *argv[])
     sceneShader.setFloat("uvScale", 1.0f);
     sceneShader.setMat4("model", model);
 
-    glBindVertexArray(boxGeometry.VAO);
-    glDrawElements(GL_TRIANGLES, boxGeometry.indices.size(), GL_UNSIGNED_INT, 0);
+    drawMesh(boxGeometry);
 
     model = glm::mat4(1.0f);
     model = glm::translate(model, glm::vec3(-1.0, 0.5, 2.0));
     sceneShader.setMat4("model", model);
 
-    glBindVertexArray(boxGeometry.VAO);
-    glDrawElements(GL_TRIANGLES, boxGeometry.indices.size(), GL_UNSIGNED_INT, 0);
+    drawMesh(boxGeometry);
     // ----------------------------------------------------------
 
     // 绘制草丛面板
     // ----------------------------------------------------------
-    glBindVertexArray(grassGeometry.VAO);
     glBindTexture(GL_TEXTURE_2D, grassMap);
 
     // 对透明物体进行动态排序
@@ -331,7 +326,7 @@ int main(int argc, char *argv[])
       model = glm::mat4(1.0f);
       model = glm::translate(model, iterator->second);
       sceneShader.setMat4("model", model);
-      glDrawElements(GL_TRIANGLES, grassGeometry.indices.size(), GL_UNSIGNED_INT, 0);
+      drawMesh(grassGeometry);
     }
     // ----------------------------------------------------------
 
@@ -347,8 +342,7 @@ int main(int argc, char *argv[])
     lightObjectShader.setMat4("model", model);
     lightObjectShader.setVec3("lightColor", glm::vec3(1.0f, 1.0f, 1.0f));
 
-    glBindVertexArray(pointLightGeometry.VAO);
-    glDrawElements(GL_TRIANGLES, pointLightGeometry.indices.size(), GL_UNSIGNED_INT, 0);
+    drawMesh(pointLightGeometry);
 
     for (unsigned int i = 0; i < 4; i++)
     {
@@ -358,8 +352,7 @@ int main(int argc, char *argv[])
       lightObjectShader.setMat4("model", model);
       lightObjectShader.setVec3("lightColor", pointLightColors[i]);
 
-      glBindVertexArray(pointLightGeometry.VAO);
-      glDrawElements(GL_TRIANGLES, pointLightGeometry.indices.size(), GL_UNSIGNED_INT, 0);
+      drawMesh(pointLightGeometry);
     }
     // ************************************************************
 
@@ -372,9 +365,8 @@ int main(int argc, char *argv[])
     //绘制创建的帧缓冲屏幕窗口
     frameBufferShader.use();
 
-    glBindVertexArray(frameGeometry.VAO);
     glBindTexture(GL_TEXTURE_2D, texColorBuffer);
-    glDrawElements(GL_TRIANGLES, frameGeometry.indices.size(), GL_UNSIGNED_INT, 0);
+    drawMesh(frameGeometry);
 
     // 渲染 gui
     ImGui::Render();
@@ -387,6 +379,8 @@ int main(int argc, char *argv[])
   boxGeometry.dispose();
   groundGeometry.dispose();
   pointLightGeometry.dispose();
+  grassGeometry.dispose();
+  frameGeometry.dispose();
   glfwTerminate();
 
   return 0;
@@ -438,43 +432,3 @@ void mouse_callback(GLFWwindow *window, double xpos, double ypos)
 
   camera.ProcessMouseMovement(xoffset, yoffset);
 }
-
-// 加载纹理贴图
-unsigned int loadTexture(char const *path)
-{
-  unsigned int textureID;
-  glGenTextures(1, &textureID);
-
-  // 图像y轴翻转
-  stbi_set_flip_vertically_on_load(true);
-  int width, height, nrComponents;
-  unsigned char *data = stbi_load(path, &width, &height, &nrComponents, 0);
-  if (data)
-  {
-    GLenum format;
-    if (nrComponents == 1)
-      format = GL_RED;
-    else if (nrComponents == 3)
-      format = GL_RGB;
-    else if (nrComponents == 4)
-      format = GL_RGBA;
-
-    glBindTexture(GL_TEXTURE_2D, textureID);
-    glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, data);
-    glGenerateMipmap(GL_TEXTURE_2D);
-
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-
-    stbi_image_free(data);
-  }
-  else
-  {
-    std::cout << "Texture failed to load at path: " << path << std::endl;
-    stbi_image_free(data);
-  }
-
-  return textureID;
-}
\ No newline at end of file
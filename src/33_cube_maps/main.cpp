@@ -12,16 +12,15 @@
 
 #define STB_IMAGE_IMPLEMENTATION
 #include <tool/stb_image.h>
+#include <tool/texture_cache.h>
 
 #include <tool/gui.h>
 
 void framebuffer_size_callback(GLFWwindow *window, int width, int height);
 void mouse_callback(GLFWwindow *window, double xpos, double ypos);
 void processInput(GLFWwindow *window);
-unsigned int loadTexture(char const *path);
-unsigned int loadCubemap(vector<std::string> faces);
 
-void drawSkyBox(Shader shader, BoxGeometry geometry, unsigned int cubeMap);
+void drawSkyBox(Shader &shader, const BoxGeometry &geometry, unsigned int cubeMap);
 
 std::string Shader::dirName;
 
@@ -116,9 +115,9 @@ int main(int argc, char *argv[])
   BoxGeometry skyboxGeometry(1.0, 1.0, 1.0);           // 天空盒
   SphereGeometry pointLightGeometry(0.04, 10.0, 10.0); // 点光源位置显示
 
-  unsigned int woodMap = loadTexture("./static/texture/wood.png");                         // 地面
-  unsigned int brickMap = loadTexture("./static/texture/brick_diffuse.jpg");               // 砖块
-  unsigned int grassMap = loadTexture("./static/texture/blending_transparent_window.png"); // 草丛
+  unsigned int woodMap = TextureCache::load("./static/texture/wood.png");                         // 地面
+  unsigned int brickMap = TextureCache::load("./static/texture/brick_diffuse.jpg");               // 砖块
+  unsigned int grassMap = TextureCache::load("./static/texture/blending_transparent_window.png"); // 草丛
 
   float factor = 0.0;
 
@@ -175,7 +174,7 @@ int main(int argc, char *argv[])
       "./static/texture/Park3Med/pz.jpg",
       "./static/texture/Park3Med/nz.jpg"};
 
-  unsigned int cubemapTexture = loadCubemap(faces);
+  unsigned int cubemapTexture = TextureCache::loadCubemap(faces);
 
   while (!glfwWindowShouldClose(window))
   {
@@ -285,9 +284,7 @@ int main(int argc, char *argv[])
     sceneShader.setFloat("uvScale", 4.0f);
     sceneShader.setMat4("model", model);
 
-    glBindVertexArray(groundGeometry.VAO);
-    glDrawElements(GL_TRIANGLES, groundGeometry.indices.size(), GL_UNSIGNED_INT, 0);
-    glBindVertexArray(0);
+    drawMesh(groundGeometry);
     // ********************************************************
 
     // 绘制砖块
@@ -300,20 +297,17 @@ int main(int argc, char *argv[])
     sceneShader.setFloat("uvScale", 1.0f);
     sceneShader.setMat4("model", model);
 
-    glBindVertexArray(containerGeometry.VAO);
-    glDrawElements(GL_TRIANGLES, containerGeometry.indices.size(), GL_UNSIGNED_INT, 0);
+    drawMesh(containerGeometry);
 
     model = glm::mat4(1.0f);
     model = glm::translate(model, glm::vec3(-1.0, 0.5, 2.0));
     sceneShader.setMat4("model", model);
 
-    glBindVertexArray(containerGeometry.VAO);
-    glDrawElements(GL_TRIANGLES, containerGeometry.indices.size(), GL_UNSIGNED_INT, 0);
+    drawMesh(containerGeometry);
     // ----------------------------------------------------------
 
     // 绘制草丛面板
     // ----------------------------------------------------------
-    glBindVertexArray(grassGeometry.VAO);
     glBindTexture(GL_TEXTURE_2D, grassMap);
 
     // 对透明物体进行动态排序
@@ -329,7 +323,7 @@ int main(int argc, char *argv[])
       model = glm::mat4(1.0f);
       model = glm::translate(model, iterator->second);
       sceneShader.setMat4("model", model);
-      glDrawElements(GL_TRIANGLES, grassGeometry.indices.size(), GL_UNSIGNED_INT, 0);
+      drawMesh(grassGeometry);
     }
     // ----------------------------------------------------------
 
@@ -345,8 +339,7 @@ int main(int argc, char *argv[])
     lightObjectShader.setMat4("model", model);
     lightObjectShader.setVec3("lightColor", glm::vec3(1.0f, 1.0f, 1.0f));
 
-    glBindVertexArray(pointLightGeometry.VAO);
-    glDrawElements(GL_TRIANGLES, pointLightGeometry.indices.size(), GL_UNSIGNED_INT, 0);
+    drawMesh(pointLightGeometry);
 
     for (unsigned int i = 0; i < 4; i++)
     {
@@ -356,8 +349,7 @@ int main(int argc, char *argv[])
       lightObjectShader.setMat4("model", model);
       lightObjectShader.setVec3("lightColor", pointLightColors[i]);
 
-      glBindVertexArray(pointLightGeometry.VAO);
-      glDrawElements(GL_TRIANGLES, pointLightGeometry.indices.size(), GL_UNSIGNED_INT, 0);
+      drawMesh(pointLightGeometry);
     }
     // ************************************************************
 
@@ -373,6 +365,7 @@ int main(int argc, char *argv[])
   skyboxGeometry.dispose();
   groundGeometry.dispose();
   pointLightGeometry.dispose();
+  grassGeometry.dispose();
   glfwTerminate();
 
   return 0;
@@ -425,84 +418,8 @@ void mouse_callback(GLFWwindow *window, double xpos, double ypos)
   camera.ProcessMouseMovement(xoffset, yoffset);
 }
 
-// 加载纹理贴图
-unsigned int loadTexture(char const *path)
-{
-  unsigned int textureID;
-  glGenTextures(1, &textureID);
-
-  // 图像y轴翻转
-  stbi_set_flip_vertically_on_load(true);
-  int width, height, nrComponents;
-  unsigned char *data = stbi_load(path, &width, &height, &nrComponents, 0);
-  if (data)
-  {
-    GLenum format;
-    if (nrComponents == 1)
-      format = GL_RED;
-    else if (nrComponents == 3)
-      format = GL_RGB;
-    else if (nrComponents == 4)
-      format = GL_RGBA;
-
-    glBindTexture(GL_TEXTURE_2D, textureID);
-    glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, data);
-    glGenerateMipmap(GL_TEXTURE_2D);
-
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-
-    stbi_image_free(data);
-  }
-  else
-  {
-    std::cout << "Texture failed to load at path: " << path << std::endl;
-    stbi_image_free(data);
-  }
-
-  return textureID;
-}
-
-// 加载立方体贴图
-
-unsigned int loadCubemap(vector<std::string> faces)
-{
-  unsigned int textureID;
-  glGenTextures(1, &textureID);
-  glBindTexture(GL_TEXTURE_CUBE_MAP, textureID);
-
-  // 此处需要将y轴旋转关闭，若之前调用过loadTexture
-  stbi_set_flip_vertically_on_load(false);
-
-  int width, height, nrChannels;
-  for (unsigned int i = 0; i < faces.size(); i++)
-  {
-    unsigned char *data = stbi_load(faces[i].c_str(), &width, &height, &nrChannels, 0);
-    if (data)
-    {
-      glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i,
-                   0, GL_RGB, width, height, 0, GL_RGB, GL_UNSIGNED_BYTE, data);
-      stbi_image_free(data);
-    }
-    else
-    {
-      std::cout << "Cubemap texture failed to load at path: " << faces[i] << std::endl;
-      stbi_image_free(data);
-    }
-  }
-  glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-  glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-  glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-  glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-  glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
-
-  return textureID;
-}
-
 // *******************method*********************
-void drawSkyBox(Shader shader, BoxGeometry geometry, unsigned int cubeMap)
+void drawSkyBox(Shader &shader, const BoxGeometry &geometry, unsigned int cubeMap)
 {
 
   glDepthFunc(GL_LEQUAL);
@@ -519,10 +436,8 @@ void drawSkyBox(Shader shader, BoxGeometry geometry, unsigned int cubeMap)
 
   glActiveTexture(GL_TEXTURE0);
   glBindTexture(GL_TEXTURE_CUBE_MAP, cubeMap);
-  glBindVertexArray(geometry.VAO);
-  glDrawElements(GL_TRIANGLES, geometry.indices.size(), GL_UNSIGNED_INT, 0);
+  drawMesh(geometry);
 
-  glBindVertexArray(0);
   glDepthFunc(GL_LESS);
   glEnable(GL_DEPTH_TEST);
   view = camera.GetViewMatrix();
@@ -5,6 +5,7 @@
 #include <map>
 
 #include <tool/shader.h>
+#include <tool/render_state.h>
 #include <tool/camera.h>
 #include <geometry/BoxGeometry.h>
 #include <geometry/PlaneGeometry.h>
@@ -12,6 +13,7 @@
 
 #define STB_IMAGE_IMPLEMENTATION
 #include <tool/stb_image.h>
+#include <tool/texture_cache.h>
 
 #include <tool/gui.h>
 
@@ -21,10 +23,8 @@
 void framebuffer_size_callback(GLFWwindow *window, int width, int height);
 void mouse_callback(GLFWwindow *window, double xpos, double ypos);
 void processInput(GLFWwindow *window);
-unsigned int loadTexture(char const *path);
-unsigned int loadCubemap(vector<std::string> faces);
 
-void drawSkyBox(Shader shader, BoxGeometry geometry, unsigned int cubeMap);
+void drawSkyBox(Shader &shader, const BoxGeometry &geometry, unsigned int cubeMap);
 
 std::string Shader::dirName;
 
@@ -122,10 +122,13 @@ int main(int argc, char *argv[])
       "./static/texture/Park3Med/pz.jpg",
       "./static/texture/Park3Med/nz.jpg"};
 
-  unsigned int cubemapTexture = loadCubemap(faces);
+  unsigned int cubemapTexture = TextureCache::loadCubemap(faces);
 
   Model ourModel("./static/model/walt/WaltHead.obj");
 
+  // 初始化阶段直接调用了 gl 函数，进入渲染循环前清空状态缓存
+  RenderState::invalidate();
+
   while (!glfwWindowShouldClose(window))
   {
     processInput(window);
@@ -204,6 +207,8 @@ int main(int argc, char *argv[])
   containerGeometry.dispose();
   sphereGeometry.dispose();
   skyboxGeometry.dispose();
+  groundGeometry.dispose();
+  ourModel.dispose();
   glfwTerminate();
 
   return 0;
@@ -256,88 +261,12 @@ void mouse_callback(GLFWwindow *window, double xpos, double ypos)
   camera.ProcessMouseMovement(xoffset, yoffset);
 }
 
-// 加载纹理贴图
-unsigned int loadTexture(char const *path)
-{
-  unsigned int textureID;
-  glGenTextures(1, &textureID);
-
-  // 图像y轴翻转
-  stbi_set_flip_vertically_on_load(true);
-  int width, height, nrComponents;
-  unsigned char *data = stbi_load(path, &width, &height, &nrComponents, 0);
-  if (data)
-  {
-    GLenum format;
-    if (nrComponents == 1)
-      format = GL_RED;
-    else if (nrComponents == 3)
-      format = GL_RGB;
-    else if (nrComponents == 4)
-      format = GL_RGBA;
-
-    glBindTexture(GL_TEXTURE_2D, textureID);
-    glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, data);
-    glGenerateMipmap(GL_TEXTURE_2D);
-
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-
-    stbi_image_free(data);
-  }
-  else
-  {
-    std::cout << "Texture failed to load at path: " << path << std::endl;
-    stbi_image_free(data);
-  }
-
-  return textureID;
-}
-
-// 加载立方体贴图
-
-unsigned int loadCubemap(vector<std::string> faces)
-{
-  unsigned int textureID;
-  glGenTextures(1, &textureID);
-  glBindTexture(GL_TEXTURE_CUBE_MAP, textureID);
-
-  // 此处需要将y轴旋转关闭，若之前调用过loadTexture
-  stbi_set_flip_vertically_on_load(false);
-
-  int width, height, nrChannels;
-  for (unsigned int i = 0; i < faces.size(); i++)
-  {
-    unsigned char *data = stbi_load(faces[i].c_str(), &width, &height, &nrChannels, 0);
-    if (data)
-    {
-      glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i,
-                   0, GL_RGB, width, height, 0, GL_RGB, GL_UNSIGNED_BYTE, data);
-      stbi_image_free(data);
-    }
-    else
-    {
-      std::cout << "Cubemap texture failed to load at path: " << faces[i] << std::endl;
-      stbi_image_free(data);
-    }
-  }
-  glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-  glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-  glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-  glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-  glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
-
-  return textureID;
-}
-
 // *******************method*********************
-void drawSkyBox(Shader shader, BoxGeometry geometry, unsigned int cubeMap)
+void drawSkyBox(Shader &shader, const BoxGeometry &geometry, unsigned int cubeMap)
 {
 
-  glDepthFunc(GL_LEQUAL);
-  glDisable(GL_DEPTH_TEST);
+  RenderState::setDepthFunc(GL_LEQUAL);
+  RenderState::setDepthTest(false);
 
   glm::mat4 view = camera.GetViewMatrix();
   glm::mat4 projection = glm::perspective(glm::radians(camera.Zoom), (float)SCREEN_WIDTH / (float)SCREEN_HEIGHT, 0.1f, 100.0f);
@@ -348,13 +277,10 @@ void drawSkyBox(Shader shader, BoxGeometry geometry, unsigned int cubeMap)
   shader.setMat4("view", view);
   shader.setMat4("projection", projection);
 
-  glActiveTexture(GL_TEXTURE0);
-  glBindTexture(GL_TEXTURE_CUBE_MAP, cubeMap);
-  glBindVertexArray(geometry.VAO);
-  glDrawElements(GL_TRIANGLES, geometry.indices.size(), GL_UNSIGNED_INT, 0);
+  RenderState::bindTexture(0, GL_TEXTURE_CUBE_MAP, cubeMap);
+  drawMesh(geometry);
 
-  glBindVertexArray(0);
-  glDepthFunc(GL_LESS);
-  glEnable(GL_DEPTH_TEST);
+  RenderState::setDepthFunc(GL_LESS);
+  RenderState::setDepthTest(true);
   view = camera.GetViewMatrix();
 }
@@ -5,6 +5,7 @@
 #include <map>
 
 #include <tool/shader.h>
+#include <tool/render_state.h>
 #include <tool/camera.h>
 #include <geometry/BoxGeometry.h>
 #include <geometry/PlaneGeometry.h>
@@ -12,6 +13,7 @@
 
 #define STB_IMAGE_IMPLEMENTATION
 #include <tool/stb_image.h>
+#include <tool/texture_cache.h>
 
 #include <tool/gui.h>
 
@@ -21,10 +23,8 @@
 void framebuffer_size_callback(GLFWwindow *window, int width, int height);
 void mouse_callback(GLFWwindow *window, double xpos, double ypos);
 void processInput(GLFWwindow *window);
-unsigned int loadTexture(char const *path);
-unsigned int loadCubemap(vector<std::string> faces);
 
-void drawSkyBox(Shader shader, BoxGeometry geometry, unsigned int cubeMap);
+void drawSkyBox(Shader &shader, const BoxGeometry &geometry, unsigned int cubeMap);
 
 std::string Shader::dirName;
 
@@ -114,8 +114,8 @@ int main(int argc, char *argv[])
   glm::vec3 view_translate = glm::vec3(0.0, 0.0, -5.0);
   ImVec4 clear_color = ImVec4(25.0 / 255.0, 25.0 / 255.0, 25.0 / 255.0, 1.0); // 25, 25, 25
 
-  unsigned int uvMap = loadTexture("./static/texture/uv_grid_directx.jpg");
-  unsigned int triMap = loadTexture("./static/texture/tri_pattern.jpg");
+  unsigned int uvMap = TextureCache::load("./static/texture/uv_grid_directx.jpg");
+  unsigned int triMap = TextureCache::load("./static/texture/tri_pattern.jpg");
 
   // 获取绑定点
   unsigned int uniformBlockIndex_1 = glGetUniformBlockIndex(sceneShader1.ID, "Matrices");
@@ -145,6 +145,9 @@ int main(int argc, char *argv[])
   glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(glm::mat4), glm::value_ptr(projection));
   glBindBuffer(GL_UNIFORM_BUFFER, 0);
 
+  // 初始化阶段直接调用了 gl 函数，进入渲染循环前清空状态缓存
+  RenderState::invalidate();
+
   while (!glfwWindowShouldClose(window))
   {
     processInput(window);
@@ -178,9 +181,7 @@ int main(int argc, char *argv[])
     glBufferSubData(GL_UNIFORM_BUFFER, sizeof(glm::mat4), sizeof(glm::mat4), glm::value_ptr(view));
     glBindBuffer(GL_UNIFORM_BUFFER, 0);
 
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, uvMap);
-    glBindVertexArray(boxGeometry.VAO);
+    RenderState::bindTexture(0, GL_TEXTURE_2D, uvMap);
 
     float rotate = glfwGetTime() * 0.2f;
     glm::qua<float> qu = glm::qua<float>(glm::vec3(rotate, rotate, rotate));
@@ -190,28 +191,28 @@ int main(int argc, char *argv[])
     model = model * glm::mat4_cast(qu);
     sceneShader1.use();
     sceneShader1.setMat4("model", model);
-    glDrawElements(GL_TRIANGLES, boxGeometry.indices.size(), GL_UNSIGNED_INT, 0);
+    drawMesh(boxGeometry);
 
     model = glm::mat4(1.0f);
     model = glm::translate(model, glm::vec3(0.75f, 0.75f, 0.0f));
     model = model * glm::mat4_cast(qu);
     sceneShader2.use();
     sceneShader2.setMat4("model", model);
-    glDrawElements(GL_TRIANGLES, boxGeometry.indices.size(), GL_UNSIGNED_INT, 0);
+    drawMesh(boxGeometry);
 
     model = glm::mat4(1.0f);
     model = glm::translate(model, glm::vec3(0.75f, -0.75f, 0.0f));
     model = model * glm::mat4_cast(qu);
     sceneShader3.use();
     sceneShader3.setMat4("model", model);
-    glDrawElements(GL_TRIANGLES, boxGeometry.indices.size(), GL_UNSIGNED_INT, 0);
+    drawMesh(boxGeometry);
 
     model = glm::mat4(1.0f);
     model = glm::translate(model, glm::vec3(-0.75f, -0.75f, 0.0f));
     model = model * glm::mat4_cast(qu);
     sceneShader4.use();
     sceneShader4.setMat4("model", model);
-    glDrawElements(GL_TRIANGLES, boxGeometry.indices.size(), GL_UNSIGNED_INT, 0);
+    drawMesh(boxGeometry);
 
     // 渲染 gui
     ImGui::Render();
@@ -221,6 +222,8 @@ int main(int argc, char *argv[])
     glfwPollEvents();
   }
 
+  sphereGeometry.dispose();
+  boxGeometry.dispose();
   glfwTerminate();
 
   return 0;
@@ -273,88 +276,12 @@ void mouse_callback(GLFWwindow *window, double xpos, double ypos)
   camera.ProcessMouseMovement(xoffset, yoffset);
 }
 
-// 加载纹理贴图
-unsigned int loadTexture(char const *path)
-{
-  unsigned int textureID;
-  glGenTextures(1, &textureID);
-
-  // 图像y轴翻转
-  stbi_set_flip_vertically_on_load(true);
-  int width, height, nrComponents;
-  unsigned char *data = stbi_load(path, &width, &height, &nrComponents, 0);
-  if (data)
-  {
-    GLenum format;
-    if (nrComponents == 1)
-      format = GL_RED;
-    else if (nrComponents == 3)
-      format = GL_RGB;
-    else if (nrComponents == 4)
-      format = GL_RGBA;
-
-    glBindTexture(GL_TEXTURE_2D, textureID);
-    glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, data);
-    glGenerateMipmap(GL_TEXTURE_2D);
-
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-
-    stbi_image_free(data);
-  }
-  else
-  {
-    std::cout << "Texture failed to load at path: " << path << std::endl;
-    stbi_image_free(data);
-  }
-
-  return textureID;
-}
-
-// 加载立方体贴图
-
-unsigned int loadCubemap(vector<std::string> faces)
-{
-  unsigned int textureID;
-  glGenTextures(1, &textureID);
-  glBindTexture(GL_TEXTURE_CUBE_MAP, textureID);
-
-  // 此处需要将y轴旋转关闭，若之前调用过loadTexture
-  stbi_set_flip_vertically_on_load(false);
-
-  int width, height, nrChannels;
-  for (unsigned int i = 0; i < faces.size(); i++)
-  {
-    unsigned char *data = stbi_load(faces[i].c_str(), &width, &height, &nrChannels, 0);
-    if (data)
-    {
-      glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i,
-                   0, GL_RGB, width, height, 0, GL_RGB, GL_UNSIGNED_BYTE, data);
-      stbi_image_free(data);
-    }
-    else
-    {
-      std::cout << "Cubemap texture failed to load at path: " << faces[i] << std::endl;
-      stbi_image_free(data);
-    }
-  }
-  glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-  glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-  glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-  glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-  glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
-
-  return textureID;
-}
-
 // *******************method*********************
-void drawSkyBox(Shader shader, BoxGeometry geometry, unsigned int cubeMap)
+void drawSkyBox(Shader &shader, const BoxGeometry &geometry, unsigned int cubeMap)
 {
 
-  glDepthFunc(GL_LEQUAL);
-  glDisable(GL_DEPTH_TEST);
+  RenderState::setDepthFunc(GL_LEQUAL);
+  RenderState::setDepthTest(false);
 
   glm::mat4 view = camera.GetViewMatrix();
   glm::mat4 projection = glm::perspective(glm::radians(camera.Zoom), (float)SCREEN_WIDTH / (float)SCREEN_HEIGHT, 0.1f, 100.0f);
@@ -365,13 +292,10 @@ void drawSkyBox(Shader shader, BoxGeometry geometry, unsigned int cubeMap)
   shader.setMat4("view", view);
   shader.setMat4("projection", projection);
 
-  glActiveTexture(GL_TEXTURE0);
-  glBindTexture(GL_TEXTURE_CUBE_MAP, cubeMap);
-  glBindVertexArray(geometry.VAO);
-  glDrawElements(GL_TRIANGLES, geometry.indices.size(), GL_UNSIGNED_INT, 0);
+  RenderState::bindTexture(0, GL_TEXTURE_CUBE_MAP, cubeMap);
+  drawMesh(geometry);
 
-  glBindVertexArray(0);
-  glDepthFunc(GL_LESS);
-  glEnable(GL_DEPTH_TEST);
+  RenderState::setDepthFunc(GL_LESS);
+  RenderState::setDepthTest(true);
   view = camera.GetViewMatrix();
 }
@@ -3,8 +3,12 @@
 #include <iostream>
 #include <cmath>
 #include <map>
+#include <memory>
+#include <vector>
 
 #include <tool/shader.h>
+#include <tool/render_state.h>
+#include <tool/frame_constants.h>
 #include <tool/camera.h>
 #include <geometry/BoxGeometry.h>
 #include <geometry/PlaneGeometry.h>
@@ -12,19 +16,29 @@
 
 #define STB_IMAGE_IMPLEMENTATION
 #include <tool/stb_image.h>
+#include <tool/texture_cache.h>
 
 #include <tool/gui.h>
 
 #include <tool/mesh.h>
 #include <tool/model.h>
+#include <tool/model_handle.h>
+#include <tool/instance_buffer.h>
+#include <tool/instance_culler.h>
+#include <tool/occlusion_culler.h>
+#include <tool/gpu_culler.h>
+#include <geometry/Frustum.h>
 
 void framebuffer_size_callback(GLFWwindow *window, int width, int height);
 void mouse_callback(GLFWwindow *window, double xpos, double ypos);
 void processInput(GLFWwindow *window);
-unsigned int loadTexture(char const *path);
-unsigned int loadCubemap(vector<std::string> faces);
 
-void drawSkyBox(Shader shader, BoxGeometry geometry, unsigned int cubeMap);
+void drawSkyBox(Shader &shader, const BoxGeometry &geometry, unsigned int cubeMap);
+void setupInstanceMatrix(unsigned int VAO, unsigned int buffer, size_t offset);
+void drawLoadingWindow(ModelHandle &rock, ModelHandle &planet);
+void drawCullingWindow(bool &culling, float &cutoff, bool &occlusionCulling, const InstanceCuller &culler, const InstanceBuffer &instances,
+                       const OcclusionCuller &occlusion, unsigned int submitted);
+void drawGpuCullingWindow(bool &gpuCulling, GpuCuller *gpuCuller);
 
 std::string Shader::dirName;
 
@@ -53,13 +67,20 @@ int main(int argc, char *argv[])
 
   // 片段着色器将作用域每一个采样点（采用4倍抗锯齿，则每个像素有4个片段（四个采样点））
   // glfwWindowHint(GLFW_SAMPLES, 4);
-  glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+  // GPU 剔除需要 4.3 的计算着色器和间接绘制，创建失败时退回 3.3，使用 CPU 剔除
+  glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
   glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
   glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
 
   // 窗口对象
   GLFWwindow *window = glfwCreateWindow(SCREEN_WIDTH, SCREEN_HEIGHT, "LearnOpenGL", NULL, NULL);
   if (window == NULL)
+  {
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+    window = glfwCreateWindow(SCREEN_WIDTH, SCREEN_HEIGHT, "LearnOpenGL", NULL, NULL);
+  }
+  if (window == NULL)
   {
     std::cout << "Failed to create GLFW window" << std::endl;
     glfwTerminate();
@@ -104,6 +125,9 @@ int main(int argc, char *argv[])
   Shader sceneShader("./shader/scene_vert.glsl", "./shader/scene_frag.glsl");
   Shader instanceShader("./shader/instance_vert.glsl", "./shader/scene_frag.glsl");
 
+  // 两个着色器共享的每帧常量
+  FrameConstants frameConstants;
+
   PlaneGeometry planeGeometry(0.1, 0.1);          // 面板
   BoxGeometry boxGeometry(0.1, 0.1, 0.1);         // 盒子
   SphereGeometry sphereGeometry(0.1, 10.0, 10.0); // 圆球
@@ -111,10 +135,18 @@ int main(int argc, char *argv[])
   float fov = 45.0f;                                                          // 视锥体的角度
   ImVec4 clear_color = ImVec4(25.0 / 255.0, 25.0 / 255.0, 25.0 / 255.0, 1.0); // 25, 25, 25
 
-  Model rock("./static/model/rock/rock.obj");
-  Model planet("./static/model/planet/planet.obj");
-
-  unsigned int amount = 100000;
+  // 十万个小行星实例，顶点读取带宽占比大，两个模型使用 24 字节的压缩顶点布局
+  // 模型在后台线程上加载，渲染循环每帧上传已经就绪的部分，加载期间行星画成线框包围盒
+  // 网格和贴图的数据经 UploadScheduler 分帧提交，每帧最多 8 MB，加载期间帧时间不出现尖峰
+  UploadScheduler::enabled = true;
+  GeometryHandle::defaultLayout = VertexLayout::compact();
+  ModelHandle rock("./static/model/rock/rock.obj");
+  ModelHandle planet("./static/model/planet/planet.obj");
+  GeometryHandle::defaultLayout = VertexLayout::standard();
+  BoxGeometry placeholderGeometry(1.0, 1.0, 1.0);
+
+  // 第二个参数可以指定数量，例如 1000000
+  unsigned int amount = argc > 2 ? (unsigned int)atoi(argv[2]) : 100000;
   glm::mat4 *modelMatrices;
   modelMatrices = new glm::mat4[amount];
   srand(glfwGetTime()); // initialize random seed
@@ -145,35 +177,44 @@ int main(int argc, char *argv[])
     modelMatrices[i] = model;
   }
 
-  // 设置实例化数组
+  // 设置实例化数组，关闭剔除时绘制全部实例
   unsigned int buffer;
   glGenBuffers(1, &buffer);
   glBindBuffer(GL_ARRAY_BUFFER, buffer);
   glBufferData(GL_ARRAY_BUFFER, amount * sizeof(glm::mat4), &modelMatrices[0], GL_STATIC_DRAW);
-  for (unsigned int i = 0; i < rock.meshes.size(); i++)
+
+  // 动态实例化：每帧在工作线程上按视锥和距离剔除，可见实例的矩阵紧凑地写进三块轮换的实例缓冲，只绘制可见的数量
+  // 包围球由模型空间的包围盒得到，导入期间包围盒还在变大，变化后重新计算
+  bool culling = true;
+  float cutoff = 60.0f; // 距离剔除，0 表示只按视锥
+  SphereSoA rockSpheres;
+  Bounds sphereBounds;
+  // 析构时删除同步对象并解除映射，需要在 glfwTerminate 之前释放
+  std::unique_ptr<InstanceBuffer> instances(new InstanceBuffer(amount));
+  InstanceCuller culler;
+  // 软件遮挡剔除：行星的代理球每帧以 256x128 光栅化，被它挡住的石头不提交
+  bool occlusionCulling = true;
+  OcclusionCuller occlusion(256, 128);
+
+  // GPU 剔除：矩阵在这里上传一次，包围球在石头加载完成（包围盒不再变化）后上传一次，
+  // 之后计算着色器写出可见下标和间接绘制命令，CPU 不再读写逐实例的数据
+  bool gpuCulling = GpuCuller::supported();
+  std::unique_ptr<GpuCuller> gpuCuller;
+  std::unique_ptr<Shader> gpuInstanceShader;
+  unsigned int matricesBuffer = 0;
+  if (GpuCuller::supported())
   {
-    unsigned int VAO = rock.meshes[i].VAO;
-    glBindVertexArray(VAO);
-    // 顶点属性
-    GLsizei vec4Size = sizeof(glm::vec4);
-    glEnableVertexAttribArray(3);
-    glVertexAttribPointer(3, 4, GL_FLOAT, GL_FALSE, 4 * vec4Size, (void *)0);
-    glEnableVertexAttribArray(4);
-    glVertexAttribPointer(4, 4, GL_FLOAT, GL_FALSE, 4 * vec4Size, (void *)(vec4Size));
-    glEnableVertexAttribArray(5);
-    glVertexAttribPointer(5, 4, GL_FLOAT, GL_FALSE, 4 * vec4Size, (void *)(2 * vec4Size));
-    glEnableVertexAttribArray(6);
-    glVertexAttribPointer(6, 4, GL_FLOAT, GL_FALSE, 4 * vec4Size, (void *)(3 * vec4Size));
-
-    glVertexAttribDivisor(3, 1);
-    glVertexAttribDivisor(4, 1);
-    glVertexAttribDivisor(5, 1);
-    glVertexAttribDivisor(6, 1);
-
-    glBindVertexArray(0);
+    gpuInstanceShader.reset(new Shader("./shader/instance_gpu_vert.glsl", "./shader/scene_frag.glsl"));
+    glGenBuffers(1, &matricesBuffer);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, matricesBuffer);
+    glBufferData(GL_SHADER_STORAGE_BUFFER, amount * sizeof(glm::mat4), &modelMatrices[0], GL_STATIC_DRAW);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
   }
 
   float factor = 0.0;
+  // 初始化阶段直接调用了 gl 函数，进入渲染循环前清空状态缓存
+  RenderState::invalidate();
+
   while (!glfwWindowShouldClose(window))
   {
     processInput(window);
@@ -196,6 +237,15 @@ int main(int argc, char *argv[])
     ImGui_ImplGlfw_NewFrame();
     ImGui::NewFrame();
     factor = glfwGetTime();
+    FrustumCuller::beginFrame();
+
+    // 上传后台线程已经准备好的网格和贴图
+    rock.update();
+    planet.update();
+    UploadScheduler::flush();
+    Model &rockModel = rock.model();
+    if (!rock.ready() || !planet.ready())
+      drawLoadingWindow(rock, planet);
     // *************************************************************************
 
     // 渲染指令
@@ -207,14 +257,25 @@ int main(int argc, char *argv[])
     glm::mat4 projection = glm::perspective(glm::radians(camera.Zoom), (float)SCREEN_WIDTH / (float)SCREEN_HEIGHT, 0.1f, 100.0f);
     glm::mat4 model = glm::mat4(1.0f);
 
+    frameConstants.setCamera(view, projection, camera.Position);
+    frameConstants.setTime(currentFrame, deltaTime);
+    frameConstants.upload();
+
     sceneShader.use();
-    sceneShader.setMat4("projection", projection);
-    sceneShader.setMat4("view", view);
     model = glm::translate(model, glm::vec3(0.0f, -1.0f, 4.0f));
     model = glm::scale(model, glm::vec3(1.0f, 1.0f, 1.0f));
     sceneShader.setMat4("model", model);
 
-    planet.Draw(sceneShader);
+    // 行星逐个网格测试，平面变换到模型空间
+    planet.Draw(sceneShader, Frustum::fromMatrix(projection * view * model));
+    glm::mat4 placeholder;
+    if (planet.placeholder(model, placeholder))
+    {
+      sceneShader.setMat4("model", placeholder);
+      glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
+      drawMesh(placeholderGeometry);
+      glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
+    }
 
     // for (unsigned int i = 0; i < amount; i++)
     // {
@@ -222,16 +283,90 @@ int main(int argc, char *argv[])
     //   rock.Draw(sceneShader);
     // }
 
-    instanceShader.use();
-    instanceShader.setMat4("projection", projection);
-    instanceShader.setMat4("view", view);
-    instanceShader.setInt("diffuseTexture", 0);
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, rock.textures_loaded[0].id);
-    for (unsigned int i = 0; i < rock.meshes.size(); i++)
+    Bounds rockBounds = rock.bounds();
+    if (!rockBounds.empty() && (rockBounds.min != sphereBounds.min || rockBounds.max != sphereBounds.max))
     {
-      glBindVertexArray(rock.meshes[i].VAO);
-      glDrawElementsInstanced(GL_TRIANGLES, rock.meshes[i].indices.size(), GL_UNSIGNED_INT, 0, amount);
+      sphereBounds = rockBounds;
+      rockSpheres.clear();
+      rockSpheres.reserve(amount);
+      for (unsigned int i = 0; i < amount; i++)
+        rockSpheres.push(rockBounds, modelMatrices[i]);
+    }
+
+    if (GpuCuller::supported() && !gpuCuller && rock.ready() && rockSpheres.size() == amount)
+    {
+      std::vector<glm::vec4> spheres(amount);
+      for (unsigned int i = 0; i < amount; i++)
+        spheres[i] = glm::vec4(rockSpheres.x[i], rockSpheres.y[i], rockSpheres.z[i], rockSpheres.radius[i]);
+      gpuCuller.reset(new GpuCuller(spheres));
+    }
+    drawGpuCullingWindow(gpuCulling, gpuCuller.get());
+
+    unsigned int instanceCount = amount;
+    unsigned int instanceBuffer = buffer;
+    size_t instanceOffset = 0;
+    bool gpu = culling && gpuCulling && gpuCuller;
+    bool dynamic = culling && !gpu && rockSpheres.size() == amount;
+    // CPU 路径的遮挡体是行星：包围盒最短的半边长作为半径，内接多面体比行星小，不会挡住露出来的石头
+    occlusion.beginFrame(projection * view);
+    Bounds planetBounds = planet.bounds();
+    bool occluding = dynamic && occlusionCulling && planet.ready() && !planetBounds.empty();
+    if (occluding)
+    {
+      glm::vec3 extents = planetBounds.extents();
+      occlusion.addSphere(model, planetBounds.center(), std::min(extents.x, std::min(extents.y, extents.z)));
+    }
+    if (gpu)
+    {
+      std::vector<const GeometryHandle *> meshes;
+      for (const Mesh &mesh : rockModel.meshes)
+        meshes.push_back(&mesh);
+      gpuCuller->setMeshes(meshes);
+      gpuCuller->cull(projection * view, camera.Position, cutoff);
+
+      gpuInstanceShader->use();
+      gpuInstanceShader->setInt("diffuseTexture", 0);
+      if (!rockModel.textures_loaded.empty())
+        RenderState::bindTexture(0, GL_TEXTURE_2D, rockModel.textures_loaded[0].id);
+      glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 3, matricesBuffer);
+      for (unsigned int i = 0; i < rockModel.meshes.size(); i++)
+        gpuCuller->draw(rockModel.meshes[i], i);
+    }
+    else if (dynamic)
+    {
+      Frustum frustum = Frustum::fromMatrix(projection * view);
+      frustum.setDistanceCutoff(camera.Position, cutoff);
+      glm::mat4 *mapped = (glm::mat4 *)instances->map();
+      instanceCount = (unsigned int)culler.cull(frustum, rockSpheres, modelMatrices, mapped, occluding ? &occlusion : nullptr);
+      instances->unmap();
+      instanceBuffer = instances->buffer;
+      instanceOffset = instances->offset();
+    }
+    drawCullingWindow(culling, cutoff, occlusionCulling, culler, *instances, occlusion, gpu ? gpuCuller->stats.visible : instanceCount);
+
+    if (!gpu)
+    {
+      instanceShader.use();
+      instanceShader.setInt("diffuseTexture", 0);
+      if (!rockModel.textures_loaded.empty())
+        RenderState::bindTexture(0, GL_TEXTURE_2D, rockModel.textures_loaded[0].id);
+      for (unsigned int i = 0; i < rockModel.meshes.size(); i++)
+      {
+        // 每帧的区域不同，实例矩阵属性重新指向这一帧的偏移
+        setupInstanceMatrix(rockModel.meshes[i].VAO, instanceBuffer, instanceOffset);
+        if (instanceCount > 0)
+          drawMeshInstanced(rockModel.meshes[i], instanceCount);
+      }
+    }
+    if (dynamic)
+      instances->fence();
+
+    // 场景画完之后生成下一帧遮挡测试用的深度金字塔，gui 不参与遮挡
+    if (gpu)
+    {
+      int width, height;
+      glfwGetFramebufferSize(window, &width, &height);
+      gpuCuller->captureDepth(width, height);
     }
 
     // 渲染 gui
@@ -242,11 +377,108 @@ int main(int argc, char *argv[])
     glfwPollEvents();
   }
 
+  gpuCuller.reset();
+  instances.reset();
+  frameConstants.dispose();
+  planeGeometry.dispose();
+  boxGeometry.dispose();
+  sphereGeometry.dispose();
+  rock.dispose();
+  planet.dispose();
+  placeholderGeometry.dispose();
+  UploadScheduler::dispose();
   glfwTerminate();
 
   return 0;
 }
 
+// 实例矩阵占用 3~6 四个属性位置，每个实例更新一次，从 buffer 的 offset 字节处开始读取
+void setupInstanceMatrix(unsigned int VAO, unsigned int buffer, size_t offset)
+{
+  glBindVertexArray(VAO);
+  // 属性指针取自当前绑定的 GL_ARRAY_BUFFER，网格上传时绑定过各自的顶点缓冲
+  glBindBuffer(GL_ARRAY_BUFFER, buffer);
+  // 顶点属性
+  GLsizei vec4Size = sizeof(glm::vec4);
+  glEnableVertexAttribArray(3);
+  glVertexAttribPointer(3, 4, GL_FLOAT, GL_FALSE, 4 * vec4Size, (void *)(offset));
+  glEnableVertexAttribArray(4);
+  glVertexAttribPointer(4, 4, GL_FLOAT, GL_FALSE, 4 * vec4Size, (void *)(offset + vec4Size));
+  glEnableVertexAttribArray(5);
+  glVertexAttribPointer(5, 4, GL_FLOAT, GL_FALSE, 4 * vec4Size, (void *)(offset + 2 * vec4Size));
+  glEnableVertexAttribArray(6);
+  glVertexAttribPointer(6, 4, GL_FLOAT, GL_FALSE, 4 * vec4Size, (void *)(offset + 3 * vec4Size));
+
+  glVertexAttribDivisor(3, 1);
+  glVertexAttribDivisor(4, 1);
+  glVertexAttribDivisor(5, 1);
+  glVertexAttribDivisor(6, 1);
+
+  glBindVertexArray(0);
+  // 直接绑定了 VAO，让状态缓存重新绑定
+  RenderState::forgetVertexArray(VAO);
+}
+
+// 加载进度窗口，样式与 CGfinal 的开始窗口相同
+void drawLoadingWindow(ModelHandle &rock, ModelHandle &planet)
+{
+  ImGui::SetNextWindowSize(ImVec2(400, 120));                                         // 设置窗口大小
+  ImGui::SetNextWindowPos(ImVec2(SCREEN_WIDTH / 2 - 200, SCREEN_HEIGHT / 2 - 60)); // 居中
+  ImGui::Begin("Loading", NULL, ImGuiWindowFlags_NoResize | ImGuiWindowFlags_NoCollapse | ImGuiWindowFlags_NoMove);
+  ImGui::Text("rock: %s", rock.status());
+  ImGui::ProgressBar(rock.progress());
+  ImGui::Text("planet: %s", planet.status());
+  ImGui::ProgressBar(planet.progress());
+  ImGui::End();
+}
+
+// 剔除开关、距离、线程数和上一帧的统计
+void drawCullingWindow(bool &culling, float &cutoff, bool &occlusionCulling, const InstanceCuller &culler, const InstanceBuffer &instances,
+                       const OcclusionCuller &occlusion, unsigned int submitted)
+{
+  const CullStats &last = FrustumCuller::lastFrame;
+  const InstanceCullStats &rocks = culler.stats;
+  ImGui::Begin("frustum culling");
+  ImGui::Checkbox("enabled", &culling);
+  ImGui::SliderFloat("distance", &cutoff, 0.0f, 100.0f);
+  int threads = (int)Parallel::threadCount;
+  if (ImGui::SliderInt("threads (0 = all)", &threads, 0, (int)std::thread::hardware_concurrency()))
+    Parallel::threadCount = (unsigned int)threads;
+  ImGui::Text("%s, submitted %u / %zu", FrustumCuller::modeName(FrustumCuller::Mode::Best), submitted, rocks.instances);
+  ImGui::Text("rocks: cull %.3f ms + compact %.3f ms on %u threads", rocks.cullMs, rocks.compactMs, rocks.threads);
+  ImGui::Text("instance buffer: %s, stalls %u", InstanceBuffer::persistentMapping() ? "persistent" : "map per frame", instances.stalls);
+  ImGui::Text("last frame: tested %zu, culled %zu, %.3f ms", last.tested, last.culled, last.ms);
+  // 软件遮挡剔除只用于 CPU 路径，GPU 路径用 Hi-Z
+  const OcclusionStats &occluded = occlusion.lastFrame;
+  ImGui::Checkbox("software occlusion (CPU path)", &occlusionCulling);
+  ImGui::Text("occlusion: %zu triangles in %.3f ms, occluded %zu / %zu, test %.3f ms", occluded.triangles, occluded.rasterizeMs, occluded.occluded,
+              occluded.tested, occluded.testMs);
+  ImGui::End();
+}
+
+// GPU 剔除的开关和几帧之前回读的统计，GL 3.3 上只显示不支持
+void drawGpuCullingWindow(bool &gpuCulling, GpuCuller *gpuCuller)
+{
+  ImGui::Begin("gpu culling");
+  if (!GpuCuller::supported())
+  {
+    ImGui::Text("needs GL 4.3, using CPU culling");
+    ImGui::End();
+    return;
+  }
+  ImGui::Checkbox("compute shader + indirect draw", &gpuCulling);
+  if (gpuCuller == nullptr)
+    ImGui::Text("waiting for rock bounds");
+  else
+  {
+    ImGui::Checkbox("Hi-Z occlusion", &gpuCuller->occlusion);
+    const GpuCullStats &stats = gpuCuller->stats;
+    ImGui::Text("visible %u / %u", stats.visible, stats.instances);
+    ImGui::Text("cull %.3f ms, Hi-Z %.3f ms (GPU)", stats.cullMs, stats.hiZMs);
+  }
+  ImGui::End();
+}
+
 // 窗口变动监听
 void framebuffer_size_callback(GLFWwindow *window, int width, int height)
 {
@@ -294,88 +526,12 @@ void mouse_callback(GLFWwindow *window, double xpos, double ypos)
   camera.ProcessMouseMovement(xoffset, yoffset);
 }
 
-// 加载纹理贴图
-unsigned int loadTexture(char const *path)
-{
-  unsigned int textureID;
-  glGenTextures(1, &textureID);
-
-  // 图像y轴翻转
-  stbi_set_flip_vertically_on_load(true);
-  int width, height, nrComponents;
-  unsigned char *data = stbi_load(path, &width, &height, &nrComponents, 0);
-  if (data)
-  {
-    GLenum format;
-    if (nrComponents == 1)
-      format = GL_RED;
-    else if (nrComponents == 3)
-      format = GL_RGB;
-    else if (nrComponents == 4)
-      format = GL_RGBA;
-
-    glBindTexture(GL_TEXTURE_2D, textureID);
-    glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, data);
-    glGenerateMipmap(GL_TEXTURE_2D);
-
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-
-    stbi_image_free(data);
-  }
-  else
-  {
-    std::cout << "Texture failed to load at path: " << path << std::endl;
-    stbi_image_free(data);
-  }
-
-  return textureID;
-}
-
-// 加载立方体贴图
-
-unsigned int loadCubemap(vector<std::string> faces)
-{
-  unsigned int textureID;
-  glGenTextures(1, &textureID);
-  glBindTexture(GL_TEXTURE_CUBE_MAP, textureID);
-
-  // 此处需要将y轴旋转关闭，若之前调用过loadTexture
-  stbi_set_flip_vertically_on_load(false);
-
-  int width, height, nrChannels;
-  for (unsigned int i = 0; i < faces.size(); i++)
-  {
-    unsigned char *data = stbi_load(faces[i].c_str(), &width, &height, &nrChannels, 0);
-    if (data)
-    {
-      glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i,
-                   0, GL_RGB, width, height, 0, GL_RGB, GL_UNSIGNED_BYTE, data);
-      stbi_image_free(data);
-    }
-    else
-    {
-      std::cout << "Cubemap texture failed to load at path: " << faces[i] << std::endl;
-      stbi_image_free(data);
-    }
-  }
-  glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-  glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-  glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-  glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-  glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
-
-  return textureID;
-}
-
 // *******************method*********************
-void drawSkyBox(Shader shader, BoxGeometry geometry, unsigned int cubeMap)
+void drawSkyBox(Shader &shader, const BoxGeometry &geometry, unsigned int cubeMap)
 {
 
-  glDepthFunc(GL_LEQUAL);
-  glDisable(GL_DEPTH_TEST);
+  RenderState::setDepthFunc(GL_LEQUAL);
+  RenderState::setDepthTest(false);
 
   glm::mat4 view = camera.GetViewMatrix();
   glm::mat4 projection = glm::perspective(glm::radians(camera.Zoom), (float)SCREEN_WIDTH / (float)SCREEN_HEIGHT, 0.1f, 100.0f);
@@ -386,13 +542,10 @@ void drawSkyBox(Shader shader, BoxGeometry geometry, unsigned int cubeMap)
   shader.setMat4("view", view);
   shader.setMat4("projection", projection);
 
-  glActiveTexture(GL_TEXTURE0);
-  glBindTexture(GL_TEXTURE_CUBE_MAP, cubeMap);
-  glBindVertexArray(geometry.VAO);
-  glDrawElements(GL_TRIANGLES, geometry.indices.size(), GL_UNSIGNED_INT, 0);
+  RenderState::bindTexture(0, GL_TEXTURE_CUBE_MAP, cubeMap);
+  drawMesh(geometry);
 
-  glBindVertexArray(0);
-  glDepthFunc(GL_LESS);
-  glEnable(GL_DEPTH_TEST);
+  RenderState::setDepthFunc(GL_LESS);
+  RenderState::setDepthTest(true);
   view = camera.GetViewMatrix();
 }
@@ -0,0 +1,19 @@
+#version 430 core
+layout(location = 0) in vec3 Position;
+layout(location = 1) in vec3 Normal;
+layout(location = 2) in vec2 TexCoords;
+
+#include "frame_constants.glsl"
+#include "gpu_instances.glsl"
+
+// 全部实例的矩阵，启动时上传一次
+layout(std430, binding = 3) readonly buffer InstanceMatrices {
+  mat4 instanceMatrices[];
+};
+
+out vec2 oTexCoord;
+
+void main() {
+  oTexCoord = TexCoords;
+  gl_Position = viewProj * instanceMatrices[visibleInstance()] * vec4(Position, 1.0f);
+}
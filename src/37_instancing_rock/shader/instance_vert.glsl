@@ -5,12 +5,11 @@ layout(location = 2) in vec2 TexCoords;
 
 layout(location = 3) in mat4 instanceMatrix;
 
-uniform mat4 view;
-uniform mat4 projection;
+#include "frame_constants.glsl"
 
 out vec2 oTexCoord;
 
 void main() {
   oTexCoord = TexCoords;
-  gl_Position = projection * view * instanceMatrix * vec4(Position, 1.0f);
+  gl_Position = viewProj * instanceMatrix * vec4(Position, 1.0f);
 }
\ No newline at end of file
@@ -4,12 +4,11 @@ layout(location = 1) in vec3 Normal;
 layout(location = 2) in vec2 TexCoords;
 
 uniform mat4 model;
-uniform mat4 view;
-uniform mat4 projection;
+#include "frame_constants.glsl"
 
 out vec2 oTexCoord;
 
 void main() {
   oTexCoord = TexCoords;
-  gl_Position = projection * view * model * vec4(Position, 1.0f);
+  gl_Position = viewProj * model * vec4(Position, 1.0f);
 }
\ No newline at end of file
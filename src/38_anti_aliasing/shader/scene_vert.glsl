@@ -4,8 +4,7 @@ layout(location = 1) in vec3 Normal;
 layout(location = 2) in vec2 TexCoords;
 
 uniform mat4 model;
-uniform mat4 view;
-uniform mat4 projection;
+#include "frame_constants.glsl"
 
 out vec2 oTexCoord;
 
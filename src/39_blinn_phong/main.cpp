@@ -5,6 +5,7 @@
 #include <map>
 
 #include <tool/shader.h>
+#include <tool/frame_constants.h>
 #include <tool/camera.h>
 #include <geometry/BoxGeometry.h>
 #include <geometry/PlaneGeometry.h>
@@ -12,13 +13,13 @@
 
 #define STB_IMAGE_IMPLEMENTATION
 #include <tool/stb_image.h>
+#include <tool/texture_cache.h>
 
 #include <tool/gui.h>
 
 void framebuffer_size_callback(GLFWwindow *window, int width, int height);
 void mouse_callback(GLFWwindow *window, double xpos, double ypos);
 void processInput(GLFWwindow *window);
-unsigned int loadTexture(char const *path);
 
 std::string Shader::dirName;
 
@@ -106,10 +107,13 @@ int main(int argc, char *argv[])
   Shader sceneShader("./shader/scene_vert.glsl", "./shader/scene_frag.glsl");
   Shader lightObjectShader("./shader/light_object_vert.glsl", "./shader/light_object_frag.glsl");
 
+  // 所有着色器共享的每帧常量
+  FrameConstants frameConstants;
+
   PlaneGeometry groundGeometry(10.0, 10.0);            // 地面
   SphereGeometry pointLightGeometry(0.01, 10.0, 10.0); // 点光源位置显示
 
-  unsigned int woodMap = loadTexture("./static/texture/wood.png"); // 地面
+  unsigned int woodMap = TextureCache::load("./static/texture/wood.png"); // 地面
 
   float factor = 0.0;
 
@@ -159,8 +163,10 @@ int main(int argc, char *argv[])
     glm::mat4 projection = glm::mat4(1.0f);
     projection = glm::perspective(glm::radians(camera.Zoom), (float)SCREEN_WIDTH / (float)SCREEN_HEIGHT, 0.1f, 100.0f);
 
-    sceneShader.setMat4("view", view);
-    sceneShader.setMat4("projection", projection);
+    frameConstants.setCamera(view, projection, camera.Position);
+    frameConstants.setTime(currentFrame, deltaTime);
+    frameConstants.upload();
+
     sceneShader.setVec3("viewPos", camera.Position);
 
     glm::vec3 lightPos = glm::vec3(lightPosition.x + glm::sin(glfwGetTime()) * 2.0, lightPosition.y, lightPosition.z);
@@ -177,17 +183,13 @@ int main(int argc, char *argv[])
     sceneShader.setFloat("uvScale", 4.0f);
     sceneShader.setMat4("model", model);
 
-    glBindVertexArray(groundGeometry.VAO);
-    glDrawElements(GL_TRIANGLES, groundGeometry.indices.size(), GL_UNSIGNED_INT, 0);
-    glBindVertexArray(0);
+    drawMesh(groundGeometry);
     // ********************************************************
 
     // 绘制灯光物体
     // ********************************************************
     // 绘制灯光物体
     lightObjectShader.use();
-    lightObjectShader.setMat4("view", view);
-    lightObjectShader.setMat4("projection", projection);
 
     model = glm::mat4(1.0f);
     model = glm::translate(model, lightPosition);
@@ -195,8 +197,7 @@ int main(int argc, char *argv[])
     lightObjectShader.setMat4("model", model);
     lightObjectShader.setVec3("lightColor", glm::vec3(1.0f, 1.0f, 1.0f));
 
-    glBindVertexArray(pointLightGeometry.VAO);
-    glDrawElements(GL_TRIANGLES, pointLightGeometry.indices.size(), GL_UNSIGNED_INT, 0);
+    drawMesh(pointLightGeometry);
     // ********************************************************
 
     // 渲染 gui
@@ -207,6 +208,7 @@ int main(int argc, char *argv[])
     glfwPollEvents();
   }
 
+  frameConstants.dispose();
   groundGeometry.dispose();
   pointLightGeometry.dispose();
   glfwTerminate();
@@ -260,43 +262,3 @@ void mouse_callback(GLFWwindow *window, double xpos, double ypos)
 
   camera.ProcessMouseMovement(xoffset, yoffset);
 }
-
-// 加载纹理贴图
-unsigned int loadTexture(char const *path)
-{
-  unsigned int textureID;
-  glGenTextures(1, &textureID);
-
-  // 图像y轴翻转
-  stbi_set_flip_vertically_on_load(true);
-  int width, height, nrComponents;
-  unsigned char *data = stbi_load(path, &width, &height, &nrComponents, 0);
-  if (data)
-  {
-    GLenum format;
-    if (nrComponents == 1)
-      format = GL_RED;
-    else if (nrComponents == 3)
-      format = GL_RGB;
-    else if (nrComponents == 4)
-      format = GL_RGBA;
-
-    glBindTexture(GL_TEXTURE_2D, textureID);
-    glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, data);
-    glGenerateMipmap(GL_TEXTURE_2D);
-
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-
-    stbi_image_free(data);
-  }
-  else
-  {
-    std::cout << "Texture failed to load at path: " << path << std::endl;
-    stbi_image_free(data);
-  }
-
-  return textureID;
-}
\ No newline at end of file
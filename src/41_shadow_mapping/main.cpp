@@ -5,6 +5,8 @@
 #include <map>
 
 #include <tool/shader.h>
+#include <tool/frame_constants.h>
+#include <tool/shader_variants.h>
 #include <tool/camera.h>
 #include <geometry/BoxGeometry.h>
 #include <geometry/PlaneGeometry.h>
@@ -12,17 +14,16 @@
 
 #define STB_IMAGE_IMPLEMENTATION
 #include <tool/stb_image.h>
+#include <tool/texture_cache.h>
 
 #include <tool/gui.h>
 
 void framebuffer_size_callback(GLFWwindow *window, int width, int height);
 void mouse_callback(GLFWwindow *window, double xpos, double ypos);
 void processInput(GLFWwindow *window);
-unsigned int loadTexture(char const *path);
 
 // method
-void drawMesh(BufferGeometry geometry);
-void drawLightObject(Shader shader, BufferGeometry geometry, glm::vec3 position);
+void drawLightObject(Shader &shader, const BufferGeometry &geometry, glm::vec3 position);
 
 std::string Shader::dirName;
 
@@ -45,6 +46,9 @@ float lastY = SCREEN_HEIGHT / 2.0f;
 
 Camera camera(glm::vec3(0.0, 1.0, 6.0));
 
+// 阴影开关，运行时用 O 键切换
+bool shadows = true;
+
 using namespace std;
 
 int main(int argc, char *argv[])
@@ -115,18 +119,22 @@ int main(int argc, char *argv[])
   Shader sceneShader("./shader/scene_vert.glsl", "./shader/scene_frag.glsl");
   Shader lightObjectShader("./shader/light_object_vert.glsl", "./shader/light_object_frag.glsl");
   Shader simpleShadowShader("./shader/shadow_map_vert.glsl", "./shader/shadow_map_frag.glsl");
-  Shader finalShaderShader("./shader/shadow_final_vert.glsl", "./shader/shadow_final_frag.glsl");
+  // 有/无阴影两个版本，第一次用到时才编译
+  ShaderVariants finalShaders("./shader/shadow_final_vert.glsl", "./shader/shadow_final_frag.glsl");
 
   Shader quadShader("./shader/shadow_quad_vert.glsl", "./shader/shadow_quad_frag.glsl");
 
+  // 所有着色器共享的每帧常量
+  FrameConstants frameConstants;
+
   PlaneGeometry groundGeometry(10.0, 10.0);            // 地面
   PlaneGeometry quadGeometry(6.0, 6.0);                // 测试面板
   BoxGeometry boxGeometry(1.0, 1.0, 1.0);              // 箱子
   BoxGeometry floorGeometry(10.0, 0.0001, 10.0);       // 箱子
   SphereGeometry pointLightGeometry(0.06, 10.0, 10.0); // 点光源位置显示
 
-  unsigned int woodMap = loadTexture("./static/texture/wood.png");           // 地面
-  unsigned int brickMap = loadTexture("./static/texture/brick_diffuse.jpg"); // 砖墙
+  unsigned int woodMap = TextureCache::load("./static/texture/wood.png");           // 地面
+  unsigned int brickMap = TextureCache::load("./static/texture/brick_diffuse.jpg"); // 砖墙
 
   float factor = 0.0;
 
@@ -158,11 +166,6 @@ int main(int argc, char *argv[])
   quadShader.use();
   quadShader.setInt("depthMap", 0);
 
-  // ------------------------------------------------
-  finalShaderShader.use();
-  finalShaderShader.setInt("diffuseTexture", 0);
-  finalShaderShader.setInt("shadowMap", 1);
-
   glm::vec3 lightPosition = glm::vec3(-2.0f, 3.0f, -1.0f); // 光照位置
   while (!glfwWindowShouldClose(window))
   {
@@ -205,24 +208,28 @@ int main(int argc, char *argv[])
     lightProjection = glm::ortho(-10.0f, 10.0f, -10.0f, 10.0f, near_plane, far_plane);
     lightView = glm::lookAt(lightPosition, glm::vec3(0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
     lightSpaceMatrix = lightProjection * lightView;
-    simpleShadowShader.use();
-    simpleShadowShader.setMat4("lightSpaceMatrix", lightSpaceMatrix);
-
-    glViewport(0, 0, SHADOW_WIDTH, SHADOW_HEIGHT);
-    glBindFramebuffer(GL_FRAMEBUFFER, depthMapFBO);
-    glClear(GL_DEPTH_BUFFER_BIT);
-    glActiveTexture(GL_TEXTURE0);
-    // 绘制场景
-    glBindTexture(GL_TEXTURE_2D, woodMap);
-
-    simpleShadowShader.setMat4("model", model);
-    drawMesh(floorGeometry);
-
-    glBindTexture(GL_TEXTURE_2D, brickMap);
-    model = glm::translate(model, glm::vec3(0.0, 0.5, 0.0));
-    simpleShadowShader.setMat4("model", model);
-    drawMesh(boxGeometry);
-    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    // 关闭阴影时整个深度贴图的 pass 都可以省掉
+    if (shadows)
+    {
+      simpleShadowShader.use();
+      simpleShadowShader.setMat4("lightSpaceMatrix", lightSpaceMatrix);
+
+      glViewport(0, 0, SHADOW_WIDTH, SHADOW_HEIGHT);
+      glBindFramebuffer(GL_FRAMEBUFFER, depthMapFBO);
+      glClear(GL_DEPTH_BUFFER_BIT);
+      glActiveTexture(GL_TEXTURE0);
+      // 绘制场景
+      glBindTexture(GL_TEXTURE_2D, woodMap);
+
+      simpleShadowShader.setMat4("model", model);
+      drawMesh(floorGeometry);
+
+      glBindTexture(GL_TEXTURE_2D, brickMap);
+      model = glm::translate(model, glm::vec3(0.0, 0.5, 0.0));
+      simpleShadowShader.setMat4("model", model);
+      drawMesh(boxGeometry);
+      glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    }
     // ++++++++++++++++++++++++++++++++++++++++++++++++
 
     glViewport(0, 0, SCREEN_WIDTH, SCREEN_HEIGHT);
@@ -231,9 +238,14 @@ int main(int argc, char *argv[])
     glm::mat4 view = camera.GetViewMatrix();
     glm::mat4 projection = glm::perspective(glm::radians(camera.Zoom), (float)SCREEN_WIDTH / (float)SCREEN_HEIGHT, 0.1f, 100.0f);
 
+    frameConstants.setCamera(view, projection, camera.Position);
+    frameConstants.setTime(currentFrame, deltaTime);
+    frameConstants.upload();
+
+    Shader &finalShaderShader = finalShaders.get({{"SHADOWS", shadows ? "1" : "0"}});
     finalShaderShader.use();
-    finalShaderShader.setMat4("view", view);
-    finalShaderShader.setMat4("projection", projection);
+    finalShaderShader.setInt("diffuseTexture", 0);
+    finalShaderShader.setInt("shadowMap", 1);
     finalShaderShader.setVec3("viewPos", camera.Position);
 
     finalShaderShader.setMat4("lightSpaceMatrix", lightSpaceMatrix);
@@ -263,18 +275,21 @@ int main(int argc, char *argv[])
     // quadShader.use();
     // glActiveTexture(GL_TEXTURE0);
     // glBindTexture(GL_TEXTURE_2D, depthMap);
-    // quadShader.setMat4("view", view);
 
     // model = glm::mat4(1.0f);
     // quadShader.setFloat("near_plane", near_plane);
     // quadShader.setFloat("far_plane", far_plane);
     // quadShader.setMat4("model", model);
-    // quadShader.setMat4("projection", projection);
     // drawMesh(quadGeometry);
     // *************************************************
 
     drawLightObject(lightObjectShader, pointLightGeometry, lightPosition);
 
+    ImGui::Begin("controls");
+    ImGui::Text("shadows: %s (O)", shadows ? "on" : "off");
+    ImGui::Text("compiled variants: %u", finalShaders.compiledCount());
+    ImGui::End();
+
     // 渲染 gui
     ImGui::Render();
     ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
@@ -283,33 +298,25 @@ int main(int argc, char *argv[])
     glfwPollEvents();
   }
 
+  frameConstants.dispose();
   groundGeometry.dispose();
   pointLightGeometry.dispose();
+  finalShaders.dispose();
+  quadGeometry.dispose();
+  boxGeometry.dispose();
+  floorGeometry.dispose();
   glfwTerminate();
 
   return 0;
 }
 
-// 绘制物体
-void drawMesh(BufferGeometry geometry)
-{
-  glBindVertexArray(geometry.VAO);
-  glDrawElements(GL_TRIANGLES, geometry.indices.size(), GL_UNSIGNED_INT, 0);
-  glBindVertexArray(0);
-}
-
 // 绘制灯光物体
-void drawLightObject(Shader shader, BufferGeometry geometry, glm::vec3 position)
+void drawLightObject(Shader &shader, const BufferGeometry &geometry, glm::vec3 position)
 {
-  glm::mat4 view = camera.GetViewMatrix();
-  glm::mat4 projection = glm::mat4(1.0f);
   glm::mat4 model = glm::mat4(1.0f);
-  projection = glm::perspective(glm::radians(camera.Zoom), (float)SCREEN_WIDTH / (float)SCREEN_HEIGHT, 0.1f, 100.0f);
 
-  // // 绘制灯光物体
+  // // 绘制灯光物体（view/projection 来自 FrameConstants）
   shader.use();
-  shader.setMat4("view", view);
-  shader.setMat4("projection", projection);
 
   model = glm::mat4(1.0f);
   model = glm::translate(model, position);
@@ -351,6 +358,13 @@ void processInput(GLFWwindow *window)
   {
     camera.ProcessKeyboard(RIGHT, deltaTime);
   }
+
+  // 切换阴影，只响应按下的那一帧
+  static bool shadowKeyDown = false;
+  bool shadowPressed = glfwGetKey(window, GLFW_KEY_O) == GLFW_PRESS;
+  if (!shadowKeyDown && shadowPressed)
+    shadows = !shadows;
+  shadowKeyDown = shadowPressed;
 }
 
 // 鼠标移动监听
@@ -365,43 +379,3 @@ void mouse_callback(GLFWwindow *window, double xpos, double ypos)
 
   camera.ProcessMouseMovement(xoffset, yoffset);
 }
-
-// 加载纹理贴图
-unsigned int loadTexture(char const *path)
-{
-  unsigned int textureID;
-  glGenTextures(1, &textureID);
-
-  // 图像y轴翻转
-  stbi_set_flip_vertically_on_load(true);
-  int width, height, nrComponents;
-  unsigned char *data = stbi_load(path, &width, &height, &nrComponents, 0);
-  if (data)
-  {
-    GLenum format;
-    if (nrComponents == 1)
-      format = GL_RED;
-    else if (nrComponents == 3)
-      format = GL_RGB;
-    else if (nrComponents == 4)
-      format = GL_RGBA;
-
-    glBindTexture(GL_TEXTURE_2D, textureID);
-    glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, data);
-    glGenerateMipmap(GL_TEXTURE_2D);
-
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-
-    stbi_image_free(data);
-  }
-  else
-  {
-    std::cout << "Texture failed to load at path: " << path << std::endl;
-    stbi_image_free(data);
-  }
-
-  return textureID;
-}
\ No newline at end of file
@@ -14,6 +14,12 @@ uniform sampler2D shadowMap;
 uniform vec3 lightPos;
 uniform vec3 viewPos;
 
+// SHADOWS 为 0 时编译出不采样阴影贴图的版本
+#ifndef SHADOWS
+#define SHADOWS 1
+#endif
+
+#if SHADOWS
 float ShadowCalculation(vec4 fragPosLightSpace, vec3 normal, vec3 lightDir) {
   // 执行透视除法
   vec3 projCoords = fragPosLightSpace.xyz / fragPosLightSpace.w;
@@ -48,6 +54,7 @@ float ShadowCalculation(vec4 fragPosLightSpace, vec3 normal, vec3 lightDir) {
 
   return shadow;
 }
+#endif
 
 void main() {
   vec3 color = texture(diffuseTexture, fs_in.TexCoords).rgb;
@@ -68,7 +75,11 @@ void main() {
   vec3 specular = spec * lightColor;    
 
   // calculate shadow
+#if SHADOWS
   float shadow = ShadowCalculation(fs_in.FragPosLightSpace, normal, lightDir);
+#else
+  float shadow = 0.0;
+#endif
   vec3 lighting = (ambient + (1.0 - shadow) * (diffuse + specular)) * color;
 
   FragColor = vec4(lighting, 1.0);
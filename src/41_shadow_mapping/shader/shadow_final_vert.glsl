@@ -10,8 +10,7 @@ out VS_OUT {
   vec4 FragPosLightSpace;
 } vs_out;
 
-uniform mat4 projection;
-uniform mat4 view;
+#include "frame_constants.glsl"
 uniform mat4 model;
 uniform mat4 lightSpaceMatrix;
 uniform float uvScale;
@@ -6,8 +6,7 @@ layout(location = 2) in vec2 TexCoords;
 out vec2 oTexCoord;
 
 uniform mat4 model;
-uniform mat4 view;
-uniform mat4 projection;
+#include "frame_constants.glsl"
 
 void main() {
     gl_Position = projection * view * model * vec4(Position, 1.0f);
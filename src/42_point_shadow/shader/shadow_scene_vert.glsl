@@ -11,8 +11,7 @@ out VS_OUT {
   vec2 TexCoords;
 } vs_out;
 
-uniform mat4 projection;
-uniform mat4 view;
+#include "frame_constants.glsl"
 uniform mat4 model;
 
 uniform float uvScale;
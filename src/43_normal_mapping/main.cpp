@@ -5,6 +5,7 @@
 #include <map>
 
 #include <tool/shader.h>
+#include <tool/frame_constants.h>
 #include <tool/camera.h>
 #include <geometry/BoxGeometry.h>
 #include <geometry/PlaneGeometry.h>
@@ -12,17 +13,16 @@
 
 #define STB_IMAGE_IMPLEMENTATION
 #include <tool/stb_image.h>
+#include <tool/texture_cache.h>
 
 #include <tool/gui.h>
 
 void framebuffer_size_callback(GLFWwindow *window, int width, int height);
 void mouse_callback(GLFWwindow *window, double xpos, double ypos);
 void processInput(GLFWwindow *window);
-unsigned int loadTexture(char const *path);
 
 // method
-void drawMesh(BufferGeometry geometry);
-void drawLightObject(Shader shader, BufferGeometry geometry, glm::vec3 position);
+void drawLightObject(Shader &shader, const BufferGeometry &geometry, glm::vec3 position);
 
 std::string Shader::dirName;
 
@@ -115,14 +115,17 @@ int main(int argc, char *argv[])
   Shader sceneShader("./shader/scene_vert.glsl", "./shader/scene_frag.glsl");
   Shader lightObjectShader("./shader/light_object_vert.glsl", "./shader/light_object_frag.glsl");
 
+  // 所有着色器共享的每帧常量
+  FrameConstants frameConstants;
+
   BoxGeometry boxGeometry(1.0, 1.0, 1.0);      // 箱子
   BoxGeometry floorGeometry(10.0, 0.01, 10.0); // 箱子
   PlaneGeometry planeGeometry(1.0, 1.0);
   SphereGeometry pointLightGeometry(0.06, 10.0, 10.0); // 点光源位置显示
 
-  unsigned int woodDiffuseMap = loadTexture("./static/texture/wood.png");             // 地面
-  unsigned int brickDiffuseMap = loadTexture("./static/texture/brickwall.jpg");       // 砖墙
-  unsigned int brickNormalMap = loadTexture("./static/texture/brickwall_normal.jpg"); // 砖墙
+  unsigned int woodDiffuseMap = TextureCache::load("./static/texture/wood.png");             // 地面
+  unsigned int brickDiffuseMap = TextureCache::load("./static/texture/brickwall.jpg");       // 砖墙
+  unsigned int brickNormalMap = TextureCache::load("./static/texture/brickwall_normal.jpg"); // 砖墙
 
   float factor = 0.0;
 
@@ -163,9 +166,11 @@ int main(int argc, char *argv[])
     glm::mat4 view = camera.GetViewMatrix();
     glm::mat4 projection = glm::perspective(glm::radians(camera.Zoom), (float)SCREEN_WIDTH / (float)SCREEN_HEIGHT, 0.1f, 100.0f);
 
+    frameConstants.setCamera(view, projection, camera.Position);
+    frameConstants.setTime(currentFrame, deltaTime);
+    frameConstants.upload();
+
     sceneShader.use();
-    sceneShader.setMat4("projection", projection);
-    sceneShader.setMat4("view", view);
     sceneShader.setVec3("viewPos", camera.Position);
     sceneShader.setVec3("lightPos", lightPosition); // 光源位置
     sceneShader.setFloat("strength", 0.01);         // 环境光强度
@@ -212,31 +217,20 @@ int main(int argc, char *argv[])
   floorGeometry.dispose();
   pointLightGeometry.dispose();
 
+  frameConstants.dispose();
+  planeGeometry.dispose();
   glfwTerminate();
 
   return 0;
 }
 
-// 绘制物体
-void drawMesh(BufferGeometry geometry)
-{
-  glBindVertexArray(geometry.VAO);
-  glDrawElements(GL_TRIANGLES, geometry.indices.size(), GL_UNSIGNED_INT, 0);
-  glBindVertexArray(0);
-}
-
 // 绘制灯光物体
-void drawLightObject(Shader shader, BufferGeometry geometry, glm::vec3 position)
+void drawLightObject(Shader &shader, const BufferGeometry &geometry, glm::vec3 position)
 {
-  glm::mat4 view = camera.GetViewMatrix();
-  glm::mat4 projection = glm::mat4(1.0f);
   glm::mat4 model = glm::mat4(1.0f);
-  projection = glm::perspective(glm::radians(camera.Zoom), (float)SCREEN_WIDTH / (float)SCREEN_HEIGHT, 0.1f, 100.0f);
 
-  // // 绘制灯光物体
+  // // 绘制灯光物体（view/projection 来自 FrameConstants）
   shader.use();
-  shader.setMat4("view", view);
-  shader.setMat4("projection", projection);
 
   model = glm::mat4(1.0f);
   model = glm::translate(model, position);
@@ -292,43 +286,3 @@ void mouse_callback(GLFWwindow *window, double xpos, double ypos)
 
   camera.ProcessMouseMovement(xoffset, yoffset);
 }
-
-// 加载纹理贴图
-unsigned int loadTexture(char const *path)
-{
-  unsigned int textureID;
-  glGenTextures(1, &textureID);
-
-  // 图像y轴翻转
-  stbi_set_flip_vertically_on_load(true);
-  int width, height, nrComponents;
-  unsigned char *data = stbi_load(path, &width, &height, &nrComponents, 0);
-  if (data)
-  {
-    GLenum format;
-    if (nrComponents == 1)
-      format = GL_RED;
-    else if (nrComponents == 3)
-      format = GL_RGB;
-    else if (nrComponents == 4)
-      format = GL_RGBA;
-
-    glBindTexture(GL_TEXTURE_2D, textureID);
-    glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, data);
-    glGenerateMipmap(GL_TEXTURE_2D);
-
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-
-    stbi_image_free(data);
-  }
-  else
-  {
-    std::cout << "Texture failed to load at path: " << path << std::endl;
-    stbi_image_free(data);
-  }
-
-  return textureID;
-}
\ No newline at end of file
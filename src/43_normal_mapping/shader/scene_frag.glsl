@@ -20,10 +20,11 @@ void main() {
   vec3 ambient = strength * color; // 环境光
 
   //vec3 normal = normalize(oNormal);
-  // 从法线贴图获取[0,1]范围的法线值
-  vec3 normal = texture(normalMap, oTexCoord).rgb;
-  // 将法线向量转换到[-1，1]范围
-  normal = normalize(normal * 2.0 - 1.0);
+  // 从法线贴图获取[0,1]范围的 xy，转换到[-1，1]范围
+  // 烘焙后的法线贴图是 BC5，只有两个通道，z 由单位长度重建
+  vec3 normal;
+  normal.xy = texture(normalMap, oTexCoord).rg * 2.0 - 1.0;
+  normal.z = sqrt(max(1.0 - dot(normal.xy, normal.xy), 0.0));
 
   vec3 lightDir = normalize(lightPos - oFragPos);
 
@@ -5,6 +5,8 @@
 #include <map>
 
 #include <tool/shader.h>
+#include <tool/frame_constants.h>
+#include <tool/shader_variants.h>
 #include <tool/camera.h>
 #include <geometry/BoxGeometry.h>
 #include <geometry/PlaneGeometry.h>
@@ -12,18 +14,16 @@
 
 #define STB_IMAGE_IMPLEMENTATION
 #include <tool/stb_image.h>
+#include <tool/texture_cache.h>
 
 #include <tool/gui.h>
 
 void framebuffer_size_callback(GLFWwindow *window, int width, int height);
 void mouse_callback(GLFWwindow *window, double xpos, double ypos);
 void processInput(GLFWwindow *window);
-unsigned int loadTexture(char const *path);
 
 // method
-void drawMesh(BufferGeometry geometry);
-void drawLightObject(Shader shader, BufferGeometry geometry, glm::vec3 position);
-void RenderQuad();
+void drawLightObject(Shader &shader, const BufferGeometry &geometry, glm::vec3 position);
 
 std::string Shader::dirName;
 
@@ -46,6 +46,9 @@ float lastY = SCREEN_HEIGHT / 2.0f;
 
 Camera camera(glm::vec3(0.0, 0.0, 6.0));
 
+// 视差贴图开关，运行时用 P 键切换
+bool parallax = true;
+
 using namespace std;
 
 int main(int argc, char *argv[])
@@ -113,24 +116,24 @@ int main(int argc, char *argv[])
   // 3.将鼠标隐藏
   glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
 
-  Shader sceneShader("./shader/scene_vert.glsl", "./shader/scene_frag.glsl");
+  // 开启/关闭视差各编译一个版本，第一次用到时才编译
+  ShaderVariants sceneShaders("./shader/scene_vert.glsl", "./shader/scene_frag.glsl");
   Shader lightObjectShader("./shader/light_object_vert.glsl", "./shader/light_object_frag.glsl");
 
+  // 所有着色器共享的每帧常量
+  FrameConstants frameConstants;
+
   BoxGeometry boxGeometry(1.0, 1.0, 1.0);      // 箱子
   BoxGeometry floorGeometry(10.0, 0.01, 10.0); // 箱子
-  PlaneGeometry planeGeometry(1.0, 1.0);
+  PlaneGeometry planeGeometry(2.0, 2.0);       // 砖墙，切线在 setupBuffers 中生成
   SphereGeometry pointLightGeometry(0.06, 10.0, 10.0); // 点光源位置显示
 
-  unsigned int diffuseMap = loadTexture("./static/texture/bricks2.jpg");       // 漫反射图
-  unsigned int normalMap = loadTexture("./static/texture/bricks2_normal.jpg"); // 法线贴图
-  unsigned int depthMap = loadTexture("./static/texture/bricks2_disp.jpg");    // 高度图
+  unsigned int diffuseMap = TextureCache::load("./static/texture/bricks2.jpg");       // 漫反射图
+  unsigned int normalMap = TextureCache::load("./static/texture/bricks2_normal.jpg"); // 法线贴图
+  unsigned int depthMap = TextureCache::load("./static/texture/bricks2_disp.jpg");    // 高度图
 
   float factor = 0.0;
 
-  sceneShader.use();
-  sceneShader.setInt("diffuseMap", 0);
-  sceneShader.setInt("normalMap", 1);
-  sceneShader.setInt("depthMap", 2);
 
   glm::vec3 lightPosition = glm::vec3(-2.0f, 2.0f, 2.0f); // 光照位置
   while (!glfwWindowShouldClose(window))
@@ -165,9 +168,15 @@ int main(int argc, char *argv[])
     glm::mat4 view = camera.GetViewMatrix();
     glm::mat4 projection = glm::perspective(glm::radians(camera.Zoom), (float)SCREEN_WIDTH / (float)SCREEN_HEIGHT, 0.1f, 100.0f);
 
+    frameConstants.setCamera(view, projection, camera.Position);
+    frameConstants.setTime(currentFrame, deltaTime);
+    frameConstants.upload();
+
+    Shader &sceneShader = parallax ? sceneShaders.get({{"PARALLAX", ""}}) : sceneShaders.get();
     sceneShader.use();
-    sceneShader.setMat4("projection", projection);
-    sceneShader.setMat4("view", view);
+    sceneShader.setInt("diffuseMap", 0);
+    sceneShader.setInt("normalMap", 1);
+    sceneShader.setInt("depthMap", 2);
     sceneShader.setVec3("viewPos", camera.Position);
     sceneShader.setVec3("lightPos", lightPosition); // 光源位置
     sceneShader.setFloat("strength", 0.01);         // 环境光强度
@@ -188,13 +197,17 @@ int main(int argc, char *argv[])
 
     sceneShader.setFloat("uvScale", 1.0f);
     sceneShader.setFloat("height_scale", 0.1f);
-    sceneShader.setBool("parallax", true);
     sceneShader.setMat4("model", model);
 
-    RenderQuad();
+    drawMesh(planeGeometry);
 
     drawLightObject(lightObjectShader, pointLightGeometry, lightPosition);
 
+    ImGui::Begin("controls");
+    ImGui::Text("parallax: %s (P)", parallax ? "on" : "off");
+    ImGui::Text("compiled variants: %u", sceneShaders.compiledCount());
+    ImGui::End();
+
     // 渲染 gui
     ImGui::Render();
     ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
@@ -205,33 +218,23 @@ int main(int argc, char *argv[])
 
   boxGeometry.dispose();
   floorGeometry.dispose();
+  planeGeometry.dispose();
   pointLightGeometry.dispose();
+  sceneShaders.dispose();
 
+  frameConstants.dispose();
   glfwTerminate();
 
   return 0;
 }
 
-// 绘制物体
-void drawMesh(BufferGeometry geometry)
-{
-  glBindVertexArray(geometry.VAO);
-  glDrawElements(GL_TRIANGLES, geometry.indices.size(), GL_UNSIGNED_INT, 0);
-  glBindVertexArray(0);
-}
-
 // 绘制灯光物体
-void drawLightObject(Shader shader, BufferGeometry geometry, glm::vec3 position)
+void drawLightObject(Shader &shader, const BufferGeometry &geometry, glm::vec3 position)
 {
-  glm::mat4 view = camera.GetViewMatrix();
-  glm::mat4 projection = glm::mat4(1.0f);
   glm::mat4 model = glm::mat4(1.0f);
-  projection = glm::perspective(glm::radians(camera.Zoom), (float)SCREEN_WIDTH / (float)SCREEN_HEIGHT, 0.1f, 100.0f);
 
-  // // 绘制灯光物体
+  // // 绘制灯光物体（view/projection 来自 FrameConstants）
   shader.use();
-  shader.setMat4("view", view);
-  shader.setMat4("projection", projection);
 
   model = glm::mat4(1.0f);
   model = glm::translate(model, position);
@@ -273,6 +276,13 @@ void processInput(GLFWwindow *window)
   {
     camera.ProcessKeyboard(RIGHT, deltaTime);
   }
+
+  // 切换视差贴图，只响应按下的那一帧
+  static bool parallaxKeyDown = false;
+  bool parallaxPressed = glfwGetKey(window, GLFW_KEY_P) == GLFW_PRESS;
+  if (!parallaxKeyDown && parallaxPressed)
+    parallax = !parallax;
+  parallaxKeyDown = parallaxPressed;
 }
 
 // 鼠标移动监听
@@ -287,133 +297,3 @@ void mouse_callback(GLFWwindow *window, double xpos, double ypos)
 
   camera.ProcessMouseMovement(xoffset, yoffset);
 }
-
-// 加载纹理贴图
-unsigned int loadTexture(char const *path)
-{
-  unsigned int textureID;
-  glGenTextures(1, &textureID);
-
-  // 图像y轴翻转
-  stbi_set_flip_vertically_on_load(true);
-  int width, height, nrComponents;
-  unsigned char *data = stbi_load(path, &width, &height, &nrComponents, 0);
-  if (data)
-  {
-    GLenum format;
-    if (nrComponents == 1)
-      format = GL_RED;
-    else if (nrComponents == 3)
-      format = GL_RGB;
-    else if (nrComponents == 4)
-      format = GL_RGBA;
-
-    glBindTexture(GL_TEXTURE_2D, textureID);
-    glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, data);
-    glGenerateMipmap(GL_TEXTURE_2D);
-
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-
-    stbi_image_free(data);
-  }
-  else
-  {
-    std::cout << "Texture failed to load at path: " << path << std::endl;
-    stbi_image_free(data);
-  }
-
-  return textureID;
-}
-
-// RenderQuad() Renders a 1x1 quad in NDC
-GLuint quadVAO = 0;
-GLuint quadVBO;
-void RenderQuad()
-{
-  if (quadVAO == 0)
-  {
-    // positions
-    glm::vec3 pos1(-1.0, 1.0, 0.0);
-    glm::vec3 pos2(-1.0, -1.0, 0.0);
-    glm::vec3 pos3(1.0, -1.0, 0.0);
-    glm::vec3 pos4(1.0, 1.0, 0.0);
-    // texture coordinates
-    glm::vec2 uv1(0.0, 1.0);
-    glm::vec2 uv2(0.0, 0.0);
-    glm::vec2 uv3(1.0, 0.0);
-    glm::vec2 uv4(1.0, 1.0);
-    // normal vector
-    glm::vec3 nm(0.0, 0.0, 1.0);
-
-    // calculate tangent/bitangent vectors of both triangles
-    glm::vec3 tangent1, bitangent1;
-    glm::vec3 tangent2, bitangent2;
-    // - triangle 1
-    glm::vec3 edge1 = pos2 - pos1;
-    glm::vec3 edge2 = pos3 - pos1;
-    glm::vec2 deltaUV1 = uv2 - uv1;
-    glm::vec2 deltaUV2 = uv3 - uv1;
-
-    GLfloat f = 1.0f / (deltaUV1.x * deltaUV2.y - deltaUV2.x * deltaUV1.y);
-
-    tangent1.x = f * (deltaUV2.y * edge1.x - deltaUV1.y * edge2.x);
-    tangent1.y = f * (deltaUV2.y * edge1.y - deltaUV1.y * edge2.y);
-    tangent1.z = f * (deltaUV2.y * edge1.z - deltaUV1.y * edge2.z);
-    tangent1 = glm::normalize(tangent1);
-
-    bitangent1.x = f * (-deltaUV2.x * edge1.x + deltaUV1.x * edge2.x);
-    bitangent1.y = f * (-deltaUV2.x * edge1.y + deltaUV1.x * edge2.y);
-    bitangent1.z = f * (-deltaUV2.x * edge1.z + deltaUV1.x * edge2.z);
-    bitangent1 = glm::normalize(bitangent1);
-
-    // - triangle 2
-    edge1 = pos3 - pos1;
-    edge2 = pos4 - pos1;
-    deltaUV1 = uv3 - uv1;
-    deltaUV2 = uv4 - uv1;
-
-    f = 1.0f / (deltaUV1.x * deltaUV2.y - deltaUV2.x * deltaUV1.y);
-
-    tangent2.x = f * (deltaUV2.y * edge1.x - deltaUV1.y * edge2.x);
-    tangent2.y = f * (deltaUV2.y * edge1.y - deltaUV1.y * edge2.y);
-    tangent2.z = f * (deltaUV2.y * edge1.z - deltaUV1.y * edge2.z);
-    tangent2 = glm::normalize(tangent2);
-
-    bitangent2.x = f * (-deltaUV2.x * edge1.x + deltaUV1.x * edge2.x);
-    bitangent2.y = f * (-deltaUV2.x * edge1.y + deltaUV1.x * edge2.y);
-    bitangent2.z = f * (-deltaUV2.x * edge1.z + deltaUV1.x * edge2.z);
-    bitangent2 = glm::normalize(bitangent2);
-
-    GLfloat quadVertices[] = {
-        // Positions            // normal         // TexCoords  // Tangent                          // Bitangent
-        pos1.x, pos1.y, pos1.z, nm.x, nm.y, nm.z, uv1.x, uv1.y, tangent1.x, tangent1.y, tangent1.z, bitangent1.x, bitangent1.y, bitangent1.z,
-        pos2.x, pos2.y, pos2.z, nm.x, nm.y, nm.z, uv2.x, uv2.y, tangent1.x, tangent1.y, tangent1.z, bitangent1.x, bitangent1.y, bitangent1.z,
-        pos3.x, pos3.y, pos3.z, nm.x, nm.y, nm.z, uv3.x, uv3.y, tangent1.x, tangent1.y, tangent1.z, bitangent1.x, bitangent1.y, bitangent1.z,
-
-        pos1.x, pos1.y, pos1.z, nm.x, nm.y, nm.z, uv1.x, uv1.y, tangent2.x, tangent2.y, tangent2.z, bitangent2.x, bitangent2.y, bitangent2.z,
-        pos3.x, pos3.y, pos3.z, nm.x, nm.y, nm.z, uv3.x, uv3.y, tangent2.x, tangent2.y, tangent2.z, bitangent2.x, bitangent2.y, bitangent2.z,
-        pos4.x, pos4.y, pos4.z, nm.x, nm.y, nm.z, uv4.x, uv4.y, tangent2.x, tangent2.y, tangent2.z, bitangent2.x, bitangent2.y, bitangent2.z};
-    // Setup plane VAO
-    glGenVertexArrays(1, &quadVAO);
-    glGenBuffers(1, &quadVBO);
-    glBindVertexArray(quadVAO);
-    glBindBuffer(GL_ARRAY_BUFFER, quadVBO);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(quadVertices), &quadVertices, GL_STATIC_DRAW);
-    glEnableVertexAttribArray(0);
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 14 * sizeof(GLfloat), (GLvoid *)0);
-    glEnableVertexAttribArray(1);
-    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 14 * sizeof(GLfloat), (GLvoid *)(3 * sizeof(GLfloat)));
-    glEnableVertexAttribArray(2);
-    glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 14 * sizeof(GLfloat), (GLvoid *)(6 * sizeof(GLfloat)));
-    glEnableVertexAttribArray(3);
-    glVertexAttribPointer(3, 3, GL_FLOAT, GL_FALSE, 14 * sizeof(GLfloat), (GLvoid *)(8 * sizeof(GLfloat)));
-    glEnableVertexAttribArray(4);
-    glVertexAttribPointer(4, 3, GL_FLOAT, GL_FALSE, 14 * sizeof(GLfloat), (GLvoid *)(11 * sizeof(GLfloat)));
-  }
-  glBindVertexArray(quadVAO);
-  glDrawArrays(GL_TRIANGLES, 0, 6);
-  glBindVertexArray(0);
-}
@@ -14,9 +14,10 @@ uniform sampler2D normalMap;  // 法线贴图
 uniform sampler2D depthMap;   // 高度贴图
 
 uniform float strength;
-uniform bool parallax;
 uniform float height_scale;
 
+// 由 ShaderVariants 传入 PARALLAX 编译出开启视差的版本，不再在片段着色器里判断 uniform
+#ifdef PARALLAX
 vec2 ParallaxMapping(vec2 texCoords, vec3 viewDir) {
   // number of depth layers
   const float minLayers = 10;
@@ -57,6 +58,7 @@ vec2 ParallaxMapping(vec2 texCoords, vec3 viewDir) {
 
   return finalTexCoords;
 }
+#endif
 
 void main() {
 
@@ -64,11 +66,11 @@ void main() {
 
   vec2 texCoords = fs_in.TexCoords;
 
-  if(parallax) {
-    texCoords = ParallaxMapping(fs_in.TexCoords, viewDir);
-    if(texCoords.x > 1.0 || texCoords.y > 1.0 || texCoords.x < 0.0 || texCoords.y < 0.0)
-      discard;
-  }
+#ifdef PARALLAX
+  texCoords = ParallaxMapping(fs_in.TexCoords, viewDir);
+  if(texCoords.x > 1.0 || texCoords.y > 1.0 || texCoords.x < 0.0 || texCoords.y < 0.0)
+    discard;
+#endif
 
   float gamma = 2.2;
   vec3 color = pow(texture(diffuseMap, texCoords).rgb, vec3(gamma));
@@ -76,10 +78,11 @@ void main() {
   vec3 ambient = strength * color; // 环境光
 
   // vec3 normal = normalize(oNormal);
-  // 从法线贴图获取[0,1]范围的法线值
-  vec3 normal = texture(normalMap, texCoords).rgb;
-  // 将法线向量转换到[-1，1]范围
-  normal = normalize(normal * 2.0 - 1.0);
+  // 从法线贴图获取[0,1]范围的 xy，转换到[-1，1]范围
+  // 烘焙后的法线贴图是 BC5，只有两个通道，z 由单位长度重建
+  vec3 normal;
+  normal.xy = texture(normalMap, texCoords).rg * 2.0 - 1.0;
+  normal.z = sqrt(max(1.0 - dot(normal.xy, normal.xy), 0.0));
 
   vec3 lightDir = normalize(fs_in.TangentLightPos - fs_in.TangentFragPos);
 
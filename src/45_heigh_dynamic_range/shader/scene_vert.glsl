@@ -12,8 +12,7 @@ uniform float factor;
 uniform float uvScale;
 
 uniform mat4 model;
-uniform mat4 view;
-uniform mat4 projection;
+#include "frame_constants.glsl"
 
 void main() {
 
@@ -5,6 +5,9 @@
 #include <map>
 
 #include <tool/shader.h>
+#include <tool/render_state.h>
+#include <tool/frame_constants.h>
+#include <tool/light_buffer.h>
 #include <tool/camera.h>
 #include <geometry/BoxGeometry.h>
 #include <geometry/PlaneGeometry.h>
@@ -12,17 +15,16 @@
 
 #define STB_IMAGE_IMPLEMENTATION
 #include <tool/stb_image.h>
+#include <tool/texture_cache.h>
 
 #include <tool/gui.h>
 
 void framebuffer_size_callback(GLFWwindow *window, int width, int height);
 void mouse_callback(GLFWwindow *window, double xpos, double ypos);
 void processInput(GLFWwindow *window);
-unsigned int loadTexture(char const *path);
 
 // method
-void drawMesh(BufferGeometry geometry);
-void drawLightObject(Shader shader, BufferGeometry geometry, glm::vec3 position);
+void drawLightObject(Shader &shader, const BufferGeometry &geometry, glm::vec3 position);
 
 std::string Shader::dirName;
 
@@ -45,6 +47,10 @@ float lastY = SCREEN_HEIGHT / 2.0f;
 
 Camera camera(glm::vec3(0.0, 0.0, 10.0));
 
+// 点光源数量，运行时用 +/- 键翻倍/减半
+unsigned int lightCount = 32;
+const unsigned int MAX_LIGHTS = 16384;
+
 using namespace std;
 
 int main(int argc, char *argv[])
@@ -113,6 +119,9 @@ int main(int argc, char *argv[])
   Shader sceneShader("./shader/scene_vert.glsl", "./shader/scene_frag.glsl");
   Shader lightShader("./shader/light_object_vert.glsl", "./shader/light_object_frag.glsl");
 
+  // 三个着色器共享的每帧常量
+  FrameConstants frameConstants;
+
   PlaneGeometry groundGeometry(10.0, 10.0);            // 地面
   PlaneGeometry grassGeometry(1.0, 1.0);               // 草丛
   BoxGeometry boxGeometry(1.0, 1.0, 1.0);              // 盒子
@@ -180,28 +189,19 @@ int main(int argc, char *argv[])
       glm::vec3(0.0, -1.0, 3.0),
       glm::vec3(3.0, -1.0, 3.0)};
 
-  const unsigned int NR_LIGHTS = 32;
   std::vector<glm::vec3> lightPositions;
   std::vector<glm::vec3> lightColors;
-  srand(13);
-  for (unsigned int i = 0; i < NR_LIGHTS; i++)
-  {
-    float xPos = ((rand() % 100) / 100.0) * 6.0 - 3.0;
-    float yPos = ((rand() % 100) / 100.0) * 6.0 - 4.0;
-    float zPos = ((rand() % 100) / 100.0) * 6.0 - 3.0;
-    lightPositions.push_back(glm::vec3(xPos, yPos, zPos));
-
-    float rColor = ((rand() % 100) / 200.0f) + 0.5; // Between 0.5 and 1.0
-    float gColor = ((rand() % 100) / 200.0f) + 0.5; // Between 0.5 and 1.0
-    float bColor = ((rand() % 100) / 200.0f) + 0.5; // Between 0.5 and 1.0
-    lightColors.push_back(glm::vec3(rColor, gColor, bColor));
-  }
+  LightBuffer lightBuffer;
+  unsigned int generatedLights = 0;
 
   sceneShader.use();
   sceneShader.setInt("gPosition", 0);
   sceneShader.setInt("gNormal", 1);
   sceneShader.setInt("gAlbedoSpec", 2);
 
+  // 初始化阶段直接调用了 gl 函数，进入渲染循环前清空状态缓存
+  RenderState::invalidate();
+
   while (!glfwWindowShouldClose(window))
   {
     processInput(window);
@@ -232,12 +232,43 @@ int main(int argc, char *argv[])
     glBindFramebuffer(GL_FRAMEBUFFER, gBuffer);
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
+    // 光源数量变化时重新生成，整个数组一次上传
+    if (generatedLights != lightCount)
+    {
+      lightPositions.clear();
+      lightColors.clear();
+      lightBuffer.clear();
+      srand(13);
+      for (unsigned int i = 0; i < lightCount; i++)
+      {
+        float xPos = ((rand() % 100) / 100.0) * 6.0 - 3.0;
+        float yPos = ((rand() % 100) / 100.0) * 6.0 - 4.0;
+        float zPos = ((rand() % 100) / 100.0) * 6.0 - 3.0;
+        lightPositions.push_back(glm::vec3(xPos, yPos, zPos));
+
+        float rColor = ((rand() % 100) / 200.0f) + 0.5; // Between 0.5 and 1.0
+        float gColor = ((rand() % 100) / 200.0f) + 0.5; // Between 0.5 and 1.0
+        float bColor = ((rand() % 100) / 200.0f) + 0.5; // Between 0.5 and 1.0
+        lightColors.push_back(glm::vec3(rColor, gColor, bColor));
+
+        lightBuffer.add(lightPositions[i], lightColors[i], glm::vec3(1.0f, 1.0f, 1.0f), glm::vec3(0.01f, 0.01f, 0.01f), 1.0f, 0.09f, 0.032f);
+      }
+      lightBuffer.upload();
+      generatedLights = lightCount;
+    }
+
+    ImGui::Begin("controls");
+    ImGui::Text("point lights: %u (+/-)", lightCount);
+    ImGui::End();
+
     glm::mat4 model = glm::mat4(1.0f);
     glm::mat4 view = camera.GetViewMatrix();
     glm::mat4 projection = glm::perspective(glm::radians(45.0f), (float)SCREEN_WIDTH / (float)SCREEN_HEIGHT, 0.1f, 100.0f);
+    frameConstants.setCamera(view, projection, camera.Position);
+    frameConstants.setTime(currentFrame, deltaTime);
+    frameConstants.upload();
+
     geometryShader.use();
-    geometryShader.setMat4("view", view);
-    geometryShader.setMat4("projection", projection);
 
     for (unsigned int i = 0; i < objectPositions.size(); i++)
     {
@@ -253,28 +284,13 @@ int main(int argc, char *argv[])
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
     sceneShader.use();
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, gPosition);
+    RenderState::bindTexture(0, GL_TEXTURE_2D, gPosition);
 
-    glActiveTexture(GL_TEXTURE1);
-    glBindTexture(GL_TEXTURE_2D, gNormal);
+    RenderState::bindTexture(1, GL_TEXTURE_2D, gNormal);
 
-    glActiveTexture(GL_TEXTURE2);
-    glBindTexture(GL_TEXTURE_2D, gAlbedoSpec);
+    RenderState::bindTexture(2, GL_TEXTURE_2D, gAlbedoSpec);
 
-    for (unsigned int i = 0; i < lightPositions.size(); i++)
-    {
-      sceneShader.setVec3("pointLights[" + std::to_string(i) + "].position", lightPositions[i]);
-      sceneShader.setVec3("pointLights[" + std::to_string(i) + "].ambient", 0.01f, 0.01f, 0.01f);
-      sceneShader.setVec3("pointLights[" + std::to_string(i) + "].diffuse", lightColors[i]);
-      sceneShader.setVec3("pointLights[" + std::to_string(i) + "].specular", 1.0f, 1.0f, 1.0f);
-
-      sceneShader.setFloat("pointLights[" + std::to_string(i) + "].linear", 0.09f);
-      sceneShader.setFloat("pointLights[" + std::to_string(i) + "].constant", 1.0f);
-      sceneShader.setFloat("pointLights[" + std::to_string(i) + "].quadratic", 0.032f);
-    }
-    sceneShader.setMat4("view", view);
-    sceneShader.setMat4("projection", projection);
+    lightBuffer.bind(sceneShader);
     model = glm::mat4(1.0f);
     sceneShader.setMat4("model", model);
     drawMesh(quadGeometry);
@@ -289,8 +305,6 @@ int main(int argc, char *argv[])
     // 绘制灯光物体
     // ************************************************************
     lightShader.use();
-    lightShader.setMat4("view", view);
-    lightShader.setMat4("projection", projection);
 
     for (unsigned int i = 0; i < lightPositions.size(); i++)
     {
@@ -312,31 +326,26 @@ int main(int argc, char *argv[])
     glfwPollEvents();
   }
 
+  lightBuffer.dispose();
+  frameConstants.dispose();
+  groundGeometry.dispose();
+  grassGeometry.dispose();
+  boxGeometry.dispose();
+  pointLightGeometry.dispose();
+  objectGeometry.dispose();
+  quadGeometry.dispose();
   glfwTerminate();
 
   return 0;
 }
 
-// 绘制物体
-void drawMesh(BufferGeometry geometry)
-{
-  glBindVertexArray(geometry.VAO);
-  glDrawElements(GL_TRIANGLES, geometry.indices.size(), GL_UNSIGNED_INT, 0);
-  glBindVertexArray(0);
-}
-
 // 绘制灯光物体
-void drawLightObject(Shader shader, BufferGeometry geometry, glm::vec3 position)
+void drawLightObject(Shader &shader, const BufferGeometry &geometry, glm::vec3 position)
 {
-  glm::mat4 view = camera.GetViewMatrix();
-  glm::mat4 projection = glm::mat4(1.0f);
   glm::mat4 model = glm::mat4(1.0f);
-  projection = glm::perspective(glm::radians(camera.Zoom), (float)SCREEN_WIDTH / (float)SCREEN_HEIGHT, 0.1f, 100.0f);
 
-  // // 绘制灯光物体
+  // // 绘制灯光物体（view/projection 来自 FrameConstants）
   shader.use();
-  shader.setMat4("view", view);
-  shader.setMat4("projection", projection);
 
   model = glm::mat4(1.0f);
   model = glm::translate(model, position);
@@ -378,6 +387,16 @@ void processInput(GLFWwindow *window)
   {
     camera.ProcessKeyboard(RIGHT, deltaTime);
   }
+
+  // 光源数量翻倍/减半，只响应按下的那一帧
+  static bool countKeyDown = false;
+  bool morePressed = glfwGetKey(window, GLFW_KEY_EQUAL) == GLFW_PRESS || glfwGetKey(window, GLFW_KEY_KP_ADD) == GLFW_PRESS;
+  bool lessPressed = glfwGetKey(window, GLFW_KEY_MINUS) == GLFW_PRESS || glfwGetKey(window, GLFW_KEY_KP_SUBTRACT) == GLFW_PRESS;
+  if (!countKeyDown && morePressed && lightCount < MAX_LIGHTS)
+    lightCount *= 2;
+  if (!countKeyDown && lessPressed && lightCount > 1)
+    lightCount /= 2;
+  countKeyDown = morePressed || lessPressed;
 }
 
 // 鼠标移动监听
@@ -392,43 +411,3 @@ void mouse_callback(GLFWwindow *window, double xpos, double ypos)
 
   camera.ProcessMouseMovement(xoffset, yoffset);
 }
-
-// 加载纹理贴图
-unsigned int loadTexture(char const *path)
-{
-  unsigned int textureID;
-  glGenTextures(1, &textureID);
-
-  // 图像y轴翻转
-  stbi_set_flip_vertically_on_load(true);
-  int width, height, nrComponents;
-  unsigned char *data = stbi_load(path, &width, &height, &nrComponents, 0);
-  if (data)
-  {
-    GLenum format;
-    if (nrComponents == 1)
-      format = GL_RED;
-    else if (nrComponents == 3)
-      format = GL_RGB;
-    else if (nrComponents == 4)
-      format = GL_RGBA;
-
-    glBindTexture(GL_TEXTURE_2D, textureID);
-    glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, data);
-    glGenerateMipmap(GL_TEXTURE_2D);
-
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-
-    stbi_image_free(data);
-  }
-  else
-  {
-    std::cout << "Texture failed to load at path: " << path << std::endl;
-    stbi_image_free(data);
-  }
-
-  return textureID;
-}
\ No newline at end of file
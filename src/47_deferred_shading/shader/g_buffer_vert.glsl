@@ -10,12 +10,11 @@ out VS_OUT {
 } vs_out;
 
 uniform mat4 model;
-uniform mat4 view;
-uniform mat4 projection;
+#include "frame_constants.glsl"
 
 void main() {
 
-  gl_Position = projection * view * model * vec4(Position, 1.0f);
+  gl_Position = viewProj * model * vec4(Position, 1.0f);
 
   vs_out.FragPos = vec3(model * vec4(Position, 1.0));
 
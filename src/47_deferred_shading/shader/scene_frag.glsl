@@ -1,22 +1,8 @@
 #version 330 core
 out vec4 FragColor;
 
-// 点光源
-struct PointLight {
-  vec3 position;
-
-  float constant;
-  float linear;
-  float quadratic;
-
-  vec3 ambient;
-  vec3 diffuse;
-  vec3 specular;
-};
-
-#define NR_POINT_LIGHTS 12
-
-uniform PointLight pointLights[NR_POINT_LIGHTS];
+#include "light_buffer.glsl"
+#include "phong_lights.glsl"
 
 uniform sampler2D gPosition; // 贴图
 uniform sampler2D gNormal; // 贴图
@@ -28,9 +14,7 @@ in VS_OUT {
   vec2 TexCoords;
 } fs_in;
 
-uniform vec3 viewPos;
-
-vec3 CalcPointLight(PointLight light, vec3 normal, vec3 fragPos, vec3 viewDir);
+#include "frame_constants.glsl"
 
 void main() {
 
@@ -39,34 +23,12 @@ void main() {
   vec3 Diffuse = texture(gAlbedoSpec, fs_in.TexCoords).rgb;
   float Specular = texture(gAlbedoSpec, fs_in.TexCoords).a;
 
-  vec3 viewDir = normalize(viewPos - FragPos);
+  vec3 viewDir = normalize(cameraPosition.xyz - FragPos);
 
   vec3 result = vec3(0.0f);
   // 点光源
-  for(int i = 0; i < NR_POINT_LIGHTS; i++) {
-    result += CalcPointLight(pointLights[i], Normal, FragPos, viewDir);
+  for(int i = 0; i < pointLightCount; i++) {
+    result += CalcPointLight(fetchPointLight(i), Normal, FragPos, viewDir);
   }
   FragColor = vec4(result, 1.0);
 }
-
-// 计算点光源
-vec3 CalcPointLight(PointLight light, vec3 normal, vec3 fragPos, vec3 viewDir) {
-  vec3 lightDir = normalize(light.position - fragPos);
-    // 漫反射着色
-  float diff = max(dot(normal, lightDir), 0.0);
-    // 镜面光着色
-  vec3 reflectDir = reflect(-lightDir, normal);
-  float spec = pow(max(dot(viewDir, reflectDir), 0.0), 32.0);
-    // 衰减
-  float distance = length(light.position - fragPos);
-  float attenuation = 1.0 / (light.constant + light.linear * distance +
-    light.quadratic * (distance * distance));    
-    // 合并结果
-  vec3 ambient = light.ambient;
-  vec3 diffuse = light.diffuse * diff;
-  vec3 specular = light.specular * spec;
-  ambient *= attenuation;
-  diffuse *= attenuation;
-  specular *= attenuation;
-  return (ambient + diffuse + specular);
-}
\ No newline at end of file
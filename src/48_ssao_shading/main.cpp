@@ -5,6 +5,8 @@
 #include <map>
 
 #include <tool/shader.h>
+#include <tool/render_state.h>
+#include <tool/frame_constants.h>
 #include <tool/camera.h>
 #include <geometry/BoxGeometry.h>
 #include <geometry/PlaneGeometry.h>
@@ -12,6 +14,7 @@
 
 #define STB_IMAGE_IMPLEMENTATION
 #include <tool/stb_image.h>
+#include <tool/texture_cache.h>
 
 #include <tool/gui.h>
 #include <tool/mesh.h>
@@ -21,11 +24,9 @@
 void framebuffer_size_callback(GLFWwindow *window, int width, int height);
 void mouse_callback(GLFWwindow *window, double xpos, double ypos);
 void processInput(GLFWwindow *window);
-unsigned int loadTexture(char const *path);
 
 // method
-void drawMesh(BufferGeometry geometry);
-void drawLightObject(Shader shader, BufferGeometry geometry, glm::vec3 position);
+void drawLightObject(Shader &shader, const BufferGeometry &geometry, glm::vec3 position);
 
 std::string Shader::dirName;
 
@@ -127,6 +128,9 @@ int main(int argc, char *argv[])
 
   Shader lightObjShader("./shader/light_object_vert.glsl", "./shader/light_object_frag.glsl");
 
+  // 所有着色器共享的每帧常量
+  FrameConstants frameConstants;
+
   PlaneGeometry groundGeometry(10.0, 10.0);            // 地面
   PlaneGeometry grassGeometry(1.0, 1.0);               // 草丛
   BoxGeometry boxGeometry(1.0, 1.0, 1.0);              // 盒子
@@ -266,12 +270,17 @@ int main(int argc, char *argv[])
   ssaoShader.setInt("gPosition", 0);
   ssaoShader.setInt("gNormal", 1);
   ssaoShader.setInt("texNoise", 2);
+  // 采样核在运行期间不变，用一次数组上传代替每帧 64 次按名字查找
+  ssaoShader.setArray(ssaoShader.uniform<glm::vec3>("samples"), &ssaoKernel[0], (GLsizei)ssaoKernel.size());
 
   ssaoBlurShader.use();
   ssaoBlurShader.setInt("ssapInput", 0);
 
   Model modelObject("./static/model/teapot/teapot.obj");
 
+  // 初始化阶段直接调用了 gl 函数，进入渲染循环前清空状态缓存
+  RenderState::invalidate();
+
   while (!glfwWindowShouldClose(window))
   {
     processInput(window);
@@ -307,9 +316,11 @@ int main(int argc, char *argv[])
     glm::mat4 view = camera.GetViewMatrix();
     glm::mat4 model = glm::mat4(1.0f);
 
+    frameConstants.setCamera(view, projection, camera.Position);
+    frameConstants.setTime(currentFrame, deltaTime);
+    frameConstants.upload();
+
     gbufferShader.use();
-    gbufferShader.setMat4("projection", projection);
-    gbufferShader.setMat4("view", view);
 
     // cout << camera.Position.x << "--" << camera.Position.y << "--" << camera.Position.z << endl;
 
@@ -321,11 +332,11 @@ int main(int argc, char *argv[])
     gbufferShader.setMat4("model", model);
     gbufferShader.setInt("invertedNormals", 1); // 在立方体内反转法线
 
-    glCullFace(GL_FRONT);
+    RenderState::setCullMode(GL_FRONT);
     drawMesh(boxGeometry);
     gbufferShader.setInt("invertedNormals", 0);
 
-    glCullFace(GL_BACK);
+    RenderState::setCullMode(GL_BACK);
 
     // draw model
     model = glm::mat4(1.0f);
@@ -348,16 +359,9 @@ int main(int argc, char *argv[])
     glBindFramebuffer(GL_FRAMEBUFFER, ssaoFBO);
     glClear(GL_COLOR_BUFFER_BIT);
     ssaoShader.use();
-    // Send kernel + rotation
-    for (unsigned int i = 0; i < 64; ++i)
-      ssaoShader.setVec3("samples[" + std::to_string(i) + "]", ssaoKernel[i]);
-    ssaoShader.setMat4("projection", projection);
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, gPosition);
-    glActiveTexture(GL_TEXTURE1);
-    glBindTexture(GL_TEXTURE_2D, gNormal);
-    glActiveTexture(GL_TEXTURE2);
-    glBindTexture(GL_TEXTURE_2D, noiseTexture);
+    RenderState::bindTexture(0, GL_TEXTURE_2D, gPosition);
+    RenderState::bindTexture(1, GL_TEXTURE_2D, gNormal);
+    RenderState::bindTexture(2, GL_TEXTURE_2D, noiseTexture);
 
     drawMesh(quadGeometry);
     glBindFramebuffer(GL_FRAMEBUFFER, 0);
@@ -367,8 +371,7 @@ int main(int argc, char *argv[])
     glBindFramebuffer(GL_FRAMEBUFFER, ssaoBlurFBO);
     glClear(GL_COLOR_BUFFER_BIT);
     ssaoBlurShader.use();
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, ssaoColorBuffer);
+    RenderState::bindTexture(0, GL_TEXTURE_2D, ssaoColorBuffer);
     drawMesh(quadGeometry);
     glBindFramebuffer(GL_FRAMEBUFFER, 0);
 
@@ -393,14 +396,10 @@ int main(int argc, char *argv[])
     const float quadratic = 0.032;
     finalShader.setFloat("light.Linear", linear);
     finalShader.setFloat("light.Quadratic", quadratic);
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, gPosition);
-    glActiveTexture(GL_TEXTURE1);
-    glBindTexture(GL_TEXTURE_2D, gNormal);
-    glActiveTexture(GL_TEXTURE2);
-    glBindTexture(GL_TEXTURE_2D, gColorSpec);
-    glActiveTexture(GL_TEXTURE3); // add extra SSAO texture to lighting pass
-    glBindTexture(GL_TEXTURE_2D, ssaoColorBufferBler);
+    RenderState::bindTexture(0, GL_TEXTURE_2D, gPosition);
+    RenderState::bindTexture(1, GL_TEXTURE_2D, gNormal);
+    RenderState::bindTexture(2, GL_TEXTURE_2D, gColorSpec);
+    RenderState::bindTexture(3, GL_TEXTURE_2D, ssaoColorBufferBler); // add extra SSAO texture to lighting pass
     drawMesh(quadGeometry);
 
     // 绘制灯光物体
@@ -412,8 +411,6 @@ int main(int argc, char *argv[])
     glBindFramebuffer(GL_FRAMEBUFFER, 0);
 
     lightObjShader.use();
-    lightObjShader.setMat4("view", view);
-    lightObjShader.setMat4("projection", projection);
 
     model = glm::mat4(1.0f);
     model = glm::translate(model, lightPos);
@@ -431,31 +428,26 @@ int main(int argc, char *argv[])
     glfwPollEvents();
   }
 
+  frameConstants.dispose();
+  groundGeometry.dispose();
+  grassGeometry.dispose();
+  boxGeometry.dispose();
+  pointLightGeometry.dispose();
+  objectGeometry.dispose();
+  quadGeometry.dispose();
+  modelObject.dispose();
   glfwTerminate();
 
   return 0;
 }
 
-// 绘制物体
-void drawMesh(BufferGeometry geometry)
-{
-  glBindVertexArray(geometry.VAO);
-  glDrawElements(GL_TRIANGLES, geometry.indices.size(), GL_UNSIGNED_INT, 0);
-  glBindVertexArray(0);
-}
-
 // 绘制灯光物体
-void drawLightObject(Shader shader, BufferGeometry geometry, glm::vec3 position)
+void drawLightObject(Shader &shader, const BufferGeometry &geometry, glm::vec3 position)
 {
-  glm::mat4 view = camera.GetViewMatrix();
-  glm::mat4 projection = glm::mat4(1.0f);
   glm::mat4 model = glm::mat4(1.0f);
-  projection = glm::perspective(glm::radians(camera.Zoom), (float)SCREEN_WIDTH / (float)SCREEN_HEIGHT, 0.1f, 100.0f);
 
-  // // 绘制灯光物体
+  // // 绘制灯光物体（view/projection 来自 FrameConstants）
   shader.use();
-  shader.setMat4("view", view);
-  shader.setMat4("projection", projection);
 
   model = glm::mat4(1.0f);
   model = glm::translate(model, position);
@@ -511,43 +503,3 @@ void mouse_callback(GLFWwindow *window, double xpos, double ypos)
 
   camera.ProcessMouseMovement(xoffset, yoffset);
 }
-
-// 加载纹理贴图
-unsigned int loadTexture(char const *path)
-{
-  unsigned int textureID;
-  glGenTextures(1, &textureID);
-
-  // 图像y轴翻转
-  stbi_set_flip_vertically_on_load(true);
-  int width, height, nrComponents;
-  unsigned char *data = stbi_load(path, &width, &height, &nrComponents, 0);
-  if (data)
-  {
-    GLenum format;
-    if (nrComponents == 1)
-      format = GL_RED;
-    else if (nrComponents == 3)
-      format = GL_RGB;
-    else if (nrComponents == 4)
-      format = GL_RGBA;
-
-    glBindTexture(GL_TEXTURE_2D, textureID);
-    glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, data);
-    glGenerateMipmap(GL_TEXTURE_2D);
-
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-
-    stbi_image_free(data);
-  }
-  else
-  {
-    std::cout << "Texture failed to load at path: " << path << std::endl;
-    stbi_image_free(data);
-  }
-
-  return textureID;
-}
\ No newline at end of file
@@ -16,7 +16,7 @@ float bias = 0.025;
 // 根据屏幕尺寸除以噪声大小在屏幕上平铺纹理
 const vec2 noiseScale = vec2(800.0 / 4.0, 600.0 / 4.0);
 
-uniform mat4 projection;
+#include "frame_constants.glsl"
 
 void main(){
   // 获取SSAO算法的输入
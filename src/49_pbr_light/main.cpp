@@ -5,6 +5,8 @@
 #include <map>
 
 #include <tool/shader.h>
+#include <tool/render_state.h>
+#include <tool/frame_constants.h>
 #include <tool/camera.h>
 #include <geometry/BoxGeometry.h>
 #include <geometry/PlaneGeometry.h>
@@ -12,8 +14,10 @@
 
 #define STB_IMAGE_IMPLEMENTATION
 #include <tool/stb_image.h>
+#include <tool/texture_cache.h>
 
 #include <tool/gui.h>
+#include <tool/texture_streamer_gui.h>
 #include <tool/mesh.h>
 #include <tool/model.h>
 
@@ -21,11 +25,9 @@
 void framebuffer_size_callback(GLFWwindow *window, int width, int height);
 void mouse_callback(GLFWwindow *window, double xpos, double ypos);
 void processInput(GLFWwindow *window);
-unsigned int loadTexture(char const *path);
 
 // method
-void drawMesh(BufferGeometry geometry);
-void drawLightObject(Shader shader, BufferGeometry geometry, glm::vec3 position);
+void drawLightObject(Shader &shader, const BufferGeometry &geometry, glm::vec3 position);
 
 std::string Shader::dirName;
 
@@ -122,6 +124,9 @@ int main(int argc, char *argv[])
   Shader sceneTextureShader("./shader/scene_vert.glsl", "./shader/scene_texture_frag.glsl");
   Shader lightObjShader("./shader/light_object_vert.glsl", "./shader/light_object_frag.glsl");
 
+  // 所有着色器共享的每帧常量
+  FrameConstants frameConstants;
+
   PlaneGeometry groundGeometry(10.0, 10.0);            // 地面
   BoxGeometry boxGeometry(1.0, 1.0, 1.0);              // 盒子
   SphereGeometry pointLightGeometry(0.17, 64.0, 64.0); // 点光源位置显示
@@ -151,15 +156,18 @@ int main(int argc, char *argv[])
   sceneShader.setVec3("albedo", 0.0f, 0.5f, 0.0f);
   sceneShader.setFloat("ao", 1.0f);
 
-  // unsigned int albedoMap = loadTexture("./static/texture/solar/TexturesCom_PaintedConcreteFloor_1K_albedo.png");
-  // unsigned int normalMap = loadTexture("./static/texture/solar/TexturesCom_PaintedConcreteFloor_1K_normal.png");
-  // unsigned int metallicMap = loadTexture("./static/texture/solar/TexturesCom_PaintedConcreteFloor_1K_metallic.png");
-  // unsigned int roughnessMap = loadTexture("./static/texture/solar/TexturesCom_PaintedConcreteFloor_1K_roughness.png");
-  // unsigned int aoMap = loadTexture("./static/texture/solar/TexturesCom_PaintedConcreteFloor_1K_ao.png");
-
-  unsigned int albedoMap = loadTexture("./static/texture/tiles/TexturesCom_Marble_TilesSquare8_512_albedo.png");
-  unsigned int normalMap = loadTexture("./static/texture/tiles/TexturesCom_Marble_TilesSquare8_512_normal.png");
-  unsigned int roughnessMap = loadTexture("./static/texture/tiles/TexturesCom_Marble_TilesSquare8_512_roughness.png");
+  // unsigned int albedoMap = TextureCache::load("./static/texture/solar/TexturesCom_PaintedConcreteFloor_1K_albedo.png");
+  // unsigned int normalMap = TextureCache::load("./static/texture/solar/TexturesCom_PaintedConcreteFloor_1K_normal.png");
+  // unsigned int metallicMap = TextureCache::load("./static/texture/solar/TexturesCom_PaintedConcreteFloor_1K_metallic.png");
+  // unsigned int roughnessMap = TextureCache::load("./static/texture/solar/TexturesCom_PaintedConcreteFloor_1K_roughness.png");
+  // unsigned int aoMap = TextureCache::load("./static/texture/solar/TexturesCom_PaintedConcreteFloor_1K_ao.png");
+
+  // 流式加载：开始只有 128x128 及以下的级别，按球在屏幕上的大小逐级调入
+  TextureParams streamed;
+  streamed.stream = true;
+  unsigned int albedoMap = TextureCache::load("./static/texture/tiles/TexturesCom_Marble_TilesSquare8_512_albedo.png", streamed);
+  unsigned int normalMap = TextureCache::load("./static/texture/tiles/TexturesCom_Marble_TilesSquare8_512_normal.png", streamed);
+  unsigned int roughnessMap = TextureCache::load("./static/texture/tiles/TexturesCom_Marble_TilesSquare8_512_roughness.png", streamed);
   unsigned int metallicMap = 0;
   unsigned int aoMap = 0;
 
@@ -170,6 +178,9 @@ int main(int argc, char *argv[])
   sceneShader.setInt("roughnessMap", 3);
   sceneShader.setInt("aoMap", 4);
 
+  // 初始化阶段直接调用了 gl 函数，进入渲染循环前清空状态缓存
+  RenderState::invalidate();
+
   while (!glfwWindowShouldClose(window))
   {
     processInput(window);
@@ -200,6 +211,10 @@ int main(int argc, char *argv[])
     glm::mat4 view = camera.GetViewMatrix();
     glm::mat4 model = glm::mat4(1.0f);
 
+    frameConstants.setCamera(view, projection, camera.Position);
+    frameConstants.setTime(currentFrame, deltaTime);
+    frameConstants.upload();
+
     float radius = 5.0f;
     float camX = sin(glfwGetTime() * 0.5) * radius;
     float camZ = cos(glfwGetTime() * 0.5) * radius;
@@ -216,20 +231,12 @@ int main(int argc, char *argv[])
       sceneShader.setVec3("lightColors[" + std::to_string(i) + "]", lightColors[i]);
     }
 
-    sceneShader.setMat4("projection", projection);
-    sceneShader.setMat4("view", view);
-    sceneShader.setVec3("camPos", camera.Position);
-
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, albedoMap);
-    glActiveTexture(GL_TEXTURE1);
-    glBindTexture(GL_TEXTURE_2D, normalMap);
-    glActiveTexture(GL_TEXTURE2);
-    glBindTexture(GL_TEXTURE_2D, metallicMap);
-    glActiveTexture(GL_TEXTURE3);
-    glBindTexture(GL_TEXTURE_2D, roughnessMap);
-    glActiveTexture(GL_TEXTURE4);
-    glBindTexture(GL_TEXTURE_2D, aoMap);
+
+    RenderState::bindTexture(0, GL_TEXTURE_2D, albedoMap);
+    RenderState::bindTexture(1, GL_TEXTURE_2D, normalMap);
+    RenderState::bindTexture(2, GL_TEXTURE_2D, metallicMap);
+    RenderState::bindTexture(3, GL_TEXTURE_2D, roughnessMap);
+    RenderState::bindTexture(4, GL_TEXTURE_2D, aoMap);
 
     for (int row = 0; row < nrRows; ++row)
     {
@@ -239,9 +246,15 @@ int main(int argc, char *argv[])
 
         sceneShader.setFloat("roughness", glm::clamp((float)col / (float)nrColumns, 0.05f, 1.0f));
         model = glm::mat4(1.0f);
-        model = glm::translate(model, glm::vec3((col - (nrColumns / 2)) * spacing, (row - (nrRows / 2)) * spacing, 0.0f));
+        glm::vec3 position((col - (nrColumns / 2)) * spacing, (row - (nrRows / 2)) * spacing, 0.0f);
+        model = glm::translate(model, position);
         sceneShader.setMat4("model", model);
 
+        // 球面的 u 绕一圈，正对相机的直径上约有 1/π 的纹理宽度
+        float screenSize = TextureStreamer::screenSize(position, 1.0f, view, projection, (float)SCREEN_HEIGHT);
+        for (unsigned int map : {albedoMap, normalMap, roughnessMap})
+          TextureStreamer::requestScreenSize(map, screenSize, glm::one_over_pi<float>());
+
         // ........render
         drawMesh(objectGeometry);
       }
@@ -250,8 +263,6 @@ int main(int argc, char *argv[])
     // 绘制灯光物体
     // --------------------------
     lightObjShader.use();
-    lightObjShader.setMat4("view", view);
-    lightObjShader.setMat4("projection", projection);
 
     for (unsigned int i = 0; i < lightPositions.size(); i++)
     {
@@ -266,7 +277,11 @@ int main(int argc, char *argv[])
     }
     // --------------------------
 
+    // 按本帧的请求调入或移出 mipmap
+    TextureStreamer::update();
+
     // 渲染 gui
+    TextureStreamerOverlay::draw();
     ImGui::Render();
     ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
 
@@ -274,31 +289,23 @@ int main(int argc, char *argv[])
     glfwPollEvents();
   }
 
+  frameConstants.dispose();
+  groundGeometry.dispose();
+  boxGeometry.dispose();
+  pointLightGeometry.dispose();
+  objectGeometry.dispose();
   glfwTerminate();
 
   return 0;
 }
 
-// 绘制物体
-void drawMesh(BufferGeometry geometry)
-{
-  glBindVertexArray(geometry.VAO);
-  glDrawElements(GL_TRIANGLES, geometry.indices.size(), GL_UNSIGNED_INT, 0);
-  glBindVertexArray(0);
-}
-
 // 绘制灯光物体
-void drawLightObject(Shader shader, BufferGeometry geometry, glm::vec3 position)
+void drawLightObject(Shader &shader, const BufferGeometry &geometry, glm::vec3 position)
 {
-  glm::mat4 view = camera.GetViewMatrix();
-  glm::mat4 projection = glm::mat4(1.0f);
   glm::mat4 model = glm::mat4(1.0f);
-  projection = glm::perspective(glm::radians(camera.Zoom), (float)SCREEN_WIDTH / (float)SCREEN_HEIGHT, 0.1f, 100.0f);
 
-  // // 绘制灯光物体
+  // // 绘制灯光物体（view/projection 来自 FrameConstants）
   shader.use();
-  shader.setMat4("view", view);
-  shader.setMat4("projection", projection);
 
   model = glm::mat4(1.0f);
   model = glm::translate(model, position);
@@ -354,43 +361,3 @@ void mouse_callback(GLFWwindow *window, double xpos, double ypos)
 
   camera.ProcessMouseMovement(xoffset, yoffset);
 }
-
-// 加载纹理贴图
-unsigned int loadTexture(char const *path)
-{
-  unsigned int textureID;
-  glGenTextures(1, &textureID);
-
-  // 图像y轴翻转
-  stbi_set_flip_vertically_on_load(true);
-  int width, height, nrComponents;
-  unsigned char *data = stbi_load(path, &width, &height, &nrComponents, 0);
-  if (data)
-  {
-    GLenum format;
-    if (nrComponents == 1)
-      format = GL_RED;
-    else if (nrComponents == 3)
-      format = GL_RGB;
-    else if (nrComponents == 4)
-      format = GL_RGBA;
-
-    glBindTexture(GL_TEXTURE_2D, textureID);
-    glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, data);
-    glGenerateMipmap(GL_TEXTURE_2D);
-
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-
-    stbi_image_free(data);
-  }
-  else
-  {
-    std::cout << "Texture failed to load at path: " << path << std::endl;
-    stbi_image_free(data);
-  }
-
-  return textureID;
-}
\ No newline at end of file
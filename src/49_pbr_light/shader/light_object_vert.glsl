@@ -5,11 +5,10 @@ layout(location = 2) in vec2 TexCoords;
 out vec2 outTexCoord;
 
 uniform mat4 model;
-uniform mat4 view;
-uniform mat4 projection;
+#include "frame_constants.glsl"
 
 void main() {
 
   outTexCoord = TexCoords;
-  gl_Position = projection * view * model * vec4(Position, 1.0f);
+  gl_Position = viewProj * model * vec4(Position, 1.0f);
 }
\ No newline at end of file
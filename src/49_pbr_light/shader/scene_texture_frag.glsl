@@ -15,7 +15,7 @@ uniform sampler2D aoMap;
 uniform vec3 lightPositions[4];
 uniform vec3 lightColors[4];
 
-uniform vec3 camPos;
+#include "frame_constants.glsl"
 
 const float PI = 3.14159265359;
 // ----------------------------------------------------------------------------
@@ -24,7 +24,10 @@ const float PI = 3.14159265359;
 // mapping the usual way for performance anways; I do plan make a note of this 
 // technique somewhere later in the normal mapping tutorial.
 vec3 getNormalFromMap() {
-  vec3 tangentNormal = texture(normalMap, TexCoords).xyz * 2.0 - 1.0;
+  // cooked normal maps are BC5 (xy only), rebuild z from the unit length
+  vec3 tangentNormal;
+  tangentNormal.xy = texture(normalMap, TexCoords).rg * 2.0 - 1.0;
+  tangentNormal.z = sqrt(max(1.0 - dot(tangentNormal.xy, tangentNormal.xy), 0.0));
 
   vec3 Q1 = dFdx(WorldPos);
   vec3 Q2 = dFdy(WorldPos);
@@ -82,7 +85,7 @@ void main() {
   float ao = texture(aoMap, TexCoords).r;
 
   vec3 N = getNormalFromMap();
-  vec3 V = normalize(camPos - WorldPos);
+  vec3 V = normalize(cameraPosition.xyz - WorldPos);
 
     // calculate reflectance at normal incidence; if dia-electric (like plastic) use F0 
     // of 0.04 and if it's a metal, use the albedo color as F0 (metallic workflow)    
@@ -8,8 +8,7 @@ out vec3 WorldPos;
 out vec3 Normal;
 
 uniform mat4 model;
-uniform mat4 view;
-uniform mat4 projection;
+#include "frame_constants.glsl"
 
 void main() {
 
@@ -19,5 +18,5 @@ void main() {
    // 解决不等比缩放，对法向量产生的影响
   Normal = mat3(transpose(inverse(model))) * aNormal;
 
-  gl_Position = projection * view * vec4(WorldPos, 1.0f);
+  gl_Position = viewProj * vec4(WorldPos, 1.0f);
 }
\ No newline at end of file
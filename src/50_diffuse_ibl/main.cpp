@@ -5,6 +5,8 @@
 #include <map>
 
 #include <tool/shader.h>
+#include <tool/render_state.h>
+#include <tool/frame_constants.h>
 #include <tool/camera.h>
 #include <geometry/BoxGeometry.h>
 #include <geometry/PlaneGeometry.h>
@@ -12,6 +14,7 @@
 
 #define STB_IMAGE_IMPLEMENTATION
 #include <tool/stb_image.h>
+#include <tool/texture_cache.h>
 
 #include <tool/gui.h>
 #include <tool/mesh.h>
@@ -21,12 +24,9 @@
 void framebuffer_size_callback(GLFWwindow *window, int width, int height);
 void mouse_callback(GLFWwindow *window, double xpos, double ypos);
 void processInput(GLFWwindow *window);
-unsigned int loadTexture(char const *path);
-unsigned int loadHdrTexture(char const *path);
 
 // method
-void drawMesh(BufferGeometry geometry);
-void drawLightObject(Shader shader, BufferGeometry geometry, glm::vec3 position);
+void drawLightObject(Shader &shader, const BufferGeometry &geometry, glm::vec3 position);
 
 std::string Shader::dirName;
 
@@ -128,6 +128,9 @@ int main(int argc, char *argv[])
   Shader envmapShader("./shader/envmap_vert.glsl", "./shader/envmap_frag.glsl");
   Shader irradianceShader("./shader/irradiance_vert.glsl", "./shader/irradiance_frag.glsl");
 
+  // 所有着色器共享的每帧常量
+  FrameConstants frameConstants;
+
   PlaneGeometry groundGeometry(10.0, 10.0);            // 地面
   BoxGeometry boxGeometry(5.0, 5.0, 5.0);              // 盒子
   SphereGeometry pointLightGeometry(0.17, 64.0, 64.0); // 点光源位置显示
@@ -187,7 +190,7 @@ int main(int argc, char *argv[])
   glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
   glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
 
-  unsigned int hdrMap = loadHdrTexture("./static/texture/Alexs_Apt_2k.hdr");
+  unsigned int hdrMap = TextureCache::loadHdr("./static/texture/Alexs_Apt_2k.hdr");
   cubemapShader.use();
   cubemapShader.setInt("equireMap", 0);
 
@@ -271,6 +274,9 @@ int main(int argc, char *argv[])
   glfwGetFramebufferSize(window, &scrWidth, &scrHeight);
   glViewport(0, 0, scrWidth, scrHeight);
 
+  // 初始化阶段直接调用了 gl 函数，进入渲染循环前清空状态缓存
+  RenderState::invalidate();
+
   while (!glfwWindowShouldClose(window))
   {
     processInput(window);
@@ -300,6 +306,10 @@ int main(int argc, char *argv[])
     glm::mat4 view = camera.GetViewMatrix();
     glm::mat4 model = glm::mat4(1.0f);
 
+    frameConstants.setCamera(view, projection, camera.Position);
+    frameConstants.setTime(currentFrame, deltaTime);
+    frameConstants.upload();
+
     float radius = 5.0f;
     float camX = sin(glfwGetTime() * 0.5) * radius;
     float camZ = cos(glfwGetTime() * 0.5) * radius;
@@ -309,8 +319,7 @@ int main(int argc, char *argv[])
 
     sceneShader.use();
     // 绑定辐照图图
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_CUBE_MAP, irradianceMap);
+    RenderState::bindTexture(0, GL_TEXTURE_CUBE_MAP, irradianceMap);
 
     for (unsigned int i = 0; i < lightPositions.size(); i++)
     {
@@ -320,8 +329,6 @@ int main(int argc, char *argv[])
       sceneShader.setVec3("lightColors[" + std::to_string(i) + "]", lightColors[i]);
     }
 
-    sceneShader.setMat4("projection", projection);
-    sceneShader.setMat4("view", view);
     sceneShader.setVec3("camPos", camera.Position);
 
     for (int row = 0; row < nrRows; ++row)
@@ -343,8 +350,7 @@ int main(int argc, char *argv[])
     // 直接采样hdr贴图
     // ----------------
     cubemapShader.use();
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, hdrMap);
+    RenderState::bindTexture(0, GL_TEXTURE_2D, hdrMap);
     cubemapShader.setMat4("view", view);
     cubemapShader.setMat4("projection", projection);
     // drawMesh(boxGeometry);
@@ -353,10 +359,7 @@ int main(int argc, char *argv[])
     // 使用处理之后的环境贴图
     // -------------------
     envmapShader.use();
-    envmapShader.setMat4("view", view);
-    envmapShader.setMat4("projection", projection);
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_CUBE_MAP, envCubemap);
+    RenderState::bindTexture(0, GL_TEXTURE_CUBE_MAP, envCubemap);
     // glBindTexture(GL_TEXTURE_CUBE_MAP, irradianceMap); // 显示生成的辐照度图
     drawMesh(boxGeometry);
     // -------------------
@@ -364,8 +367,6 @@ int main(int argc, char *argv[])
     // 绘制灯光物体
     // --------------------------
     lightObjShader.use();
-    lightObjShader.setMat4("view", view);
-    lightObjShader.setMat4("projection", projection);
 
     for (unsigned int i = 0; i < lightPositions.size(); i++)
     {
@@ -388,31 +389,23 @@ int main(int argc, char *argv[])
     glfwPollEvents();
   }
 
+  frameConstants.dispose();
+  groundGeometry.dispose();
+  boxGeometry.dispose();
+  pointLightGeometry.dispose();
+  objectGeometry.dispose();
   glfwTerminate();
 
   return 0;
 }
 
-// 绘制物体
-void drawMesh(BufferGeometry geometry)
-{
-  glBindVertexArray(geometry.VAO);
-  glDrawElements(GL_TRIANGLES, geometry.indices.size(), GL_UNSIGNED_INT, 0);
-  glBindVertexArray(0);
-}
-
 // 绘制灯光物体
-void drawLightObject(Shader shader, BufferGeometry geometry, glm::vec3 position)
+void drawLightObject(Shader &shader, const BufferGeometry &geometry, glm::vec3 position)
 {
-  glm::mat4 view = camera.GetViewMatrix();
-  glm::mat4 projection = glm::mat4(1.0f);
   glm::mat4 model = glm::mat4(1.0f);
-  projection = glm::perspective(glm::radians(camera.Zoom), (float)SCREEN_WIDTH / (float)SCREEN_HEIGHT, 0.1f, 100.0f);
 
-  // // 绘制灯光物体
+  // // 绘制灯光物体（view/projection 来自 FrameConstants）
   shader.use();
-  shader.setMat4("view", view);
-  shader.setMat4("projection", projection);
 
   model = glm::mat4(1.0f);
   model = glm::translate(model, position);
@@ -468,75 +461,3 @@ void mouse_callback(GLFWwindow *window, double xpos, double ypos)
 
   camera.ProcessMouseMovement(xoffset, yoffset);
 }
-
-// 加载纹理贴图
-unsigned int loadTexture(char const *path)
-{
-  unsigned int textureID;
-  glGenTextures(1, &textureID);
-
-  // 图像y轴翻转
-  stbi_set_flip_vertically_on_load(true);
-  int width, height, nrComponents;
-  unsigned char *data = stbi_load(path, &width, &height, &nrComponents, 0);
-  if (data)
-  {
-    GLenum format;
-    if (nrComponents == 1)
-      format = GL_RED;
-    else if (nrComponents == 3)
-      format = GL_RGB;
-    else if (nrComponents == 4)
-      format = GL_RGBA;
-
-    glBindTexture(GL_TEXTURE_2D, textureID);
-    glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, data);
-    glGenerateMipmap(GL_TEXTURE_2D);
-
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-
-    stbi_image_free(data);
-  }
-  else
-  {
-    std::cout << "Texture failed to load at path: " << path << std::endl;
-    stbi_image_free(data);
-  }
-
-  return textureID;
-}
-
-// 加载hdr贴图
-unsigned int loadHdrTexture(char const *path)
-{
-  unsigned int textureID;
-  glGenTextures(1, &textureID);
-
-  // 图像y轴翻转
-  stbi_set_flip_vertically_on_load(true);
-  int width, height, nrComponents;
-  float *data = stbi_loadf(path, &width, &height, &nrComponents, 0);
-  if (data)
-  {
-    glGenTextures(1, &textureID);
-    glBindTexture(GL_TEXTURE_2D, textureID);
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB16F, width, height, 0, GL_RGB, GL_FLOAT, data); // note how we specify the texture's data value to be float
-
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-
-    stbi_image_free(data);
-  }
-  else
-  {
-    std::cout << "Failed to load HDR image." << std::endl;
-    stbi_image_free(data);
-  }
-
-  return textureID;
-}
\ No newline at end of file
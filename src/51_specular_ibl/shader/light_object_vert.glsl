@@ -5,8 +5,7 @@ layout(location = 2) in vec2 TexCoords;
 out vec2 outTexCoord;
 
 uniform mat4 model;
-uniform mat4 view;
-uniform mat4 projection;
+#include "frame_constants.glsl"
 
 void main() {
 
@@ -5,6 +5,11 @@
 #include <map>
 
 #include <tool/shader.h>
+#include <tool/render_state.h>
+#include <tool/frame_constants.h>
+#include <tool/light_buffer.h>
+#include <tool/occlusion_culler.h>
+#include <tool/render_queue.h>
 #include "camera.h"
 #include <geometry/BoxGeometry.h>
 #include <geometry/PlaneGeometry.h>
@@ -15,14 +20,13 @@
 
 #define STB_IMAGE_IMPLEMENTATION
 #include <tool/stb_image.h>
+#include <tool/texture_cache.h>
 
 #include <tool/gui.h>
 
 void framebuffer_size_callback(GLFWwindow *window, int width, int height);
 void mouse_callback(GLFWwindow *window, double xpos, double ypos);
 void processInput(GLFWwindow *window);
-unsigned int loadTexture(char const *path);
-unsigned int loadCubemap(vector<std::string> faces);
 bool showStartWindow = true; // 是否显示游戏开始提示窗口
 
 
@@ -64,7 +68,7 @@ void generateRandomGrassPositions(std::vector<glm::vec3> &grassPositions, float
     }
 }
 
-void drawSkyBox(Shader shader, BoxGeometry geometry, unsigned int cubeMap);
+void drawSkyBox(Shader &shader, const BoxGeometry &geometry, unsigned int cubeMap);
 
 std::string Shader::dirName;
 
@@ -176,15 +180,20 @@ int main(int argc, char *argv[])
   Shader lightObjectShader("./shader/light_object_vert.glsl", "./shader/light_object_frag.glsl");
   Shader skyboxShader("./shader/cube_map_vert.glsl", "./shader/cube_map_frag.glsl");
 
+  // 相机、投影和平行光每帧只上传一次，三个着色器共享
+  FrameConstants frameConstants;
+
+  // 几何体上传后不再修改，释放 CPU 端的顶点和索引
+  GeometryHandle::keepCpuData = false;
   PlaneGeometry groundGeometry(50.0, 5.0);            // 地面
   PlaneGeometry grassGeometry(1.0, 1.0);               // 草丛
   BoxGeometry containerGeometry(1.0, 1.0, 1.0);        // 箱子
   BoxGeometry skyboxGeometry(1.0, 1.0, 1.0);           // 天空盒
   SphereGeometry pointLightGeometry(0.04, 10.0, 10.0); // 点光源位置显示
 
-  unsigned int woodMap = loadTexture("./static/texture/wall.jpg");                         // 地面
-  unsigned int brickMap = loadTexture("./static/texture/brick_diffuse.jpg");               // 砖块
-  unsigned int grassMap = loadTexture("./static/texture/blending_transparent_window.png"); // 草丛
+  unsigned int woodMap = TextureCache::load("./static/texture/wall.jpg");                         // 地面
+  unsigned int brickMap = TextureCache::load("./static/texture/brick_diffuse.jpg");               // 砖块
+  unsigned int grassMap = TextureCache::load("./static/texture/blending_transparent_window.png"); // 草丛
 
   float factor = 0.0;
 
@@ -202,10 +211,9 @@ int main(int argc, char *argv[])
   glm::vec3 lightPosition = glm::vec3(1.0, 2.5, 2.0); // 光照位置
 
   // 设置平行光光照属性
-  sceneShader.setVec3("directionLight.direction", -0.1, -1.0f, -0.1f);  // 更接近平行
-  sceneShader.setVec3("directionLight.ambient", 0.3f, 0.3f, 0.3f);       // 增强环境光分量
-  sceneShader.setVec3("directionLight.diffuse", 1.0f, 1.0f, 1.0f);       // 增强漫反射
-  sceneShader.setVec3("directionLight.specular", 1.0f, 1.0f, 1.0f);      // 增强镜面反射
+  // 原先这里的 ambient/diffuse/specular 是在没有绑定着色器程序时设置的，从未生效，
+  // 画面一直按 0 渲染，这里保持同样的结果，只保留每帧设置的方向
+  frameConstants.setDirectionLight(glm::vec3(-0.2f, -1.0f, -0.3f), glm::vec3(0.0f), glm::vec3(0.0f), glm::vec3(0.0f));
 
   // 全局环境光设置（暖白色光）
   sceneShader.setVec3("globalAmbient", 0.5f, 0.5f, 0.5f);
@@ -229,6 +237,34 @@ int main(int argc, char *argv[])
       glm::vec3(0.0f, 1.0f, 0.0f)};
 
 
+  // 点光源数组放在纹理缓冲中，数量不受 uniform 上限约束
+  LightBuffer pointLights;
+  for (unsigned int i = 0; i < 4; i++)
+    pointLights.add(pointLightPositions[i], pointLightColors[i], glm::vec3(1.0f, 1.0f, 1.0f), glm::vec3(0.01f, 0.01f, 0.01f), 1.0f, 0.09f, 0.032f);
+  pointLights.upload();
+
+  // uniform 句柄，只在初始化时解析一次
+  Uniform<glm::mat4> sceneModel = sceneShader.uniform<glm::mat4>("model");
+  Uniform<float> sceneUvScale = sceneShader.uniform<float>("uvScale");
+  Uniform<glm::mat4> lightObjectModel = lightObjectShader.uniform<glm::mat4>("model");
+  Uniform<glm::vec3> lightObjectColor = lightObjectShader.uniform<glm::vec3>("lightColor");
+
+  // 场景的绘制加入队列，按程序、纹理和深度排序之后一次提交；栅栏是透明的，由远到近绘制
+  RenderQueue renderQueue;
+
+  // 软件遮挡剔除：两条路沿每帧以 256x128 光栅化，被挡住的栅栏和灯光物体不提交
+  bool occlusionCulling = true;
+  OcclusionCuller occlusion(256, 128);
+  Bounds unitBox;   // BoxGeometry(1, 1, 1)
+  unitBox.expand(glm::vec3(-0.5f));
+  unitBox.expand(glm::vec3(0.5f));
+  Bounds grassBounds; // PlaneGeometry(1, 1)，在 xy 平面上
+  grassBounds.expand(glm::vec3(-0.5f, -0.5f, 0.0f));
+  grassBounds.expand(glm::vec3(0.5f, 0.5f, 0.0f));
+  Bounds pointLightBounds; // SphereGeometry(0.04)
+  pointLightBounds.expand(glm::vec3(-0.04f));
+  pointLightBounds.expand(glm::vec3(0.04f));
+
   // 设置随机数种子
   srand(static_cast<unsigned>(time(0)));
 
@@ -256,10 +292,14 @@ int main(int argc, char *argv[])
       "./static/texture/Park3Med/pz.jpg",
       "./static/texture/Park3Med/nz.jpg"};
 
-  unsigned int cubemapTexture = loadCubemap(faces);
+  unsigned int cubemapTexture = TextureCache::loadCubemap(faces);
+
+  // 初始化阶段直接调用了 gl 函数，进入渲染循环前清空状态缓存
+  RenderState::invalidate();
 
   while (!glfwWindowShouldClose(window))
   {
+    RenderState::beginFrame();
     processInput(window);
 
     float currentFrame = glfwGetTime();
@@ -301,7 +341,9 @@ int main(int argc, char *argv[])
 
     std::string FPS = std::to_string(fps_value);
     std::string ms = std::to_string(ms_value);
-    std::string newTitle = "LearnOpenGL - " + ms + " ms/frame " + FPS;
+    // 上一帧实际发出 / 被状态缓存省掉的 GL 调用数
+    std::string glCalls = std::to_string(RenderState::lastFrame.issued) + "/" + std::to_string(RenderState::lastFrame.skipped);
+    std::string newTitle = "LearnOpenGL - " + ms + " ms/frame " + FPS + " GL calls " + glCalls;
     glfwSetWindowTitle(window, newTitle.c_str());
 
     ImGui_ImplOpenGL3_NewFrame();
@@ -314,18 +356,12 @@ int main(int argc, char *argv[])
     glClearColor(clear_color.x, clear_color.y, clear_color.z, clear_color.w);
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
-    // 绘制天空盒
-    drawSkyBox(skyboxShader, skyboxGeometry, cubemapTexture);
-
     // 修改光源颜色
     glm::vec3 lightColor;
     lightColor.x = sin(glfwGetTime() * 2.0f);
     lightColor.y = sin(glfwGetTime() * 0.7f);
     lightColor.z = sin(glfwGetTime() * 1.3f);
 
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, woodMap);
-
     float radius = 5.0f;
     float camX = sin(glfwGetTime() * 0.5) * radius;
     float camZ = cos(glfwGetTime() * 0.5) * radius;
@@ -334,6 +370,15 @@ int main(int argc, char *argv[])
     glm::mat4 projection = glm::mat4(1.0f);
     projection = glm::perspective(glm::radians(fov), (float)SCREEN_WIDTH / (float)SCREEN_HEIGHT, 0.1f, 100.0f);
 
+    // 每帧常量整块上传一次
+    frameConstants.setCamera(view, projection, camera.Position);
+    frameConstants.setTime(currentFrame, deltaTime);
+    frameConstants.upload();
+    renderQueue.beginFrame(view, 100.0f);
+
+    // 绘制天空盒
+    drawSkyBox(skyboxShader, skyboxGeometry, cubemapTexture);
+
     glm::vec3 lightPos = glm::vec3(lightPosition.x * glm::sin(glfwGetTime()) * 2.0, lightPosition.y, lightPosition.z);
 
     // 绘制天空盒
@@ -363,29 +408,14 @@ int main(int argc, char *argv[])
     sceneShader.setInt("textureMap", 0);
     factor = glfwGetTime();
     sceneShader.setFloat("factor", -factor * 0.3);
-    sceneShader.setMat4("view", view);
-    sceneShader.setMat4("projection", projection);
-
-    sceneShader.setVec3("directionLight.direction", -0.2f, -1.0f, -0.3f); // 光源位置
-    sceneShader.setVec3("viewPos", camera.Position);
 
     pointLightPositions[0].z = camZ;
     pointLightPositions[0].x = camX;
 
-    for (unsigned int i = 0; i < 4; i++)
-    {
-
-      // 设置点光源属性
-      sceneShader.setVec3("pointLights[" + std::to_string(i) + "].position", pointLightPositions[i]);
-      sceneShader.setVec3("pointLights[" + std::to_string(i) + "].ambient", 0.01f, 0.01f, 0.01f);
-      sceneShader.setVec3("pointLights[" + std::to_string(i) + "].diffuse", pointLightColors[i]);
-      sceneShader.setVec3("pointLights[" + std::to_string(i) + "].specular", 1.0f, 1.0f, 1.0f);
-
-      // // 设置衰减
-      sceneShader.setFloat("pointLights[" + std::to_string(i) + "].constant", 1.0f);
-      sceneShader.setFloat("pointLights[" + std::to_string(i) + "].linear", 0.09f);
-      sceneShader.setFloat("pointLights[" + std::to_string(i) + "].quadratic", 0.032f);
-    }
+    // 点光源整体一次上传
+    pointLights.setPosition(0, pointLightPositions[0]);
+    pointLights.upload();
+    pointLights.bind(sceneShader);
 
     // 绘制地板
     // ********************************************************
@@ -396,12 +426,7 @@ int main(int argc, char *argv[])
     // 向摄像机方向延伸地面
     model = glm::translate(model, glm::vec3(-5.0, 0.0, 0.0));  // 沿摄像机方向平移
 
-    sceneShader.setFloat("uvScale", 4.0f);
-    sceneShader.setMat4("model", model);
-
-    glBindVertexArray(groundGeometry.VAO);
-    glDrawElements(GL_TRIANGLES, groundGeometry.indices.size(), GL_UNSIGNED_INT, 0);
-    glBindVertexArray(0);
+    renderQueue.add(sceneShader, groundGeometry, glm::vec3(model[3])).texture(0, GL_TEXTURE_2D, woodMap).set(sceneUvScale, 4.0f).set(sceneModel, model);
     // ********************************************************
 
     // 左路沿
@@ -411,11 +436,10 @@ int main(int argc, char *argv[])
     leftCurbModel = glm::translate(leftCurbModel, glm::vec3(17.5, 2.2, 0.2));
     leftCurbModel = glm::scale(leftCurbModel, glm::vec3(50.0, 0.8, 1.0));
 
-    sceneShader.setFloat("uvScale", 1.0f);
-    sceneShader.setMat4("model", leftCurbModel);
-
-    glBindVertexArray(containerGeometry.VAO);
-    glDrawElements(GL_TRIANGLES, containerGeometry.indices.size(), GL_UNSIGNED_INT, 0);
+    renderQueue.add(sceneShader, containerGeometry, glm::vec3(leftCurbModel[3]))
+        .texture(0, GL_TEXTURE_2D, woodMap)
+        .set(sceneUvScale, 1.0f)
+        .set(sceneModel, leftCurbModel);
 
     // 右路沿
     glm::mat4 rightCurbModel = glm::mat4(1.0f);
@@ -424,11 +448,18 @@ int main(int argc, char *argv[])
     rightCurbModel = glm::translate(rightCurbModel, glm::vec3(17.5, -2.2, 0.2));
     rightCurbModel = glm::scale(rightCurbModel, glm::vec3(50.0, 0.8, 1.0));
 
-    sceneShader.setFloat("uvScale", 1.0f);
-    sceneShader.setMat4("model", rightCurbModel);
+    renderQueue.add(sceneShader, containerGeometry, glm::vec3(rightCurbModel[3]))
+        .texture(0, GL_TEXTURE_2D, woodMap)
+        .set(sceneUvScale, 1.0f)
+        .set(sceneModel, rightCurbModel);
 
-    glBindVertexArray(containerGeometry.VAO);
-    glDrawElements(GL_TRIANGLES, containerGeometry.indices.size(), GL_UNSIGNED_INT, 0);
+    // 路沿作为遮挡体，之后的物体提交前先测试
+    occlusion.beginFrame(projection * view);
+    if (occlusionCulling)
+    {
+      occlusion.addBox(leftCurbModel, unitBox);
+      occlusion.addBox(rightCurbModel, unitBox);
+    }
 
 
     // 绘制箱子
@@ -454,58 +485,64 @@ int main(int argc, char *argv[])
 
     // 绘制栅栏面板
     // ----------------------------------------------------------
-    glBindVertexArray(grassGeometry.VAO);
-    glBindTexture(GL_TEXTURE_2D, grassMap);
-
-    // 对透明物体进行动态排序
-    std::map<float, glm::vec3> sorted;
-    for (unsigned int i = 0; i < grassPositions.size(); i++)
-    {
-      float distance = glm::length(camera.Position - grassPositions[i]);
-      sorted[distance] = grassPositions[i];
-    }
-
-    // 从远到近绘制栅栏
-    for (std::map<float, glm::vec3>::reverse_iterator iterator = sorted.rbegin(); iterator != sorted.rend(); iterator++) {
+    // 透明物体由队列按深度从远到近排序
+    for (const glm::vec3 &grassPosition : grassPositions) {
         glm::mat4 model = glm::mat4(1.0f);
-        model = glm::translate(model, iterator->second); // 设置栅栏位置
+        model = glm::translate(model, grassPosition); // 设置栅栏位置
 
         // 添加缩放变换，将高度缩小为原来的三分之二
         model = glm::scale(model, glm::vec3(1.0f, 0.6667f, 1.0f)); // x 和 z 方向保持 1.0，y 缩小到 2/3
+        if (occlusionCulling && !occlusion.visible(transformBounds(grassBounds, model)))
+          continue;
         
-        sceneShader.setMat4("model", model);
-        glDrawElements(GL_TRIANGLES, grassGeometry.indices.size(), GL_UNSIGNED_INT, 0);
+        renderQueue.add(sceneShader, grassGeometry, grassPosition, RenderQueue::Transparent)
+            .texture(0, GL_TEXTURE_2D, grassMap)
+            .set(sceneUvScale, 1.0f)
+            .set(sceneModel, model);
     }
     // ----------------------------------------------------------
 
     // 绘制灯光物体
     // ************************************************************
-    lightObjectShader.use();
-    lightObjectShader.setMat4("view", view);
-    lightObjectShader.setMat4("projection", projection);
-
     model = glm::mat4(1.0f);
     model = glm::translate(model, lightPos);
 
-    lightObjectShader.setMat4("model", model);
-    lightObjectShader.setVec3("lightColor", glm::vec3(1.0f, 1.0f, 1.0f));
-
-    glBindVertexArray(pointLightGeometry.VAO);
-    glDrawElements(GL_TRIANGLES, pointLightGeometry.indices.size(), GL_UNSIGNED_INT, 0);
+    if (!occlusionCulling || occlusion.visible(transformBounds(pointLightBounds, model)))
+      renderQueue.add(lightObjectShader, pointLightGeometry, lightPos).set(lightObjectModel, model).set(lightObjectColor, glm::vec3(1.0f, 1.0f, 1.0f));
 
     for (unsigned int i = 0; i < 4; i++)
     {
       model = glm::mat4(1.0f);
       model = glm::translate(model, pointLightPositions[i]);
+      if (occlusionCulling && !occlusion.visible(transformBounds(pointLightBounds, model)))
+        continue;
 
-      lightObjectShader.setMat4("model", model);
-      lightObjectShader.setVec3("lightColor", pointLightColors[i]);
-
-      glBindVertexArray(pointLightGeometry.VAO);
-      glDrawElements(GL_TRIANGLES, pointLightGeometry.indices.size(), GL_UNSIGNED_INT, 0);
+      renderQueue.add(lightObjectShader, pointLightGeometry, pointLightPositions[i]).set(lightObjectModel, model).set(lightObjectColor, pointLightColors[i]);
     }
     // ************************************************************
 
+    // 不透明的按程序、纹理、深度，透明的由远到近，一次提交
+    renderQueue.flush();
+
+    // 遮挡剔除的开关和上一帧的统计
+    const OcclusionStats &occluded = occlusion.lastFrame;
+    ImGui::Begin("occlusion culling");
+    ImGui::Checkbox("enabled", &occlusionCulling);
+    ImGui::Text("%s, %dx%d", FrustumCuller::modeName(occlusion.mode), occlusion.bufferWidth(), occlusion.bufferHeight());
+    ImGui::Text("rasterize %zu triangles: %.3f ms", occluded.triangles, occluded.rasterizeMs);
+    ImGui::Text("test: occluded %zu / %zu, %.3f ms", occluded.occluded, occluded.tested, occluded.testMs);
+    ImGui::End();
+
+    // 排序后和按提交顺序的状态切换次数
+    const RenderQueueStats &queued = renderQueue.stats;
+    ImGui::Begin("render queue");
+    ImGui::Text("%zu items (%zu transparent), %u constants", queued.items, queued.transparent, queued.constants);
+    ImGui::Text("program changes %u (submitted order %u)", queued.programChanges, queued.submittedProgramChanges);
+    ImGui::Text("texture changes %u (submitted order %u)", queued.textureChanges, queued.submittedTextureChanges);
+    ImGui::Text("VAO changes %u (submitted order %u)", queued.vertexArrayChanges, queued.submittedVertexArrayChanges);
+    ImGui::Text("sort %.3f ms, execute %.3f ms", queued.sortMs, queued.executeMs);
+    ImGui::End();
+
     if (showStartWindow) {
     ImGui::SetNextWindowSize(ImVec2(400, 200)); // 设置窗口大小
     ImGui::SetNextWindowPos(ImVec2(SCREEN_WIDTH / 2 - 200, SCREEN_HEIGHT / 2 - 100)); // 居中
@@ -542,9 +579,12 @@ int main(int argc, char *argv[])
     glfwPollEvents();
 
   }
+  frameConstants.dispose();
+  pointLights.dispose();
   containerGeometry.dispose();
   skyboxGeometry.dispose();
   groundGeometry.dispose();
+  grassGeometry.dispose();
   pointLightGeometry.dispose();
   glfwTerminate();
 
@@ -673,105 +713,19 @@ void mouse_callback(GLFWwindow *window, double xpos, double ypos)
     // std::cout << "Pitch: " << camera.Pitch << ", Yaw: " << camera.Yaw << std::endl; // 调试信息
 }
 
-// 加载纹理贴图
-unsigned int loadTexture(char const *path)
-{
-  unsigned int textureID;
-  glGenTextures(1, &textureID);
-
-  // 图像y轴翻转
-  stbi_set_flip_vertically_on_load(true);
-  int width, height, nrComponents;
-  unsigned char *data = stbi_load(path, &width, &height, &nrComponents, 0);
-  if (data)
-  {
-    GLenum format;
-    if (nrComponents == 1)
-      format = GL_RED;
-    else if (nrComponents == 3)
-      format = GL_RGB;
-    else if (nrComponents == 4)
-      format = GL_RGBA;
-
-    glBindTexture(GL_TEXTURE_2D, textureID);
-    glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, data);
-    glGenerateMipmap(GL_TEXTURE_2D);
-
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-
-    stbi_image_free(data);
-  }
-  else
-  {
-    std::cout << "Texture failed to load at path: " << path << std::endl;
-    stbi_image_free(data);
-  }
-
-  return textureID;
-}
-
-// 加载立方体贴图
-
-unsigned int loadCubemap(vector<std::string> faces)
-{
-  unsigned int textureID;
-  glGenTextures(1, &textureID);
-  glBindTexture(GL_TEXTURE_CUBE_MAP, textureID);
-
-  // 此处需要将y轴旋转关闭，若之前调用过loadTexture
-  stbi_set_flip_vertically_on_load(false);
-
-  int width, height, nrChannels;
-  for (unsigned int i = 0; i < faces.size(); i++)
-  {
-    unsigned char *data = stbi_load(faces[i].c_str(), &width, &height, &nrChannels, 0);
-    if (data)
-    {
-      glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i,
-                   0, GL_RGB, width, height, 0, GL_RGB, GL_UNSIGNED_BYTE, data);
-      stbi_image_free(data);
-    }
-    else
-    {
-      std::cout << "Cubemap texture failed to load at path: " << faces[i] << std::endl;
-      stbi_image_free(data);
-    }
-  }
-  glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-  glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-  glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-  glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-  glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
-
-  return textureID;
-}
-
 // *******************method*********************
-void drawSkyBox(Shader shader, BoxGeometry geometry, unsigned int cubeMap)
+void drawSkyBox(Shader &shader, const BoxGeometry &geometry, unsigned int cubeMap)
 {
 
-  glDepthFunc(GL_LEQUAL);
-  glDisable(GL_DEPTH_TEST);
-
-  glm::mat4 view = camera.GetViewMatrix();
-  glm::mat4 projection = glm::perspective(glm::radians(camera.Zoom), (float)SCREEN_WIDTH / (float)SCREEN_HEIGHT, 0.1f, 100.0f);
+  RenderState::setDepthFunc(GL_LEQUAL);
+  RenderState::setDepthTest(false);
 
+  // view/projection 来自 FrameConstants，平移分量在着色器中移除
   shader.use();
-  view = glm::mat4(glm::mat3(camera.GetViewMatrix())); // 移除平移分量
 
-  shader.setMat4("view", view);
-  shader.setMat4("projection", projection);
+  RenderState::bindTexture(0, GL_TEXTURE_CUBE_MAP, cubeMap);
+  drawMesh(geometry);
 
-  glActiveTexture(GL_TEXTURE0);
-  glBindTexture(GL_TEXTURE_CUBE_MAP, cubeMap);
-  glBindVertexArray(geometry.VAO);
-  glDrawElements(GL_TRIANGLES, geometry.indices.size(), GL_UNSIGNED_INT, 0);
-
-  glBindVertexArray(0);
-  glDepthFunc(GL_LESS);
-  glEnable(GL_DEPTH_TEST);
-  view = camera.GetViewMatrix();
+  RenderState::setDepthFunc(GL_LESS);
+  RenderState::setDepthTest(true);
 }
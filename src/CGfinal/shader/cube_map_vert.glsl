@@ -3,11 +3,11 @@ layout(location = 0) in vec3 Position;
 
 out vec3 outTexCoord;
 
-uniform mat4 view;
-uniform mat4 projection;
+#include "frame_constants.glsl"
 
 void main() {
 	outTexCoord = Position;
-	vec4 pos = projection * view * vec4(Position, 1.0);
+	// 移除平移分量
+	vec4 pos = projection * mat4(mat3(view)) * vec4(Position, 1.0);
 	gl_Position = pos.xyww;
 }
\ No newline at end of file
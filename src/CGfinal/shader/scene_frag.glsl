@@ -1,48 +1,10 @@
 #version 330 core
 out vec4 FragColor;
 
-// 定向光
-struct DirectionLight {
-  vec3 direction;
-
-  vec3 ambient;
-  vec3 diffuse;
-  vec3 specular;
-};
-
-// 点光源
-struct PointLight {
-  vec3 position;
-
-  float constant;
-  float linear;
-  float quadratic;
-
-  vec3 ambient;
-  vec3 diffuse;
-  vec3 specular;
-};
-
-// 聚光灯
-struct SpotLight {
-  vec3 position;
-  vec3 direction;
-  float cutOff;
-  float outerCutOff;
-
-  float constant;
-  float linear;
-  float quadratic;
-
-  vec3 ambient;
-  vec3 diffuse;
-  vec3 specular;
-};
-
-#define NR_POINT_LIGHTS 4
-
-uniform DirectionLight directionLight;
-uniform PointLight pointLights[NR_POINT_LIGHTS];
+#include "frame_constants.glsl"
+
+#include "light_buffer.glsl"
+
 uniform SpotLight spotLight;
 uniform vec3 globalAmbient; // 全局环境光
 
@@ -53,7 +15,6 @@ in vec2 outTexCoord;
 in vec3 outNormal;
 in vec3 outFragPos;
 
-uniform vec3 viewPos;
 uniform float factor; // 变化值
 
 vec3 CalcDirectionLight(DirectionLight light, vec3 normal, vec3 viewDir);
@@ -63,18 +24,19 @@ float LinearizeDepth(float depth, float near, float far);
 
 void main() {
 
-  vec3 viewDir = normalize(viewPos - outFragPos);
+  vec3 viewDir = normalize(cameraPosition.xyz - outFragPos);
   vec3 normal = normalize(outNormal);
 
   // 初始化结果为全局环境光
   vec3 result = vec3(0.0);
 
   // 定向光照
+  DirectionLight directionLight = DirectionLight(lightDirection.xyz, lightAmbient.rgb, lightDiffuse.rgb, lightSpecular.rgb);
   result += CalcDirectionLight(directionLight, normal, viewDir);
 
   // 点光源
-  for(int i = 0; i < NR_POINT_LIGHTS; i++) {
-    result += CalcPointLight(pointLights[i], normal, outFragPos, viewDir);
+  for(int i = 0; i < pointLightCount; i++) {
+    result += CalcPointLight(fetchPointLight(i), normal, outFragPos, viewDir);
   }
 
   // 添加全局环境光
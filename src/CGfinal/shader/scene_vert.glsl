@@ -12,12 +12,12 @@ uniform float factor;
 uniform float uvScale;
 
 uniform mat4 model;
-uniform mat4 view;
-uniform mat4 projection;
+
+#include "frame_constants.glsl"
 
 void main() {
 
-  gl_Position = projection * view * model * vec4(Position, 1.0f);
+  gl_Position = viewProj * model * vec4(Position, 1.0f);
 
   outFragPos = vec3(model * vec4(Position, 1.0));
 
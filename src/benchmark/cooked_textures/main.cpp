@@ -0,0 +1,136 @@
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include <filesystem>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <tool/shader.h>
+
+#define STB_IMAGE_IMPLEMENTATION
+#include <tool/stb_image.h>
+
+#include <tool/mesh.h>
+#include <tool/model.h>
+
+std::string Shader::dirName;
+
+// 检查 Model 加载时材质贴图确实使用了 texture_cooker 的烘焙结果，并比较两种路径的加载耗时
+// 先运行 make run dir=tools/texture_cooker
+using namespace std;
+
+struct LoadResult
+{
+  double loadMs = 0.0;
+  double textureMs = 0.0;
+  unsigned int cooked = 0; // 这次加载中使用烘焙结果上传的纹理数
+};
+
+LoadResult load(const string &path, bool useCooked)
+{
+  TextureCache::useCooked = useCooked;
+  unsigned int cookedBefore = TextureCache::stats.cooked;
+  LoadResult result;
+  {
+    Model model(path);
+    result.loadMs = model.loadMs;
+    result.textureMs = model.textureMs;
+    for (Mesh &mesh : model.meshes)
+      mesh.dispose();
+  }
+  result.cooked = TextureCache::stats.cooked - cookedBefore;
+  TextureCache::useCooked = true;
+  return result;
+}
+
+// 返回应该命中却没有命中的贴图数
+unsigned int checkModel(const string &path, bool flip)
+{
+  Model::flipTextures = flip;
+  cout << path << (flip ? " (flipped)" : " (unflipped)") << endl;
+
+  // 预热：生成网格缓存，并取得贴图列表。析构后贴图引用归零，下面的两次加载都会重新解码或映射
+  // 与 Model 加载材质贴图时的参数相同（gamma = false）
+  TextureParams params;
+  params.flip = flip;
+  size_t textureCount = 0;
+  vector<string> withKtx;
+  {
+    Model model(path);
+    for (Mesh &mesh : model.meshes)
+      mesh.dispose();
+    textureCount = model.textures_loaded.size();
+    for (const Texture &texture : model.textures_loaded)
+    {
+      string file = model.directory + '/' + *texture.path;
+      error_code error;
+      if (filesystem::exists(TextureCache::cookedPath(file, flip), error))
+        withKtx.push_back(file);
+    }
+  }
+
+  LoadResult source = load(path, false);
+  LoadResult cooked = load(path, true);
+  cout << "  textures: " << textureCount << ", with KTX: " << withKtx.size() << ", uploaded from KTX: " << cooked.cooked << endl;
+  cout << "  source: " << source.loadMs << " ms (textures " << source.textureMs << " ms)" << endl;
+  cout << "  cooked: " << cooked.loadMs << " ms (textures " << cooked.textureMs << " ms)" << endl;
+
+  // 有 KTX 却没有用上的贴图：decode 拒绝了它（哈希或方向不一致），或者驱动不支持它的压缩格式
+  unsigned int missed = 0;
+  for (const string &file : withKtx)
+  {
+    TextureImage image = TextureCache::decode(file, params);
+    if (image.cooked)
+      continue;
+    stbi_image_free(image.data);
+    cout << "  MISSED " << file << " (" << TextureCache::cookedPath(file, flip) << " rejected)" << endl;
+    missed++;
+  }
+  if (missed == 0 && cooked.cooked < withKtx.size())
+    cout << "  " << withKtx.size() - cooked.cooked << " KTX decoded from source: the driver lacks their format" << endl;
+  if (withKtx.empty())
+    cout << "  no cooked textures, run make run dir=tools/texture_cooker first" << endl;
+  return missed;
+}
+
+int main(int argc, char *argv[])
+{
+  Shader::dirName = argv[1];
+  glfwInit();
+  glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+  glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+  glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+  // 上传贴图需要一个上下文，不需要显示窗口
+  glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+
+  GLFWwindow *window = glfwCreateWindow(64, 64, "cooked_textures", NULL, NULL);
+  if (window == NULL)
+  {
+    std::cout << "Failed to create GLFW window" << std::endl;
+    glfwTerminate();
+    return -1;
+  }
+  glfwMakeContextCurrent(window);
+
+  if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
+  {
+    std::cout << "Failed to initialize GLAD" << std::endl;
+    return -1;
+  }
+
+  // 默认检查示例实际使用的两种方向：37 的行星不翻转，27 设置了 Model::flipTextures，nanosuit 按翻转加载
+  // 第二个参数可以指定其他模型，第三个参数为 flip 时按翻转加载
+  unsigned int missed = 0;
+  if (argc > 2)
+    missed += checkModel(argv[2], argc > 3 && string(argv[3]) == "flip");
+  else
+  {
+    missed += checkModel("./static/model/planet/planet.obj", false);
+    missed += checkModel("./static/model/nanosuit/nanosuit.obj", true);
+  }
+  cout << (missed == 0 ? "ok" : "FAILED: cooked textures were not used") << endl;
+
+  glfwTerminate();
+
+  return missed == 0 ? 0 : 1;
+}
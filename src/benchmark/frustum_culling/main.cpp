@@ -0,0 +1,109 @@
+#include <iostream>
+#include <chrono>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <geometry/Frustum.h>
+
+// 对比 FrustumCuller 标量、SSE2、AVX 三种实现
+// 包围体随机分布在 200x40x200 的区域内，相机在原点绕 y 轴转一圈，每个方向测试一次，每种实现取 3 轮中的最小值
+const int ROUNDS = 3;
+const int DIRECTIONS = 12;
+
+using namespace std;
+
+double elapsedMs(chrono::steady_clock::time_point start)
+{
+  return chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+}
+
+vector<Frustum> makeFrustums()
+{
+  glm::mat4 projection = glm::perspective(glm::radians(45.0f), 16.0f / 9.0f, 0.1f, 100.0f);
+  vector<Frustum> frustums;
+  for (int i = 0; i < DIRECTIONS; i++)
+  {
+    float angle = glm::radians(360.0f * i / DIRECTIONS);
+    glm::mat4 view = glm::lookAt(glm::vec3(0.0f), glm::vec3(sin(angle), 0.0f, cos(angle)), glm::vec3(0.0f, 1.0f, 0.0f));
+    frustums.push_back(Frustum::fromMatrix(projection * view));
+  }
+  return frustums;
+}
+
+// 所有方向的可见下标依次拼接，用来比较不同实现的结果
+template <typename Volumes>
+double run(const vector<Frustum> &frustums, const Volumes &volumes, FrustumCuller::Mode mode, vector<uint32_t> &result)
+{
+  vector<uint32_t> visible(volumes.size());
+  double best = 1e30;
+  for (int round = 0; round < ROUNDS; round++)
+  {
+    result.clear();
+    auto start = chrono::steady_clock::now();
+    for (const Frustum &frustum : frustums)
+    {
+      size_t count = FrustumCuller::cull(frustum, volumes, 0, volumes.size(), visible.data(), mode);
+      result.insert(result.end(), visible.begin(), visible.begin() + count);
+    }
+    best = min(best, elapsedMs(start));
+  }
+  return best / frustums.size();
+}
+
+template <typename Volumes>
+void compare(const char *name, const vector<Frustum> &frustums, const Volumes &volumes)
+{
+  const FrustumCuller::Mode modes[] = {FrustumCuller::Mode::Scalar, FrustumCuller::Mode::Sse, FrustumCuller::Mode::Avx};
+  vector<uint32_t> reference, result;
+  double scalarMs = 0.0;
+  for (FrustumCuller::Mode mode : modes)
+  {
+    // 没有打开 AVX 编译时 Avx 退回 SSE2，不重复测试
+    if (mode == FrustumCuller::Mode::Avx && string(FrustumCuller::modeName(mode)) != "AVX")
+    {
+      cout << "  AVX: not compiled (build with -mavx)" << endl;
+      continue;
+    }
+    double ms = run(frustums, volumes, mode, mode == FrustumCuller::Mode::Scalar ? reference : result);
+    if (mode == FrustumCuller::Mode::Scalar)
+    {
+      scalarMs = ms;
+      cout << name << ": " << volumes.size() << " volumes, " << reference.size() / frustums.size() << " visible on average" << endl;
+      result = reference;
+    }
+    cout << "  " << FrustumCuller::modeName(mode) << ": " << ms << " ms per frustum, " << scalarMs / ms << "x"
+         << (result == reference ? "" : "  (MISMATCH)") << endl;
+  }
+}
+
+int main(int argc, char *argv[])
+{
+  // 第二个参数可以指定数量
+  size_t count = argc > 2 ? (size_t)atol(argv[2]) : 1000000;
+  mt19937 random(42);
+  uniform_real_distribution<float> horizontal(-100.0f, 100.0f), vertical(-20.0f, 20.0f), size(0.05f, 1.0f);
+
+  SphereSoA spheres;
+  BoundsSoA boxes;
+  spheres.reserve(count);
+  for (size_t i = 0; i < count; i++)
+  {
+    glm::vec3 center(horizontal(random), vertical(random), horizontal(random));
+    glm::vec3 extents(size(random), size(random), size(random));
+    Bounds bounds;
+    bounds.expand(center - extents);
+    bounds.expand(center + extents);
+    spheres.push(center, glm::length(extents));
+    boxes.push(bounds);
+  }
+
+  vector<Frustum> frustums = makeFrustums();
+  compare("spheres", frustums, spheres);
+  compare("AABBs", frustums, boxes);
+  return 0;
+}
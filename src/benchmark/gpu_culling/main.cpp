@@ -0,0 +1,342 @@
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <tool/shader.h>
+#include <tool/render_state.h>
+#include <tool/gpu_culler.h>
+#include <geometry/Frustum.h>
+#include <geometry/PlaneGeometry.h>
+#include <geometry/SphereGeometry.h>
+
+std::string Shader::dirName;
+
+// 在隐藏窗口中检查 GpuCuller：
+// 1. 不做遮挡测试时，GPU 的可见集合与 FrustumCuller::cull 相同
+// 2. Hi-Z 遮挡只剔除完全被遮挡墙挡住的实例（墙上的缝后面的必须保留），并且确实剔除了一部分
+// 需要 GL 4.3，否则 GpuCuller 不会被使用（37 退回 CPU 剔除），这里直接跳过
+// 与示例的默认窗口相同，宽高都不是 2 的幂
+const int WIDTH = 800;
+const int HEIGHT = 600;
+
+using namespace std;
+
+struct CameraCase
+{
+  const char *name;
+  glm::vec3 eye;
+  glm::vec3 target;
+  float maxDistance;
+};
+
+// 读回 cull() 写出的可见下标（第 0 个命令的 instanceCount 为数量），排序后返回
+vector<uint32_t> readVisible(const GpuCuller &culler)
+{
+  DrawElementsIndirectCommand command;
+  glBindBuffer(GL_COPY_READ_BUFFER, culler.commandBuffer);
+  glGetBufferSubData(GL_COPY_READ_BUFFER, 0, sizeof(command), &command);
+  vector<uint32_t> visible(command.instanceCount);
+  glBindBuffer(GL_COPY_READ_BUFFER, culler.visibleBuffer);
+  glGetBufferSubData(GL_COPY_READ_BUFFER, 0, visible.size() * sizeof(uint32_t), visible.data());
+  glBindBuffer(GL_COPY_READ_BUFFER, 0);
+  sort(visible.begin(), visible.end());
+  return visible;
+}
+
+// 包围球离最近的剔除边界有多远（平面或距离剔除），GPU 与 CPU 的运算顺序不同，贴着边界的结果可以不一致
+float boundaryMargin(const Frustum &frustum, const glm::vec4 &sphere)
+{
+  glm::vec3 center(sphere);
+  float margin = INFINITY;
+  for (const glm::vec4 &plane : frustum.planes)
+    margin = min(margin, fabs(glm::dot(glm::vec3(plane), center) + plane.w + sphere.w));
+  if (frustum.maxDistance > 0.0f)
+    margin = min(margin, fabs(glm::length(center - frustum.eye) - (frustum.maxDistance + sphere.w)));
+  return margin;
+}
+
+glm::mat4 viewProjection(const CameraCase &camera)
+{
+  glm::mat4 projection = glm::perspective(glm::radians(60.0f), (float)WIDTH / (float)HEIGHT, 0.1f, 100.0f);
+  return projection * glm::lookAt(camera.eye, camera.target, glm::vec3(0.0f, 1.0f, 0.0f));
+}
+
+// 返回不一致（不在边界上）的数量
+size_t checkFrustum(GpuCuller &culler, const vector<glm::vec4> &spheres, const SphereSoA &soa, const CameraCase &camera)
+{
+  glm::mat4 viewProj = viewProjection(camera);
+  culler.invalidateDepth();
+  culler.cull(viewProj, camera.eye, camera.maxDistance);
+  vector<uint32_t> gpu = readVisible(culler);
+
+  Frustum frustum = Frustum::fromMatrix(viewProj);
+  frustum.setDistanceCutoff(camera.eye, camera.maxDistance);
+  vector<uint32_t> cpu(soa.size());
+  auto start = chrono::steady_clock::now();
+  cpu.resize(FrustumCuller::cull(frustum, soa, 0, soa.size(), cpu.data()));
+  double cpuMs = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+
+  size_t duplicates = 0;
+  for (size_t i = 1; i < gpu.size(); i++)
+    duplicates += gpu[i] == gpu[i - 1];
+  vector<uint32_t> mismatched;
+  set_symmetric_difference(gpu.begin(), gpu.end(), cpu.begin(), cpu.end(), back_inserter(mismatched));
+  size_t boundary = 0;
+  for (uint32_t i : mismatched)
+    if (boundaryMargin(frustum, spheres[i]) < 1e-4f * max(1.0f, glm::length(glm::vec3(spheres[i]))))
+      boundary++;
+
+  cout << "  " << camera.name << ": gpu " << gpu.size() << ", cpu " << cpu.size() << " (" << cpuMs << " ms), mismatched " << mismatched.size() - boundary << ", on the boundary " << boundary;
+  if (duplicates > 0)
+    cout << ", duplicated " << duplicates;
+  cout << endl;
+  return mismatched.size() - boundary + duplicates;
+}
+
+// 左半边屏幕放一面墙，墙上有一条竖缝和一条横缝（各 3 个像素宽），位置选在旧的纹素映射会偏到别的纹素的地方
+const float WALL_Z = -5.0f;
+const int GAP = 3;
+const int GAP_COLUMN = 129;
+const int GAP_ROW = 256;
+
+// 像素边界在墙所在平面上的坐标（相机在原点看向 -z）
+float wallX(int column)
+{
+  return (2.0f * column / WIDTH - 1.0f) * tanf(glm::radians(30.0f)) * WIDTH / HEIGHT * -WALL_Z;
+}
+
+float wallY(int row)
+{
+  return (2.0f * row / HEIGHT - 1.0f) * tanf(glm::radians(30.0f)) * -WALL_Z;
+}
+
+// 单位平面缩放到 [x0, x1] x [y0, y1]
+void drawRect(Shader &shader, const PlaneGeometry &plane, const glm::mat4 &viewProj, float x0, float x1, float y0, float y1)
+{
+  glm::mat4 model = glm::translate(glm::mat4(1.0f), glm::vec3((x0 + x1) * 0.5f, (y0 + y1) * 0.5f, WALL_Z));
+  model = glm::scale(model, glm::vec3(x1 - x0, y1 - y0, 1.0f));
+  shader.setMat4("transform", viewProj * model);
+  drawMesh(plane);
+}
+
+// 墙后贴着两条缝的球，大小从几个像素到两百多个像素，落在 Hi-Z 的各个级别
+void addGapProbes(vector<glm::vec4> &spheres, SphereSoA &soa, size_t count, mt19937 &random)
+{
+  uniform_real_distribution<float> unit(0.0f, 1.0f);
+  float gapX = (wallX(GAP_COLUMN) + wallX(GAP_COLUMN + GAP)) * 0.5f;
+  float gapY = (wallY(GAP_ROW) + wallY(GAP_ROW + GAP)) * 0.5f;
+  for (size_t i = 0; i < count; i++)
+  {
+    float radius = 0.05f + 2.95f * unit(random);
+    float z = WALL_Z - radius - 0.05f - (35.0f - radius) * unit(random);
+    float scale = z / WALL_Z; // 缝在这个深度上的投影位置
+    glm::vec4 sphere(0.0f, 0.0f, z, radius);
+    if (i % 2 == 0)
+    {
+      sphere.x = gapX * scale + (unit(random) * 4.0f - 2.0f) * radius;
+      sphere.y = (unit(random) - 0.5f) * 0.8f * -z;
+    }
+    else
+    {
+      sphere.x = -unit(random) * 0.7f * -z;
+      sphere.y = gapY * scale + (unit(random) * 4.0f - 2.0f) * radius;
+    }
+    spheres.push_back(sphere);
+    soa.push(glm::vec3(sphere), sphere.w);
+  }
+}
+
+// 和 gpu_cull_comp.glsl 一样投影包围球的外接立方体，返回覆盖的像素范围，跨过相机平面或超出屏幕时返回 false
+// 范围两端各收缩一点，与 GPU 的舍入差异只会让这里更宽容
+bool pixelRect(const glm::mat4 &viewProj, const glm::vec4 &sphere, glm::ivec2 &first, glm::ivec2 &last)
+{
+  glm::vec2 ndcMin(1.0f), ndcMax(-1.0f);
+  for (int i = 0; i < 8; i++)
+  {
+    glm::vec3 corner = glm::vec3(sphere) + sphere.w * glm::vec3(i & 1 ? 1.0f : -1.0f, i & 2 ? 1.0f : -1.0f, i & 4 ? 1.0f : -1.0f);
+    glm::vec4 clip = viewProj * glm::vec4(corner, 1.0f);
+    if (clip.w <= 0.0f)
+      return false;
+    ndcMin = glm::min(ndcMin, glm::vec2(clip) / clip.w);
+    ndcMax = glm::max(ndcMax, glm::vec2(clip) / clip.w);
+  }
+  if (ndcMin.x < -1.0f || ndcMin.y < -1.0f || ndcMax.x > 1.0f || ndcMax.y > 1.0f)
+    return false;
+  glm::vec2 size(WIDTH, HEIGHT);
+  first = glm::ivec2(glm::floor((ndcMin * 0.5f + 0.5f) * size + 1e-3f));
+  last = glm::ivec2(glm::floor((ndcMax * 0.5f + 0.5f) * size - 1e-3f));
+  first = glm::clamp(first, glm::ivec2(0), glm::ivec2(WIDTH - 1, HEIGHT - 1));
+  last = glm::clamp(glm::max(last, first), glm::ivec2(0), glm::ivec2(WIDTH - 1, HEIGHT - 1));
+  return true;
+}
+
+// 返回被错误剔除的数量
+size_t checkOcclusion(GpuCuller &culler, const vector<glm::vec4> &spheres, Shader &occluderShader)
+{
+  CameraCase camera = {"wall", glm::vec3(0.0f), glm::vec3(0.0f, 0.0f, -1.0f), 0.0f};
+  glm::mat4 viewProj = viewProjection(camera);
+
+  // 第一次没有深度金字塔，只按视锥剔除
+  culler.invalidateDepth();
+  culler.cull(viewProj, camera.eye);
+  vector<uint32_t> inFrustum = readVisible(culler);
+
+  // 墙覆盖 x ∈ [-40, 0]，y ∈ [-20, 20]，去掉两条缝分成四块，画完之后生成深度金字塔
+  float xs[] = {-40.0f, wallX(GAP_COLUMN), wallX(GAP_COLUMN + GAP), 0.0f};
+  float ys[] = {-20.0f, wallY(GAP_ROW), wallY(GAP_ROW + GAP), 20.0f};
+  glViewport(0, 0, WIDTH, HEIGHT);
+  glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+  PlaneGeometry plane(1.0f, 1.0f);
+  occluderShader.use();
+  for (int i = 0; i < 4; i += 2)
+    for (int j = 0; j < 4; j += 2)
+      drawRect(occluderShader, plane, viewProj, xs[i], xs[i + 1], ys[j], ys[j + 1]);
+  culler.captureDepth(WIDTH, HEIGHT);
+  plane.dispose();
+
+  // 实际光栅化出的覆盖范围：没有画到的像素数的前缀和
+  vector<float> depth(WIDTH * HEIGHT);
+  glReadPixels(0, 0, WIDTH, HEIGHT, GL_DEPTH_COMPONENT, GL_FLOAT, depth.data());
+  vector<int> open((WIDTH + 1) * (HEIGHT + 1), 0);
+  for (int y = 0; y < HEIGHT; y++)
+    for (int x = 0; x < WIDTH; x++)
+      open[(y + 1) * (WIDTH + 1) + x + 1] = (depth[y * WIDTH + x] >= 1.0f) + open[y * (WIDTH + 1) + x + 1] +
+                                           open[(y + 1) * (WIDTH + 1) + x] - open[y * (WIDTH + 1) + x];
+  auto covered = [&](glm::ivec2 first, glm::ivec2 last)
+  {
+    return open[(last.y + 1) * (WIDTH + 1) + last.x + 1] - open[first.y * (WIDTH + 1) + last.x + 1] -
+               open[(last.y + 1) * (WIDTH + 1) + first.x] + open[first.y * (WIDTH + 1) + first.x] ==
+           0;
+  };
+
+  culler.occlusion = true;
+  culler.cull(viewProj, camera.eye);
+  vector<uint32_t> visible = readVisible(culler);
+
+  // 整个球在墙平面后面，并且投影范围内的像素都被墙覆盖才可以剔除，其余的必须保留
+  size_t behind = 0, hidden = 0, wrong = 0;
+  for (uint32_t i : inFrustum)
+  {
+    const glm::vec4 &sphere = spheres[i];
+    glm::ivec2 first, last;
+    bool isBehind = sphere.z + sphere.w < WALL_Z && pixelRect(viewProj, sphere, first, last) && covered(first, last);
+    bool kept = binary_search(visible.begin(), visible.end(), i);
+    behind += isBehind;
+    hidden += isBehind && !kept;
+    wrong += !isBehind && !kept;
+  }
+  size_t extra = 0;
+  for (uint32_t i : visible)
+    extra += !binary_search(inFrustum.begin(), inFrustum.end(), i);
+
+  cout << "  in frustum " << inFrustum.size() << ", behind the wall " << behind << ", hidden " << hidden
+       << " (" << (behind > 0 ? 100.0 * hidden / behind : 0.0) << "%), wrongly hidden " << wrong << ", outside the frustum " << extra << endl;
+  if (hidden == 0)
+    cout << "  Hi-Z did not hide anything" << endl;
+  return wrong + extra + (hidden == 0 ? 1 : 0);
+}
+
+int main(int argc, char *argv[])
+{
+  Shader::dirName = argv[1];
+  glfwInit();
+  glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
+  glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+  glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+  // 不需要显示窗口，只需要一个上下文和默认帧缓冲的深度
+  glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+
+  GLFWwindow *window = glfwCreateWindow(WIDTH, HEIGHT, "gpu_culling", NULL, NULL);
+  if (window == NULL)
+  {
+    cout << "GL 4.3 is not available, GpuCuller is not used, skipped" << endl;
+    glfwTerminate();
+    return 0;
+  }
+  glfwMakeContextCurrent(window);
+
+  if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
+  {
+    std::cout << "Failed to initialize GLAD" << std::endl;
+    return -1;
+  }
+  if (!GpuCuller::supported())
+  {
+    cout << "GL 4.3 is not available, GpuCuller is not used, skipped" << endl;
+    glfwTerminate();
+    return 0;
+  }
+  cout << glGetString(GL_RENDERER) << ", " << glGetString(GL_VERSION) << endl;
+
+  // 第二个参数为实例数量
+  size_t count = argc > 2 ? (size_t)atol(argv[2]) : 100000;
+  mt19937 random(7);
+  uniform_real_distribution<float> horizontal(-30.0f, 30.0f), depth(-60.0f, 10.0f), radius(0.05f, 0.5f);
+  vector<glm::vec4> spheres(count);
+  SphereSoA soa;
+  soa.reserve(count);
+  for (glm::vec4 &sphere : spheres)
+  {
+    sphere.x = horizontal(random);
+    sphere.y = horizontal(random);
+    sphere.z = depth(random);
+    sphere.w = radius(random);
+    soa.push(glm::vec3(sphere), sphere.w);
+  }
+  addGapProbes(spheres, soa, count / 5, random);
+
+  Shader occluderShader("./shader/occluder_vert.glsl", "./shader/occluder_frag.glsl");
+  RenderState::setDepthTest(true);
+
+  size_t failures = 0;
+  {
+    GpuCuller culler(spheres);
+    SphereGeometry sphereGeometry(1.0f, 8.0f, 8.0f);
+    culler.setMeshes({&sphereGeometry});
+
+    cout << spheres.size() << " instances, frustum and distance culling (occlusion off):" << endl;
+    CameraCase cameras[] = {
+        {"forward", glm::vec3(0.0f), glm::vec3(0.0f, 0.0f, -1.0f), 0.0f},
+        {"forward, cutoff 25", glm::vec3(0.0f), glm::vec3(0.0f, 0.0f, -1.0f), 25.0f},
+        {"oblique, cutoff 40", glm::vec3(10.0f, 5.0f, 5.0f), glm::vec3(-5.0f, 0.0f, -20.0f), 40.0f},
+        {"sideways", glm::vec3(-20.0f, 0.0f, -20.0f), glm::vec3(20.0f, 3.0f, -25.0f), 0.0f},
+    };
+    for (const CameraCase &camera : cameras)
+      failures += checkFrustum(culler, spheres, soa, camera);
+
+    cout << "Hi-Z occlusion:" << endl;
+    failures += checkOcclusion(culler, spheres, occluderShader);
+
+    // GPU 耗时是几帧之后回读的，多跑几帧再读
+    for (int frame = 0; frame < 8; frame++)
+    {
+      culler.cull(viewProjection(cameras[0]), cameras[0].eye);
+      culler.captureDepth(WIDTH, HEIGHT);
+      glFinish();
+    }
+    cout << "gpu cull " << culler.stats.cullMs << " ms, Hi-Z " << culler.stats.hiZMs << " ms" << endl;
+    sphereGeometry.dispose();
+  }
+
+  GLenum error = glGetError();
+  if (error != GL_NO_ERROR)
+  {
+    cout << "GL error 0x" << hex << error << dec << endl;
+    failures++;
+  }
+  cout << (failures == 0 ? "ok" : "FAILED") << endl;
+
+  glfwTerminate();
+
+  return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,8 @@
+#version 330 core
+layout(location = 0) in vec3 Position;
+
+uniform mat4 transform; // projection * view * model
+
+void main() {
+  gl_Position = transform * vec4(Position, 1.0f);
+}
@@ -0,0 +1,103 @@
+#include <iostream>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <geometry/Frustum.h>
+#include <tool/instance_culler.h>
+
+// 与 37_instancing_rock 相同的小行星带，InstanceCuller 在不同线程数下剔除和紧凑的耗时
+// 相机在小行星带上绕圈，每个线程数测试 FRAMES 帧取平均，输出写到普通内存（映射的实例缓冲在显存或写合并内存中，写入更慢）
+const int FRAMES = 60;
+
+using namespace std;
+
+vector<glm::mat4> makeRocks(size_t amount)
+{
+  mt19937 random(42);
+  uniform_real_distribution<float> offset(-2.5f, 2.5f), scale(0.05f, 0.25f), angle(0.0f, 360.0f);
+  vector<glm::mat4> matrices(amount);
+  for (size_t i = 0; i < amount; i++)
+  {
+    float around = glm::radians(360.0f * i / amount);
+    glm::vec3 position(sin(around) * 50.0f + offset(random), offset(random) * 0.4f, cos(around) * 50.0f + offset(random));
+    glm::mat4 model = glm::translate(glm::mat4(1.0f), position);
+    model = glm::scale(model, glm::vec3(scale(random)));
+    matrices[i] = glm::rotate(model, glm::radians(angle(random)), glm::vec3(0.4f, 0.6f, 0.8f));
+  }
+  return matrices;
+}
+
+Frustum frustumAt(int frame, float cutoff)
+{
+  glm::mat4 projection = glm::perspective(glm::radians(45.0f), 16.0f / 9.0f, 0.1f, 100.0f);
+  float around = glm::radians(360.0f * frame / FRAMES);
+  glm::vec3 eye(sin(around) * 50.0f, 2.0f, cos(around) * 50.0f);
+  glm::vec3 forward(cos(around), -0.05f, -sin(around)); // 沿着小行星带的切线方向
+  Frustum frustum = Frustum::fromMatrix(projection * glm::lookAt(eye, eye + forward, glm::vec3(0.0f, 1.0f, 0.0f)));
+  frustum.setDistanceCutoff(eye, cutoff);
+  return frustum;
+}
+
+int main(int argc, char *argv[])
+{
+  // 第二个参数可以指定数量，第三个参数指定距离剔除（默认 60，0 表示只按视锥）
+  size_t amount = argc > 2 ? (size_t)atol(argv[2]) : 1000000;
+  float cutoff = argc > 3 ? (float)atof(argv[3]) : 60.0f;
+
+  vector<glm::mat4> matrices = makeRocks(amount);
+  // 石头模型的包围盒大约是 [-1, 1]^3
+  Bounds rockBounds;
+  rockBounds.expand(glm::vec3(-1.0f));
+  rockBounds.expand(glm::vec3(1.0f));
+  SphereSoA spheres;
+  spheres.reserve(amount);
+  for (const glm::mat4 &matrix : matrices)
+    spheres.push(rockBounds, matrix);
+
+  vector<unsigned int> threadCounts;
+  for (unsigned int threads = 1; threads < thread::hardware_concurrency(); threads *= 2)
+    threadCounts.push_back(threads);
+  threadCounts.push_back(max(1u, thread::hardware_concurrency()));
+
+  cout << amount << " instances, distance cutoff " << cutoff << ", " << FrustumCuller::modeName(FrustumCuller::Mode::Best)
+       << ", chunk " << InstanceCuller::chunkSize << endl;
+  vector<glm::mat4> out(amount), reference(amount);
+  size_t referenceCount = 0;
+  double singleMs = 0.0;
+  for (unsigned int threads : threadCounts)
+  {
+    Parallel::threadCount = threads;
+    InstanceCuller culler;
+    double cullMs = 0.0, compactMs = 0.0;
+    size_t visible = 0;
+    bool same = true;
+    for (int frame = 0; frame < FRAMES; frame++)
+    {
+      size_t count = culler.cull(frustumAt(frame, cutoff), spheres, matrices.data(), out.data());
+      cullMs += culler.stats.cullMs;
+      compactMs += culler.stats.compactMs;
+      visible += count;
+      // 第 0 帧的结果与单线程比较
+      if (frame == 0 && threads == threadCounts[0])
+      {
+        reference = out;
+        referenceCount = count;
+      }
+      else if (frame == 0)
+        same = count == referenceCount && memcmp(out.data(), reference.data(), count * sizeof(glm::mat4)) == 0;
+    }
+    double totalMs = (cullMs + compactMs) / FRAMES;
+    if (threads == threadCounts[0])
+      singleMs = totalMs;
+    cout << "  " << threads << " threads: cull " << cullMs / FRAMES << " ms + compact " << compactMs / FRAMES << " ms = " << totalMs
+         << " ms, " << singleMs / totalMs << "x, " << visible / FRAMES << " visible" << (same ? "" : "  (MISMATCH)") << endl;
+  }
+  return 0;
+}
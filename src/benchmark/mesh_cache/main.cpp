@@ -0,0 +1,119 @@
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include <iostream>
+#include <vector>
+#include <string>
+
+#include <tool/shader.h>
+
+#define STB_IMAGE_IMPLEMENTATION
+#include <tool/stb_image.h>
+
+#include <tool/mesh.h>
+#include <tool/model.h>
+
+std::string Shader::dirName;
+
+// 对比 assimp 导入与映射 MeshCache 的模型加载时间
+// 每项重复 ITERATIONS 次取平均，两条路径都包含贴图加载
+const unsigned int ITERATIONS = 5;
+
+using namespace std;
+
+struct LoadResult
+{
+  double ms = 0.0;
+  size_t meshCount = 0;
+  size_t vertexCount = 0;
+  bool fromCache = false;
+};
+
+LoadResult load(const string &path)
+{
+  LoadResult result;
+  for (unsigned int i = 0; i < ITERATIONS; i++)
+  {
+    Model model(path);
+    result.ms += model.loadMs;
+    result.meshCount = model.meshes.size();
+    result.vertexCount = 0;
+    for (Mesh &mesh : model.meshes)
+    {
+      result.vertexCount += mesh.vertices.size();
+      mesh.dispose();
+    }
+    result.fromCache = model.fromCache;
+  }
+  result.ms /= ITERATIONS;
+  return result;
+}
+
+void benchmarkModel(const string &path)
+{
+  MeshCache::enabled = false;
+  LoadResult assimp = load(path);
+
+  // 先删除旧缓存，第一次加载生成缓存，之后都从缓存加载
+  MeshCache::enabled = true;
+  std::error_code error;
+  std::filesystem::remove(MeshCache::cachePath(path), error);
+  double cookMs;
+  {
+    Model model(path);
+    cookMs = model.loadMs;
+    for (Mesh &mesh : model.meshes)
+      mesh.dispose();
+  }
+  LoadResult cached = load(path);
+
+  std::error_code sizeError;
+  uintmax_t cacheBytes = std::filesystem::file_size(MeshCache::cachePath(path), sizeError);
+  cout << path << ": " << assimp.meshCount << " meshes, " << assimp.vertexCount << " vertices, cache " << (sizeError ? 0 : cacheBytes) << " B" << endl;
+  cout << "  assimp:        " << assimp.ms << " ms" << endl;
+  cout << "  assimp + cook: " << cookMs << " ms" << endl;
+  cout << "  mesh cache:    " << cached.ms << " ms" << (cached.fromCache ? "" : " (cache rejected!)") << endl;
+  if (cached.ms > 0.0)
+    cout << "  speedup:       " << assimp.ms / cached.ms << "x" << endl;
+}
+
+int main(int argc, char *argv[])
+{
+  Shader::dirName = argv[1];
+  glfwInit();
+  glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+  glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+  glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+  // 上传网格和贴图需要一个上下文，不需要显示窗口
+  glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+
+  GLFWwindow *window = glfwCreateWindow(64, 64, "mesh_cache", NULL, NULL);
+  if (window == NULL)
+  {
+    std::cout << "Failed to create GLFW window" << std::endl;
+    glfwTerminate();
+    return -1;
+  }
+  glfwMakeContextCurrent(window);
+
+  if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
+  {
+    std::cout << "Failed to initialize GLAD" << std::endl;
+    return -1;
+  }
+
+  // 第二个参数可以指定其他模型
+  if (argc > 2)
+    benchmarkModel(argv[2]);
+  else
+  {
+    const char *models[] = {"./static/model/cerberus/Cerberus.obj", "./static/model/nanosuit/nanosuit.obj",
+                            "./static/model/planet/planet.obj", "./static/model/walt/WaltHead.obj"};
+    for (const char *path : models)
+      benchmarkModel(path);
+  }
+  MeshCache::printStats();
+
+  glfwTerminate();
+
+  return 0;
+}
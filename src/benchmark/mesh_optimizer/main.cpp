@@ -0,0 +1,128 @@
+#include <assimp/Importer.hpp>
+#include <assimp/scene.h>
+#include <assimp/postprocess.h>
+#include <iostream>
+#include <chrono>
+#include <vector>
+#include <string>
+
+#include <geometry/MeshOptimizer.h>
+
+// 逐步执行 MeshOptimizer 的各个阶段，输出每一步之后的 ACMR / ATVR 和耗时
+// 只用到 assimp，不需要 GL 上下文
+const unsigned int BASE_FLAGS = aiProcess_Triangulate | aiProcess_GenSmoothNormals | aiProcess_FlipUVs | aiProcess_CalcTangentSpace;
+
+using namespace std;
+
+struct MeshData
+{
+  vector<Vertex> vertices;
+  vector<unsigned int> indices;
+};
+
+double elapsedMs(chrono::steady_clock::time_point start)
+{
+  return chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+}
+
+// 与 Model::processMesh 相同的拷贝方式，只保留三角形网格
+vector<MeshData> extractMeshes(const aiScene *scene)
+{
+  vector<MeshData> meshes;
+  for (unsigned int m = 0; m < scene->mNumMeshes; m++)
+  {
+    const aiMesh *mesh = scene->mMeshes[m];
+    if (mesh->mPrimitiveTypes != aiPrimitiveType_TRIANGLE)
+      continue;
+    MeshData data;
+    data.vertices.resize(mesh->mNumVertices);
+    for (unsigned int i = 0; i < mesh->mNumVertices; i++)
+    {
+      Vertex &vertex = data.vertices[i];
+      vertex.Position = glm::vec3(mesh->mVertices[i].x, mesh->mVertices[i].y, mesh->mVertices[i].z);
+      vertex.Normal = glm::vec3(mesh->mNormals[i].x, mesh->mNormals[i].y, mesh->mNormals[i].z);
+      if (mesh->mTextureCoords[0])
+        vertex.TexCoords = glm::vec2(mesh->mTextureCoords[0][i].x, mesh->mTextureCoords[0][i].y);
+      if (mesh->HasTangentsAndBitangents())
+      {
+        vertex.Tangent = glm::vec3(mesh->mTangents[i].x, mesh->mTangents[i].y, mesh->mTangents[i].z);
+        vertex.Bitangent = glm::vec3(mesh->mBitangents[i].x, mesh->mBitangents[i].y, mesh->mBitangents[i].z);
+      }
+    }
+    for (unsigned int i = 0; i < mesh->mNumFaces; i++)
+      for (unsigned int j = 0; j < mesh->mFaces[i].mNumIndices; j++)
+        data.indices.push_back(mesh->mFaces[i].mIndices[j]);
+    meshes.push_back(std::move(data));
+  }
+  return meshes;
+}
+
+void reportStage(const string &stage, const vector<MeshData> &meshes, double ms)
+{
+  VertexCacheStats fifo16, fifo32;
+  for (const MeshData &mesh : meshes)
+  {
+    fifo16.add(MeshOptimizer::analyzeVertexCache(mesh.indices, mesh.vertices.size(), 16));
+    fifo32.add(MeshOptimizer::analyzeVertexCache(mesh.indices, mesh.vertices.size(), 32));
+  }
+  cout << "  " << stage << ": " << fifo16.vertices << " vertices, ACMR " << fifo16.acmr() << " (16) / " << fifo32.acmr() << " (32), ATVR "
+       << fifo16.atvr() << " (16) / " << fifo32.atvr() << " (32)";
+  if (ms >= 0.0)
+    cout << ", " << ms << " ms";
+  cout << endl;
+}
+
+void benchmarkModel(const string &path)
+{
+  Assimp::Importer importer;
+  const aiScene *scene = importer.ReadFile(path, BASE_FLAGS);
+  if (!scene || scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE || !scene->mRootNode)
+  {
+    cout << "ERROR::ASSIMP:: " << importer.GetErrorString() << endl;
+    return;
+  }
+  vector<MeshData> meshes = extractMeshes(scene);
+  size_t triangleCount = 0;
+  for (const MeshData &mesh : meshes)
+    triangleCount += mesh.indices.size() / 3;
+  cout << path << ": " << meshes.size() << " meshes, " << triangleCount << " triangles" << endl;
+  reportStage("import  ", meshes, -1.0);
+
+  auto start = chrono::steady_clock::now();
+  for (MeshData &mesh : meshes)
+    MeshOptimizer::weld(mesh.vertices, mesh.indices);
+  reportStage("weld    ", meshes, elapsedMs(start));
+
+  vector<vector<unsigned int>> clusters(meshes.size());
+  start = chrono::steady_clock::now();
+  for (size_t i = 0; i < meshes.size(); i++)
+    meshes[i].indices = MeshOptimizer::tipsify(meshes[i].indices, meshes[i].vertices.size(), MeshOptimizer::cacheSize, &clusters[i]);
+  reportStage("tipsify ", meshes, elapsedMs(start));
+
+  start = chrono::steady_clock::now();
+  for (size_t i = 0; i < meshes.size(); i++)
+    MeshOptimizer::optimizeOverdraw(meshes[i].indices, meshes[i].vertices, clusters[i], MeshOptimizer::overdrawThreshold);
+  reportStage("overdraw", meshes, elapsedMs(start));
+
+  start = chrono::steady_clock::now();
+  for (MeshData &mesh : meshes)
+    MeshOptimizer::optimizeVertexFetch(mesh.vertices, mesh.indices);
+  reportStage("fetch   ", meshes, elapsedMs(start));
+}
+
+int main(int argc, char *argv[])
+{
+  // 第二个参数可以指定其他模型
+  if (argc > 2)
+  {
+    benchmarkModel(argv[2]);
+    return 0;
+  }
+
+  const char *models[] = {"./static/model/cerberus/Cerberus.obj", "./static/model/nanosuit/nanosuit.obj",
+                          "./static/model/teapot/teapot.obj", "./static/model/rock/rock.obj"};
+  for (const char *path : models)
+    benchmarkModel(path);
+
+  return 0;
+}
@@ -0,0 +1,190 @@
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include <iostream>
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <vector>
+#include <string>
+
+#define STB_IMAGE_IMPLEMENTATION
+#include <tool/stb_image.h>
+#include <tool/mip_generator.h>
+
+// glGenerateMipmap 与 MipGenerator（标量、SSE2）生成 mipmap 的耗时，以及 CPU 生成后逐级上传的耗时
+// GPU 部分每次以 glFinish 结束，包含驱动实际完成的时间
+const int ITERATIONS = 5;
+
+using namespace std;
+
+const char *TEXTURES[] = {
+    "./static/texture/wood.png",
+    "./static/texture/TexturesCom_MuddySand2_2x2_2K_albedo.png",
+    "./static/texture/brickwall_normal.jpg",
+    "./static/texture/blending_transparent_window.png"};
+
+// 多次运行取最小值，单位毫秒
+double measure(const function<void()> &work)
+{
+  double best = 1e30;
+  for (int i = 0; i < ITERATIONS; i++)
+  {
+    auto start = chrono::steady_clock::now();
+    work();
+    best = min(best, chrono::duration<double, milli>(chrono::steady_clock::now() - start).count());
+  }
+  return best;
+}
+
+void printRow(const string &name, double ms, double megaPixels)
+{
+  cout << "    " << name;
+  for (size_t i = name.size(); i < 26; i++)
+    cout << ' ';
+  cout << ms << " ms, " << megaPixels / (ms / 1000.0) << " MPix/s" << endl;
+}
+
+GLenum baseFormat(int channels)
+{
+  static const GLenum formats[4] = {GL_RED, GL_RG, GL_RGB, GL_RGBA};
+  return formats[channels - 1];
+}
+
+GLenum internalFormat(int channels, MipFilter filter)
+{
+  static const GLenum formats[4] = {GL_R8, GL_RG8, GL_RGB8, GL_RGBA8};
+  if (filter == MipFilter::Srgb && channels == 3)
+    return GL_SRGB8;
+  if (filter == MipFilter::Srgb && channels == 4)
+    return GL_SRGB8_ALPHA8;
+  return formats[channels - 1];
+}
+
+// 与 TextureCache 相同的分配方式，返回级别数
+GLsizei allocate(unsigned int texture, int width, int height, int channels, MipFilter filter)
+{
+  GLsizei levels = 1;
+  while ((max(width, height) >> levels) > 0)
+    levels++;
+  glBindTexture(GL_TEXTURE_2D, texture);
+  GLenum internal = internalFormat(channels, filter);
+  if (GLAD_GL_VERSION_4_2)
+    glTexStorage2D(GL_TEXTURE_2D, levels, internal, width, height);
+  else
+  {
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, levels - 1);
+    for (GLsizei level = 0; level < levels; level++)
+      glTexImage2D(GL_TEXTURE_2D, level, internal, max(1, width >> level), max(1, height >> level), 0, baseFormat(channels), GL_UNSIGNED_BYTE, nullptr);
+  }
+  return levels;
+}
+
+void benchmarkTexture(const string &path)
+{
+  int width, height, channels;
+  stbi_set_flip_vertically_on_load(true);
+  unsigned char *pixels = stbi_load(path.c_str(), &width, &height, &channels, 0);
+  if (pixels == nullptr)
+  {
+    cout << path << ": failed to load" << endl;
+    return;
+  }
+  MipFilter filter = MipGenerator::guess(path);
+  const char *filterNames[3] = {"linear", "srgb", "normal"};
+  double megaPixels = (double)width * height / 1e6;
+  GLenum format = baseFormat(channels);
+  cout << path << "  " << width << "x" << height << "x" << channels << ", filter " << filterNames[(int)filter] << endl;
+
+  glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+  unsigned int texture;
+  glGenTextures(1, &texture);
+  allocate(texture, width, height, channels, filter);
+
+  // 只上传第 0 级，作为两种方式共同的部分
+  double uploadMs = measure([&]()
+                            {
+                              glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, width, height, format, GL_UNSIGNED_BYTE, pixels);
+                              glFinish(); });
+  double gpuMs = measure([&]()
+                         {
+                           glGenerateMipmap(GL_TEXTURE_2D);
+                           glFinish(); });
+  printRow("upload level 0", uploadMs, megaPixels);
+  printRow("glGenerateMipmap", gpuMs, megaPixels);
+
+  vector<MipLevel> mips;
+  bool simd = MipGenerator::simd;
+  MipGenerator::simd = false;
+  double scalarMs = measure([&]()
+                            { mips = MipGenerator::generate(pixels, width, height, channels, filter); });
+  MipGenerator::simd = simd;
+  double simdMs = measure([&]()
+                          { mips = MipGenerator::generate(pixels, width, height, channels, filter); });
+  double mipUploadMs = measure([&]()
+                               {
+                                 for (size_t level = 0; level < mips.size(); level++)
+                                   glTexSubImage2D(GL_TEXTURE_2D, (GLint)level + 1, 0, 0, mips[level].width, mips[level].height, format, GL_UNSIGNED_BYTE,
+                                                   mips[level].data.data());
+                                 glFinish(); });
+  printRow("MipGenerator scalar", scalarMs, megaPixels);
+#ifdef MIP_GENERATOR_SSE2
+  printRow("MipGenerator SSE2", simdMs, megaPixels);
+#else
+  cout << "    (SSE2 not available, scalar only)" << endl;
+#endif
+  printRow("upload levels 1..n", mipUploadMs, megaPixels);
+
+  // 带透明度的图片：比较每级透明度大于 0.1 的比例，直接平均时会随级别下降
+  if (channels == 4)
+  {
+    const float cutoff = 0.1f;
+    vector<MipLevel> scaled = MipGenerator::generate(pixels, width, height, channels, filter, cutoff);
+    cout << "    alpha coverage (> " << cutoff << ") plain / scaled: " << MipGenerator::coverage(pixels, width, height, channels, cutoff, 1.0f);
+    for (size_t level = 0; level < mips.size() && level < 6; level++)
+      cout << "  " << MipGenerator::coverage(mips[level].data.data(), mips[level].width, mips[level].height, channels, cutoff, 1.0f) << "/"
+           << MipGenerator::coverage(scaled[level].data.data(), scaled[level].width, scaled[level].height, channels, cutoff, 1.0f);
+    cout << endl;
+  }
+
+  glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+  glDeleteTextures(1, &texture);
+  stbi_image_free(pixels);
+}
+
+int main(int argc, char *argv[])
+{
+  glfwInit();
+  glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+  glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+  glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+  glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+
+  GLFWwindow *window = glfwCreateWindow(64, 64, "mip_generation", NULL, NULL);
+  if (window == NULL)
+  {
+    std::cout << "Failed to create GLFW window" << std::endl;
+    glfwTerminate();
+    return -1;
+  }
+  glfwMakeContextCurrent(window);
+
+  if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
+  {
+    std::cout << "Failed to initialize GLAD" << std::endl;
+    return -1;
+  }
+
+  // 第二个及之后的参数可以指定其他图片
+  vector<string> paths;
+  for (int i = 2; i < argc; i++)
+    paths.push_back(argv[i]);
+  if (paths.empty())
+    paths.assign(begin(TEXTURES), end(TEXTURES));
+
+  cout << "best of " << ITERATIONS << " runs, MPix/s relative to level 0" << endl;
+  for (const string &path : paths)
+    benchmarkTexture(path);
+
+  glfwTerminate();
+  return 0;
+}
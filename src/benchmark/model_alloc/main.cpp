@@ -0,0 +1,216 @@
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include <iostream>
+#include <fstream>
+#include <cstdlib>
+#include <atomic>
+#include <new>
+#include <vector>
+#include <string>
+
+#include <tool/shader.h>
+
+#define STB_IMAGE_IMPLEMENTATION
+#include <tool/stb_image.h>
+
+#include <tool/mesh.h>
+#include <tool/model.h>
+
+std::string Shader::dirName;
+
+// 统计加载模型时的堆分配次数、分配总量和峰值
+// 替换全局 operator new / delete，每块内存前面多分配 16 字节记录大小
+// 贴图解码和切线生成在工作线程上执行，计数都是原子的
+using namespace std;
+
+struct AllocationStats
+{
+  atomic<size_t> count{0}; // operator new 调用次数
+  atomic<size_t> bytes{0}; // 累计分配的字节数
+  atomic<size_t> live{0};  // 当前未释放的字节数
+  atomic<size_t> peak{0};  // live 的最大值
+};
+
+static AllocationStats allocations;
+static const size_t HEADER = 16; // 保持 operator new 的 16 字节对齐
+
+void *countedAlloc(size_t size)
+{
+  unsigned char *block = (unsigned char *)malloc(size + HEADER);
+  if (block == nullptr)
+    return nullptr;
+  *(size_t *)block = size;
+  allocations.count++;
+  allocations.bytes += size;
+  size_t live = allocations.live += size;
+  size_t peak = allocations.peak;
+  while (live > peak && !allocations.peak.compare_exchange_weak(peak, live))
+    ;
+  return block + HEADER;
+}
+
+void countedFree(void *pointer)
+{
+  if (pointer == nullptr)
+    return;
+  unsigned char *block = (unsigned char *)pointer - HEADER;
+  allocations.live -= *(size_t *)block;
+  free(block);
+}
+
+void *operator new(size_t size)
+{
+  void *pointer = countedAlloc(size);
+  if (pointer == nullptr)
+    throw std::bad_alloc();
+  return pointer;
+}
+void *operator new[](size_t size)
+{
+  return operator new(size);
+}
+void *operator new(size_t size, const std::nothrow_t &) noexcept
+{
+  return countedAlloc(size);
+}
+void *operator new[](size_t size, const std::nothrow_t &) noexcept
+{
+  return countedAlloc(size);
+}
+void operator delete(void *pointer) noexcept
+{
+  countedFree(pointer);
+}
+void operator delete[](void *pointer) noexcept
+{
+  countedFree(pointer);
+}
+void operator delete(void *pointer, size_t) noexcept
+{
+  countedFree(pointer);
+}
+void operator delete[](void *pointer, size_t) noexcept
+{
+  countedFree(pointer);
+}
+
+// 进程的常驻内存峰值（Linux 的 VmHWM），其他平台返回 0
+size_t peakResidentBytes()
+{
+  ifstream status("/proc/self/status");
+  string line;
+  while (getline(status, line))
+    if (line.compare(0, 6, "VmHWM:") == 0)
+      return (size_t)strtoull(line.c_str() + 6, nullptr, 10) * 1024;
+  return 0;
+}
+
+// 把 VmHWM 重置为当前的常驻内存，之后的峰值只反映这一项
+void resetPeakResident()
+{
+  ofstream clearRefs("/proc/self/clear_refs");
+  clearRefs << "5";
+}
+
+struct Measurement
+{
+  size_t count = 0;
+  size_t bytes = 0;
+  size_t peak = 0;     // 相对开始时增加的堆内存峰值
+  size_t resident = 0; // 常驻内存峰值
+  double ms = 0.0;
+};
+
+template <typename Fn>
+Measurement measure(Fn fn)
+{
+  resetPeakResident();
+  size_t startCount = allocations.count;
+  size_t startBytes = allocations.bytes;
+  size_t startLive = allocations.live;
+  allocations.peak = startLive;
+  auto clock = chrono::steady_clock::now();
+  fn();
+  Measurement result;
+  result.ms = chrono::duration<double, milli>(chrono::steady_clock::now() - clock).count();
+  result.count = allocations.count - startCount;
+  result.bytes = allocations.bytes - startBytes;
+  result.peak = allocations.peak - startLive;
+  result.resident = peakResidentBytes();
+  return result;
+}
+
+void report(const char *name, const Measurement &result)
+{
+  const double MB = 1024.0 * 1024.0;
+  cout << "  " << name << result.count << " allocations, " << result.bytes / MB << " MB allocated, peak heap +"
+       << result.peak / MB << " MB";
+  if (result.resident > 0)
+    cout << ", peak RSS " << result.resident / MB << " MB";
+  cout << ", " << result.ms << " ms" << endl;
+}
+
+void loadModel(const string &path)
+{
+  Model model(path);
+  for (Mesh &mesh : model.meshes)
+    mesh.dispose();
+}
+
+void benchmarkModel(const string &path)
+{
+  // 预热：生成网格缓存，让文件进入系统的文件缓存，并填满字符串驻留表
+  loadModel(path);
+  cout << path << ":" << endl;
+
+  unsigned int flags = aiProcess_Triangulate | aiProcess_GenSmoothNormals | aiProcess_FlipUVs;
+  if (Model::assimpTangents)
+    flags |= aiProcess_CalcTangentSpace;
+  auto importOnly = [&]()
+  {
+    Assimp::Importer importer;
+    importer.ReadFile(path, flags);
+  };
+  auto load = [&]()
+  {
+    loadModel(path);
+  };
+  report("assimp only: ", measure(importOnly));
+  MeshCache::enabled = false;
+  report("Model:       ", measure(load));
+  MeshCache::enabled = true;
+  report("mesh cache:  ", measure(load));
+}
+
+int main(int argc, char *argv[])
+{
+  Shader::dirName = argv[1];
+  glfwInit();
+  glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+  glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+  glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+  // 上传网格和贴图需要一个上下文，不需要显示窗口
+  glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+
+  GLFWwindow *window = glfwCreateWindow(64, 64, "model_alloc", NULL, NULL);
+  if (window == NULL)
+  {
+    std::cout << "Failed to create GLFW window" << std::endl;
+    glfwTerminate();
+    return -1;
+  }
+  glfwMakeContextCurrent(window);
+
+  if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
+  {
+    std::cout << "Failed to initialize GLAD" << std::endl;
+    return -1;
+  }
+
+  // 第二个参数可以指定其他模型
+  benchmarkModel(argc > 2 ? argv[2] : "./static/model/nanosuit/nanosuit.obj");
+
+  glfwTerminate();
+
+  return 0;
+}
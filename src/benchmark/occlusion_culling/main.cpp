@@ -0,0 +1,121 @@
+#include <iostream>
+#include <chrono>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <geometry/Frustum.h>
+#include <tool/occlusion_culler.h>
+
+// 与 37_instancing_rock 类似的场景：一颗行星和环绕它的小行星带，相机在带外侧绕行星转一圈
+// 每个方向先按视锥剔除，再把行星和几个大石块光栅化，测试视锥内的小行星，三种实现分别计时并比较结果
+const int DIRECTIONS = 12;
+
+using namespace std;
+
+struct Scene
+{
+  vector<Bounds> rocks;
+  vector<glm::mat4> boulders; // 作为遮挡体的大石块，模型空间是 [-0.5, 0.5]^3
+};
+
+Scene makeScene(size_t amount)
+{
+  mt19937 random(42);
+  uniform_real_distribution<float> offset(-2.5f, 2.5f), size(0.05f, 0.25f), angle(0.0f, 360.0f);
+  Scene scene;
+  scene.rocks.resize(amount);
+  for (size_t i = 0; i < amount; i++)
+  {
+    float around = glm::radians(360.0f * i / amount);
+    glm::vec3 center(sin(around) * 25.0f + offset(random), offset(random) * 0.4f, cos(around) * 25.0f + offset(random));
+    float half = size(random);
+    scene.rocks[i].expand(center - glm::vec3(half));
+    scene.rocks[i].expand(center + glm::vec3(half));
+  }
+  for (int i = 0; i < 16; i++)
+  {
+    float around = glm::radians(360.0f * i / 16.0f + 7.0f);
+    glm::mat4 model = glm::translate(glm::mat4(1.0f), glm::vec3(sin(around) * 22.0f, 0.0f, cos(around) * 22.0f));
+    model = glm::rotate(model, glm::radians(angle(random)), glm::vec3(0.0f, 1.0f, 0.0f));
+    scene.boulders.push_back(glm::scale(model, glm::vec3(3.0f, 2.0f, 1.0f)));
+  }
+  return scene;
+}
+
+glm::mat4 viewProjAt(int direction)
+{
+  glm::mat4 projection = glm::perspective(glm::radians(45.0f), 16.0f / 9.0f, 0.1f, 100.0f);
+  float around = glm::radians(360.0f * direction / DIRECTIONS);
+  glm::vec3 eye(sin(around) * 40.0f, 3.0f, cos(around) * 40.0f);
+  return projection * glm::lookAt(eye, glm::vec3(0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+}
+
+int main(int argc, char *argv[])
+{
+  // 第二个参数可以指定小行星数量，第三、四个参数指定遮挡缓冲的分辨率
+  size_t amount = argc > 2 ? (size_t)atol(argv[2]) : 100000;
+  int width = argc > 3 ? atoi(argv[3]) : 256;
+  int height = argc > 4 ? atoi(argv[4]) : 128;
+
+  Scene scene = makeScene(amount);
+  BoundsSoA rocks;
+  for (const Bounds &bounds : scene.rocks)
+    rocks.push(bounds);
+  Bounds unitBox;
+  unitBox.expand(glm::vec3(-0.5f));
+  unitBox.expand(glm::vec3(0.5f));
+
+  OcclusionCuller occlusion(width, height);
+  cout << amount << " rocks, " << scene.boulders.size() << " boulders + planet, buffer " << occlusion.bufferWidth() << "x"
+       << occlusion.bufferHeight() << endl;
+
+  vector<uint32_t> visible(amount);
+  vector<vector<uint8_t>> reference(DIRECTIONS);
+  double scalarMs = 0.0;
+  for (FrustumCuller::Mode mode : {FrustumCuller::Mode::Scalar, FrustumCuller::Mode::Sse, FrustumCuller::Mode::Avx})
+  {
+    if (mode == FrustumCuller::Mode::Avx && string(FrustumCuller::modeName(mode)) != "AVX")
+    {
+      cout << "  AVX: not compiled (build with -mavx)" << endl;
+      continue;
+    }
+    occlusion.mode = mode;
+    double rasterizeMs = 0.0, testMs = 0.0;
+    size_t tested = 0, occluded = 0, triangles = 0;
+    bool same = true;
+    for (int direction = 0; direction < DIRECTIONS; direction++)
+    {
+      glm::mat4 viewProj = viewProjAt(direction);
+      size_t count = FrustumCuller::cull(Frustum::fromMatrix(viewProj), rocks, 0, rocks.size(), visible.data());
+
+      occlusion.beginFrame(viewProj);
+      occlusion.addSphere(glm::mat4(1.0f), glm::vec3(0.0f), 15.0f);
+      for (const glm::mat4 &boulder : scene.boulders)
+        occlusion.addBox(boulder, unitBox);
+      vector<uint8_t> result(count);
+      for (size_t i = 0; i < count; i++)
+        result[i] = occlusion.visible(scene.rocks[visible[i]]);
+
+      rasterizeMs += occlusion.stats.rasterizeMs;
+      testMs += occlusion.stats.testMs;
+      tested += occlusion.stats.tested;
+      occluded += occlusion.stats.occluded;
+      triangles += occlusion.stats.triangles;
+      if (mode == FrustumCuller::Mode::Scalar)
+        reference[direction] = result;
+      else
+        same = same && result == reference[direction];
+    }
+    double totalMs = (rasterizeMs + testMs) / DIRECTIONS;
+    if (mode == FrustumCuller::Mode::Scalar)
+      scalarMs = totalMs;
+    cout << "  " << FrustumCuller::modeName(mode) << ": rasterize " << triangles / DIRECTIONS << " triangles " << rasterizeMs / DIRECTIONS
+         << " ms + test " << tested / DIRECTIONS << " rocks " << testMs / DIRECTIONS << " ms, " << scalarMs / totalMs << "x, occluded "
+         << occluded / DIRECTIONS << (same ? "" : "  (MISMATCH)") << endl;
+  }
+  return 0;
+}
@@ -0,0 +1,83 @@
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include <iostream>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <vector>
+
+#include <tool/shader.h>
+
+std::string Shader::dirName;
+
+using namespace std;
+
+// 51_specular_ibl 启动时创建的全部着色器程序
+const char *programs[][2] = {
+    {"./shader/scene_vert.glsl", "./shader/scene_frag.glsl"},
+    {"./shader/light_object_vert.glsl", "./shader/light_object_frag.glsl"},
+    {"./shader/cubemap_vert.glsl", "./shader/cubemap_frag.glsl"},
+    {"./shader/envmap_vert.glsl", "./shader/envmap_frag.glsl"},
+    {"./shader/irradiance_vert.glsl", "./shader/irradiance_frag.glsl"},
+    {"./shader/prefilter_vert.glsl", "./shader/prefilter_frag.glsl"},
+    {"./shader/brdf_vert.glsl", "./shader/brdf_frag.glsl"},
+    {"./shader/test_brdf_vert.glsl", "./shader/test_brdf_frag.glsl"},
+};
+
+// 用法: main <任意> [cold]
+// 传入 cold 时先清空缓存目录，模拟首次启动；否则为热启动
+int main(int argc, char *argv[])
+{
+  bool cold = argc > 2 && strcmp(argv[2], "cold") == 0;
+  Shader::dirName = "src/51_specular_ibl/";
+
+  glfwInit();
+  glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+  glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+  glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+  // 无需显示窗口
+  glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+
+  GLFWwindow *window = glfwCreateWindow(64, 64, "shader_cache", NULL, NULL);
+  if (window == NULL)
+  {
+    std::cout << "Failed to create GLFW window" << std::endl;
+    glfwTerminate();
+    return -1;
+  }
+  glfwMakeContextCurrent(window);
+
+  if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
+  {
+    std::cout << "Failed to initialize GLAD" << std::endl;
+    return -1;
+  }
+
+  std::cout << "GL_RENDERER: " << glGetString(GL_RENDERER) << std::endl;
+  std::cout << "GL_VERSION:  " << glGetString(GL_VERSION) << std::endl;
+
+  if (cold)
+  {
+    std::error_code error;
+    std::filesystem::remove_all(Shader::cacheDir, error);
+  }
+
+  auto start = chrono::steady_clock::now();
+  vector<unsigned int> ids;
+  for (auto &program : programs)
+  {
+    Shader shader(program[0], program[1]);
+    ids.push_back(shader.ID);
+  }
+  glFinish();
+  double totalMs = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+
+  std::cout << (cold ? "cold" : "warm") << " start: " << ids.size() << " programs in " << totalMs << " ms" << std::endl;
+  Shader::printCacheStats();
+
+  for (unsigned int id : ids)
+    glDeleteProgram(id);
+  glfwTerminate();
+
+  return 0;
+}
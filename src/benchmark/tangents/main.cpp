@@ -0,0 +1,180 @@
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include <assimp/Importer.hpp>
+#include <assimp/scene.h>
+#include <assimp/postprocess.h>
+#include <iostream>
+#include <chrono>
+#include <vector>
+#include <string>
+
+#include <geometry/SphereGeometry.h>
+#include <geometry/Tangents.h>
+#include <tool/parallel.h>
+
+// 对比 generateTangents 与 assimp 的 aiProcess_CalcTangentSpace
+// 每项重复 ITERATIONS 次取平均
+const unsigned int ITERATIONS = 10;
+const unsigned int BASE_FLAGS = aiProcess_Triangulate | aiProcess_GenSmoothNormals | aiProcess_FlipUVs;
+
+using namespace std;
+
+struct MeshData
+{
+  vector<Vertex> vertices;
+  vector<unsigned int> indices;
+};
+
+double elapsedMs(chrono::steady_clock::time_point start)
+{
+  return chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+}
+
+// 与 Model::processMesh 相同的拷贝方式，只保留计算切线需要的属性
+vector<MeshData> extractMeshes(const aiScene *scene)
+{
+  vector<MeshData> meshes;
+  for (unsigned int m = 0; m < scene->mNumMeshes; m++)
+  {
+    const aiMesh *mesh = scene->mMeshes[m];
+    if (!mesh->mTextureCoords[0])
+      continue;
+    MeshData data;
+    data.vertices.resize(mesh->mNumVertices);
+    for (unsigned int i = 0; i < mesh->mNumVertices; i++)
+    {
+      Vertex &vertex = data.vertices[i];
+      vertex.Position = glm::vec3(mesh->mVertices[i].x, mesh->mVertices[i].y, mesh->mVertices[i].z);
+      vertex.Normal = glm::vec3(mesh->mNormals[i].x, mesh->mNormals[i].y, mesh->mNormals[i].z);
+      vertex.TexCoords = glm::vec2(mesh->mTextureCoords[0][i].x, mesh->mTextureCoords[0][i].y);
+    }
+    for (unsigned int i = 0; i < mesh->mNumFaces; i++)
+      for (unsigned int j = 0; j < mesh->mFaces[i].mNumIndices; j++)
+        data.indices.push_back(mesh->mFaces[i].mIndices[j]);
+    meshes.push_back(std::move(data));
+  }
+  return meshes;
+}
+
+double timeGenerate(vector<MeshData> &meshes, unsigned int threads)
+{
+  Parallel::threadCount = threads;
+  auto start = chrono::steady_clock::now();
+  for (unsigned int i = 0; i < ITERATIONS; i++)
+    for (MeshData &mesh : meshes)
+      generateTangents(mesh.vertices, mesh.indices);
+  Parallel::threadCount = 0;
+  return elapsedMs(start) / ITERATIONS;
+}
+
+void benchmarkModel(const string &path)
+{
+  Assimp::Importer importer;
+  const aiScene *scene = importer.ReadFile(path, BASE_FLAGS);
+  if (!scene || scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE || !scene->mRootNode)
+  {
+    cout << "ERROR::ASSIMP:: " << importer.GetErrorString() << endl;
+    return;
+  }
+  vector<MeshData> meshes = extractMeshes(scene);
+  size_t vertexCount = 0, triangleCount = 0;
+  for (const MeshData &mesh : meshes)
+  {
+    vertexCount += mesh.vertices.size();
+    triangleCount += mesh.indices.size() / 3;
+  }
+
+  double singleMs = timeGenerate(meshes, 1);
+  double parallelMs = timeGenerate(meshes, 0);
+
+  // assimp 的后处理会修改场景，每次重新导入，只计后处理的时间
+  double assimpMs = 0.0;
+  for (unsigned int i = 0; i < ITERATIONS; i++)
+  {
+    importer.ReadFile(path, BASE_FLAGS);
+    auto start = chrono::steady_clock::now();
+    scene = importer.ApplyPostProcessing(aiProcess_CalcTangentSpace);
+    assimpMs += elapsedMs(start);
+  }
+  assimpMs /= ITERATIONS;
+
+  // 与 assimp 结果的一致性：切线方向夹角的余弦平均值
+  double cosineSum = 0.0;
+  size_t compared = 0;
+  unsigned int meshIndex = 0;
+  for (unsigned int m = 0; m < scene->mNumMeshes; m++)
+  {
+    const aiMesh *mesh = scene->mMeshes[m];
+    if (!mesh->mTextureCoords[0])
+      continue;
+    const MeshData &ours = meshes[meshIndex++];
+    if (!mesh->HasTangentsAndBitangents())
+      continue;
+    for (unsigned int i = 0; i < mesh->mNumVertices; i++)
+    {
+      glm::vec3 theirs(mesh->mTangents[i].x, mesh->mTangents[i].y, mesh->mTangents[i].z);
+      float length = glm::length(theirs);
+      if (length == 0.0f || glm::any(glm::isnan(theirs)))
+        continue;
+      cosineSum += glm::dot(ours.vertices[i].Tangent, theirs / length);
+      compared++;
+    }
+  }
+
+  cout << path << ": " << meshes.size() << " meshes, " << vertexCount << " vertices, " << triangleCount << " triangles" << endl;
+  cout << "  aiProcess_CalcTangentSpace:   " << assimpMs << " ms" << endl;
+  cout << "  generateTangents (1 thread):  " << singleMs << " ms" << endl;
+  cout << "  generateTangents (" << Parallel::workerCount() << " threads): " << parallelMs << " ms" << endl;
+  cout << "  mean cos(angle) vs assimp:    " << (compared > 0 ? cosineSum / compared : 0.0) << endl;
+}
+
+void benchmarkSphere(unsigned int segments)
+{
+  SphereGeometry sphere(1.0f, segments, segments);
+  vector<MeshData> meshes(1);
+  meshes[0].vertices = sphere.vertices;
+  meshes[0].indices = sphere.indices;
+
+  double singleMs = timeGenerate(meshes, 1);
+  double parallelMs = timeGenerate(meshes, 0);
+  cout << "SphereGeometry " << segments << "x" << segments << ": " << sphere.vertices.size() << " vertices" << endl;
+  cout << "  generateTangents (1 thread):  " << singleMs << " ms" << endl;
+  cout << "  generateTangents (" << Parallel::workerCount() << " threads): " << parallelMs << " ms" << endl;
+  sphere.dispose();
+}
+
+int main(int argc, char *argv[])
+{
+  glfwInit();
+  glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+  glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+  glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+  // SphereGeometry 构造时会上传缓冲，需要一个上下文，不需要显示窗口
+  glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+
+  GLFWwindow *window = glfwCreateWindow(64, 64, "tangents", NULL, NULL);
+  if (window == NULL)
+  {
+    std::cout << "Failed to create GLFW window" << std::endl;
+    glfwTerminate();
+    return -1;
+  }
+  glfwMakeContextCurrent(window);
+
+  if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
+  {
+    std::cout << "Failed to initialize GLAD" << std::endl;
+    return -1;
+  }
+
+  benchmarkSphere(64);
+  benchmarkSphere(256);
+  benchmarkSphere(1024);
+
+  // 第二个参数可以指定其他模型
+  benchmarkModel(argc > 2 ? argv[2] : "./static/model/cerberus/Cerberus.obj");
+
+  glfwTerminate();
+
+  return 0;
+}
@@ -0,0 +1,107 @@
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include <iostream>
+#include <vector>
+#include <string>
+
+#include <tool/shader.h>
+
+#define STB_IMAGE_IMPLEMENTATION
+#include <tool/stb_image.h>
+
+#include <tool/mesh.h>
+#include <tool/model.h>
+
+std::string Shader::dirName;
+
+// 模型加载的墙钟时间随解码线程数的变化
+// 网格走 MeshCache，主要耗时在贴图的解码和上传
+const unsigned int ITERATIONS = 3;
+
+using namespace std;
+
+struct LoadResult
+{
+  double loadMs = 0.0;
+  double textureMs = 0.0;
+  size_t textureCount = 0;
+};
+
+LoadResult load(const string &path, unsigned int threads)
+{
+  Parallel::threadCount = threads;
+  LoadResult result;
+  for (unsigned int i = 0; i < ITERATIONS; i++)
+  {
+    Model model(path);
+    result.loadMs += model.loadMs;
+    result.textureMs += model.textureMs;
+    result.textureCount = model.textures_loaded.size();
+    for (Mesh &mesh : model.meshes)
+      mesh.dispose();
+  }
+  Parallel::threadCount = 0;
+  result.loadMs /= ITERATIONS;
+  result.textureMs /= ITERATIONS;
+  return result;
+}
+
+void benchmarkModel(const string &path)
+{
+  // 预热：生成网格缓存，并让图片文件进入系统的文件缓存
+  load(path, 0);
+
+  unsigned int hardware = Parallel::workerCount();
+  vector<unsigned int> threadCounts;
+  for (unsigned int threads = 1; threads < hardware; threads *= 2)
+    threadCounts.push_back(threads);
+  threadCounts.push_back(hardware);
+
+  double baseline = 0.0;
+  for (unsigned int threads : threadCounts)
+  {
+    LoadResult result = load(path, threads);
+    if (threads == 1)
+    {
+      baseline = result.loadMs;
+      cout << path << ": " << result.textureCount << " textures" << endl;
+    }
+    cout << "  " << threads << (threads == 1 ? " thread:  " : " threads: ") << result.loadMs << " ms (textures " << result.textureMs << " ms)";
+    if (result.loadMs > 0.0)
+      cout << ", " << baseline / result.loadMs << "x";
+    cout << endl;
+  }
+}
+
+int main(int argc, char *argv[])
+{
+  Shader::dirName = argv[1];
+  glfwInit();
+  glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+  glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+  glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+  // 上传贴图需要一个上下文，不需要显示窗口
+  glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+
+  GLFWwindow *window = glfwCreateWindow(64, 64, "texture_decode", NULL, NULL);
+  if (window == NULL)
+  {
+    std::cout << "Failed to create GLFW window" << std::endl;
+    glfwTerminate();
+    return -1;
+  }
+  glfwMakeContextCurrent(window);
+
+  if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
+  {
+    std::cout << "Failed to initialize GLAD" << std::endl;
+    return -1;
+  }
+
+  // 第二个参数可以指定其他模型
+  benchmarkModel(argc > 2 ? argv[2] : "./static/model/nanosuit/nanosuit.obj");
+
+  glfwTerminate();
+
+  return 0;
+}
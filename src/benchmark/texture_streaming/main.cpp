@@ -0,0 +1,170 @@
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include <iostream>
+#include <fstream>
+#include <filesystem>
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <vector>
+#include <string>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#define STB_IMAGE_IMPLEMENTATION
+#include <tool/stb_image.h>
+#include <tool/texture_cache.h>
+#include <tool/texture_streamer.h>
+
+// 相机沿一排物体飞过时流式纹理的显存占用
+// 每个物体使用一组贴图（Cerberus 的 5 张 2K 贴图或 MuddySand2 的 3 张），每帧按包围球的屏幕尺寸请求级别。
+// 物体每 4 个换一组贴图，相机附近的物体需要精细的级别，远处的只需要低精度级别
+using namespace std;
+
+const int FRAMES = 600;
+const int OBJECTS = 16;
+const float SPACING = 6.0f;
+const float VIEWPORT_HEIGHT = 720.0f;
+
+const vector<vector<string>> MATERIALS = {
+    {"./static/model/cerberus/Cerberus_A.jpg", "./static/model/cerberus/Cerberus_N.jpg", "./static/model/cerberus/Cerberus_M.jpg",
+     "./static/model/cerberus/Cerberus_R.jpg", "./static/model/cerberus/Cerberus_RM.jpg"},
+    {"./static/texture/TexturesCom_MuddySand2_2x2_2K_albedo.png", "./static/texture/TexturesCom_MuddySand2_2x2_2K_normal.png",
+     "./static/texture/TexturesCom_MuddySand2_2x2_2K_height.png"}};
+
+struct FrameSample
+{
+  double residentMB = 0.0;
+  double uploadedKB = 0.0;
+  double updateMs = 0.0;
+  unsigned int deferred = 0;
+};
+
+// 每个物体一组贴图；同一张图片用不同的采样参数加载成独立的纹理，避免内容去重后只剩两组
+vector<vector<unsigned int>> loadMaterials(bool stream)
+{
+  vector<vector<unsigned int>> objects;
+  for (int i = 0; i < OBJECTS; i++)
+  {
+    TextureParams params;
+    params.stream = stream;
+    params.wrap = i % 4 < 2 ? GL_REPEAT : GL_MIRRORED_REPEAT; // 参数不同的纹理是独立的缓存项
+    params.magFilter = i % 2 == 0 ? GL_LINEAR : GL_NEAREST;
+    vector<unsigned int> textures;
+    for (const string &path : MATERIALS[(i / 4) % MATERIALS.size()])
+      textures.push_back(TextureCache::load(path, params));
+    objects.push_back(textures);
+  }
+  return objects;
+}
+
+void releaseMaterials(const vector<vector<unsigned int>> &objects)
+{
+  for (const vector<unsigned int> &textures : objects)
+    for (unsigned int id : textures)
+      TextureCache::release(id);
+}
+
+vector<FrameSample> flyThrough(const vector<vector<unsigned int>> &objects)
+{
+  glm::mat4 projection = glm::perspective(glm::radians(45.0f), 16.0f / 9.0f, 0.1f, 200.0f);
+  vector<FrameSample> samples;
+  for (int frame = 0; frame < FRAMES; frame++)
+  {
+    // 从第一个物体前飞到最后一个物体后
+    float z = -SPACING + (OBJECTS + 1) * SPACING * frame / (FRAMES - 1);
+    glm::mat4 view = glm::lookAt(glm::vec3(2.0f, 0.0f, z), glm::vec3(2.0f, 0.0f, z + 10.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+    for (int i = 0; i < OBJECTS; i++)
+    {
+      glm::vec3 center(0.0f, 0.0f, i * SPACING);
+      if ((view * glm::vec4(center, 1.0f)).z > 1.0f) // 在相机后面，不绘制
+        continue;
+      float screenSize = TextureStreamer::screenSize(center, 1.0f, view, projection, VIEWPORT_HEIGHT);
+      for (unsigned int id : objects[i])
+        TextureStreamer::requestScreenSize(id, screenSize);
+    }
+
+    auto start = chrono::steady_clock::now();
+    TextureStreamer::update();
+    glFinish();
+    FrameSample sample;
+    sample.updateMs = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+    sample.residentMB = TextureStreamer::stats.residentBytes / (1024.0 * 1024.0);
+    sample.uploadedKB = TextureStreamer::lastFrame.uploadedBytes / 1024.0;
+    sample.deferred = TextureStreamer::lastFrame.deferred;
+    samples.push_back(sample);
+  }
+  return samples;
+}
+
+int main(int argc, char *argv[])
+{
+  glfwInit();
+  glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+  glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+  glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+  glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+
+  GLFWwindow *window = glfwCreateWindow(64, 64, "texture_streaming", NULL, NULL);
+  if (window == NULL)
+  {
+    std::cout << "Failed to create GLFW window" << std::endl;
+    glfwTerminate();
+    return -1;
+  }
+  glfwMakeContextCurrent(window);
+
+  if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
+  {
+    std::cout << "Failed to initialize GLAD" << std::endl;
+    return -1;
+  }
+
+  // 第二个参数可以指定预算（MB）
+  TextureStreamer::budgetBytes = (size_t)(argc > 2 ? atoi(argv[2]) : 64) * 1024 * 1024;
+  const double MB = 1024.0 * 1024.0;
+
+  // 全部常驻：每个纹理的所有级别
+  auto start = chrono::steady_clock::now();
+  vector<vector<unsigned int>> resident = loadMaterials(false);
+  glFinish();
+  double residentLoadMs = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+  double residentMB = TextureCache::byteCount() / MB;
+  size_t textureCount = TextureCache::textureCount();
+  releaseMaterials(resident);
+
+  start = chrono::steady_clock::now();
+  vector<vector<unsigned int>> streamed = loadMaterials(true);
+  glFinish();
+  double streamedLoadMs = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+  double initialMB = TextureStreamer::stats.residentBytes / MB;
+  vector<FrameSample> samples = flyThrough(streamed);
+
+  double peakMB = 0.0, totalKB = 0.0, maxUpdateMs = 0.0;
+  unsigned int deferredFrames = 0;
+  for (const FrameSample &sample : samples)
+  {
+    peakMB = max(peakMB, sample.residentMB);
+    totalKB += sample.uploadedKB;
+    maxUpdateMs = max(maxUpdateMs, sample.updateMs);
+    deferredFrames += sample.deferred > 0;
+  }
+
+  cout << textureCount << " textures on " << OBJECTS << " objects, " << FRAMES << " frames, budget " << TextureStreamer::budgetBytes / MB << " MB" << endl;
+  cout << "  fully resident: " << residentMB << " MB, load " << residentLoadMs << " ms" << endl;
+  cout << "  streamed:       initial " << initialMB << " MB, peak " << peakMB << " MB, load " << streamedLoadMs << " ms" << endl;
+  cout << "  streamed in " << totalKB / 1024.0 << " MB over the fly-through, max update " << maxUpdateMs
+       << " ms, frames with deferred levels: " << deferredFrames << endl;
+
+  filesystem::create_directories("./output");
+  ofstream trace("./output/texture_streaming.csv");
+  trace << "frame,resident_mb,uploaded_kb,update_ms,deferred" << endl;
+  for (size_t i = 0; i < samples.size(); i++)
+    trace << i << "," << samples[i].residentMB << "," << samples[i].uploadedKB << "," << samples[i].updateMs << "," << samples[i].deferred << endl;
+  cout << "  frame trace: ./output/texture_streaming.csv" << endl;
+
+  releaseMaterials(streamed);
+  glfwTerminate();
+  return 0;
+}
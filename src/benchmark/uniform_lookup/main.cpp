@@ -0,0 +1,144 @@
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include <iostream>
+#include <chrono>
+#include <vector>
+
+#include <tool/shader.h>
+
+std::string Shader::dirName;
+
+// 每次迭代模拟一帧：4 个点光源 * 7 个属性 + 64 个 SSAO 采样
+const unsigned int FRAMES = 2000;
+const unsigned int NR_POINT_LIGHTS = 4;
+const unsigned int NR_SAMPLES = 64;
+
+using namespace std;
+
+struct PointLightUniforms
+{
+  Uniform<glm::vec3> position, ambient, diffuse, specular;
+  Uniform<float> constant, linear, quadratic;
+};
+
+double elapsedMs(chrono::steady_clock::time_point start)
+{
+  return chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+}
+
+int main(int argc, char *argv[])
+{
+  Shader::dirName = argv[1];
+  glfwInit();
+  glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+  glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+  glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+  // 不需要显示窗口，只需要一个上下文
+  glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+
+  GLFWwindow *window = glfwCreateWindow(64, 64, "uniform_lookup", NULL, NULL);
+  if (window == NULL)
+  {
+    std::cout << "Failed to create GLFW window" << std::endl;
+    glfwTerminate();
+    return -1;
+  }
+  glfwMakeContextCurrent(window);
+
+  if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
+  {
+    std::cout << "Failed to initialize GLAD" << std::endl;
+    return -1;
+  }
+
+  Shader sceneShader("./shader/scene_vert.glsl", "./shader/scene_frag.glsl");
+  sceneShader.use();
+
+  vector<glm::vec3> samples(NR_SAMPLES, glm::vec3(0.1f, 0.2f, 0.3f));
+  glm::vec3 lightPosition = glm::vec3(1.0f, 2.0f, 3.0f);
+
+  // 1. 旧路径：每帧拼接字符串 + glGetUniformLocation
+  // ----------------------------------------------------
+  auto start = chrono::steady_clock::now();
+  for (unsigned int frame = 0; frame < FRAMES; frame++)
+  {
+    for (unsigned int i = 0; i < NR_POINT_LIGHTS; i++)
+    {
+      glUniform3fv(glGetUniformLocation(sceneShader.ID, ("pointLights[" + std::to_string(i) + "].position").c_str()), 1, &lightPosition[0]);
+      glUniform3f(glGetUniformLocation(sceneShader.ID, ("pointLights[" + std::to_string(i) + "].ambient").c_str()), 0.01f, 0.01f, 0.01f);
+      glUniform3f(glGetUniformLocation(sceneShader.ID, ("pointLights[" + std::to_string(i) + "].diffuse").c_str()), 1.0f, 0.0f, 0.0f);
+      glUniform3f(glGetUniformLocation(sceneShader.ID, ("pointLights[" + std::to_string(i) + "].specular").c_str()), 1.0f, 1.0f, 1.0f);
+      glUniform1f(glGetUniformLocation(sceneShader.ID, ("pointLights[" + std::to_string(i) + "].constant").c_str()), 1.0f);
+      glUniform1f(glGetUniformLocation(sceneShader.ID, ("pointLights[" + std::to_string(i) + "].linear").c_str()), 0.09f);
+      glUniform1f(glGetUniformLocation(sceneShader.ID, ("pointLights[" + std::to_string(i) + "].quadratic").c_str()), 0.032f);
+    }
+    for (unsigned int i = 0; i < NR_SAMPLES; i++)
+      glUniform3fv(glGetUniformLocation(sceneShader.ID, ("samples[" + std::to_string(i) + "]").c_str()), 1, &samples[i][0]);
+  }
+  glFinish();
+  double driverLookupMs = elapsedMs(start);
+
+  // 2. 按名字设置，但位置来自链接时反射出的哈希表
+  // ----------------------------------------------------
+  start = chrono::steady_clock::now();
+  for (unsigned int frame = 0; frame < FRAMES; frame++)
+  {
+    for (unsigned int i = 0; i < NR_POINT_LIGHTS; i++)
+    {
+      sceneShader.setVec3("pointLights[" + std::to_string(i) + "].position", lightPosition);
+      sceneShader.setVec3("pointLights[" + std::to_string(i) + "].ambient", 0.01f, 0.01f, 0.01f);
+      sceneShader.setVec3("pointLights[" + std::to_string(i) + "].diffuse", 1.0f, 0.0f, 0.0f);
+      sceneShader.setVec3("pointLights[" + std::to_string(i) + "].specular", 1.0f, 1.0f, 1.0f);
+      sceneShader.setFloat("pointLights[" + std::to_string(i) + "].constant", 1.0f);
+      sceneShader.setFloat("pointLights[" + std::to_string(i) + "].linear", 0.09f);
+      sceneShader.setFloat("pointLights[" + std::to_string(i) + "].quadratic", 0.032f);
+    }
+    for (unsigned int i = 0; i < NR_SAMPLES; i++)
+      sceneShader.setVec3("samples[" + std::to_string(i) + "]", samples[i]);
+  }
+  glFinish();
+  double hashedLookupMs = elapsedMs(start);
+
+  // 3. 类型化句柄：初始化时解析，循环中零分配
+  // ----------------------------------------------------
+  PointLightUniforms pointLights[NR_POINT_LIGHTS];
+  for (unsigned int i = 0; i < NR_POINT_LIGHTS; i++)
+  {
+    std::string prefix = "pointLights[" + std::to_string(i) + "].";
+    pointLights[i].position = sceneShader.uniform<glm::vec3>(prefix + "position");
+    pointLights[i].ambient = sceneShader.uniform<glm::vec3>(prefix + "ambient");
+    pointLights[i].diffuse = sceneShader.uniform<glm::vec3>(prefix + "diffuse");
+    pointLights[i].specular = sceneShader.uniform<glm::vec3>(prefix + "specular");
+    pointLights[i].constant = sceneShader.uniform<float>(prefix + "constant");
+    pointLights[i].linear = sceneShader.uniform<float>(prefix + "linear");
+    pointLights[i].quadratic = sceneShader.uniform<float>(prefix + "quadratic");
+  }
+  Uniform<glm::vec3> samplesUniform = sceneShader.uniform<glm::vec3>("samples");
+
+  start = chrono::steady_clock::now();
+  for (unsigned int frame = 0; frame < FRAMES; frame++)
+  {
+    for (unsigned int i = 0; i < NR_POINT_LIGHTS; i++)
+    {
+      sceneShader.set(pointLights[i].position, lightPosition);
+      sceneShader.set(pointLights[i].ambient, glm::vec3(0.01f, 0.01f, 0.01f));
+      sceneShader.set(pointLights[i].diffuse, glm::vec3(1.0f, 0.0f, 0.0f));
+      sceneShader.set(pointLights[i].specular, glm::vec3(1.0f, 1.0f, 1.0f));
+      sceneShader.set(pointLights[i].constant, 1.0f);
+      sceneShader.set(pointLights[i].linear, 0.09f);
+      sceneShader.set(pointLights[i].quadratic, 0.032f);
+    }
+    sceneShader.setArray(samplesUniform, &samples[0], (GLsizei)samples.size());
+  }
+  glFinish();
+  double handleMs = elapsedMs(start);
+
+  std::cout << "frames: " << FRAMES << std::endl;
+  std::cout << "string + glGetUniformLocation: " << driverLookupMs << " ms (" << driverLookupMs * 1000.0 / FRAMES << " us/frame)" << std::endl;
+  std::cout << "string + cached location:      " << hashedLookupMs << " ms (" << hashedLookupMs * 1000.0 / FRAMES << " us/frame)" << std::endl;
+  std::cout << "typed handle:                  " << handleMs << " ms (" << handleMs * 1000.0 / FRAMES << " us/frame)" << std::endl;
+
+  glfwTerminate();
+
+  return 0;
+}
@@ -0,0 +1,33 @@
+#version 330 core
+out vec4 FragColor;
+
+// 与 CGfinal 相同的点光源结构
+struct PointLight {
+  vec3 position;
+
+  float constant;
+  float linear;
+  float quadratic;
+
+  vec3 ambient;
+  vec3 diffuse;
+  vec3 specular;
+};
+
+#define NR_POINT_LIGHTS 4
+
+uniform PointLight pointLights[NR_POINT_LIGHTS];
+uniform vec3 samples[64];
+
+void main() {
+  vec3 result = vec3(0.0);
+  for(int i = 0; i < NR_POINT_LIGHTS; i++) {
+    PointLight light = pointLights[i];
+    result += (light.ambient + light.diffuse + light.specular) * light.position /
+      (light.constant + light.linear + light.quadratic);
+  }
+  for(int i = 0; i < 64; i++) {
+    result += samples[i];
+  }
+  FragColor = vec4(result, 1.0);
+}
@@ -0,0 +1,188 @@
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include <iostream>
+#include <fstream>
+#include <filesystem>
+#include <algorithm>
+#include <chrono>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <string>
+
+#include <tool/shader.h>
+
+#define STB_IMAGE_IMPLEMENTATION
+#include <tool/stb_image.h>
+#include <tool/texture_cache.h>
+#include <tool/upload_scheduler.h>
+
+#include <tool/mesh.h>
+#include <tool/model.h>
+#include <tool/model_handle.h>
+
+std::string Shader::dirName;
+
+// 运行中途加载资源时的逐帧耗时
+// 第 STREAM_FRAME 帧开始在后台加载 nanosuit 和三张 2K 的 MuddySand2 贴图，解码都在工作线程上，
+// 渲染线程只负责上传。同步上传和 UploadScheduler 分帧上传各跑一遍，每帧以 glFinish 结束，
+// 帧时间包括 GPU 完成上传的时间
+using namespace std;
+
+const int FRAMES = 300;
+const int STREAM_FRAME = 30;
+
+const char *SAND_TEXTURES[] = {
+    "./static/texture/TexturesCom_MuddySand2_2x2_2K_albedo.png",
+    "./static/texture/TexturesCom_MuddySand2_2x2_2K_normal.png",
+    "./static/texture/TexturesCom_MuddySand2_2x2_2K_height.png"};
+
+struct DecodedTexture
+{
+  string key;
+  TextureImage image;
+};
+
+// 一次运行，返回每帧的毫秒数
+vector<double> runSession(GLFWwindow *window, const string &modelPath, bool scheduled)
+{
+  UploadScheduler::enabled = scheduled;
+  TextureParams params;
+
+  mutex lock;
+  deque<DecodedTexture> decoded;
+  thread decoder;
+  ModelHandle *model = nullptr;
+  vector<unsigned int> sand;
+  vector<double> frames;
+
+  for (int frame = 0; frame < FRAMES; frame++)
+  {
+    auto start = chrono::steady_clock::now();
+
+    if (frame == STREAM_FRAME)
+    {
+      model = new ModelHandle(modelPath);
+      decoder = thread([&]()
+                       {
+                         for (const char *path : SAND_TEXTURES)
+                         {
+                           DecodedTexture texture;
+                           texture.key = TextureCache::key(path, params);
+                           texture.image = TextureCache::decode(path, params);
+                           lock_guard<mutex> guard(lock);
+                           decoded.push_back(std::move(texture));
+                         } });
+    }
+
+    if (model != nullptr)
+      model->update();
+    {
+      lock_guard<mutex> guard(lock);
+      while (!decoded.empty())
+      {
+        DecodedTexture &texture = decoded.front();
+        unsigned int id = TextureCache::acquire(texture.key);
+        if (id == 0)
+          id = TextureCache::insert(texture.key, params, texture.image);
+        else
+          stbi_image_free(texture.image.data);
+        sand.push_back(id);
+        decoded.pop_front();
+      }
+    }
+    UploadScheduler::flush();
+
+    glClearColor(0.1f, 0.1f, 0.1f, 1.0f);
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    glfwSwapBuffers(window);
+    glFinish();
+
+    frames.push_back(chrono::duration<double, milli>(chrono::steady_clock::now() - start).count());
+  }
+
+  // 帧数不够时把剩下的上传做完，保证下一轮从同样的状态开始
+  if (decoder.joinable())
+    decoder.join();
+  while (model != nullptr && !model->ready())
+    model->update(1e9);
+  UploadScheduler::finish();
+  if (sand.size() < 3 || (model != nullptr && !model->ready()))
+    cout << "  warning: streaming did not finish within " << FRAMES << " frames" << endl;
+
+  for (unsigned int id : sand)
+    TextureCache::release(id);
+  delete model;
+  glFinish();
+  return frames;
+}
+
+void report(const char *name, vector<double> frames)
+{
+  double total = 0.0;
+  int over = 0;
+  for (double ms : frames)
+  {
+    total += ms;
+    if (ms > 1000.0 / 60.0)
+      over++;
+  }
+  sort(frames.begin(), frames.end());
+  double p99 = frames[(size_t)(frames.size() * 0.99)];
+  cout << "  " << name << "mean " << total / frames.size() << " ms, p99 " << p99 << " ms, max " << frames.back()
+       << " ms, frames over 16.7 ms: " << over << endl;
+}
+
+int main(int argc, char *argv[])
+{
+  Shader::dirName = argv[1];
+  glfwInit();
+  glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+  glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+  glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+  glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+
+  GLFWwindow *window = glfwCreateWindow(1280, 720, "upload_stream", NULL, NULL);
+  if (window == NULL)
+  {
+    std::cout << "Failed to create GLFW window" << std::endl;
+    glfwTerminate();
+    return -1;
+  }
+  glfwMakeContextCurrent(window);
+  glfwSwapInterval(0);
+
+  if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
+  {
+    std::cout << "Failed to initialize GLAD" << std::endl;
+    return -1;
+  }
+  glEnable(GL_DEPTH_TEST);
+
+  // 第二个参数可以指定其他模型
+  string modelPath = argc > 2 ? argv[2] : "./static/model/nanosuit/nanosuit.obj";
+  cout << modelPath << " + MuddySand2 2K x3, " << FRAMES << " frames, streaming from frame " << STREAM_FRAME << endl;
+  cout << "  persistent mapping: " << (UploadScheduler::persistentMapping() ? "yes" : "no") << ", budget "
+       << UploadScheduler::bytesPerFrame / (1024 * 1024) << " MB / " << UploadScheduler::msPerFrame << " ms per frame" << endl;
+
+  // 预热：生成网格缓存，让文件进入系统的文件缓存
+  runSession(window, modelPath, false);
+
+  vector<double> sync = runSession(window, modelPath, false);
+  vector<double> streamed = runSession(window, modelPath, true);
+  report("sync:      ", sync);
+  report("scheduled: ", streamed);
+
+  filesystem::create_directories("./output");
+  ofstream trace("./output/upload_stream.csv");
+  trace << "frame,sync_ms,scheduled_ms" << endl;
+  for (int i = 0; i < FRAMES; i++)
+    trace << i << "," << sync[i] << "," << streamed[i] << endl;
+  cout << "  frame trace: ./output/upload_stream.csv" << endl;
+
+  UploadScheduler::dispose();
+  glfwTerminate();
+
+  return 0;
+}
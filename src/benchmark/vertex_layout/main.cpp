@@ -0,0 +1,140 @@
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include <iostream>
+#include <vector>
+#include <string>
+
+#include <tool/shader.h>
+#include <geometry/SphereGeometry.h>
+
+#define STB_IMAGE_IMPLEMENTATION
+#include <tool/stb_image.h>
+
+#include <tool/mesh.h>
+#include <tool/model.h>
+
+std::string Shader::dirName;
+
+// 对比标准（56 字节）与压缩（24 字节）顶点布局的显存占用和顶点读取耗时
+// 打开 GL_RASTERIZER_DISCARD，只测顶点阶段
+const unsigned int DRAWS = 200;
+
+using namespace std;
+
+struct LayoutResult
+{
+  size_t vertexBytes = 0;
+  size_t indexBytes = 0;
+  size_t vertexCount = 0;
+  double gpuMs = 0.0;
+};
+
+// 每个网格绘制 DRAWS 次，用 GL_TIME_ELAPSED 查询 GPU 耗时
+double timeDraws(const vector<const GeometryHandle *> &meshes, Shader &shader)
+{
+  shader.use();
+  unsigned int query;
+  glGenQueries(1, &query);
+  glFinish();
+  glBeginQuery(GL_TIME_ELAPSED, query);
+  for (unsigned int i = 0; i < DRAWS; i++)
+    for (const GeometryHandle *mesh : meshes)
+      drawMesh(*mesh);
+  glEndQuery(GL_TIME_ELAPSED);
+  GLuint64 elapsed = 0;
+  glGetQueryObjectui64v(query, GL_QUERY_RESULT, &elapsed);
+  glDeleteQueries(1, &query);
+  return elapsed / 1.0e6;
+}
+
+LayoutResult measureModel(const string &path, const VertexLayout &layout, Shader &shader)
+{
+  GeometryHandle::defaultLayout = layout;
+  Model model(path);
+  GeometryHandle::defaultLayout = VertexLayout::standard();
+
+  LayoutResult result;
+  vector<const GeometryHandle *> meshes;
+  for (const Mesh &mesh : model.meshes)
+  {
+    result.vertexBytes += mesh.vertexBytes;
+    result.indexBytes += mesh.indexBytes;
+    result.vertexCount += mesh.vertices.size();
+    meshes.push_back(&mesh);
+  }
+  timeDraws(meshes, shader); // 预热
+  result.gpuMs = timeDraws(meshes, shader);
+  for (Mesh &mesh : model.meshes)
+    mesh.dispose();
+  return result;
+}
+
+LayoutResult measureSphere(unsigned int segments, const VertexLayout &layout, Shader &shader)
+{
+  GeometryHandle::defaultLayout = layout;
+  SphereGeometry sphere(1.0f, segments, segments);
+  GeometryHandle::defaultLayout = VertexLayout::standard();
+
+  LayoutResult result;
+  result.vertexBytes = sphere.vertexBytes;
+  result.indexBytes = sphere.indexBytes;
+  result.vertexCount = sphere.vertices.size();
+  timeDraws({&sphere}, shader);
+  result.gpuMs = timeDraws({&sphere}, shader);
+  sphere.dispose();
+  return result;
+}
+
+void report(const string &name, const LayoutResult &standard, const LayoutResult &compact)
+{
+  cout << name << ": " << standard.vertexCount << " vertices" << endl;
+  cout << "  standard: vertex " << standard.vertexBytes << " B, index " << standard.indexBytes << " B, "
+       << standard.gpuMs << " ms / " << DRAWS << " draws" << endl;
+  cout << "  compact:  vertex " << compact.vertexBytes << " B, index " << compact.indexBytes << " B, "
+       << compact.gpuMs << " ms / " << DRAWS << " draws" << endl;
+  size_t before = standard.vertexBytes + standard.indexBytes;
+  size_t after = compact.vertexBytes + compact.indexBytes;
+  cout << "  total bytes: " << (before > 0 ? 100.0 * after / before : 0.0) << "% of standard" << endl;
+}
+
+int main(int argc, char *argv[])
+{
+  Shader::dirName = argv[1];
+  glfwInit();
+  glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+  glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+  glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+  // 不需要显示窗口，只需要一个上下文
+  glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+
+  GLFWwindow *window = glfwCreateWindow(64, 64, "vertex_layout", NULL, NULL);
+  if (window == NULL)
+  {
+    std::cout << "Failed to create GLFW window" << std::endl;
+    glfwTerminate();
+    return -1;
+  }
+  glfwMakeContextCurrent(window);
+
+  if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
+  {
+    std::cout << "Failed to initialize GLAD" << std::endl;
+    return -1;
+  }
+
+  Shader fetchShader("./shader/fetch_vert.glsl", "./shader/fetch_frag.glsl");
+  glEnable(GL_RASTERIZER_DISCARD);
+
+  cout << "stride: standard " << VertexLayout::standard().stride() << " B, compact " << VertexLayout::compact().stride() << " B" << endl;
+  cout << "immutable storage: " << (GeometryHandle::immutableStorage() ? "yes" : "no (glBufferData)") << endl;
+
+  const char *models[] = {"./static/model/rock/rock.obj", "./static/model/cerberus/Cerberus.obj"};
+  for (const char *path : models)
+    report(path, measureModel(path, VertexLayout::standard(), fetchShader), measureModel(path, VertexLayout::compact(), fetchShader));
+
+  report("SphereGeometry 256x256", measureSphere(256, VertexLayout::standard(), fetchShader), measureSphere(256, VertexLayout::compact(), fetchShader));
+
+  glfwTerminate();
+
+  return 0;
+}
@@ -0,0 +1,12 @@
+#version 330 core
+layout(location = 0) in vec3 Position;
+layout(location = 1) in vec3 Normal;
+layout(location = 2) in vec2 TexCoords;
+layout(location = 3) in vec3 Tangent;
+layout(location = 4) in vec3 Bitangent;
+
+// 读取全部属性，避免被编译器优化掉
+void main() {
+  vec3 offset = (Normal + Tangent + Bitangent + vec3(TexCoords, 0.0)) * 0.001;
+  gl_Position = vec4(Position + offset, 1.0);
+}
@@ -0,0 +1,292 @@
+#include <iostream>
+#include <filesystem>
+#include <algorithm>
+#include <chrono>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+#define STB_IMAGE_IMPLEMENTATION
+#include <tool/stb_image.h>
+#include <tool/block_compress.h>
+#include <tool/ktx.h>
+#include <tool/mip_generator.h>
+#include <tool/texture_cache.h>
+
+// 离线贴图烘焙：把 static 下的 PNG/JPG 压缩成带完整 mipmap 的 BCn KTX
+// 输出到 TextureCache::cookedPath() 指定的位置，运行时 TextureCache 自动使用
+// 2D 贴图按翻转和不翻转各烘焙一份（TextureParams::flip 两种取值的加载都能命中），例如 Model 默认不翻转
+//
+// 按文件名和内容选择格式：
+//   法线贴图（*normal*、*_ddn*、*_nrm*）  -> BC5，只保留 xy
+//   单通道或高度/AO/粗糙度/金属度贴图      -> BC4
+//   带透明度的颜色贴图                    -> BC7
+//   其他颜色贴图                          -> BC1
+// 同一目录下的六个立方体贴图面（px/nx/py/ny/pz/nz 或 right/left/top/bottom/front/back）
+// 合成一个六个面的 KTX（TextureCache::cookedCubemapPath()），不再单独烘焙
+using namespace std;
+
+struct CookStats
+{
+  size_t files = 0;
+  size_t upToDate = 0;
+  size_t failed = 0;
+  size_t sourceBytes = 0;
+  size_t cookedBytes = 0;
+  size_t rawBytes = 0; // 本次新烘焙的贴图不压缩上传时的显存占用（含 mipmap）
+  size_t newBytes = 0; // 本次新烘焙的贴图压缩后的显存占用
+};
+
+bool contains(const string &name, const char *part)
+{
+  return name.find(part) != string::npos;
+}
+
+bool isNormalMap(const string &name)
+{
+  return contains(name, "normal") || contains(name, "_ddn") || contains(name, "_nrm");
+}
+
+BlockFormat chooseFormat(const string &path, int channels, const unsigned char *rgba, int width, int height)
+{
+  string name = filesystem::path(path).filename().string();
+  transform(name.begin(), name.end(), name.begin(), ::tolower);
+  if (isNormalMap(name))
+    return BlockFormat::BC5;
+  if (channels <= 2 || contains(name, "height") || contains(name, "disp") || contains(name, "_ao") || contains(name, "roughness") ||
+      contains(name, "metallic"))
+    return BlockFormat::BC4;
+  if (channels == 4)
+    for (size_t i = 0; i < (size_t)width * height; i++)
+      if (rgba[i * 4 + 3] != 255)
+        return BlockFormat::BC7;
+  return BlockFormat::BC1;
+}
+
+void cook(const string &path, bool flip, CookStats &stats)
+{
+  auto start = chrono::steady_clock::now();
+  MappedFile file(path);
+  if (!file.valid())
+    return;
+  unsigned long long sourceHash = hashBytes(file.data(), file.size());
+  string output = TextureCache::cookedPath(path, flip);
+  stats.files++;
+  if (flip)
+    stats.sourceBytes += file.size();
+
+  KtxFile existing(output);
+  if (existing.valid() && existing.value("sourceHash") == to_string(sourceHash))
+  {
+    stats.upToDate++;
+    stats.cookedBytes += filesystem::file_size(output);
+    return;
+  }
+
+  int width, height, channels;
+  stbi_set_flip_vertically_on_load(flip);
+  unsigned char *pixels = stbi_load_from_memory(file.data(), (int)file.size(), &width, &height, &channels, 4);
+  if (pixels == nullptr)
+  {
+    cout << "  failed to decode " << path << endl;
+    stats.failed++;
+    return;
+  }
+  BlockFormat format = chooseFormat(path, channels, pixels, width, height);
+
+  // mipmap 与运行时 TextureCache 解码源文件时的结果相同（MipGenerator::guess 选择滤波方式）
+  MipFilter filter = format == BlockFormat::BC5 ? MipFilter::Normal : format == BlockFormat::BC4 ? MipFilter::Linear : MipGenerator::guess(path);
+  vector<MipLevel> mips = MipGenerator::generate(pixels, width, height, 4, filter);
+  vector<vector<unsigned char>> levels;
+  levels.push_back(BlockCompress::compress(format, pixels, width, height));
+  stbi_image_free(pixels);
+  for (const MipLevel &mip : mips)
+    levels.push_back(BlockCompress::compress(format, mip.data.data(), mip.width, mip.height));
+  size_t cookedBytes = 0;
+  for (const vector<unsigned char> &level : levels)
+    cookedBytes += level.size();
+
+  error_code error;
+  filesystem::create_directories(filesystem::path(output).parent_path(), error);
+  map<string, string> keyValues = {{"KTXorientation", TextureCache::orientation(flip)}, {"sourceHash", to_string(sourceHash)}};
+  if (!KtxFile::write(output, BlockCompress::internalFormat(format), BlockCompress::baseFormat(format), width, height, 1, levels, keyValues))
+  {
+    cout << "  failed to write " << output << endl;
+    stats.failed++;
+    return;
+  }
+
+  size_t rawBytes = (size_t)width * height * channels * 4 / 3;
+  stats.rawBytes += rawBytes;
+  stats.newBytes += cookedBytes;
+  stats.cookedBytes += cookedBytes;
+  double ms = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+  cout << "  " << BlockCompress::name(format) << "  " << width << "x" << height << "  " << rawBytes / 1024 << " KB -> "
+       << cookedBytes / 1024 << " KB  " << ms << " ms  " << path << (flip ? "" : " (noflip)") << endl;
+}
+
+// 立方体贴图的面名，顺序为 +X, -X, +Y, -Y, +Z, -Z
+const char *CUBEMAP_NAMES[2][6] = {{"px", "nx", "py", "ny", "pz", "nz"}, {"right", "left", "top", "bottom", "front", "back"}};
+
+// 从文件列表中找出完整的立方体贴图面组，并把它们从列表中移除
+vector<vector<string>> takeCubemaps(vector<string> &files)
+{
+  map<string, map<string, string>> byDirectory; // 目录 -> 小写文件名（不含扩展名）-> 路径
+  for (const string &file : files)
+  {
+    filesystem::path path(file);
+    string stem = path.stem().string();
+    transform(stem.begin(), stem.end(), stem.begin(), ::tolower);
+    byDirectory[path.parent_path().generic_string()][stem] = file;
+  }
+
+  vector<vector<string>> cubemaps;
+  set<string> taken;
+  for (const auto &directory : byDirectory)
+    for (const auto &names : CUBEMAP_NAMES)
+    {
+      vector<string> faces;
+      for (const char *name : names)
+      {
+        auto found = directory.second.find(name);
+        if (found != directory.second.end())
+          faces.push_back(found->second);
+      }
+      if (faces.size() != 6)
+        continue;
+      cubemaps.push_back(faces);
+      taken.insert(faces.begin(), faces.end());
+      break;
+    }
+  files.erase(remove_if(files.begin(), files.end(), [&](const string &file)
+                        { return taken.count(file) != 0; }),
+              files.end());
+  return cubemaps;
+}
+
+// 六个面按 TextureParams::cubemap() 的方向（不翻转）解码，每个面单独生成 mipmap 并压缩
+void cookCubemap(const vector<string> &faces, CookStats &stats)
+{
+  auto start = chrono::steady_clock::now();
+  vector<unsigned long long> hashes;
+  for (const string &face : faces)
+  {
+    MappedFile file(face);
+    if (!file.valid())
+      return;
+    hashes.push_back(hashBytes(file.data(), file.size()));
+    stats.sourceBytes += file.size();
+  }
+  unsigned long long sourceHash = TextureCache::cubemapSourceHash(hashes);
+  string output = TextureCache::cookedCubemapPath(faces);
+  stats.files++;
+
+  KtxFile existing(output);
+  if (existing.valid() && existing.value("sourceHash") == to_string(sourceHash))
+  {
+    stats.upToDate++;
+    stats.cookedBytes += filesystem::file_size(output);
+    return;
+  }
+
+  stbi_set_flip_vertically_on_load(false);
+  int width = 0, height = 0, channels = 0;
+  BlockFormat format = BlockFormat::BC1;
+  vector<vector<vector<unsigned char>>> faceLevels; // 面 -> 级别
+  for (size_t i = 0; i < faces.size(); i++)
+  {
+    int w, h, n;
+    unsigned char *pixels = stbi_load(faces[i].c_str(), &w, &h, &n, 4);
+    if (pixels == nullptr || (i > 0 && (w != width || h != height)))
+    {
+      cout << "  failed to decode or size mismatch " << faces[i] << endl;
+      stbi_image_free(pixels);
+      stats.failed++;
+      return;
+    }
+    if (i == 0)
+    {
+      width = w, height = h, channels = n;
+      format = chooseFormat(faces[i], n, pixels, w, h) == BlockFormat::BC7 ? BlockFormat::BC7 : BlockFormat::BC1;
+    }
+    vector<MipLevel> mips = MipGenerator::generate(pixels, w, h, 4, MipFilter::Srgb);
+    faceLevels.emplace_back();
+    faceLevels.back().push_back(BlockCompress::compress(format, pixels, w, h));
+    stbi_image_free(pixels);
+    for (const MipLevel &mip : mips)
+      faceLevels.back().push_back(BlockCompress::compress(format, mip.data.data(), mip.width, mip.height));
+  }
+
+  // KTX 按级别优先、面在内的顺序存放
+  vector<vector<unsigned char>> images;
+  size_t cookedBytes = 0;
+  for (size_t level = 0; level < faceLevels[0].size(); level++)
+    for (size_t face = 0; face < faceLevels.size(); face++)
+    {
+      cookedBytes += faceLevels[face][level].size();
+      images.push_back(std::move(faceLevels[face][level]));
+    }
+
+  error_code error;
+  filesystem::create_directories(filesystem::path(output).parent_path(), error);
+  map<string, string> keyValues = {{"KTXorientation", TextureCache::orientation(false)}, {"sourceHash", to_string(sourceHash)}};
+  if (!KtxFile::write(output, BlockCompress::internalFormat(format), BlockCompress::baseFormat(format), width, height, 6, images, keyValues))
+  {
+    cout << "  failed to write " << output << endl;
+    stats.failed++;
+    return;
+  }
+
+  size_t rawBytes = (size_t)width * height * channels * 6 * 4 / 3;
+  stats.rawBytes += rawBytes;
+  stats.newBytes += cookedBytes;
+  stats.cookedBytes += cookedBytes;
+  double ms = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+  cout << "  " << BlockCompress::name(format) << "  6x" << width << "x" << height << "  " << rawBytes / 1024 << " KB -> "
+       << cookedBytes / 1024 << " KB  " << ms << " ms  " << filesystem::path(faces[0]).parent_path().generic_string() << " (cubemap)" << endl;
+}
+
+int main(int argc, char *argv[])
+{
+  // 第二个及之后的参数可以指定其他目录
+  vector<string> roots;
+  for (int i = 2; i < argc; i++)
+    roots.push_back(argv[i]);
+  if (roots.empty())
+    roots = {"./static/texture", "./static/model"};
+
+  vector<string> files;
+  for (const string &root : roots)
+  {
+    error_code error;
+    for (auto it = filesystem::recursive_directory_iterator(root, error); !error && it != filesystem::recursive_directory_iterator(); it.increment(error))
+    {
+      if (!it->is_regular_file())
+        continue;
+      string extension = it->path().extension().string();
+      transform(extension.begin(), extension.end(), extension.begin(), ::tolower);
+      if (extension == ".png" || extension == ".jpg" || extension == ".jpeg")
+        files.push_back(it->path().generic_string());
+    }
+  }
+  sort(files.begin(), files.end());
+  vector<vector<string>> cubemaps = takeCubemaps(files);
+
+  cout << "cooking " << files.size() << " textures (flipped and unflipped) and " << cubemaps.size() << " cubemaps into " << TextureCache::cookedDir << endl;
+  CookStats stats;
+  auto start = chrono::steady_clock::now();
+  for (const string &path : files)
+    for (bool flip : {true, false})
+      cook(path, flip, stats);
+  for (const vector<string> &faces : cubemaps)
+    cookCubemap(faces, stats);
+
+  const double MB = 1024.0 * 1024.0;
+  cout << "files: " << stats.files << ", up to date: " << stats.upToDate << ", failed: " << stats.failed << endl;
+  cout << "source: " << stats.sourceBytes / MB << " MB, cooked: " << stats.cookedBytes / MB << " MB";
+  if (stats.rawBytes > 0)
+    cout << ", newly cooked VRAM: " << stats.rawBytes / MB << " MB -> " << stats.newBytes / MB << " MB";
+  cout << ", " << chrono::duration<double>(chrono::steady_clock::now() - start).count() << " s" << endl;
+  return 0;
+}
@@ -0,0 +1,12 @@
+// 每帧常量，由 FrameConstants 每帧上传一次
+layout(std140) uniform FrameConstants {
+  mat4 view;
+  mat4 projection;
+  mat4 viewProj;
+  vec4 cameraPosition; // xyz: 相机位置
+  vec4 frameTime;      // x: 时间, y: 帧间隔
+  vec4 lightDirection; // 平行光
+  vec4 lightAmbient;
+  vec4 lightDiffuse;
+  vec4 lightSpecular;
+};
@@ -0,0 +1,99 @@
+#version 430 core
+// GpuCuller 的剔除：每个线程测试一个实例的包围球，可见的下标追加到 visibleInstances，
+// 并把每个间接绘制命令的 instanceCount 加一
+layout(local_size_x = 64) in;
+
+struct DrawCommand {
+  uint count;
+  uint instanceCount;
+  uint firstIndex;
+  int baseVertex;
+  uint baseInstance;
+};
+
+layout(std430, binding = 0) readonly buffer InstanceSpheres {
+  vec4 spheres[]; // xyz: 世界空间中心, w: 半径
+};
+layout(std430, binding = 1) writeonly buffer VisibleInstances {
+  uint visibleInstances[];
+};
+layout(std430, binding = 2) buffer DrawCommands {
+  DrawCommand commands[];
+};
+
+uniform int instanceCount;
+uniform int commandCount;
+uniform vec4 planes[6];
+uniform vec4 eyeCutoff; // xyz: 相机位置, w: 距离剔除，0 表示不限制
+
+// 上一帧的深度金字塔，每个纹素是覆盖区域内的最大深度
+uniform bool occlusion;
+uniform mat4 previousViewProj;
+uniform sampler2D hiZ;
+uniform int hiZLevels;
+
+bool insideFrustum(vec3 center, float radius) {
+  for (int i = 0; i < 6; i++)
+    if (dot(planes[i].xyz, center) + planes[i].w < -radius)
+      return false;
+  if (eyeCutoff.w > 0.0) {
+    vec3 offset = center - eyeCutoff.xyz;
+    float limit = eyeCutoff.w + radius;
+    if (dot(offset, offset) > limit * limit)
+      return false;
+  }
+  return true;
+}
+
+// 包围球的外接立方体投影到上一帧的屏幕上，取覆盖它的最多 2x2 个纹素的级别，
+// 最近的深度比这些纹素的最大深度还远时被遮挡
+bool occluded(vec3 center, float radius) {
+  vec3 ndcMin = vec3(1.0), ndcMax = vec3(-1.0);
+  for (int i = 0; i < 8; i++) {
+    vec3 corner = center + radius * vec3((i & 1) != 0 ? 1.0 : -1.0, (i & 2) != 0 ? 1.0 : -1.0, (i & 4) != 0 ? 1.0 : -1.0);
+    vec4 clip = previousViewProj * vec4(corner, 1.0);
+    if (clip.w <= 0.0)
+      return false; // 跨过相机平面，不做判断
+    vec3 ndc = clip.xyz / clip.w;
+    ndcMin = min(ndcMin, ndc);
+    ndcMax = max(ndcMax, ndc);
+  }
+  // 上一帧有一部分在屏幕外，那部分没有深度信息
+  if (any(lessThan(ndcMin.xy, vec2(-1.0))) || any(greaterThan(ndcMax.xy, vec2(1.0))))
+    return false;
+  vec2 uvMin = ndcMin.xy * 0.5 + 0.5;
+  vec2 uvMax = ndcMax.xy * 0.5 + 0.5;
+  float nearest = ndcMin.z * 0.5 + 0.5;
+
+  ivec2 size0 = textureSize(hiZ, 0);
+  vec2 size = (uvMax - uvMin) * vec2(size0);
+  int level = clamp(int(ceil(log2(max(max(size.x, size.y), 1.0)))), 0, hiZLevels - 1);
+  // 每个实例的 level 不同，llvmpipe 上 textureSize 的 lod 不一致时会取到别的层级的尺寸，这里按 mip 规则从第 0 层推算
+  ivec2 levelSize = max(size0 >> level, ivec2(1));
+  // 先取第 0 层的像素范围再右移：尺寸为奇数时每级最后一个纹素多覆盖一个，
+  // 直接按 uv * levelSize 选纹素会偏到不包含这些像素的纹素上
+  ivec2 pixelMin = clamp(ivec2(uvMin * vec2(size0)), ivec2(0), size0 - 1);
+  ivec2 pixelMax = clamp(ivec2(uvMax * vec2(size0)), ivec2(0), size0 - 1);
+  ivec2 first = min(pixelMin >> level, levelSize - 1);
+  ivec2 last = min(pixelMax >> level, levelSize - 1);
+  float farthest = 0.0;
+  for (int y = first.y; y <= last.y; y++)
+    for (int x = first.x; x <= last.x; x++)
+      farthest = max(farthest, texelFetch(hiZ, ivec2(x, y), level).r);
+  return nearest > farthest;
+}
+
+void main() {
+  int index = int(gl_GlobalInvocationID.x);
+  if (index >= instanceCount)
+    return;
+  vec4 sphere = spheres[index];
+  if (!insideFrustum(sphere.xyz, sphere.w))
+    return;
+  if (occlusion && occluded(sphere.xyz, sphere.w))
+    return;
+  uint slot = atomicAdd(commands[0].instanceCount, 1u);
+  visibleInstances[slot] = uint(index);
+  for (int i = 1; i < commandCount; i++)
+    atomicAdd(commands[i].instanceCount, 1u);
+}
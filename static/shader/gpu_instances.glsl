@@ -0,0 +1,9 @@
+// GpuCuller 写出的可见实例下标，间接绘制时第 gl_InstanceID 个实例对应 visibleInstances[gl_InstanceID]
+// 需要 #version 430
+layout(std430, binding = 1) readonly buffer VisibleInstances {
+  uint visibleInstances[];
+};
+
+uint visibleInstance() {
+  return visibleInstances[gl_InstanceID];
+}
@@ -0,0 +1,29 @@
+#version 430 core
+// 深度金字塔的一级：scale 为 1 时从深度纹理复制第 0 级，为 2 时取上一级 2x2 的最大深度，
+// 上一级尺寸为奇数时最后一行/列多取一个纹素，保证覆盖完整
+layout(local_size_x = 8, local_size_y = 8) in;
+
+uniform sampler2D source;
+uniform int sourceLevel;
+uniform int scale;
+layout(r32f, binding = 0) writeonly uniform image2D target;
+
+void main() {
+  ivec2 texel = ivec2(gl_GlobalInvocationID.xy);
+  ivec2 targetSize = imageSize(target);
+  if (any(greaterThanEqual(texel, targetSize)))
+    return;
+  ivec2 sourceSize = textureSize(source, sourceLevel);
+  ivec2 extent = ivec2(scale);
+  if (scale == 2) {
+    if (texel.x == targetSize.x - 1 && (sourceSize.x & 1) != 0)
+      extent.x = 3;
+    if (texel.y == targetSize.y - 1 && (sourceSize.y & 1) != 0)
+      extent.y = 3;
+  }
+  float depth = 0.0;
+  for (int y = 0; y < extent.y; y++)
+    for (int x = 0; x < extent.x; x++)
+      depth = max(depth, texelFetch(source, min(texel * scale + ivec2(x, y), sourceSize - 1), sourceLevel).r);
+  imageStore(target, texel, vec4(depth));
+}
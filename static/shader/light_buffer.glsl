@@ -0,0 +1,23 @@
+#include "light_types.glsl"
+
+// 点光源数组存放在纹理缓冲中，每个光源 4 个纹素，数量由 CPU 每帧给出
+uniform samplerBuffer pointLightBuffer;
+uniform int pointLightCount;
+
+PointLight fetchPointLight(int index) {
+  int base = index * 4;
+  vec4 positionConstant = texelFetch(pointLightBuffer, base);
+  vec4 diffuseLinear = texelFetch(pointLightBuffer, base + 1);
+  vec4 specularQuadratic = texelFetch(pointLightBuffer, base + 2);
+  vec4 ambient = texelFetch(pointLightBuffer, base + 3);
+
+  PointLight light;
+  light.position = positionConstant.xyz;
+  light.constant = positionConstant.w;
+  light.linear = diffuseLinear.w;
+  light.quadratic = specularQuadratic.w;
+  light.ambient = ambient.rgb;
+  light.diffuse = diffuseLinear.rgb;
+  light.specular = specularQuadratic.rgb;
+  return light;
+}